@@ -28,6 +28,7 @@
 #include <cstring>
 #include <limits>
 #include <map>
+#include <new>
 #include <sstream>
 #include <stdarg.h> /* va_list, va_start, va_arg, va_end */
 #include <stdint.h>
@@ -136,6 +137,105 @@ public:
   SRSASN_CODE align_bytes_zero();
 };
 
+/*********************
+     memory arena
+*********************/
+
+/**
+ * Bump allocator for the dynamic members of decoded PDUs. While an arena_scope is active on a thread, dyn_array and
+ * copy_ptr take their storage from the arena, and destroying them only runs the destructors of the elements. The
+ * memory is given back in one shot when the arena is reset, so a decoded message costs a handful of pointer bumps
+ * instead of one heap allocation per list, octet string and optional field.
+ */
+class mem_arena
+{
+public:
+  static const size_t default_block_size = 16384;
+
+  explicit mem_arena(size_t block_size_ = default_block_size) : block_size(block_size_) {}
+  ~mem_arena();
+  mem_arena(const mem_arena&) = delete;
+  mem_arena& operator=(const mem_arena&) = delete;
+
+  void* allocate(size_t sz, size_t align);
+  // Frees all the allocations. Objects allocated in the arena must be destroyed before
+  void   reset();
+  size_t nof_bytes_used() const { return used_total; }
+
+  // Arena used by the allocations of the calling thread, or nullptr for the heap
+  static mem_arena* current();
+
+  // Reference counting of the PDUs stored in the arena, which is reset when the last one is destroyed
+  void attach() { nof_users++; }
+  void detach()
+  {
+    if (--nof_users == 0) {
+      reset();
+    }
+  }
+
+private:
+  struct block_t {
+    block_t* next;
+    size_t   size;
+  };
+
+  void free_blocks();
+
+  const size_t block_size;
+  block_t*     blocks     = nullptr;
+  uint8_t*     cur        = nullptr;
+  uint8_t*     end        = nullptr;
+  size_t       used_total = 0;
+  size_t       high_water = 0;
+  uint32_t     nof_users  = 0;
+};
+
+// Makes the calling thread allocate from the arena until the end of the scope
+class arena_scope
+{
+public:
+  explicit arena_scope(mem_arena& arena);
+  ~arena_scope();
+  arena_scope(const arena_scope&) = delete;
+  arena_scope& operator=(const arena_scope&) = delete;
+
+private:
+  mem_arena* prev;
+};
+
+/**
+ * Decoded PDU whose dynamic members live in a mem_arena. Only the unpacking allocates from the arena; copies made
+ * by the message handlers use the heap and can outlive the PDU. The arena is reset once no PDU decoded in it is
+ * alive.
+ */
+template <class T>
+class arena_pdu
+{
+public:
+  explicit arena_pdu(mem_arena& arena_) : holder(arena_) {}
+
+  SRSASN_CODE unpack(cbit_ref& bref)
+  {
+    arena_scope scope(holder.arena);
+    return msg.unpack(bref);
+  }
+
+  T&       operator*() { return msg; }
+  const T& operator*() const { return msg; }
+  T*       operator->() { return &msg; }
+  const T* operator->() const { return &msg; }
+
+private:
+  // Declared before msg, so that the arena is released after msg is destroyed
+  struct arena_holder {
+    explicit arena_holder(mem_arena& arena_) : arena(arena_) { arena.attach(); }
+    ~arena_holder() { arena.detach(); }
+    mem_arena& arena;
+  } holder;
+  T msg;
+};
+
 /*********************
   function helpers
 *********************/
@@ -148,19 +248,19 @@ public:
   using const_iterator = const T*;
 
   dyn_array() = default;
-  explicit dyn_array(uint32_t new_size) : size_(new_size), cap_(new_size) { data_ = new T[size_]; }
+  explicit dyn_array(uint32_t new_size) : size_(new_size), cap_(new_size) { data_ = alloc_items(cap_, in_arena); }
   dyn_array(const dyn_array<T>& other) : dyn_array(&other[0], other.size_) {}
   dyn_array(const T* ptr, uint32_t nof_items)
   {
     size_ = nof_items;
     cap_  = nof_items;
-    data_ = new T[cap_];
+    data_ = alloc_items(cap_, in_arena);
     std::copy(ptr, ptr + size_, data_);
   }
   ~dyn_array()
   {
     if (data_ != NULL) {
-      delete[] data_;
+      free_items(data_, cap_, in_arena);
     }
   }
   uint32_t      size() const { return size_; }
@@ -185,10 +285,12 @@ public:
       size_ = new_size;
       return;
     }
-    T* old_data = data_;
-    cap_        = new_size > new_cap ? new_size : new_cap;
+    T*       old_data     = data_;
+    uint32_t old_cap      = cap_;
+    bool     old_in_arena = in_arena;
+    cap_                  = new_size > new_cap ? new_size : new_cap;
     if (cap_ > 0) {
-      data_ = new T[cap_];
+      data_ = alloc_items(cap_, in_arena);
       if (old_data != NULL) {
         std::copy(&old_data[0], &old_data[size_], data_);
       }
@@ -197,7 +299,7 @@ public:
     }
     size_ = new_size;
     if (old_data != NULL) {
-      delete[] old_data;
+      free_items(old_data, old_cap, old_in_arena);
     }
   }
   bool operator==(const dyn_array<T>& other) const
@@ -219,9 +321,34 @@ public:
   const_iterator end() const { return &data_[size()]; }
 
 private:
-  T*       data_ = nullptr;
-  uint32_t size_ = 0;
-  uint32_t cap_  = 0;
+  static T* alloc_items(uint32_t n, bool& from_arena)
+  {
+    mem_arena* arena = mem_arena::current();
+    from_arena       = arena != nullptr;
+    if (arena == nullptr) {
+      return new T[n];
+    }
+    T* items = static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T)));
+    for (uint32_t i = 0; i < n; ++i) {
+      new (&items[i]) T();
+    }
+    return items;
+  }
+  static void free_items(T* items, uint32_t n, bool from_arena)
+  {
+    if (not from_arena) {
+      delete[] items;
+      return;
+    }
+    for (uint32_t i = 0; i < n; ++i) {
+      items[i].~T();
+    }
+  }
+
+  T*       data_    = nullptr;
+  uint32_t size_    = 0;
+  uint32_t cap_     = 0;
+  bool     in_arena = false;
 };
 
 template <class T, uint32_t MAX_N>
@@ -1037,7 +1164,12 @@ public:
   T*       release()
   {
     T* ret = ptr;
-    ptr    = nullptr;
+    if (in_arena) {
+      // the caller owns the returned pointer, so it can not point to the arena
+      ret = new T(*ptr);
+      destroy_();
+    }
+    ptr = nullptr;
     return ret;
   }
   void reset(T* ptr_ = nullptr)
@@ -1048,6 +1180,13 @@ public:
   void set_present(bool flag = true)
   {
     if (flag) {
+      mem_arena* arena = mem_arena::current();
+      if (arena != nullptr) {
+        destroy_();
+        ptr      = new (arena->allocate(sizeof(T), alignof(T))) T();
+        in_arena = true;
+        return;
+      }
       reset(new T());
     } else {
       reset();
@@ -1059,10 +1198,16 @@ private:
   void destroy_()
   {
     if (ptr != NULL) {
-      delete ptr;
+      if (in_arena) {
+        ptr->~T();
+      } else {
+        delete ptr;
+      }
     }
+    in_arena = false;
   }
-  T* ptr;
+  T*   ptr;
+  bool in_arena = false;
 };
 
 template <class T>
@@ -23,10 +23,13 @@
 #define SRSLTE_BUFFER_POOL_H
 
 #include <algorithm>
+#include <atomic>
+#include <inttypes.h>
 #include <map>
+#include <memory>
 #include <pthread.h>
-#include <stack>
 #include <string>
+#include <time.h>
 #include <vector>
 
 /*******************************************************************************
@@ -38,6 +41,34 @@
 
 namespace srslte {
 
+/******************************************************************************
+ * Per-thread slot used to index the buffer pool caches
+ *
+ * Each thread gets a small index the first time it touches a pool. Indexes are
+ * recycled when threads exit. Threads beyond BUFFER_POOL_MAX_THREADS get
+ * BUFFER_POOL_NO_THREAD_IDX and use the shared depot only.
+ *****************************************************************************/
+
+#define BUFFER_POOL_MAX_THREADS 64
+#define BUFFER_POOL_NO_THREAD_IDX (BUFFER_POOL_MAX_THREADS)
+
+uint32_t buffer_pool_thread_idx();
+
+struct buffer_pool_thread_stats_t {
+  uint32_t thread_idx;
+  uint64_t nof_allocs;
+  uint64_t nof_cache_hits;
+  uint64_t nof_deallocs;
+};
+
+struct buffer_pool_stats_t {
+  uint32_t                                capacity;
+  uint32_t                                nof_available;
+  uint32_t                                high_watermark; // max buffers out of the depot at once
+  uint64_t                                nof_depot_allocs;
+  std::vector<buffer_pool_thread_stats_t> threads;
+};
+
 /******************************************************************************
  * Buffer pool
  *
@@ -45,6 +76,12 @@ namespace srslte {
  * deallocate functions. Provides quick object creation and deletion as well
  * as object reuse.
  * Singleton class of byte_buffer_t (but other pools of different type can be created)
+ *
+ * Buffers are kept in a single array. Free buffers sit either in a lock-free
+ * depot (a tagged stack of indexes) or in a small per-thread cache that is
+ * refilled from and flushed to the depot in batches. The common
+ * allocate/deallocate path touches no lock and no shared cache line. When the
+ * depot runs dry, allocations take buffers from the caches of other threads.
  *****************************************************************************/
 
 template <class buffer_t>
@@ -60,23 +97,39 @@ public:
     }
     pthread_mutex_init(&mutex, NULL);
     pthread_cond_init(&cv_not_empty, NULL);
-    for (uint32_t i = 0; i < nof_buffers; i++) {
-      buffer_t* b = new buffer_t;
-      available.push(b);
-    }
     capacity = nof_buffers;
+
+    // Small pools are not worth caching, they would end up spread over thread caches
+    cache_size  = std::min((uint32_t)MAX_CACHE_SIZE, capacity / 128);
+    cache_batch = cache_size / 2;
+    if (cache_size > 0) {
+      caches.reset(new thread_cache_t[BUFFER_POOL_MAX_THREADS]);
+    }
+
+    buffers.reset(new buffer_t[capacity]);
+    in_use.reset(new std::atomic<uint8_t>[capacity]);
+    next.reset(new std::atomic<uint32_t>[capacity]);
+    for (uint32_t i = 0; i < capacity; i++) {
+      in_use[i].store(0, std::memory_order_relaxed);
+      next[i].store(i + 1 < capacity ? i + 1 : NIL, std::memory_order_relaxed);
+    }
+    depot_head.store(0, std::memory_order_relaxed);
+    depot_count.store(capacity, std::memory_order_relaxed);
+    depot_min_count = capacity;
   }
 
   ~buffer_pool()
   {
-    // this destructor assumes all buffers have been properly deallocated
-    while (available.size()) {
-      delete available.top();
-      available.pop();
+    // Buffers still held by users must not point into freed memory, so in that case the storage is leaked on purpose
+    uint32_t nof_used = 0;
+    for (uint32_t i = 0; i < capacity; i++) {
+      nof_used += in_use[i].load(std::memory_order_relaxed);
     }
-
-    for (uint32_t i = 0; i < used.size(); i++) {
-      delete used[i];
+    if (nof_used > 0) {
+      printf("Warning: destroying buffer pool with %d buffers in use, its memory is not released\n", nof_used);
+      buffers.release();
+      in_use.release();
+      next.release();
     }
     pthread_cond_destroy(&cv_not_empty);
     pthread_mutex_destroy(&mutex);
@@ -84,11 +137,13 @@ public:
 
   void print_all_buffers()
   {
-    printf("%d buffers in queue\n", (int)used.size());
+    printf("%d buffers in queue\n", (int)(capacity - nof_available_pdus()));
 #ifdef SRSLTE_BUFFER_POOL_LOG_ENABLED
     std::map<std::string, uint32_t> buffer_cnt;
-    for (uint32_t i = 0; i < used.size(); i++) {
-      buffer_cnt[strlen(used[i]->debug_name) ? used[i]->debug_name : "Undefined"]++;
+    for (uint32_t i = 0; i < capacity; i++) {
+      if (in_use[i].load(std::memory_order_relaxed)) {
+        buffer_cnt[strlen(buffers[i].debug_name) ? buffers[i].debug_name : "Undefined"]++;
+      }
     }
     std::map<std::string, uint32_t>::iterator it;
     for (it = buffer_cnt.begin(); it != buffer_cnt.end(); it++) {
@@ -97,75 +152,307 @@ public:
 #endif
   }
 
-  uint32_t nof_available_pdus() { return available.size(); }
+  uint32_t nof_available_pdus()
+  {
+    uint32_t n = depot_count.load(std::memory_order_relaxed);
+    for (uint32_t i = 0; caches != nullptr && i < BUFFER_POOL_MAX_THREADS; i++) {
+      n += top_count(caches[i].top.load(std::memory_order_relaxed));
+    }
+    return std::min(n, capacity);
+  }
 
-  bool is_almost_empty() { return available.size() < capacity / 20; }
+  bool is_almost_empty() { return nof_available_pdus() < capacity / 20; }
 
   buffer_t* allocate(const char* debug_name = NULL, bool blocking = false)
   {
-    pthread_mutex_lock(&mutex);
-    buffer_t* b = NULL;
+    uint32_t idx = NIL;
 
-    if (available.size() > 0) {
-      b = available.top();
-      used.push_back(b);
-      available.pop();
+    uint32_t tidx = buffer_pool_thread_idx();
+    if (tidx < BUFFER_POOL_MAX_THREADS && cache_size > 0) {
+      idx = cache_pop(caches[tidx]);
+    } else {
+      idx = depot_pop_one();
+    }
 
-      if (is_almost_empty()) {
-        printf("Warning buffer pool capacity is %f %%\n", (float)100 * available.size() / capacity);
-      }
-#ifdef SRSLTE_BUFFER_POOL_LOG_ENABLED
-      if (debug_name) {
-        strncpy(b->debug_name, debug_name, SRSLTE_BUFFER_POOL_LOG_NAME_LEN);
-        b->debug_name[SRSLTE_BUFFER_POOL_LOG_NAME_LEN - 1] = 0;
-      }
-#endif
-    } else if (blocking) {
-      // blocking allocation
-      while (available.size() == 0) {
-        pthread_cond_wait(&cv_not_empty, &mutex);
-      }
+    if (idx == NIL) {
+      idx = steal_from_caches();
+    }
 
-      // retrieve the new buffer
-      b = available.top();
-      used.push_back(b);
-      available.pop();
+    if (idx == NIL && blocking) {
+      idx = wait_for_buffer();
+    }
 
-      // do not print any warning
-    } else {
+    if (idx == NIL) {
       printf("Error - buffer pool is empty\n");
-
 #ifdef SRSLTE_BUFFER_POOL_LOG_ENABLED
       print_all_buffers();
 #endif
+      return NULL;
     }
 
-    pthread_mutex_unlock(&mutex);
+    in_use[idx].store(1, std::memory_order_relaxed);
+    buffer_t* b = &buffers[idx];
+#ifdef SRSLTE_BUFFER_POOL_LOG_ENABLED
+    if (debug_name) {
+      strncpy(b->debug_name, debug_name, SRSLTE_BUFFER_POOL_LOG_NAME_LEN);
+      b->debug_name[SRSLTE_BUFFER_POOL_LOG_NAME_LEN - 1] = 0;
+    }
+#endif
     return b;
   }
 
   bool deallocate(buffer_t* b)
   {
-    bool ret = false;
+    // Reject buffers not owned by this pool and double frees
+    if (b < &buffers[0] || b >= &buffers[0] + capacity) {
+      return false;
+    }
+    uint32_t idx = (uint32_t)(b - &buffers[0]);
+    if (in_use[idx].exchange(0, std::memory_order_relaxed) == 0) {
+      return false;
+    }
+
+    uint32_t tidx = buffer_pool_thread_idx();
+    if (tidx < BUFFER_POOL_MAX_THREADS && cache_size > 0 && nof_waiting.load() == 0) {
+      cache_push(caches[tidx], idx);
+    } else {
+      depot_push_one(idx);
+      wake_waiting();
+    }
+    return true;
+  }
+
+  buffer_pool_stats_t get_stats()
+  {
+    buffer_pool_stats_t stats = {};
+    stats.capacity            = capacity;
+    stats.nof_available       = nof_available_pdus();
+    stats.high_watermark      = capacity - depot_min_count.load(std::memory_order_relaxed);
+    stats.nof_depot_allocs    = nof_depot_allocs.load(std::memory_order_relaxed);
+    for (uint32_t i = 0; caches != nullptr && i < BUFFER_POOL_MAX_THREADS; i++) {
+      const thread_cache_t& c = caches[i];
+      if (c.nof_allocs.load(std::memory_order_relaxed) || c.nof_deallocs.load(std::memory_order_relaxed)) {
+        buffer_pool_thread_stats_t t = {};
+        t.thread_idx                 = i;
+        t.nof_allocs                 = c.nof_allocs.load(std::memory_order_relaxed);
+        t.nof_cache_hits             = c.nof_hits.load(std::memory_order_relaxed);
+        t.nof_deallocs               = c.nof_deallocs.load(std::memory_order_relaxed);
+        stats.threads.push_back(t);
+      }
+    }
+    return stats;
+  }
+
+  void print_stats()
+  {
+    buffer_pool_stats_t stats = get_stats();
+    printf("Buffer pool: capacity=%d, available=%d, high-watermark=%d, depot-only allocs=%" PRIu64 "\n",
+           stats.capacity,
+           stats.nof_available,
+           stats.high_watermark,
+           stats.nof_depot_allocs);
+    for (const buffer_pool_thread_stats_t& t : stats.threads) {
+      printf(" - thread %2d: allocs=%" PRIu64 ", cache hit rate=%.1f%%, deallocs=%" PRIu64 "\n",
+             t.thread_idx,
+             t.nof_allocs,
+             t.nof_allocs ? 100.0 * t.nof_cache_hits / t.nof_allocs : 0.0,
+             t.nof_deallocs);
+    }
+  }
+
+private:
+  static const int      POOL_SIZE      = 4096;
+  static const int      MAX_CACHE_SIZE = 64;
+  static const uint32_t NIL            = 0xffffffff;
+  static const long     WAIT_POLL_NS   = 10000000;
+
+  // Only the owning thread adds buffers to a cache, any thread may take them. The top of a cache packs the number
+  // of cached buffers with a tag that changes on every update, which avoids ABA between the owner and other threads.
+  // Counters are atomic so that stats can be read from anywhere.
+  struct thread_cache_t {
+    std::atomic<uint64_t> top{0};
+    std::atomic<uint64_t> nof_allocs{0};
+    std::atomic<uint64_t> nof_hits{0};
+    std::atomic<uint64_t> nof_deallocs{0};
+    std::atomic<uint32_t> idx[MAX_CACHE_SIZE];
+    uint8_t               padding[64]; // keep neighbour caches off our cache line
+  };
+
+  static uint32_t top_count(uint64_t top) { return (uint32_t)top; }
+  static uint64_t next_top(uint64_t top, uint32_t count) { return (((top >> 32) + 1) << 32) | count; }
+
+  // Takes up to n of the most recently cached buffers
+  uint32_t cache_take(thread_cache_t& c, uint32_t* out, uint32_t n)
+  {
+    uint64_t top = c.top.load(std::memory_order_acquire);
+    while (top_count(top) > 0) {
+      uint32_t count = top_count(top);
+      uint32_t got   = std::min(n, count);
+      for (uint32_t i = 0; i < got; i++) {
+        out[i] = c.idx[count - got + i].load(std::memory_order_relaxed);
+      }
+      if (c.top.compare_exchange_weak(
+              top, next_top(top, count - got), std::memory_order_acquire, std::memory_order_acquire)) {
+        return got;
+      }
+    }
+    return 0;
+  }
+
+  uint32_t cache_pop(thread_cache_t& c)
+  {
+    c.nof_allocs.store(c.nof_allocs.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    uint32_t idx = NIL;
+    if (cache_take(c, &idx, 1) > 0) {
+      c.nof_hits.store(c.nof_hits.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+      return idx;
+    }
+    // refill from the depot, keep one for the caller
+    uint32_t refill[MAX_CACHE_SIZE];
+    uint32_t got = depot_pop(refill, cache_batch);
+    if (got == 0) {
+      return NIL;
+    }
+    for (uint32_t i = 0; i < got - 1; i++) {
+      c.idx[i].store(refill[i], std::memory_order_relaxed);
+    }
+    // the cache is empty and only this thread adds to it, so nobody else changes the top meanwhile
+    uint64_t top = c.top.load(std::memory_order_relaxed);
+    c.top.store(next_top(top, got - 1), std::memory_order_release);
+    return refill[got - 1];
+  }
+
+  void cache_push(thread_cache_t& c, uint32_t idx)
+  {
+    c.nof_deallocs.store(c.nof_deallocs.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    if (top_count(c.top.load(std::memory_order_relaxed)) == cache_size) {
+      // flush half of the cache to the depot
+      uint32_t flush[MAX_CACHE_SIZE];
+      depot_push(flush, cache_take(c, flush, cache_batch));
+    }
+    // other threads only take buffers, so the count can only drop below cache_size
+    uint64_t top = c.top.load(std::memory_order_relaxed);
+    do {
+      c.idx[top_count(top)].store(idx, std::memory_order_relaxed);
+    } while (!c.top.compare_exchange_weak(
+        top, next_top(top, top_count(top) + 1), std::memory_order_release, std::memory_order_relaxed));
+  }
+
+  // Used when the depot is empty, free buffers may still sit in the caches of threads that stopped allocating
+  uint32_t steal_from_caches()
+  {
+    uint32_t idx = NIL;
+    for (uint32_t i = 0; caches != nullptr && i < BUFFER_POOL_MAX_THREADS; i++) {
+      if (cache_take(caches[i], &idx, 1) > 0) {
+        return idx;
+      }
+    }
+    return NIL;
+  }
+
+  // Depot: Treiber stack of indexes. The upper 32 bits of the head are a tag that avoids ABA.
+  uint32_t depot_pop_one()
+  {
+    uint32_t idx = NIL;
+    if (depot_pop(&idx, 1) > 0) {
+      nof_depot_allocs.fetch_add(1, std::memory_order_relaxed);
+    }
+    return idx;
+  }
+
+  void depot_push_one(uint32_t idx) { depot_push(&idx, 1); }
+
+  uint32_t depot_pop(uint32_t* out, uint32_t n)
+  {
+    uint32_t got = 0;
+    while (got < n) {
+      uint64_t head = depot_head.load(std::memory_order_acquire);
+      uint32_t idx  = (uint32_t)head;
+      if (idx == NIL) {
+        break;
+      }
+      uint64_t new_head = (((head >> 32) + 1) << 32) | next[idx].load(std::memory_order_relaxed);
+      if (depot_head.compare_exchange_weak(head, new_head, std::memory_order_acquire, std::memory_order_relaxed)) {
+        out[got++] = idx;
+      }
+    }
+    if (got > 0) {
+      // the low-watermark is only a statistic, a lost update under contention is fine
+      uint32_t left = depot_count.fetch_sub(got, std::memory_order_relaxed) - got;
+      if (left < depot_min_count.load(std::memory_order_relaxed)) {
+        depot_min_count.store(left, std::memory_order_relaxed);
+      }
+      // warn once each time the pool runs low, not on every allocation
+      if (left < capacity / 20 && not low_warned.load(std::memory_order_relaxed) &&
+          not low_warned.exchange(true, std::memory_order_relaxed)) {
+        printf("Warning buffer pool capacity is %f %%\n", (float)100 * left / capacity);
+      }
+    }
+    return got;
+  }
+
+  void depot_push(const uint32_t* in, uint32_t n)
+  {
+    for (uint32_t i = 0; i < n; i++) {
+      uint64_t head = depot_head.load(std::memory_order_relaxed);
+      uint64_t new_head;
+      do {
+        next[in[i]].store((uint32_t)head, std::memory_order_relaxed);
+        new_head = (((head >> 32) + 1) << 32) | in[i];
+      } while (!depot_head.compare_exchange_weak(head, new_head, std::memory_order_release, std::memory_order_relaxed));
+    }
+    uint32_t count = depot_count.fetch_add(n, std::memory_order_relaxed) + n;
+    if (count > capacity / 10 && low_warned.load(std::memory_order_relaxed)) {
+      low_warned.store(false, std::memory_order_relaxed);
+    }
+  }
+
+  // blocking allocation
+  uint32_t wait_for_buffer()
+  {
+    uint32_t idx = NIL;
+    nof_waiting.fetch_add(1);
     pthread_mutex_lock(&mutex);
-    typename std::vector<buffer_t*>::iterator elem = std::find(used.begin(), used.end(), b);
-    if (elem != used.end()) {
-      used.erase(elem);
-      available.push(b);
-      ret = true;
+    while ((idx = depot_pop_one()) == NIL && (idx = steal_from_caches()) == NIL) {
+      // a buffer freed into a cache just before the waiter registered does not signal, so poll the caches again
+      struct timespec deadline = {};
+      clock_gettime(CLOCK_REALTIME, &deadline);
+      deadline.tv_nsec += WAIT_POLL_NS;
+      if (deadline.tv_nsec >= 1000000000) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000;
+      }
+      pthread_cond_timedwait(&cv_not_empty, &mutex, &deadline);
     }
-    pthread_cond_signal(&cv_not_empty);
     pthread_mutex_unlock(&mutex);
-    return ret;
+    nof_waiting.fetch_sub(1);
+    return idx;
   }
 
-private:
-  static const int       POOL_SIZE = 4096;
-  std::stack<buffer_t*>  available;
-  std::vector<buffer_t*> used;
-  pthread_mutex_t        mutex;
-  pthread_cond_t         cv_not_empty;
-  uint32_t               capacity;
+  void wake_waiting()
+  {
+    if (nof_waiting.load() > 0) {
+      pthread_mutex_lock(&mutex);
+      pthread_cond_signal(&cv_not_empty);
+      pthread_mutex_unlock(&mutex);
+    }
+  }
+
+  uint32_t                                 capacity    = 0;
+  uint32_t                                 cache_size  = 0;
+  uint32_t                                 cache_batch = 0;
+  std::unique_ptr<buffer_t[]>              buffers;
+  std::unique_ptr<std::atomic<uint8_t>[]>  in_use;
+  std::unique_ptr<std::atomic<uint32_t>[]> next;
+  std::atomic<uint64_t>                    depot_head{0};
+  std::atomic<uint32_t>                    depot_count{0};
+  std::atomic<uint32_t>                    depot_min_count{0};
+  std::atomic<uint64_t>                    nof_depot_allocs{0};
+  std::unique_ptr<thread_cache_t[]>        caches;
+  std::atomic<uint32_t>                    nof_waiting{0};
+  std::atomic<bool>                        low_warned{false};
+  pthread_mutex_t                          mutex;
+  pthread_cond_t                           cv_not_empty;
 };
 
 class byte_buffer_pool
@@ -211,7 +498,12 @@ public:
     }
     b = NULL;
   }
-  void print_all_buffers() { pool->print_all_buffers(); }
+  void print_all_buffers()
+  {
+    pool->print_all_buffers();
+    pool->print_stats();
+  }
+  buffer_pool_stats_t get_stats() { return pool->get_stats(); }
 
 private:
   srslte::log*                log;
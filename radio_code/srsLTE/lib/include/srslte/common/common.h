@@ -29,6 +29,7 @@
 #include <memory>
 #include <stdint.h>
 #include <string.h>
+#include <vector>
 
 /*******************************************************************************
                               DEFINES
@@ -264,6 +265,9 @@ public:
 
 typedef std::unique_ptr<byte_buffer_t, byte_buffer_deleter> unique_byte_buffer_t;
 
+// Burst of buffers handed over between layers in a single call
+typedef std::vector<unique_byte_buffer_t> unique_byte_buffer_list_t;
+
 } // namespace srslte
 
 #endif // SRSLTE_COMMON_H
@@ -164,6 +164,32 @@ LIBLTE_ERROR_ENUM liblte_security_generate_k_up(uint8*
                                                 uint8*                                      k_up_enc,
                                                 uint8*                                      k_up_int);
 
+/*********************************************************************
+    Name: liblte_security_aes_ctx_alloc
+
+    Description: Precomputes the AES-128 key context used by EEA2 and
+                 EIA2, so the key is not expanded for every message.
+                 By default uses AES-NI when supported by the CPU.
+                 Returns NULL if the requested backend is not
+                 available.
+
+    Document Reference: -
+*********************************************************************/
+// Defines
+// Enums
+typedef enum {
+  LIBLTE_SECURITY_AES_BACKEND_AUTO = 0,
+  LIBLTE_SECURITY_AES_BACKEND_LIBRARY,
+  LIBLTE_SECURITY_AES_BACKEND_AESNI,
+  LIBLTE_SECURITY_AES_BACKEND_N_ITEMS,
+} LIBLTE_SECURITY_AES_BACKEND_ENUM;
+// Structs
+typedef struct LIBLTE_SECURITY_AES_CTX_STRUCT_S LIBLTE_SECURITY_AES_CTX_STRUCT;
+// Functions
+LIBLTE_SECURITY_AES_CTX_STRUCT*
+liblte_security_aes_ctx_alloc(uint8* key, LIBLTE_SECURITY_AES_BACKEND_ENUM backend = LIBLTE_SECURITY_AES_BACKEND_AUTO);
+void liblte_security_aes_ctx_free(LIBLTE_SECURITY_AES_CTX_STRUCT* ctx);
+
 /*********************************************************************
     Name: liblte_security_128_eia2
 
@@ -186,6 +212,13 @@ LIBLTE_ERROR_ENUM liblte_security_128_eia2(uint8* key,
                                            uint8* msg,
                                            uint32 msg_len,
                                            uint8* mac);
+LIBLTE_ERROR_ENUM liblte_security_128_eia2(LIBLTE_SECURITY_AES_CTX_STRUCT* ctx,
+                                           uint32                          count,
+                                           uint8                           bearer,
+                                           uint8                           direction,
+                                           uint8*                          msg,
+                                           uint32                          msg_len,
+                                           uint8*                          mac);
 LIBLTE_ERROR_ENUM liblte_security_128_eia2(uint8*                 key,
                                            uint32                 count,
                                            uint8                  bearer,
@@ -250,6 +283,13 @@ LIBLTE_ERROR_ENUM liblte_security_encryption_eea2(uint8* key,
                                                   uint8* msg,
                                                   uint32 msg_len,
                                                   uint8* out);
+LIBLTE_ERROR_ENUM liblte_security_encryption_eea2(LIBLTE_SECURITY_AES_CTX_STRUCT* ctx,
+                                                  uint32                          count,
+                                                  uint8                           bearer,
+                                                  uint8                           direction,
+                                                  uint8*                          msg,
+                                                  uint32                          msg_len,
+                                                  uint8*                          out);
 
 /*********************************************************************
     Name: liblte_security_decryption_eea2
@@ -265,6 +305,13 @@ LIBLTE_ERROR_ENUM liblte_security_decryption_eea2(uint8* key,
                                                   uint8* ct,
                                                   uint32 ct_len,
                                                   uint8* out);
+LIBLTE_ERROR_ENUM liblte_security_decryption_eea2(LIBLTE_SECURITY_AES_CTX_STRUCT* ctx,
+                                                  uint32                          count,
+                                                  uint8                           bearer,
+                                                  uint8                           direction,
+                                                  uint8*                          ct,
+                                                  uint32                          ct_len,
+                                                  uint8*                          out);
 
 LIBLTE_ERROR_ENUM liblte_security_encryption_eea3(uint8* key,
                                                   uint32 count,
@@ -0,0 +1,450 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/******************************************************************************
+ *  File:         lockfree_multiqueue.h
+ *  Description:  Multiqueue with the same interface as multiqueue_handler,
+ *                where each queue is a bounded lock-free ring with many
+ *                producers and a single consumer. Producers never take a
+ *                lock, and a blocked consumer or producer sleeps on a futex
+ *                that is only signalled when someone is waiting. Queues have
+ *                a priority, and the consumer can pop several objects at once.
+ *****************************************************************************/
+
+#ifndef SRSLTE_LOCKFREE_MULTIQUEUE_H
+#define SRSLTE_LOCKFREE_MULTIQUEUE_H
+
+#include <atomic>
+#include <linux/futex.h>
+#include <memory>
+#include <mutex>
+#include <sched.h>
+#include <stdint.h>
+#include <sys/syscall.h>
+#include <type_traits>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+namespace srslte {
+
+namespace mq_details {
+
+//! Wakes up threads that sleep until a condition, checked without a lock, changes. The notifier only makes a syscall
+//! if there are threads waiting
+class futex_event
+{
+public:
+  //! Registers the calling thread as a waiter. The condition must be checked after this call and before wait()
+  uint32_t prepare_wait()
+  {
+    nof_waiters.fetch_add(1);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    return seq.load(std::memory_order_acquire);
+  }
+
+  void cancel_wait() { nof_waiters.fetch_sub(1); }
+
+  //! Sleeps until notified, unless there was a notification since prepare_wait() returned key
+  void wait(uint32_t key)
+  {
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&seq), FUTEX_WAIT_PRIVATE, key, nullptr, nullptr, 0);
+    nof_waiters.fetch_sub(1);
+  }
+
+  void notify_one() { notify(1); }
+  void notify_all() { notify(INT32_MAX); }
+
+  uint32_t get_nof_waiters() const { return nof_waiters.load(); }
+
+private:
+  void notify(int count)
+  {
+    // orders the change of the condition before the check of waiters, and pairs with the fence in prepare_wait()
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (nof_waiters.load(std::memory_order_relaxed) > 0) {
+      seq.fetch_add(1, std::memory_order_release);
+      syscall(SYS_futex, reinterpret_cast<uint32_t*>(&seq), FUTEX_WAKE_PRIVATE, count, nullptr, nullptr, 0);
+    }
+  }
+
+  static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex word must be a plain uint32_t");
+
+  std::atomic<uint32_t> seq{0};
+  std::atomic<uint32_t> nof_waiters{0};
+};
+
+//! Bounded ring with many producers and one consumer. Each cell has a sequence number that tells whether it is free
+//! for the producer that claimed its position, or holds an object for the consumer
+template <typename myobj>
+class mpsc_ring
+{
+  struct cell_t {
+    std::atomic<size_t>                                                seq;
+    typename std::aligned_storage<sizeof(myobj), alignof(myobj)>::type storage;
+
+    myobj* get() { return reinterpret_cast<myobj*>(&storage); }
+  };
+  static const size_t cache_line_size = 64;
+
+public:
+  explicit mpsc_ring(uint32_t cap) : mask(round_up_pow2(cap) - 1), cells(new cell_t[mask + 1])
+  {
+    for (size_t i = 0; i <= mask; ++i) {
+      cells[i].seq.store(i, std::memory_order_relaxed);
+    }
+  }
+  mpsc_ring(const mpsc_ring&) = delete;
+  mpsc_ring& operator=(const mpsc_ring&) = delete;
+  ~mpsc_ring() { clear(); }
+
+  size_t capacity() const { return mask + 1; }
+
+  //! Approximate when called concurrently with push/pop
+  size_t size() const
+  {
+    size_t r = head.load(std::memory_order_acquire);
+    size_t w = tail.load(std::memory_order_acquire);
+    return w > r ? w - r : 0;
+  }
+  bool empty() const { return size() == 0; }
+
+  //! Thread-safe. The object is only moved from if the push succeeds
+  template <typename T>
+  bool try_push(T&& o)
+  {
+    size_t  pos = tail.load(std::memory_order_relaxed);
+    cell_t* c;
+    for (;;) {
+      c            = &cells[pos & mask];
+      size_t   seq = c->seq.load(std::memory_order_acquire);
+      intptr_t dif = (intptr_t)seq - (intptr_t)pos;
+      if (dif == 0) {
+        if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (dif < 0) {
+        // the consumer has not freed this cell yet
+        return false;
+      } else {
+        pos = tail.load(std::memory_order_relaxed);
+      }
+    }
+    ::new (&c->storage) myobj(std::forward<T>(o));
+    c->seq.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  //! Consumer thread only
+  bool try_pop(myobj* value)
+  {
+    size_t  pos = head.load(std::memory_order_relaxed);
+    cell_t& c   = cells[pos & mask];
+    if (c.seq.load(std::memory_order_acquire) != pos + 1) {
+      // empty, or the producer that claimed the cell is still writing it
+      return false;
+    }
+    if (value != nullptr) {
+      *value = std::move(*c.get());
+    }
+    c.get()->~myobj();
+    c.seq.store(pos + mask + 1, std::memory_order_release);
+    head.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  //! Consumer thread only
+  void clear()
+  {
+    while (try_pop(nullptr)) {
+    }
+  }
+
+private:
+  static size_t round_up_pow2(uint32_t n)
+  {
+    size_t v = 1;
+    while (v < n) {
+      v <<= 1;
+    }
+    return v;
+  }
+
+  const size_t              mask;
+  std::unique_ptr<cell_t[]> cells;
+  char                      pad0[cache_line_size];
+  std::atomic<size_t>       tail{0};
+  char                      pad1[cache_line_size];
+  std::atomic<size_t>       head{0};
+  char                      pad2[cache_line_size];
+};
+
+} // namespace mq_details
+
+/**
+ * Lock-free counterpart of multiqueue_handler. Any thread can push, but only one thread at a time may pop or erase
+ * queues. Queues are popped in order of priority, and round-robin among queues of equal priority.
+ * Queue capacities are rounded up to a power of two.
+ */
+template <typename myobj>
+class lockfree_multiqueue_handler
+{
+  struct queue_t {
+    explicit queue_t(uint32_t cap) : ring(cap) {}
+    mq_details::mpsc_ring<myobj> ring;
+    std::atomic<bool>            active{false};
+    std::atomic<int>             priority{0};
+  };
+
+public:
+  class queue_handler
+  {
+  public:
+    queue_handler() = default;
+    queue_handler(lockfree_multiqueue_handler<myobj>* parent_, int id) : parent(parent_), queue_id(id) {}
+    template <typename FwdRef>
+    void push(FwdRef&& value)
+    {
+      parent->push(queue_id, std::forward<FwdRef>(value));
+    }
+    bool                   try_push(const myobj& value) { return parent->try_push(queue_id, value); }
+    std::pair<bool, myobj> try_push(myobj&& value) { return parent->try_push(queue_id, std::move(value)); }
+
+  private:
+    lockfree_multiqueue_handler<myobj>* parent   = nullptr;
+    int                                 queue_id = -1;
+  };
+
+  explicit lockfree_multiqueue_handler(uint32_t capacity_ = 8192, uint32_t max_queues = 16) :
+    capacity(capacity_),
+    queues(max_queues)
+  {
+  }
+  ~lockfree_multiqueue_handler() { reset(); }
+
+  void reset()
+  {
+    running.store(false);
+    // unblock all producers and consumers, and wait for them to return
+    while (not_empty.get_nof_waiters() > 0 or not_full.get_nof_waiters() > 0) {
+      not_empty.notify_all();
+      not_full.notify_all();
+      sched_yield();
+    }
+    uint32_t n = nof_slots.load(std::memory_order_acquire);
+    for (uint32_t i = 0; i < n; ++i) {
+      queues[i]->active.store(false);
+      queues[i]->ring.clear();
+    }
+  }
+
+  //! Queues with higher priority are popped first
+  int add_queue(int priority = 0)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (not running.load()) {
+      return -1;
+    }
+    uint32_t n    = nof_slots.load(std::memory_order_relaxed);
+    uint32_t qidx = 0;
+    for (; qidx < n and queues[qidx]->active.load(); ++qidx)
+      ;
+    if (qidx == n) {
+      if (n == queues.size()) {
+        return -1;
+      }
+      // create new queue. Slots are never freed while the multiqueue is alive, so they can be read without the lock
+      queues[qidx].reset(new queue_t(capacity));
+      nof_slots.store(n + 1, std::memory_order_release);
+    }
+    queues[qidx]->priority.store(priority);
+    queues[qidx]->active.store(true, std::memory_order_release);
+    return (int)qidx;
+  }
+
+  int nof_queues()
+  {
+    uint32_t n     = nof_slots.load(std::memory_order_acquire);
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < n; ++i) {
+      count += queues[i]->active.load() ? 1 : 0;
+    }
+    return count;
+  }
+
+  //! Blocks while the queue is full
+  template <typename FwdRef>
+  void push(int q_idx, FwdRef&& value)
+  {
+    while (is_queue_active(q_idx)) {
+      if (queues[q_idx]->ring.try_push(std::forward<FwdRef>(value))) {
+        not_empty.notify_one();
+        return;
+      }
+      uint32_t key = not_full.prepare_wait();
+      if (not is_queue_active(q_idx) or queues[q_idx]->ring.size() < queues[q_idx]->ring.capacity()) {
+        not_full.cancel_wait();
+        continue;
+      }
+      not_full.wait(key);
+    }
+  }
+
+  bool try_push(int q_idx, const myobj& value)
+  {
+    if (not is_queue_active(q_idx) or not queues[q_idx]->ring.try_push(value)) {
+      return false;
+    }
+    not_empty.notify_one();
+    return true;
+  }
+
+  std::pair<bool, myobj> try_push(int q_idx, myobj&& value)
+  {
+    if (not is_queue_active(q_idx) or not queues[q_idx]->ring.try_push(std::move(value))) {
+      return {false, std::move(value)};
+    }
+    not_empty.notify_one();
+    return {true, std::move(value)};
+  }
+
+  //! Blocks until an object is available. Returns its queue, or -1 if the multiqueue was reset
+  int wait_pop(myobj* value)
+  {
+    while (running.load(std::memory_order_relaxed)) {
+      int qidx = pop_(value);
+      if (qidx >= 0) {
+        not_full.notify_all();
+        return qidx;
+      }
+      wait_not_empty();
+    }
+    return -1;
+  }
+
+  int try_pop(myobj* value)
+  {
+    if (not running.load(std::memory_order_relaxed)) {
+      return -1;
+    }
+    int qidx = pop_(value);
+    if (qidx >= 0) {
+      not_full.notify_all();
+    }
+    return qidx;
+  }
+
+  //! Blocks until at least one object is available, and pops up to max_values objects. Returns the number of objects
+  //! popped, which is zero if the multiqueue was reset
+  uint32_t wait_pop_batch(myobj* values, uint32_t max_values)
+  {
+    while (running.load(std::memory_order_relaxed)) {
+      uint32_t n = 0;
+      while (n < max_values and pop_(&values[n]) >= 0) {
+        n++;
+      }
+      if (n > 0) {
+        not_full.notify_all();
+        return n;
+      }
+      wait_not_empty();
+    }
+    return 0;
+  }
+
+  bool empty(int qidx) { return queues[qidx]->ring.empty(); }
+
+  size_t size(int qidx) { return queues[qidx]->ring.size(); }
+
+  void erase_queue(int qidx)
+  {
+    if (is_queue_active(qidx)) {
+      queues[qidx]->active.store(false);
+      queues[qidx]->ring.clear();
+      not_full.notify_all();
+    }
+  }
+
+  bool is_queue_active(int qidx) const
+  {
+    return running.load(std::memory_order_relaxed) and qidx >= 0 and
+           (uint32_t)qidx < nof_slots.load(std::memory_order_acquire) and
+           queues[qidx]->active.load(std::memory_order_acquire);
+  }
+
+  queue_handler get_queue_handler(int priority = 0) { return {this, add_queue(priority)}; }
+
+private:
+  void wait_not_empty()
+  {
+    uint32_t key = not_empty.prepare_wait();
+    if (not running.load() or has_pending_()) {
+      not_empty.cancel_wait();
+      return;
+    }
+    not_empty.wait(key);
+  }
+
+  bool has_pending_() const
+  {
+    uint32_t n = nof_slots.load(std::memory_order_acquire);
+    for (uint32_t i = 0; i < n; ++i) {
+      if (queues[i]->active.load(std::memory_order_relaxed) and not queues[i]->ring.empty()) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Pops from the non-empty queue with the highest priority. Queues of equal priority are visited round-robin
+  int pop_(myobj* value)
+  {
+    uint32_t n    = nof_slots.load(std::memory_order_acquire);
+    int      best = -1;
+    for (uint32_t i = 0; i < n; ++i) {
+      uint32_t qidx = (spin_idx + 1 + i) % n;
+      queue_t& q    = *queues[qidx];
+      if (not q.active.load(std::memory_order_relaxed) or q.ring.empty()) {
+        continue;
+      }
+      if (best < 0 or q.priority.load(std::memory_order_relaxed) > queues[best]->priority.load()) {
+        best = qidx;
+      }
+    }
+    if (best < 0 or not queues[best]->ring.try_pop(value)) {
+      return -1;
+    }
+    spin_idx = best;
+    return best;
+  }
+
+  const uint32_t                        capacity;
+  std::vector<std::unique_ptr<queue_t>> queues;
+  std::atomic<uint32_t>                 nof_slots{0};
+  std::atomic<bool>                     running{true};
+  uint32_t                              spin_idx = 0;
+  std::mutex                            mutex; // Protects the creation of queues
+  mq_details::futex_event               not_empty, not_full;
+};
+
+} // namespace srslte
+
+#endif // SRSLTE_LOCKFREE_MULTIQUEUE_H
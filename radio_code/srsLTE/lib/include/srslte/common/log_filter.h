@@ -42,6 +42,8 @@ namespace srslte {
 
 typedef std::string* str_ptr;
 
+class logger_binary;
+
 class log_filter : public srslte::log
 {
 public:
@@ -77,8 +79,10 @@ public:
   void set_time_src(time_itf* source, time_format_t format);
 
 protected:
-  logger* logger_h;
-  bool    do_tti;
+  logger*        logger_h;
+  logger_binary* binary_h          = nullptr; // Set if logger_h takes unformatted messages
+  uint16_t       binary_service_id = 0;
+  bool           do_tti;
 
   static const int char_buff_size = logger::preallocated_log_str_size - 64 * 3;
 
@@ -93,6 +97,11 @@ protected:
                       const uint8_t*         hex      = nullptr,
                       int                    size     = 0,
                       bool                   long_msg = false);
+  void        binary_log(srslte::LOG_LEVEL_ENUM level,
+                         const char*            msg,
+                         va_list                args,
+                         const uint8_t*         hex  = nullptr,
+                         int                    size = 0);
   void        now_time(char* buffer, const uint32_t buffer_len);
   void        get_tti_str(const uint32_t tti_, char* buffer, const uint32_t buffer_len);
   std::string hex_string(const uint8_t* hex, int size);
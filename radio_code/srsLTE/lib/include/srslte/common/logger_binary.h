@@ -0,0 +1,157 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/******************************************************************************
+ * File:        logger_binary.h
+ * Description: Asynchronous log object with per-thread ring buffers.
+ *              log_filter stores the format string id and the raw
+ *              arguments of each message in a lock-free ring owned by the
+ *              calling thread. A backend thread drains the rings and
+ *              either formats the messages to a text file, with the same
+ *              output as logger_file, or writes the records to a compact
+ *              binary file that is decoded offline (srslte_log_decoder).
+ *              Producers never block: if a ring is full the message is
+ *              dropped and counted.
+ *****************************************************************************/
+
+#ifndef SRSLTE_LOGGER_BINARY_H
+#define SRSLTE_LOGGER_BINARY_H
+
+#include "srslte/common/logger.h"
+#include "srslte/common/threads.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace srslte {
+
+class log_ring;
+struct log_fmt_t;
+
+// Per-message metadata, filled by log_filter on the calling thread
+struct log_meta_t {
+  // Flags
+  static const uint8_t flag_tti = 0x1; // Print the TTI
+  static const uint8_t flag_raw = 0x2; // Message is written as is, without time, service or level
+
+  // How time_us is printed, mirrors log_filter::now_time()
+  enum time_fmt_t : uint8_t { TIME_OF_DAY = 0, EPOCH_US, SECS_US };
+
+  uint64_t           time_us    = 0;
+  uint32_t           tti        = 0;
+  uint16_t           service_id = 0;
+  uint8_t            level      = 0;
+  uint8_t            flags      = 0;
+  time_fmt_t         time_fmt   = TIME_OF_DAY;
+  const std::string* prefix     = nullptr; // log::prepend_string() text, if enabled
+};
+
+class logger_binary : public thread, public logger
+{
+public:
+  typedef enum { TEXT, BINARY } output_t;
+
+  static const uint32_t default_ring_size = 256 * 1024;
+
+  logger_binary();
+  ~logger_binary();
+  void init(std::string file, output_t output_ = TEXT, int max_length_ = -1, uint32_t ring_size_ = default_ring_size);
+  void stop();
+
+  // Implementation of log_out, for messages that are already formatted
+  void log(unique_log_str_t msg);
+
+  // Returns the id that log_filter passes in log_meta_t for a layer name
+  uint16_t register_service(const std::string& name);
+
+  // Stores a printf-style message without formatting it. fmt must stay valid and unmodified for the lifetime of the
+  // logger, which holds for string literals. Formats with conversions that can not be stored raw (%n, %m, positional
+  // arguments, wide strings) are formatted on the calling thread instead.
+  void log_fmt(const log_meta_t& meta,
+               const char*       fmt,
+               va_list           args,
+               const uint8_t*    hex     = nullptr,
+               uint32_t          hex_len = 0);
+  void log_text(const log_meta_t& meta,
+                const char*       msg,
+                uint32_t          len,
+                const uint8_t*    hex     = nullptr,
+                uint32_t          hex_len = 0);
+
+  uint64_t get_nof_dropped() const { return nof_dropped; }
+
+  // Writes the text form of a binary log file to out. Returns the number of messages, or -1 if the file is malformed
+  static int decode(FILE* in, FILE* out);
+
+private:
+  void      run_thread();
+  bool      drain();
+  void      write_record(const uint8_t* rec);
+  void      write_raw(const char* msg);
+  void      write_out(const void* data, size_t len);
+  void      start_file();
+  void      rotate_file();
+  log_ring* get_ring();
+  uint32_t  get_fmt_id(const char* fmt, const log_fmt_t** desc);
+  void      refresh_dictionaries();
+
+  const uint64_t instance_id;
+
+  output_t    output     = TEXT;
+  uint32_t    ring_size  = default_ring_size;
+  uint32_t    name_idx   = 0;
+  int64_t     max_length = 0;
+  int64_t     cur_length = 0;
+  FILE*       logfile    = nullptr;
+  std::string filename;
+
+  std::atomic<bool> is_running;
+  bool              pending_flush = false;
+
+  // Producer rings. Rings of exited threads are freed once drained
+  std::mutex                             ring_mutex;
+  std::vector<std::shared_ptr<log_ring>> rings;
+  std::atomic<uint32_t>                  rings_version;
+  std::vector<std::shared_ptr<log_ring>> backend_rings;
+  uint32_t                               backend_rings_version = 0;
+
+  // Format strings and layer names, indexed by id. Only appended to
+  std::mutex                                dict_mutex;
+  std::unordered_map<const char*, uint32_t> fmt_ids;
+  std::vector<std::unique_ptr<log_fmt_t>>   fmts;
+  std::vector<std::string>                  services;
+  std::vector<const log_fmt_t*>             backend_fmts;
+  std::vector<std::string>                  backend_services;
+  uint32_t                                  nof_written_fmts     = 0;
+  uint32_t                                  nof_written_services = 0;
+
+  std::string           line;
+  std::atomic<uint64_t> nof_dropped;
+};
+
+} // namespace srslte
+
+#endif // SRSLTE_LOGGER_BINARY_H
@@ -23,21 +23,45 @@
 #define SRSLTE_MAC_PCAP_H
 
 #include "srslte/common/pcap.h"
+#include "srslte/common/threads.h"
+#include <atomic>
+#include <memory>
 #include <stdint.h>
+#include <string>
+#include <vector>
 
 namespace srslte {
 
-class mac_pcap
+class mac_pcap_ring;
+
+class mac_pcap : public thread
 {
 public:
+  static const uint32_t default_ring_size = 16 * 1024 * 1024;
+
   mac_pcap();
   ~mac_pcap();
   void enable(bool en);
   void open(const char* filename, uint32_t ue_id = 0);
+  // Asynchronous capture: PDUs are copied to a lock-free ring and written to file in batches by a background thread,
+  // so the calling threads never wait for file I/O. PDUs that do not fit in the ring are dropped and counted.
+  // The file is rotated to filename.1, filename.2, ... after max_file_size_kb or rotation_period_s (if not -1 or 0)
+  void open_async(const char* filename,
+                  uint32_t    ue_id             = 0,
+                  int         max_file_size_kb  = -1,
+                  uint32_t    rotation_period_s = 0,
+                  uint32_t    ring_size         = default_ring_size);
   void close();
 
   void set_ue_id(uint16_t ue_id);
 
+  // Comma-separated lists of RNTIs and LCIDs. If not empty, only the PDUs of the listed C-RNTIs and the PDUs with a
+  // subheader of one of the listed LCIDs are written. PDUs of common RNTIs (SI, P, RA, M) are never filtered.
+  // Must be set before the capture is opened
+  int set_filters(const std::string& rnti_list, const std::string& lcid_list);
+
+  uint64_t get_nof_dropped() const { return nof_dropped; }
+
   void
        write_ul_crnti(uint8_t* pdu, uint32_t pdu_len_bytes, uint16_t crnti, uint32_t reTX, uint32_t tti, uint8_t cc_idx);
   void write_dl_crnti(uint8_t* pdu, uint32_t pdu_len_bytes, uint16_t crnti, bool crc_ok, uint32_t tti, uint8_t cc_idx);
@@ -55,9 +79,32 @@ public:
   void write_sl_crnti(uint8_t* pdu, uint32_t pdu_len_bytes, uint16_t rnti, uint32_t reTX, uint32_t tti, uint8_t cc_idx);
 
 private:
+  void run_thread();
+  bool drain();
+  void write_batch();
+  void rotate_file(uint32_t ts_sec);
+  bool lcid_filter_match(const uint8_t* pdu, uint32_t pdu_len_bytes, uint8_t direction);
+
   bool     enable_write;
   FILE*    pcap_file;
   uint32_t ue_id;
+
+  // Asynchronous capture
+  std::unique_ptr<mac_pcap_ring> ring;
+  std::atomic<bool>              is_running;
+  std::atomic<uint64_t>          nof_dropped;
+  std::vector<uint8_t>           batch;
+  std::string                    filename;
+  uint32_t                       name_idx        = 0;
+  int64_t                        max_file_size   = 0;
+  int64_t                        cur_file_size   = 0;
+  uint32_t                       rotation_period = 0;
+  uint32_t                       file_start_sec  = 0;
+
+  // Filters, empty if disabled
+  std::vector<bool> rnti_filter;
+  std::vector<bool> lcid_filter;
+
   void     pack_and_write(uint8_t* pdu,
                           uint32_t pdu_len_bytes,
                           uint32_t reTX,
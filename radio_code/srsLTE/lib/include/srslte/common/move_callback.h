@@ -23,6 +23,9 @@
 #define SRSLTE_MOVE_CALLBACK_H
 
 #include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
 #include <functional>
 #include <type_traits>
 
@@ -177,7 +180,7 @@ public:
 
   R operator()(Args&&... args) const noexcept { return oper_ptr->call(&buffer, std::forward<Args>(args)...); }
 
-  bool is_empty() const { return oper_ptr == empty_table; }
+  bool is_empty() const { return oper_ptr == &empty_table; }
   bool is_in_small_buffer() const { return oper_ptr->is_in_small_buffer(); }
 
 private:
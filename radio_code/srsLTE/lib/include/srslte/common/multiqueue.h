@@ -28,6 +28,7 @@
 #ifndef SRSLTE_MULTIQUEUE_H
 #define SRSLTE_MULTIQUEUE_H
 
+#include "lockfree_multiqueue.h"
 #include "move_callback.h"
 #include <algorithm>
 #include <condition_variable>
@@ -121,8 +122,10 @@ public:
         queues[i].cv_full.notify_all();
       }
       lock.lock();
-      // wait for all threads to unblock
-      cv_exit.wait(lock);
+      // wait for all threads to unblock. They may have left while the lock was released
+      if (nof_threads_waiting > 0) {
+        cv_exit.wait(lock);
+      }
     }
     queues.clear();
   }
@@ -302,8 +305,8 @@ private:
   uint32_t                     nof_threads_waiting = 0;
 };
 
-//! Specialization for tasks
-using task_multiqueue = multiqueue_handler<move_task_t>;
+//! Specialization for tasks. Producers are PHY workers, timers and sockets, so the queues of the stacks are lock-free
+using task_multiqueue = lockfree_multiqueue_handler<move_task_t>;
 
 } // namespace srslte
 
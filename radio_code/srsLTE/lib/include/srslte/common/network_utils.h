@@ -34,6 +34,7 @@
 #include <sys/socket.h>
 #include <sys/types.h>
 #include <unistd.h> // for the pipe
+#include <vector>
 
 namespace srslte {
 
@@ -103,6 +104,38 @@ int  tcp_accept(socket_handler_t* socket, sockaddr_in* destaddr);
 int  tcp_read(int remotefd, void* buf, size_t nbytes);
 int  tcp_send(int remotefd, const void* buf, size_t nbytes);
 
+// Batched UDP
+const uint32_t UDP_MAX_BATCH = 32;
+
+// Receives up to bufs.size() datagrams in one recvmmsg(...) call, without blocking. Datagrams are written in place
+// at bufs[i]->msg. Returns the number received (filling the first entries of bufs and from), or -1 on error.
+int udp_recv_burst(int fd, unique_byte_buffer_list_t& bufs, std::vector<sockaddr_in>& from);
+
+/**
+ * Description - Queues outgoing UDP PDUs and sends them with a single sendmmsg(...) call.
+ *               PDUs are held until sent, so headers can be written in place before queueing.
+ */
+class udp_tx_batch
+{
+public:
+  udp_tx_batch()                    = default;
+  udp_tx_batch(const udp_tx_batch&) = delete;
+  udp_tx_batch& operator=(const udp_tx_batch&) = delete;
+
+  // Queues a PDU. The batch is sent when it is full or the socket changes. Returns false if a send failed
+  bool push(int fd, unique_byte_buffer_t pdu, const sockaddr_in& dest);
+  // Sends all queued PDUs. Returns false if any of them could not be sent
+  bool   flush();
+  bool   empty() const { return nof_pdus == 0; }
+  size_t size() const { return nof_pdus; }
+
+private:
+  int                  fd       = -1;
+  uint32_t             nof_pdus = 0;
+  unique_byte_buffer_t pdus[UDP_MAX_BATCH];
+  sockaddr_in          dests[UDP_MAX_BATCH];
+};
+
 } // namespace net_utils
 
 /****************************
@@ -126,6 +159,8 @@ public:
   };
   using task_callback_t     = std::unique_ptr<recv_task>;
   using recvfrom_callback_t = std::function<void(srslte::unique_byte_buffer_t, const sockaddr_in&)>;
+  using recvmmsg_callback_t =
+      std::function<void(srslte::unique_byte_buffer_list_t&, const std::vector<sockaddr_in>&)>;
   using sctp_recv_callback_t =
       std::function<void(srslte::unique_byte_buffer_t, const sockaddr_in&, const sctp_sndrcvinfo&, int)>;
 
@@ -141,6 +176,7 @@ public:
   bool add_socket_handler(int fd, task_callback_t handler);
   // convenience methods for recv using buffer pool
   bool add_socket_pdu_handler(int fd, recvfrom_callback_t pdu_task);
+  bool add_socket_pdu_burst_handler(int fd, recvmmsg_callback_t burst_task);
   bool add_socket_sctp_pdu_handler(int fd, sctp_recv_callback_t task);
 
   void run_thread() override;
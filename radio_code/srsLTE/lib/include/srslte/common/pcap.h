@@ -81,6 +81,7 @@ typedef struct pcaprec_hdr_s {
 #define MAC_LTE_CRC_STATUS_TAG 0x07
 #define MAC_LTE_CARRIER_ID_TAG 0x0A
 #define MAC_LTE_NB_MODE_TAG 0x0F
+#define MAC_LTE_CONTEXT_MAX_LEN 32
 
 /* Context information for every MAC PDU that will be logged */
 typedef struct MAC_Context_Info_t {
@@ -194,6 +195,9 @@ FILE* LTE_PCAP_Open(uint32_t DLT, const char* fileName);
 /* Close the PCAP file */
 void LTE_PCAP_Close(FILE* fd);
 
+/* Pack the mac-context that precedes a MAC PDU. Returns the number of bytes written, or -1 if buffer is too small */
+int LTE_PCAP_PACK_MAC_CONTEXT_TO_BUFFER(MAC_Context_Info_t* context, uint8_t* buffer, unsigned int length);
+
 /* Write an individual MAC PDU (PCAP packet header + mac-context + mac-pdu) */
 int LTE_PCAP_MAC_WritePDU(FILE* fd, MAC_Context_Info_t* context, const unsigned char* PDU, unsigned int length);
 
@@ -28,6 +28,8 @@
 
 #include "srslte/common/common.h"
 
+struct LIBLTE_SECURITY_AES_CTX_STRUCT_S;
+
 namespace srslte {
 
 typedef enum {
@@ -71,6 +73,27 @@ struct as_security_config_t {
   CIPHERING_ALGORITHM_ID_ENUM cipher_algo;
 };
 
+/******************************************************************************
+ * Precomputed AES-128 key schedule and CMAC subkeys for EEA2/EIA2
+ *****************************************************************************/
+class security_aes_ctx
+{
+public:
+  security_aes_ctx() = default;
+  ~security_aes_ctx() { reset(); }
+  security_aes_ctx(const security_aes_ctx&) = delete;
+  security_aes_ctx& operator=(const security_aes_ctx&) = delete;
+
+  void set_key(uint8_t* key);
+  void reset();
+  bool is_set() const { return ctx != nullptr; }
+
+  LIBLTE_SECURITY_AES_CTX_STRUCT_S* get() const { return ctx; }
+
+private:
+  LIBLTE_SECURITY_AES_CTX_STRUCT_S* ctx = nullptr;
+};
+
 /******************************************************************************
  * Key Generation
  *****************************************************************************/
@@ -125,6 +148,14 @@ uint8_t security_128_eia2(uint8_t* key,
                           uint32_t msg_len,
                           uint8_t* mac);
 
+uint8_t security_128_eia2(const security_aes_ctx& ctx,
+                          uint32_t                count,
+                          uint32_t                bearer,
+                          uint8_t                 direction,
+                          uint8_t*                msg,
+                          uint32_t                msg_len,
+                          uint8_t*                mac);
+
 uint8_t security_128_eia3(uint8_t* key,
                           uint32_t count,
                           uint32_t bearer,
@@ -154,6 +185,14 @@ uint8_t security_128_eea2(uint8_t* key,
                           uint32_t msg_len,
                           uint8_t* msg_out);
 
+uint8_t security_128_eea2(const security_aes_ctx& ctx,
+                          uint32_t                count,
+                          uint8_t                 bearer,
+                          uint8_t                 direction,
+                          uint8_t*                msg,
+                          uint32_t                msg_len,
+                          uint8_t*                msg_out);
+
 uint8_t security_128_eea3(uint8_t* key,
                           uint32_t count,
                           uint8_t  bearer,
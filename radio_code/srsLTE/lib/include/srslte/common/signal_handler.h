@@ -27,6 +27,7 @@
 #ifndef SRSLTE_SIGNAL_HANDLER_H
 #define SRSLTE_SIGNAL_HANDLER_H
 
+#include "srslte/common/logger_binary.h"
 #include "srslte/common/logger_file.h"
 #include <signal.h>
 #include <stdio.h>
@@ -38,8 +39,9 @@ extern "C" {
 #define SRSLTE_TERM_TIMEOUT_S (5)
 
 // static vars required by signal handling
-static srslte::logger_file logger_file;
-static bool                running = true;
+static srslte::logger_file   logger_file;
+static srslte::logger_binary logger_binary;
+static bool                  running = true;
 
 static void srslte_signal_handler(int signal)
 {
@@ -47,6 +49,7 @@ static void srslte_signal_handler(int signal)
     case SIGALRM:
       fprintf(stderr, "Couldn't stop after %ds. Forcing exit.\n", SRSLTE_TERM_TIMEOUT_S);
       logger_file.stop();
+      logger_binary.stop();
       raise(SIGKILL);
     default:
       // all other registered signals try to stop the app gracefully
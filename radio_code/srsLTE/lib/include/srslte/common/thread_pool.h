@@ -29,7 +29,9 @@
 #ifndef SRSLTE_THREAD_POOL_H
 #define SRSLTE_THREAD_POOL_H
 
+#include <atomic>
 #include <condition_variable>
+#include <deque>
 #include <functional>
 #include <memory>
 #include <mutex>
@@ -39,10 +41,13 @@
 #include <string>
 #include <vector>
 
+#include "srslte/common/move_callback.h"
 #include "srslte/common/threads.h"
 
 namespace srslte {
 
+class task_thread_pool;
+
 class thread_pool
 {
 public:
@@ -54,20 +59,30 @@ public:
     void     setup(uint32_t id, thread_pool* parent, uint32_t prio = 0, uint32_t mask = 255);
     uint32_t get_id();
     void     release();
+    // Pins the worker to one CPU core. Must be called before the worker is added to the pool
+    void set_cpu(int cpu_) { cpu = cpu_; }
+    int  get_cpu() const { return cpu; }
 
   protected:
     virtual void work_imp() = 0;
 
   private:
+    friend class thread_pool;
+
     uint32_t     my_id     = 0;
     thread_pool* my_parent = nullptr;
+    int          cpu       = -1;
 
     void run_thread();
+    void run_task();
     void wait_to_start();
     void finished();
   };
 
   thread_pool(uint32_t nof_workers);
+  // Runs the workers as tasks of executor instead of in their own threads, so that several pools can share the same
+  // threads. The executor must run its tasks in order. Must be called before the first init_worker()
+  void     set_executor(task_thread_pool* executor_) { executor = executor_; }
   void     init_worker(uint32_t id, worker*, uint32_t prio = 0, uint32_t mask = 255);
   void     stop();
   worker*  wait_worker_id(uint32_t id);
@@ -91,6 +106,8 @@ private:
   std::mutex                           mutex_queue = {};
   std::vector<worker_status>           status      = {};
   std::vector<std::condition_variable> cvar_worker = {};
+  task_thread_pool*                    executor    = nullptr;
+  uint32_t                             nof_tasks   = 0; // Worker tasks pushed to the executor and not finished yet
 };
 
 class task_thread_pool
@@ -134,6 +151,80 @@ private:
   bool                    running;
 };
 
+/**
+ * Pool of threads that run short tasks, split from a larger job, in parallel. Each thread has its own queue and steals
+ * from the queues of the others when its own is empty. The thread that submits the tasks of a group runs the tasks of
+ * the group that are still queued while it waits for the group to finish. Without threads, tasks run when submitted.
+ */
+class work_stealing_pool
+{
+public:
+  using task_t = srslte::move_task_t;
+
+  class task_group
+  {
+  public:
+    task_group() = default;
+    task_group(const task_group&) = delete;
+    task_group& operator=(const task_group&) = delete;
+
+  private:
+    friend class work_stealing_pool;
+    uint32_t                pending = 0;
+    std::mutex              mutex;
+    std::condition_variable cvar;
+  };
+
+  explicit work_stealing_pool(uint32_t nof_threads);
+  ~work_stealing_pool();
+  // Starts the threads. If cpus is not empty, thread i is pinned to cpus[i % cpus.size()]
+  void start(int32_t prio = -1, const std::vector<int>& cpus = {});
+  void stop();
+
+  void     run(task_group& group, task_t task);
+  void     wait(task_group& group);
+  uint32_t nof_threads() const { return workers.size(); }
+  uint32_t nof_stolen_tasks() const { return nof_stolen; }
+
+private:
+  struct item_t {
+    task_t      task;
+    task_group* group;
+  };
+  struct task_queue_t {
+    std::mutex         mutex;
+    std::deque<item_t> items;
+  };
+
+  class worker_t : public thread
+  {
+  public:
+    worker_t(work_stealing_pool* parent_, uint32_t id);
+    void setup(int32_t prio, int cpu_);
+
+  protected:
+    void run_thread() override;
+
+  private:
+    work_stealing_pool* parent;
+    uint32_t            id;
+    int                 cpu = -1;
+  };
+
+  bool pop_task(uint32_t queue_idx, item_t* item);
+  bool pop_group_task(task_group& group, item_t* item);
+  void run_task(item_t& item);
+
+  std::vector<std::unique_ptr<task_queue_t> > queues;
+  std::vector<std::unique_ptr<worker_t> >     workers;
+  std::atomic<uint32_t>                       next_queue{0};
+  std::atomic<uint32_t>                       nof_queued{0};
+  std::atomic<uint32_t>                       nof_stolen{0};
+  std::mutex                                  mutex; // Protects the sleep of idle threads
+  std::condition_variable                     cvar;
+  bool                                        running = false;
+};
+
 } // namespace srslte
 
 #endif // SRSLTE_THREAD_POOL_H
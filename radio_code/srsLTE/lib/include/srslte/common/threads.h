@@ -40,6 +40,8 @@ bool threads_new_rt_prio(pthread_t* thread, void* (*start_routine)(void*), void*
 bool threads_new_rt_cpu(pthread_t* thread, void* (*start_routine)(void*), void* arg, int cpu, int prio_offset);
 bool threads_new_rt_mask(pthread_t* thread, void* (*start_routine)(void*), void* arg, int mask, int prio_offset);
 void threads_print_self();
+bool threads_set_self_cpu(int cpu);
+int  threads_move_to_local_node(void* ptr, size_t len);
 
 #ifdef __cplusplus
 }
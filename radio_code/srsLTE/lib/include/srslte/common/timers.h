@@ -22,7 +22,8 @@
 /******************************************************************************
  *  File:         timers.h
  *  Description:  Manually incremented timers. Call a callback function upon
- *                expiry.
+ *                expiry. Running timers are kept in a hierarchical timing
+ *                wheel, so that run, stop and expiry are O(1).
  *  Reference:
  *****************************************************************************/
 
@@ -30,15 +31,15 @@
 #define SRSLTE_TIMERS_H
 
 #include <algorithm>
-#include <functional>
+#include <array>
+#include <deque>
 #include <limits>
 #include <mutex>
-#include <queue>
 #include <stdint.h>
 #include <stdio.h>
 #include <time.h>
-#include <vector>
 
+#include "srslte/common/move_callback.h"
 #include "srslte/srslte.h"
 
 namespace srslte {
@@ -54,16 +55,62 @@ class timer_handler
   constexpr static uint32_t MAX_TIMER_DURATION = std::numeric_limits<uint32_t>::max() / 4;
   constexpr static uint32_t MAX_TIMER_VALUE    = std::numeric_limits<uint32_t>::max() / 2;
 
-  struct timer_impl {
-    timer_handler*                parent;
-    uint32_t                      duration = 0, timeout = 0;
-    bool                          running = false;
-    bool                          active  = false;
-    std::function<void(uint32_t)> callback;
+  // The wheel has two levels of WHEEL_SIZE slots. Level 0 has one slot per tick, level 1 one slot per WHEEL_SIZE
+  // ticks. The timers of a level 1 slot are moved to level 0 when the time reaches the slot. Timers beyond the range
+  // of level 1 go back to it until they are in range.
+  constexpr static uint32_t WHEEL_SHIFT = 8;
+  constexpr static uint32_t WHEEL_SIZE  = 1u << WHEEL_SHIFT;
+  constexpr static uint32_t WHEEL_MASK  = WHEEL_SIZE - 1;
+
+  using callback_t = srslte::move_callback<void(uint32_t)>;
+
+  // Intrusive doubly linked list. A node that is not in a list points to itself
+  struct list_node {
+    list_node*        prev = this;
+    list_node*        next = this;
+    list_node()            = default;
+    list_node(const list_node&) = delete;
+    list_node& operator=(const list_node&) = delete;
+
+    bool empty() const { return next == this; }
+    void push_back(list_node* n)
+    {
+      n->prev    = prev;
+      n->next    = this;
+      prev->next = n;
+      prev       = n;
+    }
+    void unlink()
+    {
+      prev->next = next;
+      next->prev = prev;
+      prev       = this;
+      next       = this;
+    }
+    // Moves all the nodes to the empty list dest
+    void move_to(list_node& dest)
+    {
+      if (not empty()) {
+        dest.next  = next;
+        dest.prev  = prev;
+        next->prev = &dest;
+        prev->next = &dest;
+        prev       = this;
+        next       = this;
+      }
+    }
+  };
 
-    explicit timer_impl(timer_handler* parent_) : parent(parent_) {}
+  struct timer_impl : public list_node {
+    timer_handler* parent;
+    const uint32_t id;
+    uint32_t       duration = 0, timeout = 0;
+    bool           running      = false;
+    bool           active       = false;
+    bool           auto_release = false; // released after the callback is called, used by defer_callback()
+    callback_t     callback;
 
-    uint32_t id() const { return std::distance((const timer_handler::timer_impl*)&parent->timer_list[0], this); }
+    explicit timer_impl(timer_handler* parent_, uint32_t id_) : parent(parent_), id(id_) {}
 
     bool is_running() const { return active and running and timeout > 0; }
 
@@ -78,7 +125,7 @@ class timer_handler
         return false;
       }
       if (not active) {
-        ERROR("Error: setting inactive timer id=%d\n", id());
+        ERROR("Error: setting inactive timer id=%d\n", id);
         return false;
       }
       duration = duration_;
@@ -89,10 +136,11 @@ class timer_handler
       return true;
     }
 
-    bool set(uint32_t duration_, std::function<void(int)> callback_)
+    template <typename F>
+    bool set(uint32_t duration_, F&& callback_)
     {
       if (set(duration_)) {
-        callback = std::move(callback_);
+        callback = callback_t{std::forward<F>(callback_)};
         return true;
       }
       return false;
@@ -100,41 +148,38 @@ class timer_handler
 
     void run()
     {
-      std::unique_lock<std::mutex> lock(parent->mutex);
+      std::lock_guard<std::mutex> lock(parent->mutex);
       if (not active) {
-        ERROR("Error: calling run() for inactive timer id=%d\n", id());
+        ERROR("Error: calling run() for inactive timer id=%d\n", id);
         return;
       }
       timeout = parent->cur_time + duration;
-      parent->running_timers.emplace(id(), timeout);
       running = true;
+      unlink();
+      parent->link(this, parent->cur_time + 1);
     }
 
     void stop()
     {
-      running = false; // invalidates trigger
+      std::lock_guard<std::mutex> lock(parent->mutex);
+      stop_unlocked();
+    }
+
+    void stop_unlocked()
+    {
+      running = false;
       if (not is_expired()) {
         timeout = 0; // if it has already expired, then do not alter is_expired() state
       }
+      unlink();
     }
 
     void clear()
     {
-      stop();
+      std::lock_guard<std::mutex> lock(parent->mutex);
+      stop_unlocked();
       duration = 0;
-      active   = false;
-      callback = std::function<void(uint32_t)>();
-      // leave run_id unchanged. Since the timeout was changed, we shall not get spurious triggering
-    }
-
-    void trigger()
-    {
-      if (is_running()) {
-        running = false;
-        if (callback) {
-          callback(id());
-        }
-      }
+      callback = callback_t{};
     }
   };
 
@@ -143,11 +188,13 @@ public:
   {
   public:
     unique_timer() : timer_id(std::numeric_limits<decltype(timer_id)>::max()) {}
-    explicit unique_timer(timer_handler* parent_, uint32_t timer_id_) : parent(parent_), timer_id(timer_id_) {}
+    explicit unique_timer(timer_handler* parent_, timer_impl* impl_) : parent(parent_), handle(impl_), timer_id(impl_->id)
+    {
+    }
 
     unique_timer(const unique_timer&) = delete;
 
-    unique_timer(unique_timer&& other) noexcept : parent(other.parent), timer_id(other.timer_id)
+    unique_timer(unique_timer&& other) noexcept : parent(other.parent), handle(other.handle), timer_id(other.timer_id)
     {
       other.parent = nullptr;
     }
@@ -156,7 +203,7 @@ public:
     {
       if (parent != nullptr) {
         // does not call callback
-        impl()->clear();
+        parent->dealloc_timer(handle);
       }
     }
 
@@ -165,7 +212,11 @@ public:
     unique_timer& operator=(unique_timer&& other) noexcept
     {
       if (this != &other) {
+        if (parent != nullptr) {
+          parent->dealloc_timer(handle);
+        }
         timer_id     = other.timer_id;
+        handle       = other.handle;
         parent       = other.parent;
         other.parent = nullptr;
       }
@@ -174,94 +225,95 @@ public:
 
     bool is_valid() const { return parent != nullptr; }
 
-    void set(uint32_t duration_, const std::function<void(int)>& callback_) { impl()->set(duration_, callback_); }
+    template <typename F>
+    void set(uint32_t duration_, F&& callback_)
+    {
+      handle->set(duration_, std::forward<F>(callback_));
+    }
 
-    void set(uint32_t duration_) { impl()->set(duration_); }
+    void set(uint32_t duration_) { handle->set(duration_); }
 
-    bool is_set() const { return (impl()->duration != 0); }
+    bool is_set() const { return (handle->duration != 0); }
 
-    bool is_running() const { return impl()->is_running(); }
+    bool is_running() const { return handle->is_running(); }
 
-    bool is_expired() const { return impl()->is_expired(); }
+    bool is_expired() const { return handle->is_expired(); }
 
-    uint32_t time_elapsed() const { return impl()->time_elapsed(); }
+    uint32_t time_elapsed() const { return handle->time_elapsed(); }
 
-    void run() { impl()->run(); }
+    void run() { handle->run(); }
 
-    void stop() { impl()->stop(); }
+    void stop() { handle->stop(); }
 
-    void clear() { impl()->clear(); }
+    // Stops the timer and removes its duration and callback. The timer stays allocated to this unique_timer
+    void clear() { handle->clear(); }
 
     void release()
     {
-      impl()->clear();
+      parent->dealloc_timer(handle);
       parent = nullptr;
     }
 
     uint32_t id() const { return timer_id; }
 
-    uint32_t duration() const { return impl()->duration; }
+    uint32_t duration() const { return handle->duration; }
 
   private:
-    timer_impl* impl() { return &parent->timer_list[timer_id]; }
-
-    const timer_impl* impl() const { return &parent->timer_list[timer_id]; }
-
     timer_handler* parent = nullptr;
+    timer_impl*    handle = nullptr;
     uint32_t       timer_id;
   };
 
-  explicit timer_handler(uint32_t capacity = 64)
-  {
-    timer_list.reserve(capacity);
-    // reserve a priority queue using a vector
-    std::vector<timer_run> v;
-    v.reserve(capacity);
-    std::priority_queue<timer_run> q(std::less<timer_run>(), std::move(v));
-    running_timers = std::move(q);
-  }
+  explicit timer_handler(uint32_t capacity = 64) {}
 
   void step_all()
   {
     std::unique_lock<std::mutex> lock(mutex);
     cur_time++;
-    while (not running_timers.empty()) {
-      uint32_t    next_timeout = running_timers.top().timeout;
-      timer_impl* ptr          = &timer_list[running_timers.top().timer_id];
-      if (not ptr->is_running() or next_timeout != ptr->timeout) {
-        // remove timers that were explicitly stopped, or re-run, to avoid unnecessary priority_queue growth
-        running_timers.pop();
+    if ((cur_time & WHEEL_MASK) == 0) {
+      cascade();
+    }
+
+    // Detach the timers that expire now, so that callbacks can run, stop or release any timer
+    list_node expired;
+    wheel[0][cur_time & WHEEL_MASK].move_to(expired);
+    while (not expired.empty()) {
+      timer_impl* t = static_cast<timer_impl*>(expired.next);
+      t->unlink();
+      if (not t->is_running()) {
+        t->running = false;
         continue;
       }
-      if (cur_time < next_timeout) {
-        break;
-      }
-      // if the timer_run and timer_impl timeouts do not match, it means that timer_impl::timeout was overwritten.
-      // in such case, do not trigger
-      uint32_t timeout = running_timers.top().timeout;
-      running_timers.pop();
+      t->running = false;
 
-      if (ptr->timeout == timeout) {
-        // unlock mutex, it could be that the callback tries to run a timer too
+      // unlock mutex, it could be that the callback tries to run a timer too
+      if (t->auto_release) {
+        callback_t callback = std::move(t->callback);
+        uint32_t   id       = t->id;
+        release_timer(t);
         lock.unlock();
-
-        // Call callback
-        ptr->trigger();
-
-        // Lock again to keep protecting the queue
-        lock.lock();
+        callback(uint32_t{id});
+      } else {
+        lock.unlock();
+        if (not t->callback.is_empty()) {
+          t->callback(uint32_t{t->id});
+        }
       }
+
+      // Lock again to keep protecting the wheel
+      lock.lock();
     }
   }
 
   void stop_all()
   {
     // does not call callback
-    while (not running_timers.empty()) {
-      running_timers.pop();
-    }
-    for (auto& i : timer_list) {
-      i.running = false;
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& t : timer_list) {
+      // released timers are linked in the free list, which must be kept
+      if (t.active) {
+        t.stop_unlocked();
+      }
     }
   }
 
@@ -282,52 +334,79 @@ public:
   template <typename F>
   void defer_callback(uint32_t duration, const F& func)
   {
-    uint32_t                      id = alloc_timer();
-    std::function<void(uint32_t)> c  = [func, this, id](uint32_t tid) {
-      func();
-      // auto-deletes timer
-      timer_list[id].clear();
-    };
-    timer_list[id].set(duration, std::move(c));
-    timer_list[id].run();
+    timer_impl* t = alloc_timer();
+    // auto-deletes timer
+    t->auto_release = true;
+    t->set(duration, [func](uint32_t tid) { func(); });
+    t->run();
   }
 
 private:
-  struct timer_run {
-    uint32_t timer_id;
-    uint32_t timeout;
-
-    timer_run(uint32_t timer_id_, uint32_t timeout_) : timer_id(timer_id_), timeout(timeout_) {}
+  // Inserts a running timer in the wheel. Timers with a timeout before first_tick expire at first_tick
+  void link(timer_impl* t, uint32_t first_tick)
+  {
+    if (t->timeout - first_tick > MAX_TIMER_VALUE) {
+      wheel[0][first_tick & WHEEL_MASK].push_back(t);
+    } else if (t->timeout - cur_time < WHEEL_SIZE) {
+      wheel[0][t->timeout & WHEEL_MASK].push_back(t);
+    } else {
+      wheel[1][(t->timeout >> WHEEL_SHIFT) & WHEEL_MASK].push_back(t);
+    }
+  }
 
-    bool operator<(const timer_run& other) const
-    {
-      // returns true, if other.timeout is lower than timeout, accounting for wrap around
-      if (timeout > other.timeout) {
-        return (timeout - other.timeout) < MAX_TIMER_VALUE / 2;
-      }
-      return (other.timeout - timeout) > MAX_TIMER_VALUE / 2;
+  // Moves the timers of the level 1 slot that starts at cur_time to level 0, or back to level 1 if still out of range
+  void cascade()
+  {
+    list_node pending;
+    wheel[1][(cur_time >> WHEEL_SHIFT) & WHEEL_MASK].move_to(pending);
+    while (not pending.empty()) {
+      timer_impl* t = static_cast<timer_impl*>(pending.next);
+      t->unlink();
+      link(t, cur_time);
     }
-  };
+  }
 
-  uint32_t alloc_timer()
+  timer_impl* alloc_timer()
   {
-    uint32_t i = 0;
-    for (; i < timer_list.size(); ++i) {
-      if (not timer_list[i].active) {
-        break;
-      }
+    std::lock_guard<std::mutex> lock(mutex);
+    timer_impl*                 t;
+    if (free_timers.empty()) {
+      timer_list.emplace_back(this, timer_list.size());
+      t = &timer_list.back();
+    } else {
+      t = static_cast<timer_impl*>(free_timers.prev);
+      t->unlink();
     }
-    if (i == timer_list.size()) {
-      timer_list.emplace_back(this);
+    t->active = true;
+    return t;
+  }
+
+  void dealloc_timer(timer_impl* t)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    release_timer(t);
+  }
+
+  void release_timer(timer_impl* t)
+  {
+    if (not t->active) {
+      return;
     }
-    timer_list[i].active = true;
-    return i;
+    t->stop_unlocked();
+    t->duration     = 0;
+    t->timeout      = 0;
+    t->active       = false;
+    t->auto_release = false;
+    t->callback     = callback_t{};
+    free_timers.push_back(t);
   }
 
-  std::vector<timer_impl>        timer_list;
-  std::priority_queue<timer_run> running_timers;
-  uint32_t                       cur_time = 0;
-  std::mutex                     mutex; // Protect priority queue
+  // Timers are never moved, so they can be linked and handed out by pointer
+  std::deque<timer_impl>                    timer_list;
+  list_node                                 free_timers;
+  std::array<std::array<list_node, WHEEL_SIZE>, 2> wheel;
+  uint32_t                                  cur_time = 0;
+  std::mutex                                mutex; // Protect the wheel and the free list
 };
 
 } // namespace srslte
@@ -337,6 +337,15 @@ public:
   virtual void write_sdu(uint16_t rnti, uint32_t lcid, srslte::unique_byte_buffer_t sdu) = 0;
   virtual void discard_sdu(uint16_t rnti, uint32_t lcid, uint32_t sn)                    = 0;
   virtual bool rb_is_um(uint16_t rnti, uint32_t lcid)                                    = 0;
+
+  /* PDCP pushes a burst of SDUs of the same bearer. Implementations can override it to amortize per-SDU overhead. */
+  virtual void write_sdu_burst(uint16_t rnti, uint32_t lcid, srslte::unique_byte_buffer_list_t& sdus)
+  {
+    for (auto& sdu : sdus) {
+      write_sdu(rnti, lcid, std::move(sdu));
+    }
+    sdus.clear();
+  }
 };
 
 // RLC interface for RRC
@@ -359,6 +368,15 @@ class pdcp_interface_gtpu
 {
 public:
   virtual void write_sdu(uint16_t rnti, uint32_t lcid, srslte::unique_byte_buffer_t sdu) = 0;
+
+  /* GTPU pushes a burst of SDUs of the same bearer, as received from S1-U */
+  virtual void write_sdu_burst(uint16_t rnti, uint32_t lcid, srslte::unique_byte_buffer_list_t& sdus)
+  {
+    for (auto& sdu : sdus) {
+      write_sdu(rnti, lcid, std::move(sdu));
+    }
+    sdus.clear();
+  }
 };
 
 // PDCP interface for RRC
@@ -24,6 +24,7 @@
 
 #include "srslte/asn1/gtpc_ies.h"
 #include "srslte/common/common.h"
+#include <functional>
 #include <netinet/sctp.h>
 #include <queue>
 
@@ -64,6 +65,9 @@ public:
   virtual bool     add_ue_to_enb_set(int32_t enb_assoc, uint32_t mme_ue_s1ap_id)             = 0;
   virtual bool     release_ue_ecm_ctx(uint32_t mme_ue_s1ap_id)                               = 0;
   virtual bool     delete_ue_ctx(uint64_t imsi)                                              = 0;
+  virtual void     delete_ue_ctx_in_owner_shard(uint64_t                  imsi,
+                                                uint32_t                  mme_ue_s1ap_id,
+                                                std::function<void(nas*)> on_deleted)        = 0;
   virtual uint64_t find_imsi_from_m_tmsi(uint32_t m_tmsi)                                    = 0;
   virtual nas*     find_nas_ctx_from_imsi(uint64_t imsi)                                     = 0;
   virtual bool     send_initial_context_setup_request(uint64_t imsi, uint16_t erab_to_setup) = 0;
@@ -59,6 +59,8 @@ public:
     uint32_t min_nof_ctrl_symbols = 1;
     uint32_t max_nof_ctrl_symbols = 3;
     int      max_aggr_level       = 3;
+    uint32_t pdcch_max_states     = 64;    ///< Max PDCCH CCE allocation combinations kept per DCI
+    bool     pdcch_greedy         = false; ///< Place each DCI in its first free position and only search on failure
   };
 
   struct cell_cfg_t {
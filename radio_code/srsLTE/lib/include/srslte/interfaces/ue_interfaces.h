@@ -290,6 +290,15 @@ public:
   virtual void write_sdu(uint32_t lcid, srslte::unique_byte_buffer_t sdu, bool blocking = true) = 0;
   virtual void discard_sdu(uint32_t lcid, uint32_t discard_sn)                                  = 0;
   virtual bool rb_is_um(uint32_t lcid)                                                          = 0;
+
+  /* PDCP pushes a burst of SDUs of the same bearer. Implementations can override it to amortize per-SDU overhead. */
+  virtual void write_sdu_burst(uint32_t lcid, srslte::unique_byte_buffer_list_t& sdus, bool blocking)
+  {
+    for (auto& sdu : sdus) {
+      write_sdu(lcid, std::move(sdu), blocking);
+    }
+    sdus.clear();
+  }
 };
 
 // RLC interface for MAC
@@ -66,7 +66,7 @@ public:
     uint32_t rlf_t_off_ms = 2000;
   } args_t;
 
-  channel(const args_t& channel_args, uint32_t _nof_channels);
+  channel(const args_t& channel_args, uint32_t _nof_channels, uint32_t _seed = 0);
   ~channel();
   void set_logger(log_filter* _log_h);
   void set_srate(uint32_t srate);
@@ -84,6 +84,7 @@ private:
   log_filter*              log_h                       = nullptr;
   uint32_t                 nof_channels                = 0;
   uint32_t                 current_srate               = 0;
+  uint32_t                 seed                        = 0;
   args_t                   args                        = {};
 };
 
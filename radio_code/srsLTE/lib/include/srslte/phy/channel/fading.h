@@ -47,9 +47,10 @@ typedef struct {
   uint32_t state_len;  // Length of the impulse response saved in the state
 
   float coeff_alpha[SRSLTE_CHANNEL_FADING_MAXTAPS][SRSLTE_CHANNEL_FADING_NTERMS]; // Angle of arrival
+  float coeff_w[SRSLTE_CHANNEL_FADING_MAXTAPS][SRSLTE_CHANNEL_FADING_NTERMS];     // Doppler shift: pi*F_d*cos(alpha)
   float coeff_a[SRSLTE_CHANNEL_FADING_MAXTAPS][SRSLTE_CHANNEL_FADING_NTERMS];     // Random phase
   float coeff_b[SRSLTE_CHANNEL_FADING_MAXTAPS][SRSLTE_CHANNEL_FADING_NTERMS];     // Random phase
-  cf_t* h_tap[SRSLTE_CHANNEL_FADING_MAXTAPS]; // Static tap signal in frequency domain
+  cf_t* h_tap[SRSLTE_CHANNEL_FADING_MAXTAPS]; // Static tap signal in frequency domain, FFT shifted
 
   // Utils
   srslte_dft_plan_t fft;             // DFT to frequency domain
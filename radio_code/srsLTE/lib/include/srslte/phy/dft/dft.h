@@ -24,6 +24,7 @@
 
 #include "srslte/config.h"
 #include <stdbool.h>
+#include <stdint.h>
 
 /**********************************************************************************************
  *  File:         dft.h
@@ -98,6 +99,18 @@ SRSLTE_API int srslte_dft_replan_r(srslte_dft_plan_t* plan, int new_dft_points);
 
 SRSLTE_API void srslte_dft_plan_free(srslte_dft_plan_t* plan);
 
+/* Plan cache and wisdom
+ *
+ * FFTW plans are shared process-wide between all srslte_dft_plan_t with the same size, direction, mode and buffer
+ * alignment. srslte_dft_plan_cache_prepare() creates the plans for every transform size used by LTE up to max_prb
+ * (OFDM symbols, PRACH and PUSCH transform precoding) so workers created afterwards do not plan. The wisdom file is
+ * read from $SRSLTE_FFTW_WISDOM if set, or from ~/.srslte_fftwisdom otherwise; a NULL filename exports to it.
+ */
+
+SRSLTE_API int srslte_dft_plan_cache_prepare(uint32_t max_prb);
+
+SRSLTE_API int srslte_dft_wisdom_export(const char* filename);
+
 /* Set options */
 
 SRSLTE_API void srslte_dft_plan_set_mirror(srslte_dft_plan_t* plan, bool val);
@@ -47,6 +47,17 @@
 
 typedef enum SRSLTE_API { SEARCH_UE, SEARCH_COMMON } srslte_pdcch_search_mode_t;
 
+#define SRSLTE_PDCCH_MAX_DECODED 64
+
+/* Result of a DCI candidate decoded from the current LLRs */
+typedef struct SRSLTE_API {
+  srslte_dci_location_t location;
+  uint32_t              nof_bits;
+  bool                  skipped; // The candidate LLRs were too weak to be decoded
+  uint16_t              crc_rem;
+  uint8_t               payload[SRSLTE_DCI_MAX_BITS];
+} srslte_pdcch_decoded_t;
+
 /* PDCCH object */
 typedef struct SRSLTE_API {
   srslte_cell_t cell;
@@ -73,6 +84,11 @@ typedef struct SRSLTE_API {
   srslte_viterbi_t     decoder;
   srslte_crc_t         crc;
 
+  /* Candidates decoded since the last call to srslte_pdcch_extract_llr(). The blind searches of the different formats
+   * and search spaces try the same locations with the same message size, which only need to be decoded once */
+  srslte_pdcch_decoded_t decoded[SRSLTE_PDCCH_MAX_DECODED];
+  uint32_t               nof_decoded;
+
 } srslte_pdcch_t;
 
 SRSLTE_API int srslte_pdcch_init_ue(srslte_pdcch_t* q, uint32_t max_prb, uint32_t nof_rx_antennas);
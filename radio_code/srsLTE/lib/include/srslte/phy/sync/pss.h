@@ -84,9 +84,9 @@ typedef struct SRSLTE_API {
   cf_t   pss_signal_freq[3][SRSLTE_PSS_LEN]; // One sequence for each N_id_2
   cf_t*  tmp_input;
   cf_t*  conv_output;
-  float* conv_output_abs;
   float  ema_alpha;
   float* conv_output_avg;
+  float* conv_output_avg_N_id_2[3]; // Averages of srslte_pss_find_pss_all(), one for each N_id_2
   float  peak_value;
 
   bool              filter_pss_enable;
@@ -137,6 +137,14 @@ SRSLTE_API int srslte_pss_set_N_id_2(srslte_pss_t* q, uint32_t N_id_2);
 
 SRSLTE_API int srslte_pss_find_pss(srslte_pss_t* q, const cf_t* input, float* corr_peak_value);
 
+SRSLTE_API int srslte_pss_find_pss_same_input(srslte_pss_t*       q,
+                                              const srslte_pss_t* prev,
+                                              const cf_t*         input,
+                                              float*              corr_peak_value);
+
+SRSLTE_API int
+srslte_pss_find_pss_all(srslte_pss_t* q, const cf_t* input, int peak_pos[3], float corr_peak_value[3]);
+
 SRSLTE_API int srslte_pss_chest(srslte_pss_t* q, const cf_t* input, cf_t ce[SRSLTE_PSS_LEN]);
 
 SRSLTE_API float srslte_pss_cfo_compute(srslte_pss_t* q, const cf_t* pss_recv);
@@ -149,6 +149,9 @@ SRSLTE_API srslte_sync_find_ret_t srslte_sync_find(srslte_sync_t* q,
                                                    uint32_t       find_offset,
                                                    uint32_t*      peak_position);
 
+/* Correlates the input signal with the three PSS sequences at once and returns the PSR of each N_id_2 */
+SRSLTE_API int srslte_sync_find_pss_all(srslte_sync_t* q, const cf_t* input, float psr[3]);
+
 /* Estimates the CP length */
 SRSLTE_API srslte_cp_t srslte_sync_detect_cp(srslte_sync_t* q, const cf_t* input, uint32_t peak_pos);
 
@@ -70,6 +70,7 @@ typedef struct SRSLTE_API {
 
   uint32_t max_frames;
   uint32_t nof_valid_frames;  // number of 5 ms frames to scan 
+  bool     pss_prescan;       // correlate the three PSS at once first and skip the N_id_2 without cells
     
   uint32_t *mode_ntimes;
   uint8_t *mode_counted; 
@@ -102,6 +103,8 @@ SRSLTE_API int srslte_ue_cellsearch_scan(srslte_ue_cellsearch_t * q,
 SRSLTE_API int srslte_ue_cellsearch_set_nof_valid_frames(srslte_ue_cellsearch_t *q, 
                                                          uint32_t nof_frames);
 
+SRSLTE_API void srslte_ue_cellsearch_set_pss_prescan(srslte_ue_cellsearch_t* q, bool enable);
+
 
 
 
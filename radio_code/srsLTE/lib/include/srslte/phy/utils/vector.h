@@ -223,6 +223,9 @@ SRSLTE_API void srslte_vec_quant_sus(const int16_t* in,
 SRSLTE_API void srslte_vec_abs_cf(const cf_t* x, float* abs, const uint32_t len);
 SRSLTE_API void srslte_vec_abs_square_cf(const cf_t* x, float* abs_square, const uint32_t len);
 
+/* exponential moving average of the squared magnitude: y = alpha * |x|^2 + (1 - alpha) * y */
+SRSLTE_API void srslte_vec_abs_square_ema_cf(const cf_t* x, const float alpha, float* y, const uint32_t len);
+
 /**
  * @brief Extracts module in decibels of a complex vector
  *
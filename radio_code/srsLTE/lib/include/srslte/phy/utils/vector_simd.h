@@ -111,6 +111,8 @@ SRSLTE_API void srslte_vec_abs_cf_simd(const cf_t* x, float* z, const int len);
 
 SRSLTE_API void srslte_vec_abs_square_cf_simd(const cf_t* x, float* z, const int len);
 
+SRSLTE_API void srslte_vec_abs_square_ema_cf_simd(const cf_t* x, const float alpha, float* y, const int len);
+
 /* Other Functions */
 SRSLTE_API void srslte_vec_lut_sss_simd(const short* x, const unsigned short* lut, short* y, const int len);
 
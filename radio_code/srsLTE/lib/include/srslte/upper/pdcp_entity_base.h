@@ -149,6 +149,12 @@ protected:
 
   srslte::as_security_config_t sec_cfg = {};
 
+  // Precomputed EEA2/EIA2 key schedules, set up once in config_security()
+  srslte::security_aes_ctx rrc_enc_ctx;
+  srslte::security_aes_ctx rrc_int_ctx;
+  srslte::security_aes_ctx up_enc_ctx;
+  srslte::security_aes_ctx up_int_ctx;
+
   // Security functions
   void integrity_generate(uint8_t* msg, uint32_t msg_len, uint32_t count, uint8_t* mac);
   bool integrity_verify(uint8_t* msg, uint32_t msg_len, uint32_t count, uint8_t* mac);
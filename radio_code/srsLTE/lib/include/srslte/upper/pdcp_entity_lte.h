@@ -58,6 +58,7 @@ public:
 
   // GW/RRC interface
   void write_sdu(unique_byte_buffer_t sdu, bool blocking);
+  void write_sdu_burst(unique_byte_buffer_list_t& sdus, bool blocking);
   void get_bearer_status(uint16_t* dlsn, uint16_t* dlhfn, uint16_t* ulsn, uint16_t* ulhfn);
 
   // RLC interface
@@ -88,6 +89,9 @@ private:
   uint32_t last_submitted_pdcp_rx_sn = 0;
   uint32_t maximum_pdcp_sn           = 0;
 
+  void check_security_tx();
+  void process_tx_sdu(const unique_byte_buffer_t& sdu);
+
   void handle_srb_pdu(srslte::unique_byte_buffer_t pdu);
   void handle_um_drb_pdu(srslte::unique_byte_buffer_t pdu);
   void handle_am_drb_pdu(srslte::unique_byte_buffer_t pdu);
@@ -52,6 +52,7 @@ public:
 
   // PDCP interface
   void write_sdu(uint32_t lcid, unique_byte_buffer_t sdu, bool blocking = true);
+  void write_sdu_burst(uint32_t lcid, unique_byte_buffer_list_t& sdus, bool blocking);
   void write_sdu_mch(uint32_t lcid, unique_byte_buffer_t sdu);
   bool rb_is_um(uint32_t lcid);
   void discard_sdu(uint32_t lcid, uint32_t discard_sn);
@@ -93,10 +94,9 @@ private:
   srsue::rrc_interface_rlc*  rrc    = nullptr;
   srslte::timer_handler*     timers = nullptr;
 
-  typedef std::map<uint16_t, rlc_common*>  rlc_map_t;
-  typedef std::pair<uint16_t, rlc_common*> rlc_map_pair_t;
-
-  rlc_map_t        rlc_array, rlc_array_mrb;
+  // RLC entities indexed by LCID, nullptr if the bearer is not configured
+  rlc_common*      rlc_array[SRSLTE_N_RADIO_BEARERS]  = {};
+  rlc_common*      rlc_array_mrb[SRSLTE_N_MCH_LCIDS] = {};
   pthread_rwlock_t rwlock;
 
   uint32_t default_lcid = 0;
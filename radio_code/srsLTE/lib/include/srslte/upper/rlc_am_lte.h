@@ -30,9 +30,11 @@
 #include "srslte/upper/rlc_am_base.h"
 #include "srslte/upper/rlc_common.h"
 #include "srslte/upper/rlc_tx_queue.h"
+#include <bitset>
 #include <deque>
 #include <list>
-#include <map>
+#include <memory>
+#include <vector>
 
 namespace srslte {
 
@@ -51,7 +53,6 @@ struct rlc_amd_tx_pdu_t {
   rlc_amd_pdu_header_t header;
   unique_byte_buffer_t buf;
   uint32_t             retx_count;
-  bool                 is_acked;
 };
 
 struct rlc_amd_retx_t {
@@ -61,6 +62,93 @@ struct rlc_amd_retx_t {
   uint32_t so_end;
 };
 
+/****************************************************************************
+ * SN-indexed window of PDUs
+ * An AM window never spans more than WINDOW_SIZE consecutive SNs, so every SN
+ * inside it owns the slot sn % WINDOW_SIZE. A slot's PDU is allocated the
+ * first time the slot is used and kept when its SN leaves the window, so the
+ * memory of a bearer follows the largest number of PDUs it had in flight and
+ * the data path does not allocate once the window has been filled. Occupancy
+ * and ACK state are kept in bitmaps.
+ ***************************************************************************/
+template <class T, std::size_t WINDOW_SIZE>
+class rlc_ringbuffer_t
+{
+public:
+  rlc_ringbuffer_t() : window(WINDOW_SIZE), sns(WINDOW_SIZE, 0) {}
+
+  T& add_pdu(uint32_t sn)
+  {
+    uint32_t idx = sn % WINDOW_SIZE;
+    if (window[idx] == nullptr) {
+      window[idx].reset(new T());
+    } else if (active.test(idx)) {
+      // a slot still held by an SN that left the window is overwritten
+      *window[idx] = T();
+    }
+    if (not active.test(idx)) {
+      active.set(idx);
+      count++;
+    }
+    acked.reset(idx);
+    sns[idx] = sn;
+    return *window[idx];
+  }
+
+  void remove_pdu(uint32_t sn)
+  {
+    if (has_sn(sn)) {
+      uint32_t idx = sn % WINDOW_SIZE;
+      // release the buffers of the PDU but keep the slot for the next SN
+      *window[idx] = T();
+      active.reset(idx);
+      acked.reset(idx);
+      count--;
+    }
+  }
+
+  bool has_sn(uint32_t sn) const
+  {
+    uint32_t idx = sn % WINDOW_SIZE;
+    return active.test(idx) && sns[idx] == sn;
+  }
+
+  void set_acked(uint32_t sn)
+  {
+    if (has_sn(sn)) {
+      acked.set(sn % WINDOW_SIZE);
+    }
+  }
+  bool is_acked(uint32_t sn) const { return has_sn(sn) && acked.test(sn % WINDOW_SIZE); }
+
+  // Only valid for SNs for which has_sn() returns true
+  T&       operator[](uint32_t sn) { return *window[sn % WINDOW_SIZE]; }
+  const T& operator[](uint32_t sn) const { return *window[sn % WINDOW_SIZE]; }
+
+  size_t size() const { return count; }
+  bool   empty() const { return count == 0; }
+
+  void clear()
+  {
+    for (uint32_t idx = 0; idx < WINDOW_SIZE && count > 0; idx++) {
+      if (active.test(idx)) {
+        *window[idx] = T();
+        count--;
+      }
+    }
+    active.reset();
+    acked.reset();
+    count = 0;
+  }
+
+private:
+  std::vector<std::unique_ptr<T> > window;
+  std::vector<uint32_t>            sns;
+  std::bitset<WINDOW_SIZE>         active;
+  std::bitset<WINDOW_SIZE>         acked;
+  size_t                           count = 0;
+};
+
 class rlc_am_lte : public rlc_common
 {
 public:
@@ -179,8 +267,8 @@ private:
     srslte::timer_handler::unique_timer status_prohibit_timer;
 
     // Tx windows
-    std::map<uint32_t, rlc_amd_tx_pdu_t> tx_window;
-    std::deque<rlc_amd_retx_t>           retx_queue;
+    rlc_ringbuffer_t<rlc_amd_tx_pdu_t, RLC_AM_WINDOW_SIZE> tx_window;
+    std::deque<rlc_amd_retx_t>                             retx_queue;
 
     // Mutexes
     pthread_mutex_t mutex;
@@ -252,8 +340,8 @@ private:
     pthread_mutex_t mutex;
 
     // Rx windows
-    std::map<uint32_t, rlc_amd_rx_pdu_t>          rx_window;
-    std::map<uint32_t, rlc_amd_rx_pdu_segments_t> rx_segments;
+    rlc_ringbuffer_t<rlc_amd_rx_pdu_t, RLC_AM_WINDOW_SIZE>          rx_window;
+    rlc_ringbuffer_t<rlc_amd_rx_pdu_segments_t, RLC_AM_WINDOW_SIZE> rx_segments;
 
     // Metrics
     uint32_t num_rx_bytes = 0;
@@ -23,6 +23,7 @@
 #include "srslte/common/logmap.h"
 #include <cmath>
 #include <stdio.h>
+#include <stdlib.h>
 
 namespace asn1 {
 
@@ -132,34 +133,47 @@ int bit_ref_impl<Ptr>::distance_bytes() const
   return ((int)(ptr - start_ptr)) + ((offset) ? 1 : 0);
 }
 
+// Big-endian word accesses, so that bit fields can be packed and unpacked a word at a time
+static inline uint64_t load_be64(const uint8_t* ptr)
+{
+  uint64_t w;
+  memcpy(&w, ptr, sizeof(w));
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  w = __builtin_bswap64(w);
+#endif
+  return w;
+}
+
+static inline void store_be64(uint8_t* ptr, uint64_t w)
+{
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  w = __builtin_bswap64(w);
+#endif
+  memcpy(ptr, &w, sizeof(w));
+}
+
 SRSASN_CODE bit_ref::pack(uint32_t val, uint32_t n_bits)
 {
   if (n_bits >= 32) {
     log_error("This method only supports packing up to 32 bits\n");
     return SRSASN_ERROR_ENCODE_FAIL;
   }
-  uint32_t mask;
-  while (n_bits > 0) {
-    if (ptr >= max_ptr) {
-      log_error("Buffer size limit was achieved\n");
-      return SRSASN_ERROR_ENCODE_FAIL;
-    }
-    mask             = ((1u << n_bits) - 1u);
-    val              = val & mask;
-    uint8_t keepmask = ((uint8_t)-1) - (uint8_t)((1u << (8u - offset)) - 1u);
-    if ((uint32_t)(8 - offset) > n_bits) {
-      auto bit = static_cast<uint8_t>(val << (8u - offset - n_bits));
-      *ptr     = ((*ptr) & keepmask) + bit;
-      offset += n_bits;
-      n_bits = 0;
-    } else {
-      auto bit = static_cast<uint8_t>(val >> (n_bits - 8u + offset));
-      *ptr     = (*ptr & keepmask) + bit;
-      n_bits -= (8 - offset);
-      offset = 0;
-      ptr++;
-    }
+  if (n_bits == 0) {
+    return SRSASN_SUCCESS;
+  }
+  uint32_t n_bytes = (offset + n_bits + 7u) / 8u;
+  if (ptr + n_bytes > max_ptr) {
+    log_error("Buffer size limit was achieved\n");
+    return SRSASN_ERROR_ENCODE_FAIL;
   }
+  // Keep the bits already written to the current byte, and zero the ones after the packed field
+  uint64_t keep = (uint64_t)(*ptr & (uint8_t)(0xffu << (8u - offset))) << 56u;
+  uint64_t bits = (uint64_t)(val & ((1u << n_bits) - 1u)) << (64u - offset - n_bits);
+  uint8_t  tmp[8];
+  store_be64(tmp, keep | bits);
+  memcpy(ptr, tmp, n_bytes);
+  ptr += (offset + n_bits) / 8u;
+  offset = (offset + n_bits) % 8u;
   return SRSASN_SUCCESS;
 }
 
@@ -170,6 +184,29 @@ SRSASN_CODE unpack_bits(T& val, Ptr& ptr, uint8_t& offset, const uint8_t* max_pt
     log_error("This method only supports unpacking up to %d bits\n", (int)sizeof(T) * 8);
     return SRSASN_ERROR_DECODE_FAIL;
   }
+  if (n_bits + offset <= 64) {
+    if (n_bits == 0) {
+      val = 0;
+      return SRSASN_SUCCESS;
+    }
+    uint32_t n_bytes = (offset + n_bits + 7u) / 8u;
+    if (ptr + n_bytes > max_ptr) {
+      log_error("Buffer size limit was achieved\n");
+      return SRSASN_ERROR_DECODE_FAIL;
+    }
+    uint64_t w;
+    if (ptr + 8 <= max_ptr) {
+      w = load_be64(ptr);
+    } else {
+      uint8_t tmp[8] = {};
+      memcpy(tmp, ptr, n_bytes);
+      w = load_be64(tmp);
+    }
+    val = static_cast<T>((w << offset) >> (64u - n_bits));
+    ptr += (offset + n_bits) / 8u;
+    offset = (offset + n_bits) % 8u;
+    return SRSASN_SUCCESS;
+  }
   val = 0;
   while (n_bits > 0) {
     if (ptr >= max_ptr) {
@@ -183,7 +220,7 @@ SRSASN_CODE unpack_bits(T& val, Ptr& ptr, uint8_t& offset, const uint8_t* max_pt
       n_bits = 0;
     } else {
       auto mask = static_cast<uint8_t>((1u << (8u - offset)) - 1u);
-      val += ((uint32_t)((*ptr) & mask)) << (n_bits - 8 + offset);
+      val += ((uint64_t)((*ptr) & mask)) << (n_bits - 8 + offset);
       n_bits -= 8 - offset;
       offset = 0;
       ptr++;
@@ -243,9 +280,15 @@ SRSASN_CODE bit_ref_impl<Ptr>::unpack_bytes(uint8_t* buf, uint32_t n_bytes)
     memcpy(buf, ptr, n_bytes);
     ptr += n_bytes;
   } else {
-    for (uint32_t i = 0; i < n_bytes; ++i) {
-      HANDLE_CODE(unpack(buf[i], 8));
+    // Each output byte straddles two input bytes. The bound check above guarantees that ptr[n_bytes] is readable
+    uint32_t i = 0;
+    for (; i + 8 < n_bytes; i += 8) {
+      store_be64(&buf[i], (load_be64(&ptr[i]) << offset) | (ptr[i + 8] >> (8u - offset)));
     }
+    for (; i < n_bytes; ++i) {
+      buf[i] = (uint8_t)((ptr[i] << offset) | (ptr[i + 1] >> (8u - offset)));
+    }
+    ptr += n_bytes;
   }
   return SRSASN_SUCCESS;
 }
@@ -306,9 +349,20 @@ SRSASN_CODE bit_ref::pack_bytes(const uint8_t* buf, uint32_t n_bytes)
     memcpy(ptr, buf, n_bytes);
     ptr += n_bytes;
   } else {
-    for (uint32_t i = 0; i < n_bytes; ++i) {
-      pack(buf[i], 8);
+    // Same result as packing byte by byte: the bits after the last byte are zeroed
+    uint8_t  carry = *ptr & (uint8_t)(0xffu << (8u - offset));
+    uint32_t i     = 0;
+    for (; i + 8 <= n_bytes; i += 8) {
+      uint64_t w = load_be64(&buf[i]);
+      store_be64(&ptr[i], ((uint64_t)carry << 56u) | (w >> offset));
+      carry = (uint8_t)(w << (8u - offset));
     }
+    for (; i < n_bytes; ++i) {
+      ptr[i] = carry | (uint8_t)(buf[i] >> offset);
+      carry  = (uint8_t)(buf[i] << (8u - offset));
+    }
+    ptr[n_bytes] = carry;
+    ptr += n_bytes;
   }
   return SRSASN_SUCCESS;
 }
@@ -328,6 +382,80 @@ SRSASN_CODE bit_ref::align_bytes_zero()
   return SRSASN_SUCCESS;
 }
 
+/*********************
+     memory arena
+*********************/
+
+static thread_local mem_arena* current_arena = nullptr;
+
+mem_arena* mem_arena::current()
+{
+  return current_arena;
+}
+
+mem_arena::~mem_arena()
+{
+  free_blocks();
+}
+
+void mem_arena::free_blocks()
+{
+  while (blocks != nullptr) {
+    block_t* next = blocks->next;
+    free(blocks);
+    blocks = next;
+  }
+}
+
+void* mem_arena::allocate(size_t sz, size_t align)
+{
+  auto aligned = [align](uint8_t* p) {
+    return reinterpret_cast<uint8_t*>((reinterpret_cast<uintptr_t>(p) + align - 1) & ~(uintptr_t)(align - 1));
+  };
+  uint8_t* p = aligned(cur);
+  if (cur == nullptr or p + sz > end) {
+    // Size the block after what previous PDUs needed, so that a reused arena settles on a single block
+    size_t bsz = std::max(std::max(block_size, high_water + high_water / 8), sizeof(block_t) + sz + align);
+    auto   b   = static_cast<block_t*>(malloc(bsz));
+    if (b == nullptr) {
+      throw std::bad_alloc();
+    }
+    b->next = blocks;
+    b->size = bsz;
+    blocks  = b;
+    cur     = reinterpret_cast<uint8_t*>(b + 1);
+    end     = reinterpret_cast<uint8_t*>(b) + bsz;
+    p       = aligned(cur);
+  }
+  cur = p + sz;
+  used_total += sz;
+  return p;
+}
+
+void mem_arena::reset()
+{
+  high_water = std::max(high_water, used_total);
+  used_total = 0;
+  if (blocks != nullptr and blocks->next != nullptr) {
+    // Drop all the blocks. The next allocation gets one block large enough for all of them
+    free_blocks();
+    cur = nullptr;
+    end    = nullptr;
+    return;
+  }
+  cur = (blocks != nullptr) ? reinterpret_cast<uint8_t*>(blocks + 1) : nullptr;
+}
+
+arena_scope::arena_scope(mem_arena& arena) : prev(current_arena)
+{
+  current_arena = &arena;
+}
+
+arena_scope::~arena_scope()
+{
+  current_arena = prev;
+}
+
 /*********************
      ext packing
 *********************/
@@ -20,12 +20,51 @@
  */
 
 #include "srslte/common/buffer_pool.h"
+#include <mutex>
 #include <pthread.h>
 #include <stdio.h>
 #include <string>
 
 namespace srslte {
 
+/* Thread slots for the per-thread buffer caches. A slot is returned when its thread exits, and the next thread
+ * taking it inherits the cached buffers, which are free buffers of the pool anyway. */
+static std::mutex thread_idx_mutex;
+static bool       thread_idx_used[BUFFER_POOL_MAX_THREADS] = {};
+
+namespace {
+struct buffer_pool_thread_slot {
+  uint32_t idx      = BUFFER_POOL_NO_THREAD_IDX;
+  bool     assigned = false;
+
+  ~buffer_pool_thread_slot()
+  {
+    if (idx != BUFFER_POOL_NO_THREAD_IDX) {
+      std::lock_guard<std::mutex> lock(thread_idx_mutex);
+      thread_idx_used[idx] = false;
+      idx                  = BUFFER_POOL_NO_THREAD_IDX;
+    }
+  }
+};
+thread_local buffer_pool_thread_slot thread_slot;
+} // namespace
+
+uint32_t buffer_pool_thread_idx()
+{
+  if (not thread_slot.assigned) {
+    thread_slot.assigned = true;
+    std::lock_guard<std::mutex> lock(thread_idx_mutex);
+    for (uint32_t i = 0; i < BUFFER_POOL_MAX_THREADS; i++) {
+      if (not thread_idx_used[i]) {
+        thread_idx_used[i] = true;
+        thread_slot.idx    = i;
+        break;
+      }
+    }
+  }
+  return thread_slot.idx;
+}
+
 byte_buffer_pool* byte_buffer_pool::instance = NULL;
 pthread_mutex_t   instance_mutex             = PTHREAD_MUTEX_INITIALIZER;
 
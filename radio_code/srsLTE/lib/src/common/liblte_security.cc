@@ -39,6 +39,12 @@
 #include "srslte/common/liblte_ssl.h"
 #include "srslte/common/zuc.h"
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <wmmintrin.h>
+#define LIBLTE_SECURITY_HAVE_AESNI
+#define AESNI_TARGET __attribute__((target("aes,sse2")))
+#endif
+
 /*******************************************************************************
                               DEFINES
 *******************************************************************************/
@@ -55,6 +61,15 @@ typedef struct {
   uint8 state[4][4];
 } STATE_STRUCT;
 
+// Precomputed AES-128 key context for EEA2/EIA2
+struct LIBLTE_SECURITY_AES_CTX_STRUCT_S {
+  uint8 rk[11][16] __attribute__((aligned(16))); // Expanded round keys for the AES-NI path
+  aes_context ctx;                               // Expanded round keys for the library path
+  bool        use_aesni;
+  uint8       K1[16]; // CMAC subkeys
+  uint8       K2[16];
+};
+
 typedef struct {
   uint32* lfsr;
   uint32* fsm;
@@ -213,6 +228,47 @@ void mix_column(STATE_STRUCT* state);
 *********************************************************************/
 void zero_tailing_bits(uint8* data, uint32 length_bits);
 
+/*********************************************************************
+    Name: aes_ctx_init
+
+    Description: Expands an AES-128 key and derives the CMAC subkeys.
+
+    Document Reference: RFC4493 Section 2.3
+*********************************************************************/
+void aes_ctx_init(LIBLTE_SECURITY_AES_CTX_STRUCT*  ctx,
+                  uint8*                           key,
+                  LIBLTE_SECURITY_AES_BACKEND_ENUM backend = LIBLTE_SECURITY_AES_BACKEND_AUTO);
+
+/*********************************************************************
+    Name: aes_ctx_encrypt_block
+
+    Description: Encrypts a single block with an expanded key.
+
+    Document Reference: -
+*********************************************************************/
+void aes_ctx_encrypt_block(LIBLTE_SECURITY_AES_CTX_STRUCT* ctx, uint8* input, uint8* output);
+
+#ifdef LIBLTE_SECURITY_HAVE_AESNI
+/*********************************************************************
+    Name: aesni_key_expansion
+
+    Description: AES-128 key expansion using AES-NI.
+
+    Document Reference: -
+*********************************************************************/
+void aesni_key_expansion(uint8* key, uint8 rk[11][16]);
+
+/*********************************************************************
+    Name: aesni_crypt_ctr
+
+    Description: AES-128 CTR mode using AES-NI, four counter blocks
+                 at a time.
+
+    Document Reference: -
+*********************************************************************/
+void aesni_crypt_ctr(LIBLTE_SECURITY_AES_CTX_STRUCT* ctx, uint8* nonce_cnt, uint8* input, uint8* output, uint32 len);
+#endif // LIBLTE_SECURITY_HAVE_AESNI
+
 /*********************************************************************
     Name: s3g_mul_x
 
@@ -617,6 +673,38 @@ LIBLTE_ERROR_ENUM liblte_security_generate_k_up(uint8*
   return (err);
 }
 
+/*********************************************************************
+    Name: liblte_security_aes_ctx_alloc
+
+    Description: Precomputes the AES-128 key context used by EEA2 and
+                 EIA2, so the key is not expanded for every message.
+
+    Document Reference: -
+*********************************************************************/
+LIBLTE_SECURITY_AES_CTX_STRUCT* liblte_security_aes_ctx_alloc(uint8* key, LIBLTE_SECURITY_AES_BACKEND_ENUM backend)
+{
+  LIBLTE_SECURITY_AES_CTX_STRUCT* ctx = NULL;
+
+  if (key != NULL && backend < LIBLTE_SECURITY_AES_BACKEND_N_ITEMS) {
+    ctx = new LIBLTE_SECURITY_AES_CTX_STRUCT;
+    aes_ctx_init(ctx, key, backend);
+    if (backend == LIBLTE_SECURITY_AES_BACKEND_AESNI && !ctx->use_aesni) {
+      delete ctx;
+      ctx = NULL;
+    }
+  }
+
+  return (ctx);
+}
+
+void liblte_security_aes_ctx_free(LIBLTE_SECURITY_AES_CTX_STRUCT* ctx)
+{
+  if (ctx != NULL) {
+    memset(ctx, 0, sizeof(LIBLTE_SECURITY_AES_CTX_STRUCT));
+    delete ctx;
+  }
+}
+
 /*********************************************************************
     Name: liblte_security_128_eia2
 
@@ -633,44 +721,34 @@ LIBLTE_ERROR_ENUM liblte_security_128_eia2(uint8* key,
                                            uint8* msg,
                                            uint32 msg_len,
                                            uint8* mac)
+{
+  LIBLTE_SECURITY_AES_CTX_STRUCT ctx;
+
+  if (key != NULL && msg != NULL && mac != NULL) {
+    aes_ctx_init(&ctx, key);
+    return liblte_security_128_eia2(&ctx, count, bearer, direction, msg, msg_len, mac);
+  }
+
+  return LIBLTE_ERROR_INVALID_INPUTS;
+}
+LIBLTE_ERROR_ENUM liblte_security_128_eia2(LIBLTE_SECURITY_AES_CTX_STRUCT* ctx,
+                                           uint32                          count,
+                                           uint8                           bearer,
+                                           uint8                           direction,
+                                           uint8*                          msg,
+                                           uint32                          msg_len,
+                                           uint8*                          mac)
 {
   LIBLTE_ERROR_ENUM err = LIBLTE_ERROR_INVALID_INPUTS;
   uint8             M[msg_len + 8 + 16];
-  aes_context       ctx;
   uint32            i;
   uint32            j;
   uint32            n;
   uint32            pad_bits;
-  uint8             const_zero[16] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
-  uint8             L[16];
-  uint8             K1[16];
-  uint8             K2[16];
   uint8             T[16];
   uint8             tmp[16];
 
-  if (key != NULL && msg != NULL && mac != NULL) {
-    // Subkey L generation
-    aes_setkey_enc(&ctx, key, 128);
-    aes_crypt_ecb(&ctx, AES_ENCRYPT, const_zero, L);
-
-    // Subkey K1 generation
-    for (i = 0; i < 15; i++) {
-      K1[i] = (L[i] << 1) | ((L[i + 1] >> 7) & 0x01);
-    }
-    K1[15] = L[15] << 1;
-    if (L[0] & 0x80) {
-      K1[15] ^= 0x87;
-    }
-
-    // Subkey K2 generation
-    for (i = 0; i < 15; i++) {
-      K2[i] = (K1[i] << 1) | ((K1[i + 1] >> 7) & 0x01);
-    }
-    K2[15] = K1[15] << 1;
-    if (K1[0] & 0x80) {
-      K2[15] ^= 0x87;
-    }
-
+  if (ctx != NULL && msg != NULL && mac != NULL) {
     // Construct M
     memset(M, 0, msg_len + 8 + 16);
     M[0] = (count >> 24) & 0xFF;
@@ -678,12 +756,10 @@ LIBLTE_ERROR_ENUM liblte_security_128_eia2(uint8* key,
     M[2] = (count >> 8) & 0xFF;
     M[3] = count & 0xFF;
     M[4] = (bearer << 3) | (direction << 2);
-    for (i = 0; i < msg_len; i++) {
-      M[8 + i] = msg[i];
-    }
+    memcpy(&M[8], msg, msg_len);
 
     // MAC generation
-    n = (uint32)(ceilf((float)(msg_len + 8) / (float)(16)));
+    n = (msg_len + 8 + 15) / 16;
     for (i = 0; i < 16; i++) {
       T[i] = 0;
     }
@@ -691,21 +767,21 @@ LIBLTE_ERROR_ENUM liblte_security_128_eia2(uint8* key,
       for (j = 0; j < 16; j++) {
         tmp[j] = T[j] ^ M[i * 16 + j];
       }
-      aes_crypt_ecb(&ctx, AES_ENCRYPT, tmp, T);
+      aes_ctx_encrypt_block(ctx, tmp, T);
     }
     pad_bits = ((msg_len * 8) + 64) % 128;
     if (pad_bits == 0) {
       for (j = 0; j < 16; j++) {
-        tmp[j] = T[j] ^ K1[j] ^ M[i * 16 + j];
+        tmp[j] = T[j] ^ ctx->K1[j] ^ M[i * 16 + j];
       }
-      aes_crypt_ecb(&ctx, AES_ENCRYPT, tmp, T);
+      aes_ctx_encrypt_block(ctx, tmp, T);
     } else {
       pad_bits = (128 - pad_bits) - 1;
       M[i * 16 + (15 - (pad_bits / 8))] |= 0x1 << (pad_bits % 8);
       for (j = 0; j < 16; j++) {
-        tmp[j] = T[j] ^ K2[j] ^ M[i * 16 + j];
+        tmp[j] = T[j] ^ ctx->K2[j] ^ M[i * 16 + j];
       }
-      aes_crypt_ecb(&ctx, AES_ENCRYPT, tmp, T);
+      aes_ctx_encrypt_block(ctx, tmp, T);
     }
 
     for (i = 0; i < 4; i++) {
@@ -1017,27 +1093,45 @@ LIBLTE_ERROR_ENUM liblte_security_encryption_eea2(uint8* key,
                                                   uint32 msg_len,
                                                   uint8* out)
 {
-  LIBLTE_ERROR_ENUM err = LIBLTE_ERROR_INVALID_INPUTS;
-  aes_context       ctx;
-  unsigned char     stream_blk[16] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
-  unsigned char     nonce_cnt[16]  = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
-  int32             i;
-  int               ret;
-  size_t            nc_off = 0;
+  LIBLTE_SECURITY_AES_CTX_STRUCT ctx;
 
   if (key != NULL && msg != NULL && out != NULL) {
-    ret = aes_setkey_enc(&ctx, key, 128);
+    aes_ctx_init(&ctx, key);
+    return liblte_security_encryption_eea2(&ctx, count, bearer, direction, msg, msg_len, out);
+  }
 
-    if (ret == 0) {
-      // Construct nonce
-      nonce_cnt[0] = (count >> 24) & 0xFF;
-      nonce_cnt[1] = (count >> 16) & 0xFF;
-      nonce_cnt[2] = (count >> 8) & 0xFF;
-      nonce_cnt[3] = (count)&0xFF;
-      nonce_cnt[4] = ((bearer & 0x1F) << 3) | ((direction & 0x01) << 2);
-
-      // Encryption
-      ret = aes_crypt_ctr(&ctx, (msg_len + 7) / 8, &nc_off, nonce_cnt, stream_blk, msg, out);
+  return LIBLTE_ERROR_INVALID_INPUTS;
+}
+LIBLTE_ERROR_ENUM liblte_security_encryption_eea2(LIBLTE_SECURITY_AES_CTX_STRUCT* ctx,
+                                                  uint32                          count,
+                                                  uint8                           bearer,
+                                                  uint8                           direction,
+                                                  uint8*                          msg,
+                                                  uint32                          msg_len,
+                                                  uint8*                          out)
+{
+  LIBLTE_ERROR_ENUM err            = LIBLTE_ERROR_INVALID_INPUTS;
+  unsigned char     stream_blk[16] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+  unsigned char     nonce_cnt[16]  = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+  int               ret            = 0;
+  size_t            nc_off         = 0;
+
+  if (ctx != NULL && msg != NULL && out != NULL) {
+    // Construct nonce
+    nonce_cnt[0] = (count >> 24) & 0xFF;
+    nonce_cnt[1] = (count >> 16) & 0xFF;
+    nonce_cnt[2] = (count >> 8) & 0xFF;
+    nonce_cnt[3] = (count)&0xFF;
+    nonce_cnt[4] = ((bearer & 0x1F) << 3) | ((direction & 0x01) << 2);
+
+    // Encryption
+#ifdef LIBLTE_SECURITY_HAVE_AESNI
+    if (ctx->use_aesni) {
+      aesni_crypt_ctr(ctx, nonce_cnt, msg, out, (msg_len + 7) / 8);
+    } else
+#endif
+    {
+      ret = aes_crypt_ctr(&ctx->ctx, (msg_len + 7) / 8, &nc_off, nonce_cnt, stream_blk, msg, out);
     }
 
     if (ret == 0) {
@@ -1067,6 +1161,16 @@ LIBLTE_ERROR_ENUM liblte_security_decryption_eea2(uint8* key,
 {
   return liblte_security_encryption_eea2(key, count, bearer, direction, ct, ct_len, out);
 }
+LIBLTE_ERROR_ENUM liblte_security_decryption_eea2(LIBLTE_SECURITY_AES_CTX_STRUCT* ctx,
+                                                  uint32                          count,
+                                                  uint8                           bearer,
+                                                  uint8                           direction,
+                                                  uint8*                          ct,
+                                                  uint32                          ct_len,
+                                                  uint8*                          out)
+{
+  return liblte_security_encryption_eea2(ctx, count, bearer, direction, ct, ct_len, out);
+}
 
 /*********************************************************************
     Name: liblte_security_encryption_eea1
@@ -1643,6 +1747,183 @@ void zero_tailing_bits(uint8* data, uint32 length_bits)
   data[(length_bits + 7) / 8 - 1] &= (uint8)(0xFF << bits);
 }
 
+/*********************************************************************
+    Name: aes_ctx_init
+
+    Description: Expands an AES-128 key and derives the CMAC subkeys.
+
+    Document Reference: RFC4493 Section 2.3
+*********************************************************************/
+void aes_ctx_init(LIBLTE_SECURITY_AES_CTX_STRUCT* ctx, uint8* key, LIBLTE_SECURITY_AES_BACKEND_ENUM backend)
+{
+  uint8  const_zero[16] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+  uint8  L[16];
+  uint32 i;
+
+  aes_setkey_enc(&ctx->ctx, key, 128);
+  ctx->use_aesni = false;
+#ifdef LIBLTE_SECURITY_HAVE_AESNI
+  if (backend != LIBLTE_SECURITY_AES_BACKEND_LIBRARY && __builtin_cpu_supports("aes")) {
+    aesni_key_expansion(key, ctx->rk);
+    ctx->use_aesni = true;
+  }
+#endif // LIBLTE_SECURITY_HAVE_AESNI
+
+  // Subkey L generation
+  aes_ctx_encrypt_block(ctx, const_zero, L);
+
+  // Subkey K1 generation
+  for (i = 0; i < 15; i++) {
+    ctx->K1[i] = (L[i] << 1) | ((L[i + 1] >> 7) & 0x01);
+  }
+  ctx->K1[15] = L[15] << 1;
+  if (L[0] & 0x80) {
+    ctx->K1[15] ^= 0x87;
+  }
+
+  // Subkey K2 generation
+  for (i = 0; i < 15; i++) {
+    ctx->K2[i] = (ctx->K1[i] << 1) | ((ctx->K1[i + 1] >> 7) & 0x01);
+  }
+  ctx->K2[15] = ctx->K1[15] << 1;
+  if (ctx->K1[0] & 0x80) {
+    ctx->K2[15] ^= 0x87;
+  }
+}
+
+#ifdef LIBLTE_SECURITY_HAVE_AESNI
+AESNI_TARGET static inline __m128i aesni_encrypt(const __m128i* rk, __m128i b)
+{
+  b = _mm_xor_si128(b, rk[0]);
+  for (uint32 r = 1; r < 10; r++) {
+    b = _mm_aesenc_si128(b, rk[r]);
+  }
+  return _mm_aesenclast_si128(b, rk[10]);
+}
+#endif // LIBLTE_SECURITY_HAVE_AESNI
+
+/*********************************************************************
+    Name: aes_ctx_encrypt_block
+
+    Description: Encrypts a single block with an expanded key.
+
+    Document Reference: -
+*********************************************************************/
+#ifdef LIBLTE_SECURITY_HAVE_AESNI
+AESNI_TARGET
+#endif // LIBLTE_SECURITY_HAVE_AESNI
+void aes_ctx_encrypt_block(LIBLTE_SECURITY_AES_CTX_STRUCT* ctx, uint8* input, uint8* output)
+{
+#ifdef LIBLTE_SECURITY_HAVE_AESNI
+  if (ctx->use_aesni) {
+    __m128i b = aesni_encrypt((const __m128i*)ctx->rk, _mm_loadu_si128((const __m128i*)input));
+    _mm_storeu_si128((__m128i*)output, b);
+    return;
+  }
+#endif // LIBLTE_SECURITY_HAVE_AESNI
+  aes_crypt_ecb(&ctx->ctx, AES_ENCRYPT, input, output);
+}
+
+#ifdef LIBLTE_SECURITY_HAVE_AESNI
+AESNI_TARGET static inline __m128i aesni_key_assist(__m128i key, __m128i kg)
+{
+  kg  = _mm_shuffle_epi32(kg, 0xff);
+  key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+  key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+  key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+  return _mm_xor_si128(key, kg);
+}
+
+/*********************************************************************
+    Name: aesni_key_expansion
+
+    Description: AES-128 key expansion using AES-NI.
+
+    Document Reference: -
+*********************************************************************/
+AESNI_TARGET void aesni_key_expansion(uint8* key, uint8 rk[11][16])
+{
+  __m128i k[11];
+
+  // The round constant must be an immediate
+  k[0]  = _mm_loadu_si128((const __m128i*)key);
+  k[1]  = aesni_key_assist(k[0], _mm_aeskeygenassist_si128(k[0], 0x01));
+  k[2]  = aesni_key_assist(k[1], _mm_aeskeygenassist_si128(k[1], 0x02));
+  k[3]  = aesni_key_assist(k[2], _mm_aeskeygenassist_si128(k[2], 0x04));
+  k[4]  = aesni_key_assist(k[3], _mm_aeskeygenassist_si128(k[3], 0x08));
+  k[5]  = aesni_key_assist(k[4], _mm_aeskeygenassist_si128(k[4], 0x10));
+  k[6]  = aesni_key_assist(k[5], _mm_aeskeygenassist_si128(k[5], 0x20));
+  k[7]  = aesni_key_assist(k[6], _mm_aeskeygenassist_si128(k[6], 0x40));
+  k[8]  = aesni_key_assist(k[7], _mm_aeskeygenassist_si128(k[7], 0x80));
+  k[9]  = aesni_key_assist(k[8], _mm_aeskeygenassist_si128(k[8], 0x1b));
+  k[10] = aesni_key_assist(k[9], _mm_aeskeygenassist_si128(k[9], 0x36));
+
+  for (uint32 i = 0; i < 11; i++) {
+    _mm_store_si128((__m128i*)rk[i], k[i]);
+  }
+}
+
+/*********************************************************************
+    Name: aesni_crypt_ctr
+
+    Description: AES-128 CTR mode using AES-NI, four counter blocks
+                 at a time.
+
+    Document Reference: -
+*********************************************************************/
+AESNI_TARGET void aesni_crypt_ctr(LIBLTE_SECURITY_AES_CTX_STRUCT* ctx,
+                                  uint8*                          nonce_cnt,
+                                  uint8*                          input,
+                                  uint8*                          output,
+                                  uint32                          len)
+{
+  const __m128i* rk = (const __m128i*)ctx->rk;
+  uint64_t       nonce;
+  uint64_t       blk = 0;
+  uint32         i   = 0;
+
+  // The upper 64 bits hold COUNT, BEARER and DIRECTION, the lower 64 bits are a big endian block counter
+  memcpy(&nonce, nonce_cnt, sizeof(uint64_t));
+
+  for (; i + 64 <= len; i += 64, blk += 4) {
+    __m128i c0 = _mm_set_epi64x(__builtin_bswap64(blk + 0), nonce);
+    __m128i c1 = _mm_set_epi64x(__builtin_bswap64(blk + 1), nonce);
+    __m128i c2 = _mm_set_epi64x(__builtin_bswap64(blk + 2), nonce);
+    __m128i c3 = _mm_set_epi64x(__builtin_bswap64(blk + 3), nonce);
+
+    c0 = _mm_xor_si128(c0, rk[0]);
+    c1 = _mm_xor_si128(c1, rk[0]);
+    c2 = _mm_xor_si128(c2, rk[0]);
+    c3 = _mm_xor_si128(c3, rk[0]);
+    for (uint32 r = 1; r < 10; r++) {
+      c0 = _mm_aesenc_si128(c0, rk[r]);
+      c1 = _mm_aesenc_si128(c1, rk[r]);
+      c2 = _mm_aesenc_si128(c2, rk[r]);
+      c3 = _mm_aesenc_si128(c3, rk[r]);
+    }
+    c0 = _mm_aesenclast_si128(c0, rk[10]);
+    c1 = _mm_aesenclast_si128(c1, rk[10]);
+    c2 = _mm_aesenclast_si128(c2, rk[10]);
+    c3 = _mm_aesenclast_si128(c3, rk[10]);
+
+    __m128i* in  = (__m128i*)&input[i];
+    __m128i* out = (__m128i*)&output[i];
+    _mm_storeu_si128(&out[0], _mm_xor_si128(c0, _mm_loadu_si128(&in[0])));
+    _mm_storeu_si128(&out[1], _mm_xor_si128(c1, _mm_loadu_si128(&in[1])));
+    _mm_storeu_si128(&out[2], _mm_xor_si128(c2, _mm_loadu_si128(&in[2])));
+    _mm_storeu_si128(&out[3], _mm_xor_si128(c3, _mm_loadu_si128(&in[3])));
+  }
+
+  for (; i < len; i += 16, blk++) {
+    uint8 ks[16];
+    _mm_storeu_si128((__m128i*)ks, aesni_encrypt(rk, _mm_set_epi64x(__builtin_bswap64(blk), nonce)));
+    for (uint32 j = 0; j < 16 && i + j < len; j++) {
+      output[i + j] = input[i + j] ^ ks[j];
+    }
+  }
+}
+#endif // LIBLTE_SECURITY_HAVE_AESNI
+
 /*********************************************************************
     Name: s3g_mul_x
 
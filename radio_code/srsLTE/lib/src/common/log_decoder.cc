@@ -0,0 +1,65 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/*
+ * Converts log files written by logger_binary in BINARY mode to the text
+ * format of logger_file.
+ */
+
+#include "srslte/common/logger_binary.h"
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+int main(int argc, char** argv)
+{
+  if (argc < 2 || argc > 3) {
+    fprintf(stderr, "Usage: %s <binary log file> [text output file, default stdout]\n", argv[0]);
+    return -1;
+  }
+
+  FILE* in = fopen(argv[1], "rb");
+  if (in == NULL) {
+    fprintf(stderr, "Error opening %s: %s\n", argv[1], strerror(errno));
+    return -1;
+  }
+  FILE* out = stdout;
+  if (argc == 3) {
+    out = fopen(argv[2], "w");
+    if (out == NULL) {
+      fprintf(stderr, "Error opening %s: %s\n", argv[2], strerror(errno));
+      fclose(in);
+      return -1;
+    }
+  }
+
+  int nof_msgs = srslte::logger_binary::decode(in, out);
+  fclose(in);
+  if (out != stdout) {
+    fclose(out);
+  }
+  if (nof_msgs < 0) {
+    fprintf(stderr, "Error: %s is not a binary log file or is corrupted\n", argv[1]);
+    return -1;
+  }
+  fprintf(stderr, "Decoded %d messages\n", nof_msgs);
+  return 0;
+}
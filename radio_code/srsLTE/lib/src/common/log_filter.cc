@@ -28,6 +28,7 @@
 #include <sys/time.h>
 
 #include "srslte/common/log_filter.h"
+#include "srslte/common/logger_binary.h"
 
 namespace srslte {
 
@@ -73,6 +74,12 @@ void log_filter::init(std::string layer, logger* logger_, bool tti)
   service_name = std::move(layer);
   logger_h     = logger_;
   do_tti       = tti;
+
+  // Messages to an asynchronous binary logger are passed unformatted
+  binary_h = dynamic_cast<logger_binary*>(logger_);
+  if (binary_h) {
+    binary_service_id = binary_h->register_service(service_name);
+  }
 }
 
 void log_filter::all_log(srslte::LOG_LEVEL_ENUM level,
@@ -121,6 +128,38 @@ void log_filter::all_log(srslte::LOG_LEVEL_ENUM level,
   }
 }
 
+void log_filter::binary_log(srslte::LOG_LEVEL_ENUM level,
+                            const char*            msg,
+                            va_list                args,
+                            const uint8_t*         hex,
+                            int                    size)
+{
+  log_meta_t meta;
+  meta.service_id = binary_service_id;
+  meta.level      = level;
+  meta.tti        = tti;
+  meta.flags      = do_tti ? log_meta_t::flag_tti : 0;
+  meta.prefix     = add_string_en ? &add_string_val : nullptr;
+
+  // Same time as now_time(), formatted by the logger
+  if (!time_src) {
+    timeval rawtime = {};
+    gettimeofday(&rawtime, nullptr);
+    meta.time_us  = rawtime.tv_sec * 1000000UL + rawtime.tv_usec;
+    meta.time_fmt = time_format == TIME ? log_meta_t::TIME_OF_DAY : log_meta_t::EPOCH_US;
+  } else {
+    srslte_timestamp_t now = time_src->get_time();
+    meta.time_us           = now.full_secs * 1000000UL + (uint64_t)(now.frac_secs * 1e6);
+    meta.time_fmt          = time_format == TIME ? log_meta_t::SECS_US : log_meta_t::EPOCH_US;
+  }
+
+  uint32_t hex_len = 0;
+  if (hex_limit > 0 && hex && size > 0) {
+    hex_len = (uint32_t)std::min(size, hex_limit);
+  }
+  binary_h->log_fmt(meta, msg, args, hex, hex_len);
+}
+
 void log_filter::console(const char* message, ...)
 {
   char    args_msg[char_buff_size];
@@ -135,11 +174,15 @@ void log_filter::console(const char* message, ...)
 #define all_log_expand(log_level)                                                                                      \
   do {                                                                                                                 \
     if (level >= log_level) {                                                                                          \
-      char    args_msg[char_buff_size];                                                                                \
       va_list args;                                                                                                    \
       va_start(args, message);                                                                                         \
-      if (vsnprintf(args_msg, char_buff_size, message, args) > 0)                                                      \
-        all_log(log_level, tti, args_msg);                                                                             \
+      if (binary_h) {                                                                                                  \
+        binary_log(log_level, message, args);                                                                          \
+      } else {                                                                                                         \
+        char args_msg[char_buff_size];                                                                                 \
+        if (vsnprintf(args_msg, char_buff_size, message, args) > 0)                                                    \
+          all_log(log_level, tti, args_msg);                                                                           \
+      }                                                                                                                \
       va_end(args);                                                                                                    \
     }                                                                                                                  \
   } while (0)
@@ -147,11 +190,15 @@ void log_filter::console(const char* message, ...)
 #define all_log_hex_expand(log_level)                                                                                  \
   do {                                                                                                                 \
     if (level >= log_level) {                                                                                          \
-      char    args_msg[char_buff_size];                                                                                \
       va_list args;                                                                                                    \
       va_start(args, message);                                                                                         \
-      if (vsnprintf(args_msg, char_buff_size, message, args) > 0)                                                      \
-        all_log(log_level, tti, args_msg, hex, size);                                                                  \
+      if (binary_h) {                                                                                                  \
+        binary_log(log_level, message, args, hex, size);                                                               \
+      } else {                                                                                                         \
+        char args_msg[char_buff_size];                                                                                 \
+        if (vsnprintf(args_msg, char_buff_size, message, args) > 0)                                                    \
+          all_log(log_level, tti, args_msg, hex, size);                                                                \
+      }                                                                                                                \
       va_end(args);                                                                                                    \
     }                                                                                                                  \
   } while (0)
@@ -174,13 +221,17 @@ void log_filter::info(const char* message, ...)
 void log_filter::info_long(const char* message, ...)
 {
   if (level >= LOG_LEVEL_INFO) {
-    char*   args_msg = NULL;
     va_list args;
     va_start(args, message);
-    if (vasprintf(&args_msg, message, args) > 0)
-      all_log(LOG_LEVEL_INFO, tti, args_msg, nullptr, strlen(args_msg), true);
+    if (binary_h) {
+      binary_log(LOG_LEVEL_INFO, message, args);
+    } else {
+      char* args_msg = NULL;
+      if (vasprintf(&args_msg, message, args) > 0)
+        all_log(LOG_LEVEL_INFO, tti, args_msg, nullptr, strlen(args_msg), true);
+      free(args_msg);
+    }
     va_end(args);
-    free(args_msg);
   }
 }
 
@@ -192,13 +243,17 @@ void log_filter::debug(const char* message, ...)
 void log_filter::debug_long(const char* message, ...)
 {
   if (level >= LOG_LEVEL_DEBUG) {
-    char*   args_msg = NULL;
     va_list args;
     va_start(args, message);
-    if (vasprintf(&args_msg, message, args) > 0)
-      all_log(LOG_LEVEL_DEBUG, tti, args_msg, nullptr, strlen(args_msg), true);
+    if (binary_h) {
+      binary_log(LOG_LEVEL_DEBUG, message, args);
+    } else {
+      char* args_msg = NULL;
+      if (vasprintf(&args_msg, message, args) > 0)
+        all_log(LOG_LEVEL_DEBUG, tti, args_msg, nullptr, strlen(args_msg), true);
+      free(args_msg);
+    }
     va_end(args);
-    free(args_msg);
   }
 }
 
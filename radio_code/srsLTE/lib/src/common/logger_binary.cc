@@ -0,0 +1,1024 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srslte/common/logger_binary.h"
+#include "srslte/common/log.h"
+#include <algorithm>
+#include <ctype.h>
+#include <inttypes.h>
+#include <string.h>
+#include <sys/time.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace srslte {
+
+/*
+ * Record layout, shared by the rings and the binary file. The header is followed by the prepended string, the raw
+ * arguments (or the text of an already formatted message) and the hex dump bytes. Records are padded to 8 bytes.
+ */
+struct log_record_t {
+  uint32_t size;     // Record size in bytes, header and padding included. 0 marks the end of a ring lap
+  uint32_t fmt_id;   // Format string id, or one of the ids below
+  uint64_t time_us;  // See log_meta_t::time_fmt_t
+  uint32_t tti;      // TTI, or id of the dictionary entry
+  uint32_t args_len; // Bytes of raw arguments or text
+  uint16_t service_id;
+  uint16_t prefix_len;
+  uint16_t hex_len;
+  uint8_t  level;
+  uint8_t  flags; // log_meta_t flags, time format in bits 4-5
+};
+
+static const uint32_t text_fmt_id         = UINT32_MAX;     // Payload is an already formatted message
+static const uint32_t dict_fmt_id         = UINT32_MAX - 1; // Binary file only: defines format string tti
+static const uint32_t dict_service_id     = UINT32_MAX - 2; // Binary file only: defines layer name tti
+static const char     binary_magic[8]     = {'S', 'R', 'S', 'L', 'O', 'G', 'B', '1'};
+static const uint32_t min_ring_size       = 64 * 1024;
+static const uint32_t max_log_args        = 32;
+static const uint32_t max_prefix_len      = 256;
+static const uint32_t max_drain_batch     = 1024;
+static const uint32_t backend_idle_us     = 1000;
+static const uint32_t ring_cleanup_period = 1000; // In idle backend loops
+static const uint32_t fmt_cache_size      = 512;
+
+static uint32_t align_record(uint32_t len)
+{
+  return (len + 7) & ~7u;
+}
+
+/*
+ * printf format string split into literal text and conversions, so that messages can be formatted from their raw
+ * arguments on the backend thread or offline
+ */
+struct log_fmt_t {
+  enum arg_t : uint8_t { INT32, INT64, DOUBLE, LONG_DOUBLE, STRING, POINTER };
+  struct piece_t {
+    std::string text;      // Literal text, or conversion specification adjusted to the type of the stored value
+    bool        is_conv;   // Piece is a conversion
+    uint8_t     nof_stars; // '*' width and precision arguments that precede the value
+    arg_t       arg;       // Type of the value
+  };
+
+  std::string          fmt;
+  std::vector<piece_t> pieces;
+  std::vector<arg_t>   args; // Types of all arguments, in va_list order
+  bool                 binary_ok = true;
+};
+
+static uint32_t int_arg_size(const std::string& len)
+{
+  if (len.empty() || len == "h" || len == "hh") {
+    return sizeof(int);
+  } else if (len == "l") {
+    return sizeof(long);
+  } else if (len == "ll" || len == "q") {
+    return sizeof(long long);
+  } else if (len == "j") {
+    return sizeof(intmax_t);
+  } else if (len == "z") {
+    return sizeof(size_t);
+  } else if (len == "t") {
+    return sizeof(ptrdiff_t);
+  }
+  return 0;
+}
+
+static void parse_fmt(const char* fmt, log_fmt_t& desc)
+{
+  desc.fmt = fmt;
+  std::string lit;
+  const char* p = fmt;
+  while (*p != '\0') {
+    if (*p != '%') {
+      lit += *p++;
+      continue;
+    }
+    if (p[1] == '%') {
+      lit += '%';
+      p += 2;
+      continue;
+    }
+    if (not lit.empty()) {
+      desc.pieces.push_back({lit, false, 0, log_fmt_t::INT32});
+      lit.clear();
+    }
+
+    log_fmt_t::piece_t conv = {"%", true, 0, log_fmt_t::INT32};
+    p++;
+    while (*p != '\0' and strchr("-+ #0'", *p) != nullptr) {
+      conv.text += *p++;
+    }
+    if (*p == '*') {
+      conv.text += *p++;
+      conv.nof_stars++;
+      desc.args.push_back(log_fmt_t::INT32);
+    } else {
+      while (isdigit(*p)) {
+        conv.text += *p++;
+      }
+    }
+    if (*p == '$') {
+      // Positional arguments
+      desc.binary_ok = false;
+      return;
+    }
+    if (*p == '.') {
+      conv.text += *p++;
+      if (*p == '*') {
+        conv.text += *p++;
+        conv.nof_stars++;
+        desc.args.push_back(log_fmt_t::INT32);
+      } else {
+        while (isdigit(*p)) {
+          conv.text += *p++;
+        }
+      }
+    }
+    std::string len;
+    while (*p != '\0' and strchr("hlLqjzt", *p) != nullptr) {
+      len += *p++;
+    }
+
+    char c = *p;
+    if (c == '\0') {
+      desc.binary_ok = false;
+      return;
+    }
+    p++;
+    switch (c) {
+      case 'd':
+      case 'i':
+      case 'u':
+      case 'o':
+      case 'x':
+      case 'X':
+        // Values are stored as int or long long, the conversion is adjusted accordingly
+        if (int_arg_size(len) == sizeof(long long)) {
+          conv.text += "ll";
+          conv.arg = log_fmt_t::INT64;
+        } else if (int_arg_size(len) == sizeof(int)) {
+          if (len == "h" or len == "hh") {
+            conv.text += len;
+          }
+          conv.arg = log_fmt_t::INT32;
+        } else {
+          desc.binary_ok = false;
+          return;
+        }
+        break;
+      case 'c':
+        conv.arg = log_fmt_t::INT32;
+        desc.binary_ok &= len.empty();
+        break;
+      case 'e':
+      case 'E':
+      case 'f':
+      case 'F':
+      case 'g':
+      case 'G':
+      case 'a':
+      case 'A':
+        // Stored and formatted as double
+        conv.arg = len == "L" ? log_fmt_t::LONG_DOUBLE : log_fmt_t::DOUBLE;
+        desc.binary_ok &= len.empty() or len == "l" or len == "L";
+        break;
+      case 's':
+        conv.arg = log_fmt_t::STRING;
+        desc.binary_ok &= len.empty();
+        break;
+      case 'p':
+        conv.arg = log_fmt_t::POINTER;
+        desc.binary_ok &= len.empty();
+        break;
+      default:
+        // %n, %m, wide characters and unknown conversions
+        desc.binary_ok = false;
+        break;
+    }
+    if (not desc.binary_ok) {
+      return;
+    }
+    conv.text += c;
+    desc.args.push_back(conv.arg);
+    desc.pieces.push_back(conv);
+  }
+  if (not lit.empty()) {
+    desc.pieces.push_back({lit, false, 0, log_fmt_t::INT32});
+  }
+}
+
+template <typename T>
+static void append_conv(std::string& out, const std::string& spec, uint32_t nof_stars, const int* stars, T value)
+{
+  char buf[256];
+  int  n = 0;
+  switch (nof_stars) {
+    case 0:
+      n = snprintf(buf, sizeof(buf), spec.c_str(), value);
+      break;
+    case 1:
+      n = snprintf(buf, sizeof(buf), spec.c_str(), stars[0], value);
+      break;
+    default:
+      n = snprintf(buf, sizeof(buf), spec.c_str(), stars[0], stars[1], value);
+      break;
+  }
+  if (n < 0) {
+    return;
+  }
+  if ((size_t)n < sizeof(buf)) {
+    out.append(buf, n);
+    return;
+  }
+  std::vector<char> big(n + 1);
+  switch (nof_stars) {
+    case 0:
+      snprintf(big.data(), big.size(), spec.c_str(), value);
+      break;
+    case 1:
+      snprintf(big.data(), big.size(), spec.c_str(), stars[0], value);
+      break;
+    default:
+      snprintf(big.data(), big.size(), spec.c_str(), stars[0], stars[1], value);
+      break;
+  }
+  out.append(big.data(), n);
+}
+
+// Formats the raw arguments of a message. Returns false if they do not match the format
+static bool format_args(const log_fmt_t& fmt, const uint8_t* args, uint32_t args_len, std::string& out)
+{
+  const uint8_t* end = args + args_len;
+  std::string    str;
+  for (const log_fmt_t::piece_t& piece : fmt.pieces) {
+    if (not piece.is_conv) {
+      out += piece.text;
+      continue;
+    }
+    int stars[2] = {};
+    for (uint32_t i = 0; i < piece.nof_stars; i++) {
+      if (args + sizeof(int32_t) > end) {
+        return false;
+      }
+      memcpy(&stars[i], args, sizeof(int32_t));
+      args += sizeof(int32_t);
+    }
+    switch (piece.arg) {
+      case log_fmt_t::INT32: {
+        int32_t v;
+        if (args + sizeof(v) > end) {
+          return false;
+        }
+        memcpy(&v, args, sizeof(v));
+        args += sizeof(v);
+        append_conv(out, piece.text, piece.nof_stars, stars, (int)v);
+      } break;
+      case log_fmt_t::INT64: {
+        int64_t v;
+        if (args + sizeof(v) > end) {
+          return false;
+        }
+        memcpy(&v, args, sizeof(v));
+        args += sizeof(v);
+        append_conv(out, piece.text, piece.nof_stars, stars, (long long)v);
+      } break;
+      case log_fmt_t::DOUBLE:
+      case log_fmt_t::LONG_DOUBLE: {
+        double v;
+        if (args + sizeof(v) > end) {
+          return false;
+        }
+        memcpy(&v, args, sizeof(v));
+        args += sizeof(v);
+        append_conv(out, piece.text, piece.nof_stars, stars, v);
+      } break;
+      case log_fmt_t::STRING: {
+        uint16_t len;
+        if (args + sizeof(len) > end) {
+          return false;
+        }
+        memcpy(&len, args, sizeof(len));
+        args += sizeof(len);
+        if (args + len > end) {
+          return false;
+        }
+        str.assign((const char*)args, len);
+        args += len;
+        append_conv(out, piece.text, piece.nof_stars, stars, str.c_str());
+      } break;
+      case log_fmt_t::POINTER: {
+        uint64_t v;
+        if (args + sizeof(v) > end) {
+          return false;
+        }
+        memcpy(&v, args, sizeof(v));
+        args += sizeof(v);
+        append_conv(out, piece.text, piece.nof_stars, stars, (void*)(uintptr_t)v);
+      } break;
+    }
+  }
+  return true;
+}
+
+// Produces the same line as log_filter::all_log()
+static void format_record(const log_record_t& rec,
+                          const uint8_t*      payload,
+                          const log_fmt_t*    fmt,
+                          const std::string*  service,
+                          std::string&        out)
+{
+  const char*    prefix = (const char*)payload;
+  const uint8_t* args   = payload + rec.prefix_len;
+  const uint8_t* hex    = args + rec.args_len;
+  char           buf[64];
+
+  out.clear();
+  if (rec.flags & log_meta_t::flag_raw) {
+    out.append((const char*)args, rec.args_len);
+    return;
+  }
+
+  uint64_t secs = rec.time_us / 1000000;
+  uint32_t usec = rec.time_us % 1000000;
+  switch ((rec.flags >> 4) & 0x3) {
+    case log_meta_t::TIME_OF_DAY: {
+      time_t t        = (time_t)secs;
+      tm     timeinfo = {};
+      gmtime_r(&t, &timeinfo);
+      size_t n = strftime(buf, sizeof(buf), "%H:%M:%S.", &timeinfo);
+      snprintf(buf + n, sizeof(buf) - n, "%06u", usec);
+    } break;
+    case log_meta_t::SECS_US:
+      snprintf(buf, sizeof(buf), "%" PRIu64 ":%06u", secs, usec);
+      break;
+    default:
+      snprintf(buf, sizeof(buf), "%" PRIu64, rec.time_us);
+      break;
+  }
+  out += buf;
+  snprintf(buf, sizeof(buf), " [%-4s] ", service ? service->c_str() : "");
+  out += buf;
+  out += log_level_text_short[rec.level < LOG_LEVEL_N_ITEMS ? rec.level : 0];
+  out += ' ';
+  if (rec.flags & log_meta_t::flag_tti) {
+    snprintf(buf, sizeof(buf), "[%5d] ", rec.tti);
+    out += buf;
+  }
+  out.append(prefix, rec.prefix_len);
+
+  size_t msg_start = out.size();
+  if (rec.fmt_id == text_fmt_id) {
+    out.append((const char*)args, rec.args_len);
+  } else if (fmt == nullptr or not format_args(*fmt, args, rec.args_len, out)) {
+    out.resize(msg_start);
+    snprintf(buf, sizeof(buf), "<undecodable message, format id %u>", rec.fmt_id);
+    out += buf;
+  }
+  if (out.size() == msg_start or out.back() != '\n') {
+    out += '\n';
+  }
+
+  for (uint32_t c = 0; c < rec.hex_len; c += 16) {
+    snprintf(buf, sizeof(buf), "             %04x: ", c);
+    out += buf;
+    for (uint32_t i = c; i < std::min(c + 16, (uint32_t)rec.hex_len); i++) {
+      snprintf(buf, sizeof(buf), "%02x ", hex[i]);
+      out += buf;
+    }
+    out += '\n';
+  }
+}
+
+/*
+ * Single producer, single consumer ring of variable size records. The producer is the thread that owns the ring
+ * and the consumer is the backend thread. Positions grow monotonically and are masked with the power of two size.
+ */
+class log_ring
+{
+public:
+  explicit log_ring(uint32_t size_) : size(size_), buffer(new uint8_t[size_]) {}
+
+  uint32_t max_record_len() const { return size / 4; }
+
+  // Returns space for a record of len bytes (multiple of 8), or nullptr if the ring is full
+  uint8_t* reserve(uint32_t len)
+  {
+    uint64_t w      = write_pos.load(std::memory_order_relaxed);
+    uint32_t offset = w & (size - 1);
+    uint32_t to_end = size - offset;
+    uint32_t need   = len <= to_end ? len : to_end + len;
+    if (w + need - cached_read_pos > size) {
+      cached_read_pos = read_pos.load(std::memory_order_acquire);
+      if (w + need - cached_read_pos > size) {
+        return nullptr;
+      }
+    }
+    if (len > to_end) {
+      // Skip the space left before the end of the buffer
+      uint32_t lap_end = 0;
+      memcpy(buffer.get() + offset, &lap_end, sizeof(lap_end));
+      offset = 0;
+    }
+    pending = need;
+    return buffer.get() + offset;
+  }
+  void commit() { write_pos.store(write_pos.load(std::memory_order_relaxed) + pending, std::memory_order_release); }
+
+  // Returns the oldest record, or nullptr if the ring is empty
+  const log_record_t* front()
+  {
+    uint64_t r = read_pos.load(std::memory_order_relaxed);
+    uint64_t w = write_pos.load(std::memory_order_acquire);
+    while (r != w) {
+      uint32_t            offset = r & (size - 1);
+      const log_record_t* rec    = reinterpret_cast<const log_record_t*>(buffer.get() + offset);
+      if (rec->size != 0) {
+        return rec;
+      }
+      r += size - offset;
+      read_pos.store(r, std::memory_order_release);
+    }
+    return nullptr;
+  }
+  void pop(const log_record_t* rec)
+  {
+    read_pos.store(read_pos.load(std::memory_order_relaxed) + rec->size, std::memory_order_release);
+  }
+
+  std::atomic<uint64_t> dropped{0};
+
+private:
+  const uint32_t             size;
+  std::unique_ptr<uint8_t[]> buffer;
+
+  // Producer
+  std::atomic<uint64_t> write_pos{0};
+  uint64_t              cached_read_pos = 0;
+  uint32_t              pending         = 0;
+  uint8_t               pad[64]         = {}; // Keep the consumer position in a different cache line
+
+  // Consumer
+  std::atomic<uint64_t> read_pos{0};
+};
+
+namespace {
+
+std::atomic<uint64_t> next_instance_id{1};
+
+// Ring of the calling thread, for the logger with instance id owner
+struct thread_ring_t {
+  uint64_t  owner  = 0;
+  log_ring* ring   = nullptr;
+  bool      exited = false; // Set once tls_ring_ref is destroyed, messages logged later are discarded
+};
+thread_local thread_ring_t tls_ring;
+
+// Keeps the ring alive while the thread runs. The backend frees it once the thread exits and the ring is drained
+struct thread_ring_ref_t {
+  std::shared_ptr<log_ring> ring;
+  ~thread_ring_ref_t()
+  {
+    tls_ring.ring   = nullptr;
+    tls_ring.exited = true;
+  }
+};
+thread_local thread_ring_ref_t tls_ring_ref;
+
+// Per-thread direct mapped cache of format string ids, so that registered formats are looked up without locking
+struct fmt_cache_t {
+  uint64_t         owner = 0;
+  const char*      fmt[fmt_cache_size];
+  uint32_t         id[fmt_cache_size];
+  const log_fmt_t* desc[fmt_cache_size];
+};
+thread_local fmt_cache_t tls_fmt_cache;
+
+} // namespace
+
+// Messages are copied to the thread rings, the pool of log strings is not used
+logger_binary::logger_binary() :
+  thread("LOGGER_BINARY"),
+  logger(1),
+  instance_id(next_instance_id++),
+  is_running(false),
+  rings_version(0),
+  nof_dropped(0)
+{}
+
+logger_binary::~logger_binary()
+{
+  stop();
+}
+
+void logger_binary::init(std::string file, output_t output_, int max_length_, uint32_t ring_size_)
+{
+  if (is_running) {
+    fprintf(stderr, "Error: logger thread is already running.\n");
+    return;
+  }
+  output     = output_;
+  max_length = (int64_t)max_length_ * 1024;
+  name_idx   = 0;
+  filename   = file;
+  ring_size  = min_ring_size;
+  while (ring_size < ring_size_) {
+    ring_size <<= 1;
+  }
+  logfile = fopen(filename.c_str(), "w");
+  if (logfile == NULL) {
+    printf("Error: could not create log file, no messages will be logged!\n");
+  }
+  start_file();
+  is_running = true;
+  start(-2);
+}
+
+void logger_binary::stop()
+{
+  if (is_running) {
+    is_running = false;
+    wait_thread_finish();
+    while (drain()) {
+    }
+    write_raw("Closing log\n");
+    if (logfile) {
+      fclose(logfile);
+      logfile = NULL;
+    }
+  }
+}
+
+void logger_binary::start_file()
+{
+  cur_length = 0;
+  if (output == BINARY) {
+    nof_written_fmts     = 0;
+    nof_written_services = 0;
+    write_out(binary_magic, sizeof(binary_magic));
+  }
+}
+
+void logger_binary::rotate_file()
+{
+  if (logfile) {
+    fclose(logfile);
+  }
+  name_idx++;
+  char numstr[21]; // enough to hold all numbers up to 64-bits
+  sprintf(numstr, ".%d", name_idx);
+  std::string newfilename = filename + numstr;
+  logfile                 = fopen(newfilename.c_str(), "w");
+  if (logfile == NULL) {
+    printf("Error: could not create log file, no messages will be logged!\n");
+  }
+  start_file();
+}
+
+void logger_binary::log(unique_log_str_t msg)
+{
+  timeval now = {};
+  gettimeofday(&now, nullptr);
+
+  log_meta_t meta;
+  meta.time_us = now.tv_sec * 1000000UL + now.tv_usec;
+  meta.flags   = log_meta_t::flag_raw;
+  log_text(meta, msg->str(), strlen(msg->str()));
+}
+
+uint16_t logger_binary::register_service(const std::string& name)
+{
+  std::lock_guard<std::mutex> lock(dict_mutex);
+  for (uint32_t i = 0; i < services.size(); i++) {
+    if (services[i] == name) {
+      return i;
+    }
+  }
+  services.push_back(name);
+  return services.size() - 1;
+}
+
+log_ring* logger_binary::get_ring()
+{
+  thread_ring_t& tls = tls_ring;
+  if (tls.owner != instance_id and not tls.exited) {
+    std::shared_ptr<log_ring> ring(new log_ring(ring_size));
+    {
+      std::lock_guard<std::mutex> lock(ring_mutex);
+      rings.push_back(ring);
+      rings_version++;
+    }
+    tls.owner         = instance_id;
+    tls.ring          = ring.get();
+    tls_ring_ref.ring = std::move(ring);
+  }
+  return tls.ring;
+}
+
+uint32_t logger_binary::get_fmt_id(const char* fmt, const log_fmt_t** desc)
+{
+  fmt_cache_t& cache = tls_fmt_cache;
+  if (cache.owner != instance_id) {
+    memset(cache.fmt, 0, sizeof(cache.fmt));
+    cache.owner = instance_id;
+  }
+  uintptr_t key = reinterpret_cast<uintptr_t>(fmt);
+  uint32_t  idx = (key ^ (key >> 9)) % fmt_cache_size;
+  if (cache.fmt[idx] != fmt) {
+    std::lock_guard<std::mutex> lock(dict_mutex);
+    auto                        it = fmt_ids.find(fmt);
+    if (it == fmt_ids.end()) {
+      it = fmt_ids.insert(std::make_pair(fmt, (uint32_t)fmts.size())).first;
+      fmts.emplace_back(new log_fmt_t);
+      parse_fmt(fmt, *fmts.back());
+    }
+    cache.fmt[idx]  = fmt;
+    cache.id[idx]   = it->second;
+    cache.desc[idx] = fmts[it->second].get();
+  }
+  *desc = cache.desc[idx];
+  return cache.id[idx];
+}
+
+void logger_binary::log_fmt(const log_meta_t& meta,
+                            const char*       fmt,
+                            va_list           args,
+                            const uint8_t*    hex,
+                            uint32_t          hex_len)
+{
+  log_ring* ring = get_ring();
+  if (ring == nullptr) {
+    return;
+  }
+  const log_fmt_t* desc   = nullptr;
+  uint32_t         fmt_id = get_fmt_id(fmt, &desc);
+
+  va_list args_copy;
+  va_copy(args_copy, args);
+
+  // Collect the arguments in a single pass over the va_list
+  bool     store_raw = desc->binary_ok and desc->args.size() <= max_log_args;
+  uint64_t values[max_log_args];
+  uint16_t str_lens[max_log_args];
+  uint32_t args_len   = 0;
+  uint32_t prefix_len = meta.prefix ? std::min((uint32_t)meta.prefix->size(), max_prefix_len) : 0;
+  for (uint32_t i = 0; store_raw and i < desc->args.size(); i++) {
+    switch (desc->args[i]) {
+      case log_fmt_t::INT32:
+        values[i] = (uint32_t)va_arg(args, int);
+        args_len += sizeof(int32_t);
+        break;
+      case log_fmt_t::INT64:
+        values[i] = (uint64_t)va_arg(args, long long);
+        args_len += sizeof(int64_t);
+        break;
+      case log_fmt_t::DOUBLE: {
+        double v = va_arg(args, double);
+        memcpy(&values[i], &v, sizeof(v));
+        args_len += sizeof(double);
+      } break;
+      case log_fmt_t::LONG_DOUBLE: {
+        double v = (double)va_arg(args, long double);
+        memcpy(&values[i], &v, sizeof(v));
+        args_len += sizeof(double);
+      } break;
+      case log_fmt_t::STRING: {
+        const char* s = va_arg(args, const char*);
+        s             = s != nullptr ? s : "(null)";
+        values[i]     = reinterpret_cast<uintptr_t>(s);
+        str_lens[i]   = strnlen(s, UINT16_MAX);
+        args_len += sizeof(uint16_t) + str_lens[i];
+      } break;
+      case log_fmt_t::POINTER:
+        values[i] = reinterpret_cast<uintptr_t>(va_arg(args, void*));
+        args_len += sizeof(uint64_t);
+        break;
+    }
+  }
+  store_raw &= sizeof(log_record_t) + prefix_len + args_len <= ring->max_record_len();
+
+  if (not store_raw) {
+    // Format on the calling thread
+    char buf[1024];
+    int  n = vsnprintf(buf, sizeof(buf), fmt, args_copy);
+    va_end(args_copy);
+    if (n > 0) {
+      log_text(meta, buf, std::min((uint32_t)n, (uint32_t)sizeof(buf) - 1), hex, hex_len);
+    }
+    return;
+  }
+  va_end(args_copy);
+
+  hex_len      = std::min(hex_len, ring->max_record_len() - (uint32_t)sizeof(log_record_t) - prefix_len - args_len);
+  hex_len      = std::min(hex_len, (uint32_t)UINT16_MAX);
+  uint32_t len = sizeof(log_record_t) + prefix_len + args_len + hex_len;
+  uint8_t* p   = ring->reserve(align_record(len));
+  if (p == nullptr) {
+    ring->dropped++;
+    return;
+  }
+
+  log_record_t* rec = reinterpret_cast<log_record_t*>(p);
+  rec->size         = align_record(len);
+  rec->fmt_id       = fmt_id;
+  rec->time_us      = meta.time_us;
+  rec->tti          = meta.tti;
+  rec->args_len     = args_len;
+  rec->service_id   = meta.service_id;
+  rec->prefix_len   = prefix_len;
+  rec->hex_len      = hex_len;
+  rec->level        = meta.level;
+  rec->flags        = meta.flags | (meta.time_fmt << 4);
+  p += sizeof(log_record_t);
+  if (prefix_len > 0) {
+    memcpy(p, meta.prefix->data(), prefix_len);
+    p += prefix_len;
+  }
+  for (uint32_t i = 0; i < desc->args.size(); i++) {
+    switch (desc->args[i]) {
+      case log_fmt_t::INT32:
+        memcpy(p, &values[i], sizeof(uint32_t));
+        p += sizeof(uint32_t);
+        break;
+      case log_fmt_t::STRING:
+        memcpy(p, &str_lens[i], sizeof(uint16_t));
+        memcpy(p + sizeof(uint16_t), reinterpret_cast<const char*>(values[i]), str_lens[i]);
+        p += sizeof(uint16_t) + str_lens[i];
+        break;
+      default:
+        memcpy(p, &values[i], sizeof(uint64_t));
+        p += sizeof(uint64_t);
+        break;
+    }
+  }
+  if (hex_len > 0) {
+    memcpy(p, hex, hex_len);
+  }
+  ring->commit();
+}
+
+void logger_binary::log_text(const log_meta_t& meta,
+                             const char*       msg,
+                             uint32_t          len,
+                             const uint8_t*    hex,
+                             uint32_t          hex_len)
+{
+  log_ring* ring = get_ring();
+  if (ring == nullptr) {
+    return;
+  }
+  uint32_t max_len    = ring->max_record_len() - sizeof(log_record_t);
+  uint32_t prefix_len = meta.prefix ? std::min((uint32_t)meta.prefix->size(), max_prefix_len) : 0;
+  len                 = std::min(len, max_len - prefix_len);
+  hex_len             = std::min(std::min(hex_len, max_len - prefix_len - len), (uint32_t)UINT16_MAX);
+
+  uint32_t rec_len = sizeof(log_record_t) + prefix_len + len + hex_len;
+  uint8_t* p       = ring->reserve(align_record(rec_len));
+  if (p == nullptr) {
+    ring->dropped++;
+    return;
+  }
+
+  log_record_t* rec = reinterpret_cast<log_record_t*>(p);
+  rec->size         = align_record(rec_len);
+  rec->fmt_id       = text_fmt_id;
+  rec->time_us      = meta.time_us;
+  rec->tti          = meta.tti;
+  rec->args_len     = len;
+  rec->service_id   = meta.service_id;
+  rec->prefix_len   = prefix_len;
+  rec->hex_len      = hex_len;
+  rec->level        = meta.level;
+  rec->flags        = meta.flags | (meta.time_fmt << 4);
+  p += sizeof(log_record_t);
+  if (prefix_len > 0) {
+    memcpy(p, meta.prefix->data(), prefix_len);
+    p += prefix_len;
+  }
+  memcpy(p, msg, len);
+  if (hex_len > 0) {
+    memcpy(p + len, hex, hex_len);
+  }
+  ring->commit();
+}
+
+void logger_binary::run_thread()
+{
+  uint32_t idle_loops = 0;
+  while (is_running) {
+    if (drain()) {
+      continue;
+    }
+    if (pending_flush && logfile) {
+      fflush(logfile);
+      pending_flush = false;
+    }
+    if (++idle_loops >= ring_cleanup_period) {
+      // Free the rings of threads that have exited. Those are only referenced by rings and backend_rings
+      idle_loops = 0;
+      std::lock_guard<std::mutex> lock(ring_mutex);
+      backend_rings = rings;
+      rings.erase(std::remove_if(rings.begin(),
+                                 rings.end(),
+                                 [](std::shared_ptr<log_ring>& r) { return r.use_count() == 2 and !r->front(); }),
+                  rings.end());
+      backend_rings         = rings;
+      backend_rings_version = ++rings_version;
+    }
+    usleep(backend_idle_us);
+  }
+}
+
+// Writes pending messages in time order. Returns false if there were none
+bool logger_binary::drain()
+{
+  if (backend_rings_version != rings_version) {
+    std::lock_guard<std::mutex> lock(ring_mutex);
+    backend_rings         = rings;
+    backend_rings_version = rings_version;
+  }
+
+  uint32_t n = 0;
+  for (; n < max_drain_batch; n++) {
+    log_ring*           oldest     = nullptr;
+    const log_record_t* oldest_rec = nullptr;
+    for (std::shared_ptr<log_ring>& r : backend_rings) {
+      const log_record_t* rec = r->front();
+      if (rec != nullptr and (oldest_rec == nullptr or rec->time_us < oldest_rec->time_us)) {
+        oldest     = r.get();
+        oldest_rec = rec;
+      }
+    }
+    if (oldest == nullptr) {
+      break;
+    }
+    write_record(reinterpret_cast<const uint8_t*>(oldest_rec));
+    oldest->pop(oldest_rec);
+  }
+
+  for (std::shared_ptr<log_ring>& r : backend_rings) {
+    uint64_t dropped = r->dropped.exchange(0);
+    if (dropped > 0) {
+      nof_dropped += dropped;
+      char buf[128];
+      snprintf(buf, sizeof(buf), "Log: %" PRIu64 " messages dropped, ring buffer full\n", dropped);
+      write_raw(buf);
+    }
+  }
+  return n > 0;
+}
+
+// Writes a message of the logger itself
+void logger_binary::write_raw(const char* msg)
+{
+  uint32_t     len = strlen(msg);
+  log_record_t rec = {};
+  rec.size         = align_record(sizeof(log_record_t) + len);
+  rec.fmt_id       = text_fmt_id;
+  rec.args_len     = len;
+  rec.flags        = log_meta_t::flag_raw;
+
+  std::vector<uint8_t> raw(rec.size);
+  memcpy(raw.data(), &rec, sizeof(rec));
+  memcpy(raw.data() + sizeof(rec), msg, len);
+  write_record(raw.data());
+}
+
+void logger_binary::refresh_dictionaries()
+{
+  {
+    std::lock_guard<std::mutex> lock(dict_mutex);
+    for (uint32_t i = backend_fmts.size(); i < fmts.size(); i++) {
+      backend_fmts.push_back(fmts[i].get());
+    }
+    for (uint32_t i = backend_services.size(); i < services.size(); i++) {
+      backend_services.push_back(services[i]);
+    }
+  }
+  if (output != BINARY) {
+    return;
+  }
+
+  // Define new format strings and layer names in the file before their first use
+  auto write_entry = [this](uint32_t id_type, uint32_t id, const std::string& s) {
+    log_record_t rec = {};
+    rec.size         = align_record(sizeof(log_record_t) + s.size());
+    rec.fmt_id       = id_type;
+    rec.tti          = id;
+    rec.args_len     = s.size();
+    uint8_t pad[8]   = {};
+    write_out(&rec, sizeof(rec));
+    write_out(s.data(), s.size());
+    write_out(pad, rec.size - sizeof(rec) - s.size());
+  };
+  for (; nof_written_fmts < backend_fmts.size(); nof_written_fmts++) {
+    write_entry(dict_fmt_id, nof_written_fmts, backend_fmts[nof_written_fmts]->fmt);
+  }
+  for (; nof_written_services < backend_services.size(); nof_written_services++) {
+    write_entry(dict_service_id, nof_written_services, backend_services[nof_written_services]);
+  }
+}
+
+void logger_binary::write_record(const uint8_t* data)
+{
+  const log_record_t* rec = reinterpret_cast<const log_record_t*>(data);
+
+  if (max_length > 0 && cur_length >= max_length) {
+    rotate_file();
+  }
+
+  bool known_fmt     = rec->fmt_id == text_fmt_id or rec->fmt_id < nof_written_fmts;
+  bool known_service = rec->service_id < nof_written_services;
+  if (output == TEXT) {
+    known_fmt     = rec->fmt_id == text_fmt_id or rec->fmt_id < backend_fmts.size();
+    known_service = rec->service_id < backend_services.size();
+  }
+  if (not known_fmt or not known_service) {
+    refresh_dictionaries();
+  }
+
+  if (output == BINARY) {
+    write_out(data, rec->size);
+    return;
+  }
+  const log_fmt_t*   fmt     = rec->fmt_id < backend_fmts.size() ? backend_fmts[rec->fmt_id] : nullptr;
+  const std::string* service = rec->service_id < backend_services.size() ? &backend_services[rec->service_id] : nullptr;
+  format_record(*rec, data + sizeof(log_record_t), fmt, service, line);
+  write_out(line.data(), line.size());
+}
+
+void logger_binary::write_out(const void* data, size_t len)
+{
+  if (logfile != NULL && len > 0 && fwrite(data, 1, len, logfile) == len) {
+    cur_length += len;
+    pending_flush = true;
+  }
+}
+
+int logger_binary::decode(FILE* in, FILE* out)
+{
+  char magic[sizeof(binary_magic)];
+  if (fread(magic, sizeof(magic), 1, in) != 1 or memcmp(magic, binary_magic, sizeof(magic)) != 0) {
+    return -1;
+  }
+
+  std::vector<std::unique_ptr<log_fmt_t>> fmts;
+  std::vector<std::string>                services;
+  std::vector<uint8_t>                    payload;
+  std::string                             line;
+  log_record_t                            rec   = {};
+  int                                     count = 0;
+  while (fread(&rec, sizeof(rec), 1, in) == 1) {
+    if (rec.size < sizeof(rec) or rec.size > 16 * 1024 * 1024) {
+      return -1;
+    }
+    payload.resize(rec.size - sizeof(rec));
+    if (not payload.empty() and fread(payload.data(), payload.size(), 1, in) != 1) {
+      return -1;
+    }
+    if ((size_t)rec.prefix_len + rec.args_len + rec.hex_len > payload.size()) {
+      return -1;
+    }
+
+    if (rec.fmt_id == dict_fmt_id) {
+      std::string fmt((const char*)payload.data(), rec.args_len);
+      if (rec.tti >= fmts.size()) {
+        fmts.resize(rec.tti + 1);
+      }
+      fmts[rec.tti].reset(new log_fmt_t);
+      parse_fmt(fmt.c_str(), *fmts[rec.tti]);
+    } else if (rec.fmt_id == dict_service_id) {
+      if (rec.tti >= services.size()) {
+        services.resize(rec.tti + 1);
+      }
+      services[rec.tti].assign((const char*)payload.data(), rec.args_len);
+    } else {
+      const log_fmt_t*   fmt     = rec.fmt_id < fmts.size() ? fmts[rec.fmt_id].get() : nullptr;
+      const std::string* service = rec.service_id < services.size() ? &services[rec.service_id] : nullptr;
+      format_record(rec, payload.data(), fmt, service, line);
+      fwrite(line.data(), 1, line.size(), out);
+      count++;
+    }
+  }
+  return count;
+}
+
+} // namespace srslte
@@ -23,11 +23,140 @@
 #include "srslte/common/pcap.h"
 
 #include "srslte/srslte.h"
+#include <inttypes.h>
 #include <stdint.h>
+#include <sys/time.h>
+#include <unistd.h>
 
 namespace srslte {
 
-mac_pcap::mac_pcap() : enable_write(false), ue_id(0), pcap_file(nullptr) {}
+static const uint32_t min_ring_size   = 256 * 1024;
+static const uint32_t max_drain_batch = 1024;
+static const uint32_t batch_size      = 1024 * 1024; // Bytes written to file at once
+static const uint32_t backend_idle_us = 1000;
+static const uint32_t max_lcid        = 31;
+
+// PDU record stored in the ring, followed by the PDU bytes. Records are padded to 8 bytes
+struct mac_pcap_pdu_t {
+  uint32_t           size; // Record size in bytes, stored last to publish the record
+  uint32_t           pdu_len;
+  uint32_t           ts_sec;
+  uint32_t           ts_usec;
+  MAC_Context_Info_t context;
+};
+
+/*
+ * Multi-producer single-consumer ring of variable size records. Producers reserve space with a CAS on the write
+ * position and publish a record by storing its size, the first word of the record, last. The consumer zeroes the
+ * space of the records it pops, so a zero size marks a record that is still being written.
+ */
+class mac_pcap_ring
+{
+public:
+  explicit mac_pcap_ring(uint32_t size_) : size(size_), buffer(new uint64_t[size_ / sizeof(uint64_t)]()) {}
+
+  uint32_t max_record_len() const { return size / 4; }
+
+  // Returns space for a record of len bytes (multiple of 8), or nullptr if the ring is full
+  uint8_t* reserve(uint32_t len)
+  {
+    uint64_t w = write_pos.load(std::memory_order_relaxed);
+    uint32_t offset, to_end, need;
+    do {
+      offset = w & (size - 1);
+      to_end = size - offset;
+      need   = len <= to_end ? len : to_end + len;
+      if (w + need - read_pos.load(std::memory_order_acquire) > size) {
+        return nullptr;
+      }
+    } while (not write_pos.compare_exchange_weak(w, w + need, std::memory_order_relaxed));
+
+    if (len > to_end) {
+      // Skip the space left before the end of the buffer
+      publish(bytes() + offset, to_end | skip_flag);
+      offset = 0;
+    }
+    return bytes() + offset;
+  }
+  void publish(uint8_t* rec, uint32_t len) { __atomic_store_n(reinterpret_cast<uint32_t*>(rec), len, __ATOMIC_RELEASE); }
+
+  // Returns the oldest record, or nullptr if the ring is empty or the oldest record is still being written
+  const uint8_t* front()
+  {
+    uint64_t r = read_pos.load(std::memory_order_relaxed);
+    while (true) {
+      uint8_t* rec = bytes() + (r & (size - 1));
+      uint32_t len = __atomic_load_n(reinterpret_cast<uint32_t*>(rec), __ATOMIC_ACQUIRE);
+      if (len == 0) {
+        return nullptr;
+      }
+      if ((len & skip_flag) == 0) {
+        return rec;
+      }
+      len &= ~skip_flag;
+      memset(rec, 0, len);
+      r += len;
+      read_pos.store(r, std::memory_order_release);
+    }
+  }
+  void pop(const uint8_t* rec)
+  {
+    uint32_t len = *reinterpret_cast<const uint32_t*>(rec);
+    memset(const_cast<uint8_t*>(rec), 0, len);
+    read_pos.store(read_pos.load(std::memory_order_relaxed) + len, std::memory_order_release);
+  }
+
+private:
+  static const uint32_t skip_flag = 0x80000000;
+
+  uint8_t* bytes() { return reinterpret_cast<uint8_t*>(buffer.get()); }
+
+  const uint32_t              size;
+  std::unique_ptr<uint64_t[]> buffer;
+
+  std::atomic<uint64_t> write_pos{0};
+  uint8_t               pad[64] = {}; // Keep the consumer position in a different cache line
+  std::atomic<uint64_t> read_pos{0};
+};
+
+// Parses a comma-separated list of numbers into a filter indexed by value
+static int parse_filter_list(const std::string& list, uint32_t max_value, std::vector<bool>& filter)
+{
+  filter.clear();
+  const char* str = list.c_str();
+  while (*str != '\0') {
+    while (isspace(*str) or *str == ',') {
+      str++;
+    }
+    if (*str == '\0') {
+      break;
+    }
+    char*         end   = nullptr;
+    unsigned long value = strtoul(str, &end, 0);
+    while (isspace(*end)) {
+      end++;
+    }
+    if (end == str or (*end != ',' and *end != '\0') or value > max_value) {
+      filter.clear();
+      return SRSLTE_ERROR;
+    }
+    if (filter.empty()) {
+      filter.resize(max_value + 1, false);
+    }
+    filter[value] = true;
+    str           = end;
+  }
+  return SRSLTE_SUCCESS;
+}
+
+mac_pcap::mac_pcap() :
+  thread("MAC_PCAP"),
+  enable_write(false),
+  pcap_file(nullptr),
+  ue_id(0),
+  is_running(false),
+  nof_dropped(0)
+{}
 
 mac_pcap::~mac_pcap()
 {
@@ -40,13 +169,56 @@ void mac_pcap::enable(bool en)
 }
 void mac_pcap::open(const char* filename, uint32_t ue_id)
 {
+  ring.reset();
   pcap_file    = LTE_PCAP_Open(MAC_LTE_DLT, filename);
   this->ue_id  = ue_id;
   enable_write = true;
 }
+void mac_pcap::open_async(const char* filename_,
+                          uint32_t    ue_id_,
+                          int         max_file_size_kb,
+                          uint32_t    rotation_period_s,
+                          uint32_t    ring_size)
+{
+  if (is_running) {
+    fprintf(stderr, "Error: MAC PCAP thread is already running.\n");
+    return;
+  }
+  uint32_t size = min_ring_size;
+  while (size < ring_size) {
+    size <<= 1;
+  }
+  ring.reset(new mac_pcap_ring(size));
+  batch.reserve(batch_size);
+
+  timeval now = {};
+  gettimeofday(&now, nullptr);
+  filename        = filename_;
+  name_idx        = 0;
+  max_file_size   = max_file_size_kb > 0 ? (int64_t)max_file_size_kb * 1024 : 0;
+  rotation_period = rotation_period_s;
+  file_start_sec  = now.tv_sec;
+  cur_file_size   = sizeof(pcap_hdr_t);
+  pcap_file       = LTE_PCAP_Open(MAC_LTE_DLT, filename.c_str());
+  ue_id           = ue_id_;
+  nof_dropped     = 0;
+
+  is_running   = true;
+  enable_write = true;
+  start(-2);
+}
 void mac_pcap::close()
 {
   enable_write = false;
+  if (is_running) {
+    is_running = false;
+    wait_thread_finish();
+    while (drain()) {
+    }
+    if (nof_dropped > 0) {
+      fprintf(stdout, "MAC PCAP: %" PRIu64 " PDUs dropped, ring buffer full\n", nof_dropped.load());
+    }
+  }
   if (pcap_file != nullptr) {
     fprintf(stdout, "Saving MAC PCAP file\n");
     LTE_PCAP_Close(pcap_file);
@@ -59,6 +231,39 @@ void mac_pcap::set_ue_id(uint16_t ue_id)
   this->ue_id = ue_id;
 }
 
+int mac_pcap::set_filters(const std::string& rnti_list, const std::string& lcid_list)
+{
+  if (parse_filter_list(rnti_list, UINT16_MAX, rnti_filter) != SRSLTE_SUCCESS) {
+    fprintf(stderr, "Error: invalid MAC PCAP RNTI filter \"%s\"\n", rnti_list.c_str());
+    return SRSLTE_ERROR;
+  }
+  if (parse_filter_list(lcid_list, max_lcid, lcid_filter) != SRSLTE_SUCCESS) {
+    fprintf(stderr, "Error: invalid MAC PCAP LCID filter \"%s\"\n", lcid_list.c_str());
+    return SRSLTE_ERROR;
+  }
+  return SRSLTE_SUCCESS;
+}
+
+// Walks the subheaders of a DL/UL-SCH PDU (TS 36.321 Section 6.1.2) looking for one of the LCIDs in the filter
+bool mac_pcap::lcid_filter_match(const uint8_t* pdu, uint32_t pdu_len_bytes, uint8_t direction)
+{
+  uint32_t offset = 0;
+  bool     ext    = true;
+  while (ext and offset < pdu_len_bytes) {
+    uint8_t hdr  = pdu[offset++];
+    uint8_t lcid = hdr & 0x1f;
+    ext          = (hdr & 0x20) != 0;
+    if (lcid_filter[lcid]) {
+      return true;
+    }
+    // Subheaders of SDUs and of variable size CEs have a length field, unless they are the last one
+    if (ext and (lcid <= 10 or (direction == DIRECTION_UPLINK and lcid == 0x19)) and offset < pdu_len_bytes) {
+      offset += ((hdr & 0x40) or (pdu[offset] & 0x80)) ? 2 : 1;
+    }
+  }
+  return false;
+}
+
 void mac_pcap::pack_and_write(uint8_t* pdu,
                               uint32_t pdu_len_bytes,
                               uint32_t reTX,
@@ -70,6 +275,13 @@ void mac_pcap::pack_and_write(uint8_t* pdu,
                               uint8_t  rnti_type)
 {
   if (enable_write) {
+    if (pdu == nullptr) {
+      return;
+    }
+    bool dedicated = rnti_type == C_RNTI or rnti_type == SL_RNTI;
+    if (dedicated and not rnti_filter.empty() and not rnti_filter[crnti]) {
+      return;
+    }
     MAC_Context_Info_t context = {};
     context.radioType          = FDD_RADIO;
     context.direction          = direction;
@@ -81,12 +293,118 @@ void mac_pcap::pack_and_write(uint8_t* pdu,
     context.cc_idx             = cc_idx;
     context.sysFrameNumber     = (uint16_t)(tti / 10);
     context.subFrameNumber     = (uint16_t)(tti % 10);
-    if (pdu) {
+
+    if (ring == nullptr) {
+      if (rnti_type == C_RNTI and not lcid_filter.empty() and not lcid_filter_match(pdu, pdu_len_bytes, direction)) {
+        return;
+      }
       LTE_PCAP_MAC_WritePDU(pcap_file, &context, pdu, pdu_len_bytes);
+      return;
+    }
+
+    // Copy the PDU to the ring, the LCID filter is applied by the background thread
+    uint32_t len = (sizeof(mac_pcap_pdu_t) + pdu_len_bytes + 7) & ~7u;
+    uint8_t* ptr = len <= ring->max_record_len() ? ring->reserve(len) : nullptr;
+    if (ptr == nullptr) {
+      nof_dropped++;
+      return;
+    }
+    timeval now = {};
+    gettimeofday(&now, nullptr);
+    mac_pcap_pdu_t* rec = reinterpret_cast<mac_pcap_pdu_t*>(ptr);
+    rec->pdu_len        = pdu_len_bytes;
+    rec->ts_sec         = now.tv_sec;
+    rec->ts_usec        = now.tv_usec;
+    rec->context        = context;
+    memcpy(ptr + sizeof(mac_pcap_pdu_t), pdu, pdu_len_bytes);
+    ring->publish(ptr, len);
+  }
+}
+
+void mac_pcap::run_thread()
+{
+  while (is_running) {
+    if (not drain()) {
+      usleep(backend_idle_us);
     }
   }
 }
 
+// Moves the pending PDUs to the file. Returns false if there were none
+bool mac_pcap::drain()
+{
+  uint32_t       nof_pdus = 0;
+  const uint8_t* ptr      = nullptr;
+  while (nof_pdus < max_drain_batch and (ptr = ring->front()) != nullptr) {
+    const mac_pcap_pdu_t* rec = reinterpret_cast<const mac_pcap_pdu_t*>(ptr);
+    const uint8_t*        pdu = ptr + sizeof(mac_pcap_pdu_t);
+    nof_pdus++;
+
+    if (rec->context.rntiType == C_RNTI and not lcid_filter.empty() and
+        not lcid_filter_match(pdu, rec->pdu_len, rec->context.direction)) {
+      ring->pop(ptr);
+      continue;
+    }
+
+    uint8_t            context_header[MAC_LTE_CONTEXT_MAX_LEN];
+    MAC_Context_Info_t context     = rec->context;
+    int                context_len = LTE_PCAP_PACK_MAC_CONTEXT_TO_BUFFER(&context, context_header, sizeof(context_header));
+    if (context_len < 0) {
+      ring->pop(ptr);
+      continue;
+    }
+
+    pcaprec_hdr_t packet_header = {};
+    packet_header.ts_sec        = rec->ts_sec;
+    packet_header.ts_usec       = rec->ts_usec;
+    packet_header.incl_len      = context_len + rec->pdu_len;
+    packet_header.orig_len      = context_len + rec->pdu_len;
+
+    int64_t packet_len = sizeof(pcaprec_hdr_t) + packet_header.incl_len;
+    if ((max_file_size > 0 and cur_file_size > (int64_t)sizeof(pcap_hdr_t) and
+         cur_file_size + packet_len > max_file_size) or
+        (rotation_period > 0 and rec->ts_sec >= file_start_sec + rotation_period)) {
+      rotate_file(rec->ts_sec);
+    }
+
+    size_t pos = batch.size();
+    batch.resize(pos + packet_len);
+    memcpy(&batch[pos], &packet_header, sizeof(pcaprec_hdr_t));
+    memcpy(&batch[pos + sizeof(pcaprec_hdr_t)], context_header, context_len);
+    memcpy(&batch[pos + sizeof(pcaprec_hdr_t) + context_len], pdu, rec->pdu_len);
+    cur_file_size += packet_len;
+    ring->pop(ptr);
+
+    if (batch.size() >= batch_size) {
+      write_batch();
+    }
+  }
+  write_batch();
+  return nof_pdus > 0;
+}
+
+void mac_pcap::write_batch()
+{
+  if (not batch.empty()) {
+    if (pcap_file != nullptr) {
+      fwrite(batch.data(), 1, batch.size(), pcap_file);
+      fflush(pcap_file);
+    }
+    batch.clear();
+  }
+}
+
+void mac_pcap::rotate_file(uint32_t ts_sec)
+{
+  write_batch();
+  LTE_PCAP_Close(pcap_file);
+  name_idx++;
+  std::string newfilename = filename + "." + std::to_string(name_idx);
+  pcap_file               = LTE_PCAP_Open(MAC_LTE_DLT, newfilename.c_str());
+  cur_file_size           = sizeof(pcap_hdr_t);
+  file_start_sec          = ts_sec;
+}
+
 void mac_pcap::write_dl_crnti(uint8_t* pdu,
                               uint32_t pdu_len_bytes,
                               uint16_t rnti,
@@ -350,6 +350,92 @@ int tcp_send(int remotefd, const void* buf, size_t nbytes)
   return nbytes - nbytes_remaining;
 }
 
+/***************************************************************
+ *                 Batched UDP
+ **************************************************************/
+
+int udp_recv_burst(int fd, unique_byte_buffer_list_t& bufs, std::vector<sockaddr_in>& from)
+{
+  uint32_t n = std::min((uint32_t)bufs.size(), UDP_MAX_BATCH);
+  mmsghdr  msgs[UDP_MAX_BATCH];
+  iovec    iovs[UDP_MAX_BATCH];
+
+  from.resize(n);
+  for (uint32_t i = 0; i < n; i++) {
+    iovs[i].iov_base            = bufs[i]->msg;
+    iovs[i].iov_len             = bufs[i]->get_tailroom();
+    msgs[i]                     = {};
+    msgs[i].msg_hdr.msg_iov     = &iovs[i];
+    msgs[i].msg_hdr.msg_iovlen  = 1;
+    msgs[i].msg_hdr.msg_name    = &from[i];
+    msgs[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+  }
+
+  int n_recv = recvmmsg(fd, msgs, n, MSG_DONTWAIT, nullptr);
+  if (n_recv < 0) {
+    return -1;
+  }
+  for (int i = 0; i < n_recv; i++) {
+    bufs[i]->N_bytes = msgs[i].msg_len;
+  }
+  from.resize(n_recv);
+  return n_recv;
+}
+
+bool udp_tx_batch::push(int fd_, unique_byte_buffer_t pdu, const sockaddr_in& dest)
+{
+  bool ret = true;
+  if (nof_pdus > 0 && fd_ != fd) {
+    ret = flush();
+  }
+  fd              = fd_;
+  pdus[nof_pdus]  = std::move(pdu);
+  dests[nof_pdus] = dest;
+  nof_pdus++;
+  if (nof_pdus == UDP_MAX_BATCH) {
+    ret &= flush();
+  }
+  return ret;
+}
+
+bool udp_tx_batch::flush()
+{
+  mmsghdr  msgs[UDP_MAX_BATCH];
+  iovec    iovs[UDP_MAX_BATCH];
+  uint32_t sent = 0;
+  bool     ret  = true;
+
+  for (uint32_t i = 0; i < nof_pdus; i++) {
+    iovs[i].iov_base            = pdus[i]->msg;
+    iovs[i].iov_len             = pdus[i]->N_bytes;
+    msgs[i]                     = {};
+    msgs[i].msg_hdr.msg_iov     = &iovs[i];
+    msgs[i].msg_hdr.msg_iovlen  = 1;
+    msgs[i].msg_hdr.msg_name    = &dests[i];
+    msgs[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+  }
+
+  // sendmmsg stops at the first datagram that fails, skip it and carry on with the rest
+  while (sent < nof_pdus) {
+    int n = sendmmsg(fd, &msgs[sent], nof_pdus - sent, 0);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      srslte::logmap::get("COMMON")->error("Failed to send UDP datagram: %s\n", strerror(errno));
+      ret = false;
+      n   = 1;
+    }
+    sent += n;
+  }
+
+  for (uint32_t i = 0; i < nof_pdus; i++) {
+    pdus[i].reset();
+  }
+  nof_pdus = 0;
+  return ret;
+}
+
 } // namespace net_utils
 
 /***************************************************************
@@ -398,6 +484,54 @@ private:
   callback_t                func;
 };
 
+/**
+ * Description: Specialization of recv_task that reads all pending datagrams (up to UDP_MAX_BATCH) with a single
+ * recvmmsg(...) call and hands them over as one burst. Buffers are kept allocated between calls.
+ */
+class recvmmsg_pdu_task final : public rx_multisocket_handler::recv_task
+{
+public:
+  using callback_t = std::function<void(srslte::unique_byte_buffer_list_t& pdus, const std::vector<sockaddr_in>& from)>;
+  explicit recvmmsg_pdu_task(srslte::byte_buffer_pool* pool_, srslte::log_ref log_, callback_t func_) :
+    pool(pool_),
+    log_h(log_),
+    func(std::move(func_))
+  {
+    bufs.reserve(net_utils::UDP_MAX_BATCH);
+  }
+
+  bool operator()(int fd) override
+  {
+    while (bufs.size() < net_utils::UDP_MAX_BATCH) {
+      bufs.push_back(srslte::allocate_unique_buffer(*pool, "Rxsocket", true));
+    }
+
+    int n_recv = net_utils::udp_recv_burst(fd, bufs, from);
+    if (n_recv == -1 and errno != EAGAIN) {
+      log_h->error("Error reading from socket: %s\n", strerror(errno));
+      return true;
+    }
+    if (n_recv == -1 and errno == EAGAIN) {
+      log_h->debug("Socket timeout reached\n");
+      return true;
+    }
+
+    srslte::unique_byte_buffer_list_t burst;
+    burst.reserve(n_recv);
+    std::move(bufs.begin(), bufs.begin() + n_recv, std::back_inserter(burst));
+    bufs.erase(bufs.begin(), bufs.begin() + n_recv);
+    func(burst, from);
+    return true;
+  }
+
+private:
+  srslte::byte_buffer_pool*         pool = nullptr;
+  srslte::log_ref                   log_h;
+  callback_t                        func;
+  srslte::unique_byte_buffer_list_t bufs;
+  std::vector<sockaddr_in>          from;
+};
+
 class sctp_recvmsg_pdu_task final : public rx_multisocket_handler::recv_task
 {
 public:
@@ -506,6 +640,16 @@ bool rx_multisocket_handler::add_socket_pdu_handler(int fd, recvfrom_callback_t
   return add_socket_handler(fd, std::move(task));
 }
 
+/**
+ * Convenience method for reading bursts of PDUs from a UDP socket
+ */
+bool rx_multisocket_handler::add_socket_pdu_burst_handler(int fd, recvmmsg_callback_t burst_task)
+{
+  std::unique_ptr<srslte::rx_multisocket_handler::recv_task> task;
+  task.reset(new srslte::recvmmsg_pdu_task(pool, log_h, std::move(burst_task)));
+  return add_socket_handler(fd, std::move(task));
+}
+
 /**
  * Convenience method for reading PDUs from SCTP socket
  */
@@ -58,60 +58,78 @@ void LTE_PCAP_Close(FILE* fd)
   }
 }
 
-/* Write an individual PDU (PCAP packet header + mac-context + mac-pdu) */
-int LTE_PCAP_MAC_WritePDU(FILE* fd, MAC_Context_Info_t* context, const unsigned char* PDU, unsigned int length)
+/* Pack the mac-context that precedes a MAC PDU */
+int LTE_PCAP_PACK_MAC_CONTEXT_TO_BUFFER(MAC_Context_Info_t* context, uint8_t* buffer, unsigned int length)
 {
-  pcaprec_hdr_t packet_header;
-  char          context_header[256];
-  int           offset = 0;
-  uint16_t      tmp16;
+  int      offset = 0;
+  uint16_t tmp16;
 
-  /* Can't write if file wasn't successfully opened */
-  if (fd == NULL) {
-    printf("Error: Can't write to empty file handle\n");
-    return 0;
+  if (buffer == NULL || length < MAC_LTE_CONTEXT_MAX_LEN) {
+    printf("Error: Buffer is too small for the MAC context\n");
+    return -1;
   }
 
   /*****************************************************************/
   /* Context information (same as written by UDP heuristic clients */
-  context_header[offset++] = context->radioType;
-  context_header[offset++] = context->direction;
-  context_header[offset++] = context->rntiType;
+  buffer[offset++] = context->radioType;
+  buffer[offset++] = context->direction;
+  buffer[offset++] = context->rntiType;
 
   /* RNTI */
-  context_header[offset++] = MAC_LTE_RNTI_TAG;
-  tmp16                    = htons(context->rnti);
-  memcpy(context_header + offset, &tmp16, 2);
+  buffer[offset++] = MAC_LTE_RNTI_TAG;
+  tmp16            = htons(context->rnti);
+  memcpy(buffer + offset, &tmp16, 2);
   offset += 2;
 
   /* UEId */
-  context_header[offset++] = MAC_LTE_UEID_TAG;
-  tmp16                    = htons(context->ueid);
-  memcpy(context_header + offset, &tmp16, 2);
+  buffer[offset++] = MAC_LTE_UEID_TAG;
+  tmp16            = htons(context->ueid);
+  memcpy(buffer + offset, &tmp16, 2);
   offset += 2;
 
   /* Subframe Number and System Frame Number */
   /* SFN is stored in 12 MSB and SF in 4 LSB */
-  context_header[offset++] = MAC_LTE_FRAME_SUBFRAME_TAG;
-  tmp16                    = (context->sysFrameNumber << 4) | context->subFrameNumber;
-  tmp16                    = htons(tmp16);
-  memcpy(context_header + offset, &tmp16, 2);
+  buffer[offset++] = MAC_LTE_FRAME_SUBFRAME_TAG;
+  tmp16            = (context->sysFrameNumber << 4) | context->subFrameNumber;
+  tmp16            = htons(tmp16);
+  memcpy(buffer + offset, &tmp16, 2);
   offset += 2;
 
   /* CRC Status */
-  context_header[offset++] = MAC_LTE_CRC_STATUS_TAG;
-  context_header[offset++] = context->crcStatusOK;
+  buffer[offset++] = MAC_LTE_CRC_STATUS_TAG;
+  buffer[offset++] = context->crcStatusOK;
 
   /* CC index */
-  context_header[offset++] = MAC_LTE_CARRIER_ID_TAG;
-  context_header[offset++] = context->cc_idx;
+  buffer[offset++] = MAC_LTE_CARRIER_ID_TAG;
+  buffer[offset++] = context->cc_idx;
 
   /* NB-IoT mode tag */
-  context_header[offset++] = MAC_LTE_NB_MODE_TAG;
-  context_header[offset++] = context->nbiotMode;
+  buffer[offset++] = MAC_LTE_NB_MODE_TAG;
+  buffer[offset++] = context->nbiotMode;
 
   /* Data tag immediately preceding PDU */
-  context_header[offset++] = MAC_LTE_PAYLOAD_TAG;
+  buffer[offset++] = MAC_LTE_PAYLOAD_TAG;
+
+  return offset;
+}
+
+/* Write an individual PDU (PCAP packet header + mac-context + mac-pdu) */
+int LTE_PCAP_MAC_WritePDU(FILE* fd, MAC_Context_Info_t* context, const unsigned char* PDU, unsigned int length)
+{
+  pcaprec_hdr_t packet_header;
+  uint8_t       context_header[MAC_LTE_CONTEXT_MAX_LEN];
+  int           offset;
+
+  /* Can't write if file wasn't successfully opened */
+  if (fd == NULL) {
+    printf("Error: Can't write to empty file handle\n");
+    return 0;
+  }
+
+  offset = LTE_PCAP_PACK_MAC_CONTEXT_TO_BUFFER(context, context_header, sizeof(context_header));
+  if (offset < 0) {
+    return 0;
+  }
 
   /****************************************************************/
   /* PCAP Header                                                  */
@@ -32,6 +32,22 @@
 
 namespace srslte {
 
+/******************************************************************************
+ * Precomputed AES-128 key schedule
+ *****************************************************************************/
+
+void security_aes_ctx::set_key(uint8_t* key)
+{
+  reset();
+  ctx = liblte_security_aes_ctx_alloc(key);
+}
+
+void security_aes_ctx::reset()
+{
+  liblte_security_aes_ctx_free(ctx);
+  ctx = nullptr;
+}
+
 /******************************************************************************
  * Key Generation
  *****************************************************************************/
@@ -136,6 +152,17 @@ uint8_t security_128_eia2(uint8_t* key,
   return liblte_security_128_eia2(key, count, bearer, direction, msg, msg_len, mac);
 }
 
+uint8_t security_128_eia2(const security_aes_ctx& ctx,
+                          uint32_t                count,
+                          uint32_t                bearer,
+                          uint8_t                 direction,
+                          uint8_t*                msg,
+                          uint32_t                msg_len,
+                          uint8_t*                mac)
+{
+  return liblte_security_128_eia2(ctx.get(), count, bearer, direction, msg, msg_len, mac);
+}
+
 uint8_t security_128_eia3(uint8_t* key,
                           uint32_t count,
                           uint32_t bearer,
@@ -187,6 +214,17 @@ uint8_t security_128_eea2(uint8_t* key,
   return liblte_security_encryption_eea2(key, count, bearer, direction, msg, msg_len * 8, msg_out);
 }
 
+uint8_t security_128_eea2(const security_aes_ctx& ctx,
+                          uint32_t                count,
+                          uint8_t                 bearer,
+                          uint8_t                 direction,
+                          uint8_t*                msg,
+                          uint32_t                msg_len,
+                          uint8_t*                msg_out)
+{
+  return liblte_security_encryption_eea2(ctx.get(), count, bearer, direction, msg, msg_len * 8, msg_out);
+}
+
 uint8_t security_128_eea3(uint8_t* key,
                           uint32_t count,
                           uint8_t  bearer,
@@ -50,6 +50,9 @@ void thread_pool::worker::setup(uint32_t id, thread_pool* parent, uint32_t prio,
 void thread_pool::worker::run_thread()
 {
   set_name(std::string("WORKER") + std::to_string(my_id));
+  if (cpu >= 0) {
+    threads_set_self_cpu(cpu);
+  }
   while (my_parent->status[my_id] != STOP) {
     wait_to_start();
     if (my_parent->status[my_id] != STOP) {
@@ -59,6 +62,20 @@ void thread_pool::worker::run_thread()
   }
 }
 
+void thread_pool::worker::run_task()
+{
+  // start_worker() has already set START_WORK, unless the pool was stopped in the meantime
+  wait_to_start();
+  if (my_parent->status[my_id] != STOP) {
+    work_imp();
+    finished();
+  }
+
+  std::lock_guard<std::mutex> lock(my_parent->mutex_queue);
+  my_parent->nof_tasks--;
+  my_parent->cvar_queue.notify_all();
+}
+
 uint32_t thread_pool::worker::get_id()
 {
   return my_id;
@@ -83,7 +100,12 @@ void thread_pool::init_worker(uint32_t id, worker* obj, uint32_t prio, uint32_t
       nof_workers = id + 1;
     }
     workers[id] = obj;
-    obj->setup(id, this, prio, mask);
+    if (executor != nullptr) {
+      obj->my_id     = id;
+      obj->my_parent = this;
+    } else {
+      obj->setup(id, this, prio, mask);
+    }
     cvar_queue.notify_all();
   }
 }
@@ -106,6 +128,15 @@ void thread_pool::stop()
   }
   mutex_queue.unlock();
 
+  if (executor != nullptr) {
+    // The workers may not be destroyed while the executor still holds one of their tasks
+    std::unique_lock<std::mutex> lock(mutex_queue);
+    while (nof_tasks > 0) {
+      cvar_queue.wait(lock);
+    }
+    return;
+  }
+
   for (uint32_t i = 0; i < nof_workers; i++) {
     debug_thread("stop(): waiting %d\n", i);
     workers[i]->wait_thread_finish();
@@ -221,6 +252,12 @@ void thread_pool::start_worker(uint32_t id)
       status[id] = START_WORK;
       cvar_worker[id].notify_all();
       cvar_queue.notify_all();
+      if (executor != nullptr) {
+        nof_tasks++;
+        worker* w = workers[id];
+        lock.unlock();
+        executor->push_task([w](uint32_t) { w->run_task(); });
+      }
     }
   }
 }
@@ -372,4 +409,165 @@ void task_thread_pool::worker_t::run_thread()
   running = false;
 }
 
+work_stealing_pool::work_stealing_pool(uint32_t nof_threads)
+{
+  // one queue per thread
+  for (uint32_t i = 0; i < nof_threads; ++i) {
+    queues.emplace_back(new task_queue_t);
+    workers.emplace_back(new worker_t(this, i));
+  }
+}
+
+work_stealing_pool::~work_stealing_pool()
+{
+  stop();
+}
+
+void work_stealing_pool::start(int32_t prio, const std::vector<int>& cpus)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  running = true;
+  for (uint32_t i = 0; i < workers.size(); ++i) {
+    workers[i]->setup(prio, cpus.empty() ? -1 : cpus[i % cpus.size()]);
+  }
+}
+
+void work_stealing_pool::stop()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (not running) {
+      return;
+    }
+    running = false;
+  }
+  cvar.notify_all();
+  for (auto& w : workers) {
+    w->wait_thread_finish();
+  }
+}
+
+void work_stealing_pool::run(task_group& group, task_t task)
+{
+  {
+    std::lock_guard<std::mutex> lock(group.mutex);
+    group.pending++;
+  }
+  item_t item{std::move(task), &group};
+  if (queues.empty()) {
+    run_task(item);
+    return;
+  }
+
+  // Spread the tasks over the thread queues
+  task_queue_t& q = *queues[next_queue.fetch_add(1, std::memory_order_relaxed) % queues.size()];
+  {
+    std::lock_guard<std::mutex> lock(q.mutex);
+    q.items.push_back(std::move(item));
+    nof_queued++;
+  }
+  {
+    // pairs with the check of idle threads before they sleep
+    std::lock_guard<std::mutex> lock(mutex);
+  }
+  cvar.notify_one();
+}
+
+void work_stealing_pool::wait(task_group& group)
+{
+  // Run the tasks of the group that no thread has started yet
+  item_t item{};
+  while (pop_group_task(group, &item)) {
+    run_task(item);
+  }
+
+  // The remaining tasks are running in the pool threads
+  std::unique_lock<std::mutex> lock(group.mutex);
+  while (group.pending > 0) {
+    group.cvar.wait(lock);
+  }
+}
+
+bool work_stealing_pool::pop_task(uint32_t queue_idx, item_t* item)
+{
+  // Own queue first, then steal the oldest task of the other queues
+  for (uint32_t i = 0; i < queues.size(); ++i) {
+    task_queue_t&               q = *queues[(queue_idx + i) % queues.size()];
+    std::lock_guard<std::mutex> lock(q.mutex);
+    if (not q.items.empty()) {
+      *item = std::move(q.items.front());
+      q.items.pop_front();
+      nof_queued--;
+      if (i > 0) {
+        nof_stolen++;
+      }
+      return true;
+    }
+  }
+  return false;
+}
+
+bool work_stealing_pool::pop_group_task(task_group& group, item_t* item)
+{
+  for (auto& q : queues) {
+    std::lock_guard<std::mutex> lock(q->mutex);
+    for (auto it = q->items.begin(); it != q->items.end(); ++it) {
+      if (it->group == &group) {
+        *item = std::move(*it);
+        q->items.erase(it);
+        nof_queued--;
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+void work_stealing_pool::run_task(item_t& item)
+{
+  item.task();
+  item.task = task_t{};
+
+  // The group may be destroyed as soon as pending reaches zero and the lock is released
+  std::lock_guard<std::mutex> lock(item.group->mutex);
+  if (--item.group->pending == 0) {
+    item.group->cvar.notify_all();
+  }
+}
+
+work_stealing_pool::worker_t::worker_t(work_stealing_pool* parent_, uint32_t id_) :
+  thread(std::string("STEALWORKER") + std::to_string(id_)),
+  parent(parent_),
+  id(id_)
+{
+}
+
+void work_stealing_pool::worker_t::setup(int32_t prio, int cpu_)
+{
+  cpu = cpu_;
+  start(prio);
+}
+
+void work_stealing_pool::worker_t::run_thread()
+{
+  if (cpu >= 0) {
+    threads_set_self_cpu(cpu);
+  }
+
+  item_t item{};
+  while (true) {
+    if (parent->pop_task(id, &item)) {
+      parent->run_task(item);
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(parent->mutex);
+    while (parent->running and parent->nof_queued == 0) {
+      parent->cvar.wait(lock);
+    }
+    if (not parent->running) {
+      break;
+    }
+  }
+}
+
 } // namespace srslte
@@ -24,6 +24,7 @@
 #include <stdbool.h>
 #include <stdio.h>
 #include <string.h>
+#include <sys/syscall.h>
 #include <sys/types.h>
 
 #include "srslte/common/threads.h"
@@ -212,3 +213,49 @@ void threads_print_self()
 
   printf("Sched policy is %s. Priority is %d\n", p, param.sched_priority);
 }
+
+/* Pins the calling thread to one CPU core */
+bool threads_set_self_cpu(int cpu)
+{
+  cpu_set_t cpuset;
+  CPU_ZERO(&cpuset);
+  CPU_SET((size_t)cpu, &cpuset);
+  int s = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset);
+  if (s != 0) {
+    fprintf(stderr, "Error setting affinity to CPU %d: %s\n", cpu, strerror(s));
+    return false;
+  }
+  return true;
+}
+
+/* Moves the memory pages that lie entirely within [ptr, ptr+len) to the NUMA node of the CPU the calling thread runs
+ * on. The caller should be pinned to a core. Returns 0 on success, -1 if the system does not support it */
+int threads_move_to_local_node(void* ptr, size_t len)
+{
+#if defined(SYS_mbind) && defined(SYS_getcpu)
+  const unsigned long mpol_bind = 2, mpol_mf_move = 2; // MPOL_BIND and MPOL_MF_MOVE from numaif.h
+  unsigned            cpu = 0, node = 0;
+  if (syscall(SYS_getcpu, &cpu, &node, NULL) != 0) {
+    return -1;
+  }
+
+  size_t    page  = (size_t)sysconf(_SC_PAGESIZE);
+  uintptr_t start = ((uintptr_t)ptr + page - 1) & ~(page - 1);
+  uintptr_t end   = ((uintptr_t)ptr + len) & ~(page - 1);
+  if (end <= start) {
+    return 0;
+  }
+
+  unsigned long nodemask[16] = {0};
+  if (node >= 8 * sizeof(nodemask)) {
+    return -1;
+  }
+  nodemask[node / (8 * sizeof(unsigned long))] = 1UL << (node % (8 * sizeof(unsigned long)));
+  if (syscall(SYS_mbind, (void*)start, end - start, mpol_bind, nodemask, 8 * sizeof(nodemask), mpol_mf_move) != 0) {
+    return -1;
+  }
+  return 0;
+#else
+  return -1;
+#endif
+}
@@ -25,7 +25,7 @@
 
 using namespace srslte;
 
-channel::channel(const channel::args_t& channel_args, uint32_t _nof_channels)
+channel::channel(const channel::args_t& channel_args, uint32_t _nof_channels, uint32_t _seed)
 {
   int      ret         = SRSLTE_SUCCESS;
   uint32_t srate_max   = (uint32_t)srslte_symbol_sz(SRSLTE_MAX_PRB) * 15000;
@@ -39,8 +39,9 @@ channel::channel(const channel::args_t& channel_args, uint32_t _nof_channels)
     return;
   }
 
-  // Copy args
+  // Copy args, the seed decorrelates the random processes of channels created with the same arguments
   args = channel_args;
+  seed = _seed;
 
   // Allocate internal buffers
   buffer_in  = srslte_vec_cf_malloc(buffer_size);
@@ -55,7 +56,7 @@ channel::channel(const channel::args_t& channel_args, uint32_t _nof_channels)
     if (channel_args.fading_enable && !channel_args.fading_model.empty() && channel_args.fading_model != "none" &&
         ret == SRSLTE_SUCCESS) {
       fading[i] = (srslte_channel_fading_t*)calloc(sizeof(srslte_channel_fading_t), 1);
-      ret       = srslte_channel_fading_init(fading[i], srate_max, channel_args.fading_model.c_str(), 0x1234 * i);
+      ret       = srslte_channel_fading_init(fading[i], srate_max, channel_args.fading_model.c_str(), seed + 0x1234 * i);
     } else {
       fading[i] = nullptr;
     }
@@ -77,7 +78,7 @@ channel::channel(const channel::args_t& channel_args, uint32_t _nof_channels)
   // Create AWGN channnel
   if (channel_args.awgn_enable && ret == SRSLTE_SUCCESS) {
     awgn = (srslte_channel_awgn_t*)calloc(sizeof(srslte_channel_awgn_t), 1);
-    ret  = srslte_channel_awgn_init(awgn, 1234);
+    ret  = srslte_channel_awgn_init(awgn, 1234 + seed);
     srslte_channel_awgn_set_n0(awgn, args.awgn_n0_dBfs);
   }
 
@@ -245,7 +246,7 @@ void channel::set_srate(uint32_t srate)
       if (fading[i]) {
         srslte_channel_fading_free(fading[i]);
 
-        srslte_channel_fading_init(fading[i], srate, args.fading_model.c_str(), 0x1234 * i);
+        srslte_channel_fading_init(fading[i], srate, args.fading_model.c_str(), seed + 0x1234 * i);
       }
 
       if (delay[i]) {
@@ -21,6 +21,7 @@
 
 #include "srslte/phy/channel/fading.h"
 #include "srslte/phy/utils/random.h"
+#include "srslte/phy/utils/simd.h"
 #include "srslte/phy/utils/vector.h"
 #include <math.h>
 #include <stdio.h>
@@ -107,27 +108,24 @@ static inline __m128 _cosine(float* table, __m128 arg)
 }
 #endif /*LV_HAVE_SSE*/
 
-static inline cf_t
-get_doppler_dispersion(srslte_channel_fading_t* q, float t, float F_d, float* alpha, float* a, float* b)
+static inline cf_t get_doppler_dispersion(srslte_channel_fading_t* q, float t, float* w, float* a, float* b)
 {
 #ifdef LV_HAVE_SSE
   const float recN   = 1.0f / sqrtf(SRSLTE_CHANNEL_FADING_NTERMS);
   cf_t        ret    = 0;
   __m128      _reacc = _mm_setzero_ps();
   __m128      _imacc = _mm_setzero_ps();
-  __m128      _arg   = _mm_set1_ps((float)M_PI * F_d);
   __m128      _t     = _mm_set1_ps(t);
-  __m128      _arg_  = (_mm_mul_ps(_arg, _t));
 
   for (int i = 0; i < SRSLTE_CHANNEL_FADING_NTERMS; i += 4) {
-    __m128 _alpha = _mm_loadu_ps(&alpha[i]);
-    __m128 _a     = _mm_loadu_ps(&a[i]);
-    __m128 _b     = _mm_loadu_ps(&b[i]);
-    __m128 _arg1  = _mm_mul_ps(_arg_, _cosine(q->sin_table, _alpha));
-    __m128 _re    = _cosine(q->sin_table, _mm_add_ps(_arg1, _a));
-    __m128 _im    = _sine(q->sin_table, _mm_add_ps(_arg1, _b));
-    _reacc        = _mm_add_ps(_reacc, _re);
-    _imacc        = _mm_add_ps(_imacc, _im);
+    __m128 _w    = _mm_loadu_ps(&w[i]);
+    __m128 _a    = _mm_loadu_ps(&a[i]);
+    __m128 _b    = _mm_loadu_ps(&b[i]);
+    __m128 _arg1 = _mm_mul_ps(_w, _t);
+    __m128 _re   = _cosine(q->sin_table, _mm_add_ps(_arg1, _a));
+    __m128 _im   = _sine(q->sin_table, _mm_add_ps(_arg1, _b));
+    _reacc       = _mm_add_ps(_reacc, _re);
+    _imacc       = _mm_add_ps(_imacc, _im);
   }
 
   __m128 _tmp = _mm_hadd_ps(_reacc, _imacc);
@@ -144,7 +142,7 @@ get_doppler_dispersion(srslte_channel_fading_t* q, float t, float F_d, float* al
   cf_t        r    = 0;
 
   for (uint32_t i = 0; i < SRSLTE_CHANNEL_FADING_NTERMS; i++) {
-    float arg = (float)M_PI * F_d * cosf(alpha[i]) * t;
+    float arg = w[i] * t;
     __real__ r += cosf(arg + a[i]);
     __imag__ r += sinf(arg + b[i]);
   }
@@ -164,23 +162,37 @@ static inline void generate_tap(float delay_ns, float power_db, float srate, cf_
 
 static inline void generate_taps(srslte_channel_fading_t* q, float time)
 {
-  // Generate taps
-  for (int i = 0; i < nof_taps[q->model]; i++) {
-    // Compute phase for the doppler dispersion
-    cf_t a = get_doppler_dispersion(q, time, q->doppler, q->coeff_alpha[i], q->coeff_a[i], q->coeff_b[i]);
-
-    if (i) {
-      // Copy tap frequency response
-      srslte_vec_sc_prod_ccc(q->h_tap[i], a, q->temp, q->N);
-
-      // Add to frequency response, shifts FFT at same time
-      srslte_vec_sum_ccc(q->h_freq, &q->temp[q->N / 2], q->h_freq, q->N / 2);
-      srslte_vec_sum_ccc(&q->h_freq[q->N / 2], q->temp, &q->h_freq[q->N / 2], q->N / 2);
-    } else {
-      // Copy tap frequency response
-      srslte_vec_sc_prod_ccc(&q->h_tap[i][q->N / 2], a, q->h_freq, q->N / 2);
-      srslte_vec_sc_prod_ccc(&q->h_tap[i][0], a, &q->h_freq[q->N / 2], q->N / 2);
+  uint32_t ntaps = nof_taps[q->model];
+  cf_t     a[SRSLTE_CHANNEL_FADING_MAXTAPS];
+
+  // Compute phase for the doppler dispersion of every tap
+  for (uint32_t i = 0; i < ntaps; i++) {
+    a[i] = get_doppler_dispersion(q, time, q->coeff_w[i], q->coeff_a[i], q->coeff_b[i]);
+  }
+
+  // Combine all the taps in a single pass, the tap frequency responses are already FFT shifted
+  uint32_t n = 0;
+#if SRSLTE_SIMD_CF_SIZE
+  simd_cf_t _a[SRSLTE_CHANNEL_FADING_MAXTAPS];
+  for (uint32_t i = 0; i < ntaps; i++) {
+    _a[i] = srslte_simd_cf_set1(a[i]);
+  }
+
+  for (; n + SRSLTE_SIMD_CF_SIZE <= q->N; n += SRSLTE_SIMD_CF_SIZE) {
+    simd_cf_t acc = srslte_simd_cf_prod(srslte_simd_cfi_load(&q->h_tap[0][n]), _a[0]);
+    for (uint32_t i = 1; i < ntaps; i++) {
+      acc = srslte_simd_cf_add(acc, srslte_simd_cf_prod(srslte_simd_cfi_load(&q->h_tap[i][n]), _a[i]));
     }
+    srslte_simd_cfi_store(&q->h_freq[n], acc);
+  }
+#endif /* SRSLTE_SIMD_CF_SIZE */
+
+  for (; n < q->N; n++) {
+    cf_t acc = q->h_tap[0][n] * a[0];
+    for (uint32_t i = 1; i < ntaps; i++) {
+      acc += q->h_tap[i][n] * a[i];
+    }
+    q->h_freq[n] = acc;
   }
   // at this stage, q->h_freq should contain the frequency response
 }
@@ -242,14 +254,27 @@ int srslte_channel_fading_init(srslte_channel_fading_t* q, double srate, const c
         q->coeff_a[i][j]     = srslte_random_uniform_real_dist(random, 0, 2.0f * (float)M_PI);
         q->coeff_b[i][j]     = srslte_random_uniform_real_dist(random, 0, 2.0f * (float)M_PI);
         q->coeff_alpha[i][j] = ((float)M_PI * ((float)i - (float)0.5f)) / (2.0f * nof_taps[q->model]);
+        q->coeff_w[i][j]     = (float)M_PI * q->doppler * cosf(q->coeff_alpha[i][j]);
       }
 
       // Allocate tap frequency response
       q->h_tap[i] = srslte_vec_cf_malloc(q->N);
+      cf_t* tap   = srslte_vec_cf_malloc(q->N);
+      if (!q->h_tap[i] || !tap) {
+        fprintf(stderr, "Error: allocating h_tap\n");
+        if (tap) {
+          free(tap);
+        }
+        srslte_random_free(random);
+        goto clean_exit;
+      }
 
-      // Generate tap frequency response
+      // Generate tap frequency response and store it FFT shifted
       generate_tap(
-          excess_tap_delay_ns[q->model][i], relative_power_db[q->model][i], q->srate, q->h_tap[i], q->N, q->path_delay);
+          excess_tap_delay_ns[q->model][i], relative_power_db[q->model][i], q->srate, tap, q->N, q->path_delay);
+      memcpy(q->h_tap[i], &tap[q->N / 2], sizeof(cf_t) * q->N / 2);
+      memcpy(&q->h_tap[i][q->N / 2], tap, sizeof(cf_t) * q->N / 2);
+      free(tap);
     }
 
     // Generate sine Table
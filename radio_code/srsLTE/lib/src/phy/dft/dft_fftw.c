@@ -34,9 +34,15 @@
 #define dft_floor(a, b) (a / b)
 
 #define FFTW_WISDOM_FILE "%s/.srslte_fftwisdom"
+#define FFTW_WISDOM_ENV "SRSLTE_FFTW_WISDOM"
 
 static int get_fftw_wisdom_file(char* full_path, uint32_t n)
 {
+  const char* env_path = getenv(FFTW_WISDOM_ENV);
+  if (env_path != NULL && strlen(env_path) > 0) {
+    return snprintf(full_path, n, "%s", env_path);
+  }
+
   const char* homedir = NULL;
   if ((homedir = getenv("HOME")) == NULL) {
     homedir = getpwuid(getuid())->pw_dir;
@@ -53,6 +59,117 @@ static int get_fftw_wisdom_file(char* full_path, uint32_t n)
 
 static pthread_mutex_t fft_mutex = PTHREAD_MUTEX_INITIALIZER;
 
+/* Process-wide plan cache. FFTW plans are immutable once created and can be executed concurrently through the new-array
+ * execute interface, so every srslte_dft_plan_t with the same geometry shares one fftwf_plan. Plans stay in the cache
+ * until the process exits, which makes replanning to a previously used size a lookup rather than an FFTW planning call.
+ * All accesses are protected by fft_mutex.
+ */
+typedef struct dft_cache_entry_s {
+  int                       size;
+  int                       sign;
+  srslte_dft_mode_t         mode;
+  int                       align_in;
+  int                       align_out;
+  bool                      in_place;
+  bool                      is_guru;
+  int                       istride;
+  int                       ostride;
+  int                       how_many;
+  int                       idist;
+  int                       odist;
+  fftwf_plan                p;
+  struct dft_cache_entry_s* next;
+} dft_cache_entry_t;
+
+static dft_cache_entry_t* dft_cache = NULL;
+
+static bool dft_cache_match(const dft_cache_entry_t* a, const dft_cache_entry_t* b)
+{
+  return a->size == b->size && a->sign == b->sign && a->mode == b->mode && a->align_in == b->align_in &&
+         a->align_out == b->align_out && a->in_place == b->in_place && a->is_guru == b->is_guru &&
+         a->istride == b->istride && a->ostride == b->ostride && a->how_many == b->how_many && a->idist == b->idist &&
+         a->odist == b->odist;
+}
+
+// Returns a cached plan for the given key, creating it if necessary. Must be called with fft_mutex locked.
+static fftwf_plan dft_cache_get(dft_cache_entry_t* key, void* in, void* out)
+{
+  for (dft_cache_entry_t* e = dft_cache; e != NULL; e = e->next) {
+    if (dft_cache_match(e, key)) {
+      return e->p;
+    }
+  }
+
+  if (key->is_guru) {
+    const fftwf_iodim iodim        = {key->size, key->istride, key->ostride};
+    const fftwf_iodim howmany_dims = {key->how_many, key->idist, key->odist};
+    key->p = fftwf_plan_guru_dft(1, &iodim, 1, &howmany_dims, in, out, key->sign, FFTW_TYPE);
+  } else if (key->mode == SRSLTE_DFT_COMPLEX) {
+    key->p = fftwf_plan_dft_1d(key->size, in, out, key->sign, FFTW_TYPE);
+  } else {
+    key->p = fftwf_plan_r2r_1d(key->size, in, out, (fftwf_r2r_kind)key->sign, FFTW_TYPE);
+  }
+  if (!key->p) {
+    return NULL;
+  }
+
+  dft_cache_entry_t* e = malloc(sizeof(dft_cache_entry_t));
+  if (!e) {
+    fftwf_destroy_plan(key->p);
+    return NULL;
+  }
+  *e        = *key;
+  e->next   = dft_cache;
+  dft_cache = e;
+  return e->p;
+}
+
+static fftwf_plan dft_cache_get_1d(int size, int sign, srslte_dft_mode_t mode, void* in, void* out)
+{
+  dft_cache_entry_t key = {};
+  key.size              = size;
+  key.sign              = sign;
+  key.mode              = mode;
+  key.align_in          = fftwf_alignment_of(in);
+  key.align_out         = fftwf_alignment_of(out);
+  key.in_place          = (in == out);
+
+  pthread_mutex_lock(&fft_mutex);
+  fftwf_plan p = dft_cache_get(&key, in, out);
+  pthread_mutex_unlock(&fft_mutex);
+  return p;
+}
+
+static fftwf_plan dft_cache_get_guru(int   size,
+                                     int   sign,
+                                     cf_t* in,
+                                     cf_t* out,
+                                     int   istride,
+                                     int   ostride,
+                                     int   how_many,
+                                     int   idist,
+                                     int   odist)
+{
+  dft_cache_entry_t key = {};
+  key.size              = size;
+  key.sign              = sign;
+  key.mode              = SRSLTE_DFT_COMPLEX;
+  key.align_in          = fftwf_alignment_of((float*)in);
+  key.align_out         = fftwf_alignment_of((float*)out);
+  key.in_place          = (in == out);
+  key.is_guru           = true;
+  key.istride           = istride;
+  key.ostride           = ostride;
+  key.how_many          = how_many;
+  key.idist             = idist;
+  key.odist             = odist;
+
+  pthread_mutex_lock(&fft_mutex);
+  fftwf_plan p = dft_cache_get(&key, in, out);
+  pthread_mutex_unlock(&fft_mutex);
+  return p;
+}
+
 // This function is called in the beggining of any executable where it is linked
 __attribute__((constructor)) static void srslte_dft_load()
 {
@@ -73,6 +190,14 @@ __attribute__((destructor)) static void srslte_dft_exit()
   get_fftw_wisdom_file(full_path, sizeof(full_path));
   fftwf_export_wisdom_to_filename(full_path);
 #endif
+  pthread_mutex_lock(&fft_mutex);
+  while (dft_cache) {
+    dft_cache_entry_t* e = dft_cache;
+    dft_cache            = e->next;
+    fftwf_destroy_plan(e->p);
+    free(e);
+  }
+  pthread_mutex_unlock(&fft_mutex);
   fftwf_cleanup();
 }
 
@@ -122,21 +247,13 @@ int srslte_dft_replan_guru_c(srslte_dft_plan_t* plan,
 {
   int sign = (plan->forward) ? FFTW_FORWARD : FFTW_BACKWARD;
 
-  const fftwf_iodim iodim        = {new_dft_points, istride, ostride};
-  const fftwf_iodim howmany_dims = {how_many, idist, odist};
-
-  pthread_mutex_lock(&fft_mutex);
-
-  /* Destroy current plan */
-  fftwf_destroy_plan(plan->p);
-
-  plan->p = fftwf_plan_guru_dft(1, &iodim, 1, &howmany_dims, in_buffer, out_buffer, sign, FFTW_TYPE);
-
-  pthread_mutex_unlock(&fft_mutex);
-
+  plan->p =
+      dft_cache_get_guru(new_dft_points, sign, in_buffer, out_buffer, istride, ostride, how_many, idist, odist);
   if (!plan->p) {
     return -1;
   }
+  plan->in        = in_buffer;
+  plan->out       = out_buffer;
   plan->size      = new_dft_points;
   plan->init_size = plan->size;
 
@@ -147,14 +264,7 @@ int srslte_dft_replan_c(srslte_dft_plan_t* plan, const int new_dft_points)
 {
   int sign = (plan->dir == SRSLTE_DFT_FORWARD) ? FFTW_FORWARD : FFTW_BACKWARD;
 
-  pthread_mutex_lock(&fft_mutex);
-  if (plan->p) {
-    fftwf_destroy_plan(plan->p);
-    plan->p = NULL;
-  }
-  plan->p = fftwf_plan_dft_1d(new_dft_points, plan->in, plan->out, sign, FFTW_TYPE);
-  pthread_mutex_unlock(&fft_mutex);
-
+  plan->p = dft_cache_get_1d(new_dft_points, sign, SRSLTE_DFT_COMPLEX, plan->in, plan->out);
   if (!plan->p) {
     return -1;
   }
@@ -175,17 +285,13 @@ int srslte_dft_plan_guru_c(srslte_dft_plan_t* plan,
 {
   int sign = (dir == SRSLTE_DFT_FORWARD) ? FFTW_FORWARD : FFTW_BACKWARD;
 
-  const fftwf_iodim iodim        = {dft_points, istride, ostride};
-  const fftwf_iodim howmany_dims = {how_many, idist, odist};
-
-  pthread_mutex_lock(&fft_mutex);
-
-  plan->p = fftwf_plan_guru_dft(1, &iodim, 1, &howmany_dims, in_buffer, out_buffer, sign, FFTW_TYPE);
+  plan->p = dft_cache_get_guru(dft_points, sign, in_buffer, out_buffer, istride, ostride, how_many, idist, odist);
   if (!plan->p) {
     return -1;
   }
-  pthread_mutex_unlock(&fft_mutex);
 
+  plan->in        = in_buffer;
+  plan->out       = out_buffer;
   plan->size      = dft_points;
   plan->init_size = plan->size;
   plan->mode      = SRSLTE_DFT_COMPLEX;
@@ -204,13 +310,8 @@ int srslte_dft_plan_c(srslte_dft_plan_t* plan, const int dft_points, srslte_dft_
 {
   allocate(plan, sizeof(fftwf_complex), sizeof(fftwf_complex), dft_points);
 
-  pthread_mutex_lock(&fft_mutex);
-
   int sign = (dir == SRSLTE_DFT_FORWARD) ? FFTW_FORWARD : FFTW_BACKWARD;
-  plan->p  = fftwf_plan_dft_1d(dft_points, plan->in, plan->out, sign, FFTW_TYPE);
-
-  pthread_mutex_unlock(&fft_mutex);
-
+  plan->p  = dft_cache_get_1d(dft_points, sign, SRSLTE_DFT_COMPLEX, plan->in, plan->out);
   if (!plan->p) {
     return -1;
   }
@@ -232,14 +333,7 @@ int srslte_dft_replan_r(srslte_dft_plan_t* plan, const int new_dft_points)
 {
   int sign = (plan->dir == SRSLTE_DFT_FORWARD) ? FFTW_R2HC : FFTW_HC2R;
 
-  pthread_mutex_lock(&fft_mutex);
-  if (plan->p) {
-    fftwf_destroy_plan(plan->p);
-    plan->p = NULL;
-  }
-  plan->p = fftwf_plan_r2r_1d(new_dft_points, plan->in, plan->out, sign, FFTW_TYPE);
-  pthread_mutex_unlock(&fft_mutex);
-
+  plan->p = dft_cache_get_1d(new_dft_points, sign, SRSLTE_REAL, plan->in, plan->out);
   if (!plan->p) {
     return -1;
   }
@@ -252,10 +346,7 @@ int srslte_dft_plan_r(srslte_dft_plan_t* plan, const int dft_points, srslte_dft_
   allocate(plan, sizeof(float), sizeof(float), dft_points);
   int sign = (dir == SRSLTE_DFT_FORWARD) ? FFTW_R2HC : FFTW_HC2R;
 
-  pthread_mutex_lock(&fft_mutex);
-  plan->p = fftwf_plan_r2r_1d(dft_points, plan->in, plan->out, sign, FFTW_TYPE);
-  pthread_mutex_unlock(&fft_mutex);
-
+  plan->p = dft_cache_get_1d(dft_points, sign, SRSLTE_REAL, plan->in, plan->out);
   if (!plan->p) {
     return -1;
   }
@@ -272,6 +363,85 @@ int srslte_dft_plan_r(srslte_dft_plan_t* plan, const int dft_points, srslte_dft_
   return 0;
 }
 
+static int dft_cache_prepare_size(int size, void* in, void* out)
+{
+  if (!dft_cache_get_1d(size, FFTW_FORWARD, SRSLTE_DFT_COMPLEX, in, out) ||
+      !dft_cache_get_1d(size, FFTW_BACKWARD, SRSLTE_DFT_COMPLEX, in, out)) {
+    ERROR("DFT: Error preparing plans for size %d\n", size);
+    return SRSLTE_ERROR;
+  }
+  return SRSLTE_SUCCESS;
+}
+
+int srslte_dft_plan_cache_prepare(uint32_t max_prb)
+{
+  const uint32_t prb_list[] = {6, 15, 25, 50, 75, 100};
+  int            ret        = SRSLTE_ERROR;
+
+  if (max_prb > SRSLTE_MAX_PRB) {
+    return SRSLTE_ERROR_INVALID_INPUTS;
+  }
+
+  // The largest transform is the PRACH IFFT: 12 times the largest OFDM symbol size
+  int   max_size = 12 * srslte_symbol_sz(max_prb);
+  void* in       = fftwf_malloc(sizeof(fftwf_complex) * max_size);
+  void* out      = fftwf_malloc(sizeof(fftwf_complex) * max_size);
+  if (!in || !out) {
+    goto clean_exit;
+  }
+
+  // OFDM symbol sizes and PRACH (formats 0-3 and 4) transform sizes
+  for (uint32_t i = 0; i < sizeof(prb_list) / sizeof(uint32_t) && prb_list[i] <= max_prb; i++) {
+    int symbol_sz = srslte_symbol_sz(prb_list[i]);
+    if (symbol_sz <= 0 || dft_cache_prepare_size(symbol_sz, in, out) ||
+        dft_cache_prepare_size(12 * symbol_sz, in, out) || dft_cache_prepare_size(2 * symbol_sz, in, out)) {
+      goto clean_exit;
+    }
+  }
+
+  // Zadoff-Chu sequences for PRACH formats 0-3
+  if (dft_cache_prepare_size(839, in, out)) {
+    goto clean_exit;
+  }
+
+  // PUSCH transform precoding
+  for (uint32_t i = 1; i <= max_prb; i++) {
+    if (srslte_dft_precoding_valid_prb(i) && dft_cache_prepare_size(i * SRSLTE_NRE, in, out)) {
+      goto clean_exit;
+    }
+  }
+
+  ret = SRSLTE_SUCCESS;
+
+clean_exit:
+  if (in) {
+    fftwf_free(in);
+  }
+  if (out) {
+    fftwf_free(out);
+  }
+  return ret;
+}
+
+int srslte_dft_wisdom_export(const char* filename)
+{
+  char full_path[256];
+  if (filename == NULL) {
+    get_fftw_wisdom_file(full_path, sizeof(full_path));
+    filename = full_path;
+  }
+
+  pthread_mutex_lock(&fft_mutex);
+  int ret = fftwf_export_wisdom_to_filename(filename);
+  pthread_mutex_unlock(&fft_mutex);
+
+  if (!ret) {
+    ERROR("DFT: Error exporting FFTW wisdom to %s\n", filename);
+    return SRSLTE_ERROR;
+  }
+  return SRSLTE_SUCCESS;
+}
+
 void srslte_dft_plan_set_mirror(srslte_dft_plan_t* plan, bool val)
 {
   plan->mirror = val;
@@ -335,7 +505,7 @@ void srslte_dft_run_c(srslte_dft_plan_t* plan, const cf_t* in, cf_t* out)
   fftwf_complex* f_out = plan->out;
 
   copy_pre((uint8_t*)plan->in, (uint8_t*)in, sizeof(cf_t), plan->size, plan->forward, plan->mirror, plan->dc);
-  fftwf_execute(plan->p);
+  fftwf_execute_dft(plan->p, plan->in, plan->out);
   if (plan->norm) {
     norm = 1.0 / sqrtf(plan->size);
     srslte_vec_sc_prod_cfc(f_out, norm, f_out, plan->size);
@@ -351,7 +521,7 @@ void srslte_dft_run_c(srslte_dft_plan_t* plan, const cf_t* in, cf_t* out)
 void srslte_dft_run_guru_c(srslte_dft_plan_t* plan)
 {
   if (plan->is_guru == true) {
-    fftwf_execute(plan->p);
+    fftwf_execute_dft(plan->p, plan->in, plan->out);
   } else {
     ERROR("srslte_dft_run_guru_c: the selected plan is not guru!\n");
   }
@@ -365,7 +535,7 @@ void srslte_dft_run_r(srslte_dft_plan_t* plan, const float* in, float* out)
   float* f_out = plan->out;
 
   memcpy(plan->in, in, sizeof(float) * plan->size);
-  fftwf_execute(plan->p);
+  fftwf_execute_r2r(plan->p, plan->in, plan->out);
   if (plan->norm) {
     norm = 1.0 / plan->size;
     srslte_vec_sc_prod_fff(f_out, norm, f_out, plan->size);
@@ -385,15 +555,12 @@ void srslte_dft_plan_free(srslte_dft_plan_t* plan)
   if (!plan->size)
     return;
 
-  pthread_mutex_lock(&fft_mutex);
+  // The FFTW plan itself is owned by the plan cache
   if (!plan->is_guru) {
     if (plan->in)
       fftwf_free(plan->in);
     if (plan->out)
       fftwf_free(plan->out);
   }
-  if (plan->p)
-    fftwf_destroy_plan(plan->p);
-  pthread_mutex_unlock(&fft_mutex);
   bzero(plan, sizeof(srslte_dft_plan_t));
 }
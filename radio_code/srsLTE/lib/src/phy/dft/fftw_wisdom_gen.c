@@ -0,0 +1,84 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/*
+ * Pre-generates the FFTW wisdom for every transform size used by LTE so that the eNb and UE do not measure plans at
+ * startup or when the cell bandwidth changes.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "srslte/srslte.h"
+
+static uint32_t max_prb  = SRSLTE_MAX_PRB;
+static char*    filename = NULL;
+
+static void usage(char* prog)
+{
+  printf("Usage: %s [po]\n", prog);
+  printf("\t-p Maximum number of PRB [Default %d]\n", max_prb);
+  printf("\t-o Output wisdom file [Default $SRSLTE_FFTW_WISDOM or ~/.srslte_fftwisdom]\n");
+}
+
+static void parse_args(int argc, char** argv)
+{
+  int opt;
+  while ((opt = getopt(argc, argv, "po")) != -1) {
+    switch (opt) {
+      case 'p':
+        max_prb = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 'o':
+        filename = argv[optind];
+        break;
+      default:
+        usage(argv[0]);
+        exit(-1);
+    }
+  }
+}
+
+int main(int argc, char** argv)
+{
+  struct timeval t[3];
+
+  parse_args(argc, argv);
+
+  gettimeofday(&t[1], NULL);
+  if (srslte_dft_plan_cache_prepare(max_prb)) {
+    ERROR("Error preparing DFT plans for %d PRB\n", max_prb);
+    exit(-1);
+  }
+  gettimeofday(&t[2], NULL);
+  get_time_interval(t);
+  printf("Prepared DFT plans up to %d PRB in %.1f ms\n", max_prb, t[0].tv_sec * 1e3 + t[0].tv_usec * 1e-3);
+
+  if (srslte_dft_wisdom_export(filename)) {
+    exit(-1);
+  }
+
+  printf("Done\n");
+  exit(0);
+}
@@ -371,11 +371,39 @@ int srslte_pdcch_dci_decode(srslte_pdcch_t* q, float* e, uint8_t* data, uint32_t
   }
 }
 
+static srslte_pdcch_decoded_t*
+pdcch_find_decoded(srslte_pdcch_t* q, const srslte_dci_location_t* location, uint32_t nof_bits)
+{
+  for (uint32_t i = 0; i < q->nof_decoded; i++) {
+    srslte_pdcch_decoded_t* c = &q->decoded[i];
+    if (c->location.ncce == location->ncce && c->location.L == location->L && c->nof_bits == nof_bits) {
+      return c;
+    }
+  }
+  return NULL;
+}
+
+static void pdcch_save_decoded(srslte_pdcch_t* q, srslte_dci_msg_t* msg, uint32_t nof_bits, bool skipped)
+{
+  if (q->nof_decoded < SRSLTE_PDCCH_MAX_DECODED) {
+    srslte_pdcch_decoded_t* c = &q->decoded[q->nof_decoded++];
+    c->location               = msg->location;
+    c->nof_bits               = nof_bits;
+    c->skipped                = skipped;
+    if (!skipped) {
+      c->crc_rem = msg->rnti;
+      memcpy(c->payload, msg->payload, nof_bits);
+    }
+  }
+}
+
 /** Tries to decode a DCI message from the LLRs stored in the srslte_pdcch_t structure by the function
  * srslte_pdcch_extract_llr(). This function can be called multiple times.
  * The location to search for is obtained from msg.
  * The decoded message is stored in msg and the CRC remainder in msg->rnti
  *
+ * A location is only decoded once per message size, later calls for the same candidate (e.g. a different format with
+ * the same size, or the UL search after the DL search) reuse the result until srslte_pdcch_extract_llr() is called.
  */
 int srslte_pdcch_decode_msg(srslte_pdcch_t* q, srslte_dl_sf_cfg_t* sf, srslte_dci_cfg_t* dci_cfg, srslte_dci_msg_t* msg)
 {
@@ -388,33 +416,56 @@ int srslte_pdcch_decode_msg(srslte_pdcch_t* q, srslte_dl_sf_cfg_t* sf, srslte_dc
 
       uint32_t nof_bits = srslte_dci_format_sizeof(&q->cell, sf, dci_cfg, msg->format);
       uint32_t e_bits   = PDCCH_FORMAT_NOF_BITS(msg->location.L);
-
-      double mean = 0;
-      for (int i = 0; i < e_bits; i++) {
-        mean += fabsf(q->llr[msg->location.ncce * 72 + i]);
-      }
-      mean /= e_bits;
-      if (mean > 0.3) {
-        ret = srslte_pdcch_dci_decode(q, &q->llr[msg->location.ncce * 72], msg->payload, e_bits, nof_bits, &msg->rnti);
-        if (ret == SRSLTE_SUCCESS) {
-          msg->nof_bits = nof_bits;
-          // Check format differentiation
-          if (msg->format == SRSLTE_DCI_FORMAT0 || msg->format == SRSLTE_DCI_FORMAT1A) {
-            msg->format = (msg->payload[dci_cfg->cif_enabled ? 3 : 0] == 0) ? SRSLTE_DCI_FORMAT0 : SRSLTE_DCI_FORMAT1A;
-          }
-        } else {
-          ERROR("Error calling pdcch_dci_decode\n");
+      bool     decoded  = false;
+
+      srslte_pdcch_decoded_t* c = pdcch_find_decoded(q, &msg->location, nof_bits);
+      if (c != NULL) {
+        if (!c->skipped) {
+          memcpy(msg->payload, c->payload, nof_bits);
+          msg->rnti = c->crc_rem;
+          decoded   = true;
         }
-        DEBUG("Decoded DCI: nCCE=%d, L=%d, format=%s, msg_len=%d, mean=%f, crc_rem=0x%x\n",
+        DEBUG("Reusing DCI: nCCE=%d, L=%d, msg_len=%d, crc_rem=0x%x\n",
               msg->location.ncce,
               msg->location.L,
-              srslte_dci_format_string(msg->format),
               nof_bits,
-              mean,
-              msg->rnti);
+              c->skipped ? 0 : c->crc_rem);
       } else {
-        DEBUG(
-            "Skipping DCI:  nCCE=%d, L=%d, msg_len=%d, mean=%f\n", msg->location.ncce, msg->location.L, nof_bits, mean);
+        double mean = 0;
+        for (int i = 0; i < e_bits; i++) {
+          mean += fabsf(q->llr[msg->location.ncce * 72 + i]);
+        }
+        mean /= e_bits;
+        if (mean > 0.3) {
+          ret = srslte_pdcch_dci_decode(q, &q->llr[msg->location.ncce * 72], msg->payload, e_bits, nof_bits, &msg->rnti);
+          if (ret == SRSLTE_SUCCESS) {
+            decoded = true;
+            pdcch_save_decoded(q, msg, nof_bits, false);
+          } else {
+            ERROR("Error calling pdcch_dci_decode\n");
+          }
+          DEBUG("Decoded DCI: nCCE=%d, L=%d, msg_len=%d, mean=%f, crc_rem=0x%x\n",
+                msg->location.ncce,
+                msg->location.L,
+                nof_bits,
+                mean,
+                msg->rnti);
+        } else {
+          pdcch_save_decoded(q, msg, nof_bits, true);
+          DEBUG("Skipping DCI:  nCCE=%d, L=%d, msg_len=%d, mean=%f\n",
+                msg->location.ncce,
+                msg->location.L,
+                nof_bits,
+                mean);
+        }
+      }
+
+      if (decoded) {
+        msg->nof_bits = nof_bits;
+        // Check format differentiation
+        if (msg->format == SRSLTE_DCI_FORMAT0 || msg->format == SRSLTE_DCI_FORMAT1A) {
+          msg->format = (msg->payload[dci_cfg->cif_enabled ? 3 : 0] == 0) ? SRSLTE_DCI_FORMAT0 : SRSLTE_DCI_FORMAT1A;
+        }
       }
     }
   } else {
@@ -444,6 +495,7 @@ int srslte_pdcch_extract_llr(srslte_pdcch_t*        q,
     nof_symbols     = e_bits / 2;
     ret             = SRSLTE_ERROR;
     srslte_vec_f_zero(q->llr, q->max_bits);
+    q->nof_decoded = 0;
 
     DEBUG("Extracting LLRs: E: %d, SF: %d, CFI: %d\n", e_bits, sf->tti % 10, sf->cfi);
 
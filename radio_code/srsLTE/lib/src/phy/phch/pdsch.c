@@ -66,7 +66,10 @@ typedef struct {
   srslte_sch_t        dl_sch;
 
   /* Encoder/Decoder data pointers: they must be set before posting start semaphore  */
-  srslte_pdsch_res_t* data;
+  srslte_pdsch_res_t*     data;
+  uint8_t*                tx_data;
+  srslte_softbuffer_tx_t* softbuffer_tx;
+  bool                    is_encoder;
 
   /* Execution status */
   int ret_status;
@@ -80,7 +83,16 @@ typedef struct {
   bool quit;
 } srslte_pdsch_coworker_t;
 
-static void* srslte_pdsch_decode_thread(void* arg);
+static void* srslte_pdsch_coworker_thread(void* arg);
+
+static int srslte_pdsch_codeword_encode(srslte_pdsch_t*         q,
+                                        srslte_dl_sf_cfg_t*     sf,
+                                        srslte_pdsch_cfg_t*     cfg,
+                                        srslte_sch_t*           dl_sch,
+                                        srslte_softbuffer_tx_t* softbuffer,
+                                        uint8_t*                data,
+                                        uint32_t                tb_idx,
+                                        uint32_t                nof_layers);
 
 static inline bool pdsch_cp_skip_symbol(const srslte_cell_t*        cell,
                                         const srslte_pdsch_grant_t* grant,
@@ -413,7 +425,7 @@ int srslte_pdsch_enable_coworker(srslte_pdsch_t* q)
       ret = SRSLTE_ERROR;
       goto clean;
     }
-    pthread_create(&h->pthread, NULL, srslte_pdsch_decode_thread, (void*)h);
+    pthread_create(&h->pthread, NULL, srslte_pdsch_coworker_thread, (void*)h);
   }
 
 clean:
@@ -604,15 +616,19 @@ static float apply_power_allocation(srslte_pdsch_t* q, srslte_pdsch_cfg_t* cfg,
   return rho_a;
 }
 
-static srslte_sequence_t*
-get_user_sequence(srslte_pdsch_t* q, uint16_t rnti, uint32_t codeword_idx, uint32_t sf_idx, uint32_t len)
+static inline bool user_sequence_is_generated(const srslte_pdsch_t* q, uint16_t rnti)
 {
   uint32_t rnti_idx = q->is_ue ? 0 : rnti;
+  return q->users[rnti_idx] && q->users[rnti_idx]->sequence_generated && q->users[rnti_idx]->cell_id == q->cell.id &&
+         (!q->is_ue || q->ue_rnti == rnti);
+}
 
+static srslte_sequence_t*
+get_user_sequence(srslte_pdsch_t* q, uint16_t rnti, uint32_t codeword_idx, uint32_t sf_idx, uint32_t len)
+{
   // The scrambling sequence is pregenerated for all RNTIs in the eNodeB but only for C-RNTI in the UE
-  if (q->users[rnti_idx] && q->users[rnti_idx]->sequence_generated && q->users[rnti_idx]->cell_id == q->cell.id &&
-      (!q->is_ue || q->ue_rnti == rnti)) {
-    return &q->users[rnti_idx]->seq[codeword_idx][sf_idx];
+  if (user_sequence_is_generated(q, rnti)) {
+    return &q->users[q->is_ue ? 0 : rnti]->seq[codeword_idx][sf_idx];
   } else {
     srslte_sequence_pdsch(&q->tmp_seq, rnti, codeword_idx, 2 * sf_idx, q->cell.id, len);
     return &q->tmp_seq;
@@ -874,7 +890,7 @@ static int srslte_pdsch_codeword_decode(srslte_pdsch_t*     q,
   return ret;
 }
 
-static void* srslte_pdsch_decode_thread(void* arg)
+static void* srslte_pdsch_coworker_thread(void* arg)
 {
   srslte_pdsch_coworker_t* q = (srslte_pdsch_coworker_t*)arg;
 
@@ -882,7 +898,13 @@ static void* srslte_pdsch_decode_thread(void* arg)
 
   sem_wait(&q->start);
   while (!q->quit) {
-    q->ret_status = srslte_pdsch_codeword_decode(q->pdsch_ptr, q->sf, q->cfg, &q->dl_sch, q->data, q->tb_idx, q->ack);
+    if (q->is_encoder) {
+      q->ret_status = srslte_pdsch_codeword_encode(
+          q->pdsch_ptr, q->sf, q->cfg, &q->dl_sch, q->softbuffer_tx, q->tx_data, q->tb_idx, q->cfg->grant.nof_layers);
+    } else {
+      q->ret_status =
+          srslte_pdsch_codeword_decode(q->pdsch_ptr, q->sf, q->cfg, &q->dl_sch, q->data, q->tb_idx, q->ack);
+    }
 
     /* Post finish semaphore */
     sem_post(&q->finish);
@@ -1017,6 +1039,7 @@ int srslte_pdsch_decode(srslte_pdsch_t*        q,
             h->data                  = &data[tb_idx];
             h->tb_idx                = tb_idx;
             h->ack                   = &data[tb_idx].crc;
+            h->is_encoder            = false;
             h->dl_sch.max_iterations = q->dl_sch.max_iterations;
             h->started               = true;
             sem_post(&h->start);
@@ -1068,6 +1091,7 @@ int srslte_pdsch_decode(srslte_pdsch_t*        q,
 static int srslte_pdsch_codeword_encode(srslte_pdsch_t*         q,
                                         srslte_dl_sf_cfg_t*     sf,
                                         srslte_pdsch_cfg_t*     cfg,
+                                        srslte_sch_t*           dl_sch,
                                         srslte_softbuffer_tx_t* softbuffer,
                                         uint8_t*                data,
                                         uint32_t                tb_idx,
@@ -1097,7 +1121,7 @@ static int srslte_pdsch_codeword_encode(srslte_pdsch_t*         q,
     }
 
     /* Channel coding */
-    if (srslte_dlsch_encode2(&q->dl_sch, cfg, data, q->e[codeword_idx], tb_idx, nof_layers)) {
+    if (srslte_dlsch_encode2(dl_sch, cfg, data, q->e[codeword_idx], tb_idx, nof_layers)) {
       ERROR("Error encoding (TB%d -> CW%d)", tb_idx, codeword_idx);
       return SRSLTE_ERROR;
     }
@@ -1168,11 +1192,37 @@ int srslte_pdsch_encode(srslte_pdsch_t*     q,
     float rho_a = apply_power_allocation(q, cfg, sf_symbols);
 
     /* Implementation of 3GPP 36.212 Table 5.3.3.1.5-1 and Table 5.3.3.1.5-2 */
+    srslte_pdsch_coworker_t* h = (srslte_pdsch_coworker_t*)q->coworker_ptr;
     for (uint32_t tb_idx = 0; tb_idx < SRSLTE_MAX_TB; tb_idx++) {
       if (cfg->grant.tb[tb_idx].enabled) {
-        ret |= srslte_pdsch_codeword_encode(
-            q, sf, cfg, cfg->softbuffers.tx[tb_idx], data[tb_idx], tb_idx, cfg->grant.nof_layers);
+        /* Offload the first codeword only if both codewords use pregenerated scrambling sequences, otherwise the two
+         * encoders would share the temporal sequence buffer */
+        if (nof_tb > 1 && tb_idx == 0 && h && user_sequence_is_generated(q, cfg->rnti)) {
+          h->pdsch_ptr     = q;
+          h->cfg           = cfg;
+          h->sf            = sf;
+          h->tx_data       = data[tb_idx];
+          h->softbuffer_tx = cfg->softbuffers.tx[tb_idx];
+          h->tb_idx        = tb_idx;
+          h->is_encoder    = true;
+          h->started       = true;
+          sem_post(&h->start);
+        } else {
+          ret |= srslte_pdsch_codeword_encode(
+              q, sf, cfg, &q->dl_sch, cfg->softbuffers.tx[tb_idx], data[tb_idx], tb_idx, cfg->grant.nof_layers);
+        }
+      }
+    }
+
+    if (h && h->started) {
+      if (sem_wait(&h->finish)) {
+        ERROR("PDSCH Coworker Encoder: %s (nof_tb=%d)\n", strerror(errno), nof_tb);
+      }
+      if (h->ret_status) {
+        ERROR("PDSCH Coworker Encoder: Error encoding\n");
       }
+      ret |= h->ret_status;
+      h->started = false;
     }
 
     /* Set scaling configured by Power Allocation */
@@ -334,6 +334,23 @@ int main(int argc, char** argv)
         ERROR("Error unpacking DCI message\n");
         goto quit;
       }
+
+      // Decoding the same candidate again must reuse the previous result
+      srslte_dci_msg_t dci_rx2 = {};
+      dci_rx2.format           = testcases[i].dci_format;
+      dci_rx2.location         = testcases[i].dci_location;
+      uint32_t nof_decoded     = pdcch_rx.nof_decoded;
+      if (srslte_pdcch_decode_msg(&pdcch_rx, &dl_sf, &dci_cfg, &dci_rx2)) {
+        ERROR("Error decoding DCI message\n");
+        goto quit;
+      }
+      if (pdcch_rx.nof_decoded != nof_decoded || dci_rx2.rnti != testcases[i].dci_rx.rnti ||
+          dci_rx2.nof_bits != testcases[i].dci_rx.nof_bits || dci_rx2.format != testcases[i].dci_rx.format ||
+          memcmp(dci_rx2.payload, testcases[i].dci_rx.payload, dci_rx2.nof_bits) != 0) {
+        printf("Error in DCI %d: Second decoding does not match\n", i);
+        goto quit;
+      }
+
       if (testcases[i].dci_rx.rnti >= 1234 && testcases[i].dci_rx.rnti < 1234 + nof_dcis) {
         testcases[i].dci_rx.rnti -= 1234;
       } else {
@@ -75,7 +75,7 @@ void usage(char* prog)
   printf("\t-a nof_rx_antennas [Default %d]\n", nof_rx_antennas);
   printf("\t-p pmi (multiplex only)  [Default %d]\n", pmi);
   printf("\t-w Swap Transport Blocks\n");
-  printf("\t-j Enable PDSCH decoder coworker\n");
+  printf("\t-j Enable PDSCH encoder and decoder coworkers\n");
   printf("\t-v [set srslte_verbose to debug, default none]\n");
   printf("\t-q Enable/Disable 256QAM modulation (default %s)\n", enable_256qam ? "enabled" : "disabled");
 }
@@ -477,6 +477,7 @@ int main(int argc, char** argv)
   int r = 0;
   if (enable_coworker) {
     srslte_pdsch_enable_coworker(&pdsch_rx);
+    srslte_pdsch_enable_coworker(&pdsch_tx);
   }
 
   for (uint32_t i = 0; i < SRSLTE_MAX_CODEWORDS; i++) {
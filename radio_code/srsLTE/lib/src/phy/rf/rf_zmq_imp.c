@@ -728,7 +728,14 @@ int rf_zmq_recv_with_time_multi(void*    h,
     rf_zmq_info(handler->id,
                 " - read %d samples. %d samples available\n",
                 NBYTES2NSAMPLES(nbytes),
-                NBYTES2NSAMPLES(srslte_ringbuffer_status(&handler->receiver[0].ringbuffer)));
+                NBYTES2NSAMPLES(handler->receiver[0].shm.ring
+                                    ? rf_zmq_shm_status(&handler->receiver[0].shm)
+                                    : srslte_ringbuffer_status(&handler->receiver[0].ringbuffer)));
+    if (handler->receiver[0].shm.ring) {
+      rf_zmq_info(handler->id,
+                  " - transmitter timestamp %" PRIu64 "\n",
+                  rf_zmq_rx_get_timestamp(&handler->receiver[0]) - nsamples_baserate);
+    }
 
     // decimate if needed
     if (decim_factor != 1) {
@@ -107,6 +107,33 @@ int rf_zmq_rx_open(rf_zmq_rx_t* q, rf_zmq_opts_t opts, void* zmq_ctx, char* sock
     strncpy(q->id, opts.id, ZMQ_ID_STRLEN - 1);
     q->id[ZMQ_ID_STRLEN - 1] = '\0';
 
+    // Shared-memory transport, samples are read straight from the ring so no socket, thread or ring buffer is needed
+    if (rf_zmq_shm_is_address(sock_args)) {
+      q->sample_format      = opts.sample_format;
+      q->frequency_mhz      = opts.frequency_mhz;
+      q->fail_on_disconnect = opts.fail_on_disconnect;
+
+      rf_zmq_info(q->id, "Attaching shared-memory receiver: %s\n", sock_args);
+      if (rf_zmq_shm_open(&q->shm, sock_args, false)) {
+        fprintf(stderr, "[zmq] Error: opening shared-memory receiver %s\n", sock_args);
+        goto clean_exit;
+      }
+
+      q->timestamp = q->shm.timestamp / sizeof(cf_t);
+      if (q->sample_format != ZMQ_TYPE_FC32) {
+        q->timestamp           = q->shm.timestamp / (2 * sizeof(short));
+        q->temp_buffer_convert = srslte_vec_malloc(ZMQ_MAX_BUFFER_SIZE);
+        if (!q->temp_buffer_convert) {
+          fprintf(stderr, "Error: allocating rx buffer\n");
+          goto clean_exit;
+        }
+      }
+
+      q->running = true;
+      ret        = SRSLTE_SUCCESS;
+      goto clean_exit;
+    }
+
     // Create socket
     q->sock = zmq_socket(zmq_ctx, opts.socket_type);
     if (!q->sock) {
@@ -210,7 +237,24 @@ int rf_zmq_rx_baseband(rf_zmq_rx_t* q, cf_t* buffer, uint32_t nsamples)
     sample_sz  = 2 * sizeof(short);
   }
 
-  int n = srslte_ringbuffer_read_timed(&q->ringbuffer, dst_buffer, sample_sz * nsamples, ZMQ_TIMEOUT_MS);
+  int n;
+  if (q->shm.ring) {
+    n = rf_zmq_shm_read(&q->shm, dst_buffer, sample_sz * nsamples, &q->running);
+
+    // The ring position is the transmitter timestamp of the samples, a jump means the transmitter restarted
+    if (n > 0) {
+      uint64_t ts = q->shm.timestamp / sample_sz;
+      if (ts != q->timestamp) {
+        rf_zmq_error(q->id,
+                     "[zmq] Rx discontinuity: transmitter timestamp %" PRIu64 ", expected %" PRIu64 "\n",
+                     ts,
+                     q->timestamp);
+      }
+      q->timestamp = ts + n / sample_sz;
+    }
+  } else {
+    n = srslte_ringbuffer_read_timed(&q->ringbuffer, dst_buffer, sample_sz * nsamples, ZMQ_TIMEOUT_MS);
+  }
   if (n < 0) {
     return n;
   }
@@ -222,6 +266,11 @@ int rf_zmq_rx_baseband(rf_zmq_rx_t* q, cf_t* buffer, uint32_t nsamples)
   return n;
 }
 
+uint64_t rf_zmq_rx_get_timestamp(rf_zmq_rx_t* q)
+{
+  return q ? q->timestamp : 0;
+}
+
 bool rf_zmq_rx_match_freq(rf_zmq_rx_t* q, uint32_t freq_hz)
 {
   bool ret = false;
@@ -241,7 +290,11 @@ void rf_zmq_rx_close(rf_zmq_rx_t* q)
     pthread_detach(q->thread);
   }
 
-  srslte_ringbuffer_free(&q->ringbuffer);
+  if (q->shm.ring) {
+    rf_zmq_shm_close(&q->shm);
+  } else {
+    srslte_ringbuffer_free(&q->ringbuffer);
+  }
 
   if (q->temp_buffer) {
     free(q->temp_buffer);
@@ -0,0 +1,241 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "rf_zmq_imp_trx.h"
+#include <fcntl.h>
+#include <sched.h>
+#include <srslte/config.h>
+#include <srslte/phy/utils/vector.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#define ZMQ_SHM_MAGIC (0x73686d71u) // "shmq"
+#define ZMQ_SHM_CACHE_LINE (64)
+#define ZMQ_SHM_SPIN_COUNT (64)
+#define ZMQ_SHM_SLEEP_US (50)
+
+/*
+ * Single-producer single-consumer ring shared between two processes. Both counters are free-running byte counters
+ * written by one side only, so the write counter divided by the sample size is the timestamp (in samples) of the next
+ * sample to be written. The transmitter bumps the generation when it creates or releases the ring, which tells a
+ * receiver that its mapping is stale and its timestamps restart.
+ */
+struct rf_zmq_shm_ring_s {
+  uint32_t magic;
+  uint32_t capacity;
+  uint32_t generation;
+  uint8_t  pad0[ZMQ_SHM_CACHE_LINE - 3 * sizeof(uint32_t)];
+  uint64_t write_count;
+  uint8_t  pad1[ZMQ_SHM_CACHE_LINE - sizeof(uint64_t)];
+  uint64_t read_count;
+  uint8_t  pad2[ZMQ_SHM_CACHE_LINE - sizeof(uint64_t)];
+  uint8_t  data[];
+};
+
+static uint64_t shm_now_ms()
+{
+  struct timeval t;
+  gettimeofday(&t, NULL);
+  return (uint64_t)t.tv_sec * 1000UL + (uint64_t)t.tv_usec / 1000UL;
+}
+
+// Spins for a short while, the other side usually catches up within a few yields, then sleeps
+static void shm_backoff(uint32_t* spins)
+{
+  if (*spins < ZMQ_SHM_SPIN_COUNT) {
+    (*spins)++;
+    sched_yield();
+  } else {
+    usleep(ZMQ_SHM_SLEEP_US);
+  }
+}
+
+static int shm_map(rf_zmq_shm_t* q)
+{
+  int fd = shm_open(q->name, O_CREAT | O_RDWR, S_IRUSR | S_IWUSR);
+  if (fd < 0) {
+    perror("shm_open");
+    return SRSLTE_ERROR;
+  }
+
+  q->map_size = sizeof(rf_zmq_shm_ring_t) + ZMQ_MAX_BUFFER_SIZE;
+  if (ftruncate(fd, q->map_size) < 0) {
+    perror("ftruncate");
+    close(fd);
+    return SRSLTE_ERROR;
+  }
+
+  q->ring = mmap(NULL, q->map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (q->ring == MAP_FAILED) {
+    perror("mmap");
+    q->ring = NULL;
+    return SRSLTE_ERROR;
+  }
+
+  // The transmitter owns the ring and discards any stale content from a previous run
+  if (q->owner || __atomic_load_n(&q->ring->magic, __ATOMIC_ACQUIRE) != ZMQ_SHM_MAGIC) {
+    __atomic_store_n(&q->ring->write_count, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&q->ring->read_count, 0, __ATOMIC_RELAXED);
+    q->ring->capacity = ZMQ_MAX_BUFFER_SIZE;
+    __atomic_add_fetch(&q->ring->generation, 1, __ATOMIC_RELEASE);
+    __atomic_store_n(&q->ring->magic, ZMQ_SHM_MAGIC, __ATOMIC_RELEASE);
+  }
+  q->generation = __atomic_load_n(&q->ring->generation, __ATOMIC_ACQUIRE);
+  q->timestamp  = __atomic_load_n(q->owner ? &q->ring->write_count : &q->ring->read_count, __ATOMIC_ACQUIRE);
+
+  return SRSLTE_SUCCESS;
+}
+
+// Maps the ring again after the transmitter has released or re-created it
+static int shm_remap(rf_zmq_shm_t* q)
+{
+  munmap(q->ring, q->map_size);
+  q->ring = NULL;
+  return shm_map(q);
+}
+
+bool rf_zmq_shm_is_address(const char* address)
+{
+  return address != NULL && strncmp(address, ZMQ_SHM_PREFIX, strlen(ZMQ_SHM_PREFIX)) == 0;
+}
+
+int rf_zmq_shm_open(rf_zmq_shm_t* q, const char* address, bool owner)
+{
+  if (q == NULL || !rf_zmq_shm_is_address(address)) {
+    return SRSLTE_ERROR_INVALID_INPUTS;
+  }
+
+  bzero(q, sizeof(rf_zmq_shm_t));
+  q->owner = owner;
+
+  // POSIX shared memory objects are named with a single leading slash
+  snprintf(q->name, ZMQ_SHM_NAME_STRLEN, "/srslte_%s", address + strlen(ZMQ_SHM_PREFIX));
+
+  return shm_map(q);
+}
+
+int rf_zmq_shm_write(rf_zmq_shm_t* q, const void* data, uint32_t nbytes, const bool* running)
+{
+  rf_zmq_shm_ring_t* r = q->ring;
+
+  if (nbytes > r->capacity) {
+    return SRSLTE_ERROR_INVALID_INPUTS;
+  }
+
+  // Wait for the reader to free enough space
+  uint64_t w        = r->write_count;
+  uint64_t deadline = shm_now_ms() + ZMQ_TIMEOUT_MS;
+  uint32_t spins    = 0;
+  while (r->capacity - (w - __atomic_load_n(&r->read_count, __ATOMIC_ACQUIRE)) < nbytes) {
+    if (!*running) {
+      return SRSLTE_SUCCESS;
+    }
+    if (shm_now_ms() > deadline) {
+      return SRSLTE_ERROR_TIMEOUT;
+    }
+    shm_backoff(&spins);
+  }
+
+  uint32_t offset = (uint32_t)(w % r->capacity);
+  uint32_t first  = SRSLTE_MIN(nbytes, r->capacity - offset);
+  if (data) {
+    memcpy(&r->data[offset], data, first);
+    memcpy(r->data, (const uint8_t*)data + first, nbytes - first);
+  } else {
+    memset(&r->data[offset], 0, first);
+    memset(r->data, 0, nbytes - first);
+  }
+
+  q->timestamp = w;
+  __atomic_store_n(&r->write_count, w + nbytes, __ATOMIC_RELEASE);
+
+  return (int)nbytes;
+}
+
+int rf_zmq_shm_read(rf_zmq_shm_t* q, void* data, uint32_t nbytes, const bool* running)
+{
+  if (nbytes > q->ring->capacity) {
+    return SRSLTE_ERROR_INVALID_INPUTS;
+  }
+
+  // Wait for the writer to provide enough samples
+  uint64_t deadline = shm_now_ms() + ZMQ_TIMEOUT_MS;
+  uint32_t spins    = 0;
+  while (__atomic_load_n(&q->ring->write_count, __ATOMIC_ACQUIRE) - q->ring->read_count < nbytes) {
+    if (!*running) {
+      return SRSLTE_SUCCESS;
+    }
+    // A restarted transmitter unlinks the old ring and creates a new one under the same name
+    if (__atomic_load_n(&q->ring->generation, __ATOMIC_ACQUIRE) != q->generation) {
+      if (shm_remap(q)) {
+        return SRSLTE_ERROR;
+      }
+      spins = 0;
+      continue;
+    }
+    if (shm_now_ms() > deadline) {
+      return SRSLTE_ERROR_TIMEOUT;
+    }
+    shm_backoff(&spins);
+  }
+
+  rf_zmq_shm_ring_t* r      = q->ring;
+  uint64_t           rd     = r->read_count;
+  uint32_t           offset = (uint32_t)(rd % r->capacity);
+  uint32_t           first  = SRSLTE_MIN(nbytes, r->capacity - offset);
+  memcpy(data, &r->data[offset], first);
+  memcpy((uint8_t*)data + first, r->data, nbytes - first);
+
+  q->timestamp = rd;
+  __atomic_store_n(&r->read_count, rd + nbytes, __ATOMIC_RELEASE);
+
+  return (int)nbytes;
+}
+
+uint32_t rf_zmq_shm_status(rf_zmq_shm_t* q)
+{
+  if (q == NULL || q->ring == NULL) {
+    return 0;
+  }
+  return (uint32_t)(__atomic_load_n(&q->ring->write_count, __ATOMIC_ACQUIRE) -
+                    __atomic_load_n(&q->ring->read_count, __ATOMIC_ACQUIRE));
+}
+
+void rf_zmq_shm_close(rf_zmq_shm_t* q)
+{
+  if (q->ring) {
+    // Tell an attached receiver that this ring is going away before unlinking it
+    if (q->owner) {
+      __atomic_add_fetch(&q->ring->generation, 1, __ATOMIC_RELEASE);
+    }
+    munmap(q->ring, q->map_size);
+    q->ring = NULL;
+  }
+
+  if (q->owner) {
+    shm_unlink(q->name);
+  }
+}
@@ -37,9 +37,23 @@
 #define ZMQ_ID_STRLEN 16
 #define ZMQ_MAX_GAIN_DB (30.0f)
 #define ZMQ_MIN_GAIN_DB (0.0f)
+#define ZMQ_SHM_PREFIX "shm://"
+#define ZMQ_SHM_NAME_STRLEN 64
 
 typedef enum { ZMQ_TYPE_FC32 = 0, ZMQ_TYPE_SC16 } rf_zmq_format_t;
 
+typedef struct rf_zmq_shm_ring_s rf_zmq_shm_ring_t;
+
+// Shared-memory transport for co-located processes, selected with a "shm://<name>" port
+typedef struct {
+  char               name[ZMQ_SHM_NAME_STRLEN];
+  rf_zmq_shm_ring_t* ring;
+  size_t             map_size;
+  bool               owner;
+  uint32_t           generation; // Generation of the mapped ring, it changes when the transmitter restarts
+  uint64_t           timestamp;  // Ring byte counter at the first byte of the last read or write
+} rf_zmq_shm_t;
+
 typedef struct {
   char            id[ZMQ_ID_STRLEN];
   uint32_t        socket_type;
@@ -51,6 +65,7 @@ typedef struct {
   cf_t*           zeros;
   void*           temp_buffer_convert;
   uint32_t        frequency_mhz;
+  rf_zmq_shm_t    shm;
 } rf_zmq_tx_t;
 
 typedef struct {
@@ -71,6 +86,8 @@ typedef struct {
   void*               temp_buffer_convert;
   uint32_t            frequency_mhz;
   bool                fail_on_disconnect;
+  rf_zmq_shm_t        shm;
+  uint64_t            timestamp; // Transmitter timestamp, in samples, of the next shared-memory sample
 } rf_zmq_rx_t;
 
 typedef struct {
@@ -90,6 +107,21 @@ SRSLTE_API void rf_zmq_error(char* id, const char* format, ...);
 
 SRSLTE_API int rf_zmq_handle_error(char* id, const char* text);
 
+/*
+ * Shared-memory transport functions
+ */
+SRSLTE_API bool rf_zmq_shm_is_address(const char* address);
+
+SRSLTE_API int rf_zmq_shm_open(rf_zmq_shm_t* q, const char* address, bool owner);
+
+SRSLTE_API int rf_zmq_shm_write(rf_zmq_shm_t* q, const void* data, uint32_t nbytes, const bool* running);
+
+SRSLTE_API int rf_zmq_shm_read(rf_zmq_shm_t* q, void* data, uint32_t nbytes, const bool* running);
+
+SRSLTE_API uint32_t rf_zmq_shm_status(rf_zmq_shm_t* q);
+
+SRSLTE_API void rf_zmq_shm_close(rf_zmq_shm_t* q);
+
 /*
  * Transmitter functions
  */
@@ -114,6 +146,8 @@ SRSLTE_API int rf_zmq_rx_baseband(rf_zmq_rx_t* q, cf_t* buffer, uint32_t nsample
 
 SRSLTE_API bool rf_zmq_rx_match_freq(rf_zmq_rx_t* q, uint32_t freq_hz);
 
+SRSLTE_API uint64_t rf_zmq_rx_get_timestamp(rf_zmq_rx_t* q);
+
 SRSLTE_API void rf_zmq_rx_close(rf_zmq_rx_t* q);
 
 #endif // SRSLTE_RF_ZMQ_IMP_TRX_H
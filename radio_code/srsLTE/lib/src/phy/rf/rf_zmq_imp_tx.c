@@ -39,42 +39,52 @@ int rf_zmq_tx_open(rf_zmq_tx_t* q, rf_zmq_opts_t opts, void* zmq_ctx, char* sock
     strncpy(q->id, opts.id, ZMQ_ID_STRLEN - 1);
     q->id[ZMQ_ID_STRLEN - 1] = '\0';
 
-    // Create socket
-    q->sock = zmq_socket(zmq_ctx, opts.socket_type);
-    if (!q->sock) {
-      fprintf(stderr, "[zmq] Error: creating transmitter socket\n");
-      goto clean_exit;
-    }
     q->socket_type   = opts.socket_type;
     q->sample_format = opts.sample_format;
     q->frequency_mhz = opts.frequency_mhz;
 
-    rf_zmq_info(q->id, "Binding transmitter: %s\n", sock_args);
+    // Shared-memory transport, the transmitter creates the ring
+    if (rf_zmq_shm_is_address(sock_args)) {
+      rf_zmq_info(q->id, "Creating shared-memory transmitter: %s\n", sock_args);
+      if (rf_zmq_shm_open(&q->shm, sock_args, true)) {
+        fprintf(stderr, "[zmq] Error: opening shared-memory transmitter %s\n", sock_args);
+        goto clean_exit;
+      }
+    } else {
+      // Create socket
+      q->sock = zmq_socket(zmq_ctx, opts.socket_type);
+      if (!q->sock) {
+        fprintf(stderr, "[zmq] Error: creating transmitter socket\n");
+        goto clean_exit;
+      }
+
+      rf_zmq_info(q->id, "Binding transmitter: %s\n", sock_args);
 
-    ret = zmq_bind(q->sock, sock_args);
-    if (ret) {
-      fprintf(stderr, "Error: connecting transmitter socket: %s\n", zmq_strerror(zmq_errno()));
-      goto clean_exit;
-    }
+      ret = zmq_bind(q->sock, sock_args);
+      if (ret) {
+        fprintf(stderr, "Error: connecting transmitter socket: %s\n", zmq_strerror(zmq_errno()));
+        goto clean_exit;
+      }
 
 #if ZMQ_TIMEOUT_MS
-    int timeout = ZMQ_TIMEOUT_MS;
-    if (zmq_setsockopt(q->sock, ZMQ_RCVTIMEO, &timeout, sizeof(timeout)) == -1) {
-      fprintf(stderr, "Error: setting receive timeout on tx socket\n");
-      goto clean_exit;
-    }
+      int timeout = ZMQ_TIMEOUT_MS;
+      if (zmq_setsockopt(q->sock, ZMQ_RCVTIMEO, &timeout, sizeof(timeout)) == -1) {
+        fprintf(stderr, "Error: setting receive timeout on tx socket\n");
+        goto clean_exit;
+      }
 
-    if (zmq_setsockopt(q->sock, ZMQ_SNDTIMEO, &timeout, sizeof(timeout)) == -1) {
-      fprintf(stderr, "Error: setting receive timeout on tx socket\n");
-      goto clean_exit;
-    }
+      if (zmq_setsockopt(q->sock, ZMQ_SNDTIMEO, &timeout, sizeof(timeout)) == -1) {
+        fprintf(stderr, "Error: setting receive timeout on tx socket\n");
+        goto clean_exit;
+      }
 
-    timeout = 0;
-    if (zmq_setsockopt(q->sock, ZMQ_LINGER, &timeout, sizeof(timeout)) == -1) {
-      fprintf(stderr, "Error: setting linger timeout on tx socket\n");
-      goto clean_exit;
-    }
+      timeout = 0;
+      if (zmq_setsockopt(q->sock, ZMQ_LINGER, &timeout, sizeof(timeout)) == -1) {
+        fprintf(stderr, "Error: setting linger timeout on tx socket\n");
+        goto clean_exit;
+      }
 #endif
+    }
 
     if (pthread_mutex_init(&q->mutex, NULL)) {
       fprintf(stderr, "Error: creating mutex\n");
@@ -103,10 +113,44 @@ clean_exit:
   return ret;
 }
 
+static int _rf_zmq_tx_baseband_shm(rf_zmq_tx_t* q, cf_t* buffer, uint32_t nsamples)
+{
+  int      n         = SRSLTE_ERROR;
+  void*    buf       = buffer;
+  uint32_t sample_sz = sizeof(cf_t);
+
+  // Samples are written straight from the caller buffer unless they need conversion
+  if (buffer && q->sample_format == ZMQ_TYPE_SC16) {
+    buf       = q->temp_buffer_convert;
+    sample_sz = 2 * sizeof(short);
+    srslte_vec_convert_fi((float*)buffer, INT16_MAX, (short*)q->temp_buffer_convert, 2 * nsamples);
+  } else if (q->sample_format == ZMQ_TYPE_SC16) {
+    sample_sz = 2 * sizeof(short);
+  }
+
+  // Keep trying while the receiver does not free space in the ring
+  while (n < 0 && q->running) {
+    n = rf_zmq_shm_write(&q->shm, buf, sample_sz * nsamples, &q->running);
+    if (n == SRSLTE_ERROR_INVALID_INPUTS) {
+      rf_zmq_error(q->id, "[zmq] Error: transmitter can not write %d samples in shared memory.\n", nsamples);
+      return SRSLTE_ERROR;
+    }
+  }
+
+  // Increment sample counter
+  q->nsamples += nsamples;
+
+  return nsamples;
+}
+
 static int _rf_zmq_tx_baseband(rf_zmq_tx_t* q, cf_t* buffer, uint32_t nsamples)
 {
   int n = SRSLTE_ERROR;
 
+  if (q->shm.ring) {
+    return _rf_zmq_tx_baseband_shm(q, buffer, nsamples);
+  }
+
   while (n < 0 && q->running) {
     // Receive Transmit request is socket type is REPLY
     if (q->socket_type == ZMQ_REP) {
@@ -232,4 +276,6 @@ void rf_zmq_tx_close(rf_zmq_tx_t* q)
     zmq_close(q->sock);
     q->sock = NULL;
   }
+
+  rf_zmq_shm_close(&q->shm);
 }
@@ -0,0 +1,319 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/*
+ * Channel emulation hub for ZMQ based operation. It connects one eNb to several UEs and applies an independent
+ * channel model to every downlink and uplink link. Uplink signals are added before they are forwarded to the eNb.
+ *
+ * The downlink and the uplink of every link are processed by their own threads, one subframe at a time, and streams
+ * are forwarded without timestamps so the sample alignment between the eNb and every UE is preserved. The channel
+ * models and the uplink sum run on the srslte_vec SIMD kernels.
+ */
+
+#include "rf_zmq_imp_trx.h"
+#include "srslte/phy/channel/channel.h"
+#include "srslte/srslte.h"
+#include <atomic>
+#include <condition_variable>
+#include <csignal>
+#include <getopt.h>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <zmq.h>
+
+#define HUB_MAX_NOF_UE (64)
+
+static std::atomic<bool>        keep_running(true);
+static uint32_t                 base_srate   = ZMQ_BASERATE_DEFAULT_HZ;
+static std::string              enb_args;
+static std::vector<std::string> ue_args;
+static srslte::channel::args_t  channel_args;
+
+typedef struct {
+  rf_zmq_tx_t         tx;
+  rf_zmq_rx_t         rx;
+  srslte::channel_ptr dl_channel;
+  srslte::channel_ptr ul_channel;
+  cf_t*               dl_buffer = nullptr;
+  cf_t*               ul_buffer = nullptr;
+  std::thread         dl_thread;
+  std::thread         ul_thread;
+} hub_link_t;
+
+// Subframe handshake between the main thread and the link threads
+static std::mutex              mutex;
+static std::condition_variable cvar_start;
+static std::condition_variable cvar_done;
+static uint64_t                sf_count   = 0;
+static uint32_t                nof_done   = 0;
+static cf_t*                   enb_buffer = nullptr;
+
+static void int_handler(int dummy)
+{
+  keep_running = false;
+}
+
+static void usage(char* prog)
+{
+  printf("Usage: %s [sfmndD] -e enb_rx_port,enb_tx_port -u ue_rx_port,ue_tx_port [-u ...]\n", prog);
+  printf("\t-e Ports towards the eNb: port the eNb transmits on, port the hub binds for the eNb to receive\n");
+  printf("\t-u Ports towards one UE: port the UE transmits on, port the hub binds for the UE to receive\n");
+  printf("\t-s Base sampling rate [Default %d Hz]\n", base_srate);
+  printf("\t-f Fading model (none, epa5, eva70, etu300...) [Default %s]\n", channel_args.fading_model.c_str());
+  printf("\t-n AWGN noise level in dBfs, disabled if not set\n");
+  printf("\t-d Maximum delay in us, disabled if not set\n");
+  printf("\t-D Delay period in seconds [Default %.0f]\n", channel_args.delay_period_s);
+}
+
+static void parse_args(int argc, char** argv)
+{
+  int opt;
+  while ((opt = getopt(argc, argv, "eusfndD")) != -1) {
+    switch (opt) {
+      case 'e':
+        enb_args = argv[optind];
+        break;
+      case 'u':
+        ue_args.push_back(argv[optind]);
+        break;
+      case 's':
+        base_srate = (uint32_t)strtof(argv[optind], NULL);
+        break;
+      case 'f':
+        channel_args.enable        = true;
+        channel_args.fading_enable = true;
+        channel_args.fading_model  = argv[optind];
+        break;
+      case 'n':
+        channel_args.enable       = true;
+        channel_args.awgn_enable  = true;
+        channel_args.awgn_n0_dBfs = strtof(argv[optind], NULL);
+        break;
+      case 'd':
+        channel_args.enable       = true;
+        channel_args.delay_enable = true;
+        channel_args.delay_max_us = strtof(argv[optind], NULL);
+        channel_args.delay_min_us = SRSLTE_MIN(channel_args.delay_min_us, channel_args.delay_max_us);
+        break;
+      case 'D':
+        channel_args.delay_period_s = strtof(argv[optind], NULL);
+        break;
+      default:
+        usage(argv[0]);
+        exit(-1);
+    }
+  }
+  if (enb_args.empty() || ue_args.empty() || ue_args.size() > HUB_MAX_NOF_UE) {
+    usage(argv[0]);
+    exit(-1);
+  }
+}
+
+static int open_link(hub_link_t* link, const std::string& args, const char* id, void* zmq_ctx)
+{
+  size_t comma = args.find(',');
+  if (comma == std::string::npos) {
+    fprintf(stderr, "Error: ports must be given as rx_port,tx_port (%s)\n", args.c_str());
+    return SRSLTE_ERROR;
+  }
+  std::string rx_port = args.substr(0, comma);
+  std::string tx_port = args.substr(comma + 1);
+
+  rf_zmq_opts_t rx_opts = {};
+  rx_opts.id            = id;
+  rx_opts.socket_type   = ZMQ_REQ;
+  rx_opts.sample_format = ZMQ_TYPE_FC32;
+
+  rf_zmq_opts_t tx_opts = rx_opts;
+  tx_opts.socket_type   = ZMQ_REP;
+
+  if (rf_zmq_rx_open(&link->rx, rx_opts, zmq_ctx, (char*)rx_port.c_str())) {
+    fprintf(stderr, "Error: opening receiver %s\n", rx_port.c_str());
+    return SRSLTE_ERROR;
+  }
+
+  if (rf_zmq_tx_open(&link->tx, tx_opts, zmq_ctx, (char*)tx_port.c_str())) {
+    fprintf(stderr, "Error: opening transmitter %s\n", tx_port.c_str());
+    return SRSLTE_ERROR;
+  }
+
+  return SRSLTE_SUCCESS;
+}
+
+static void close_link(hub_link_t* link)
+{
+  rf_zmq_tx_close(&link->tx);
+  rf_zmq_rx_close(&link->rx);
+  if (link->dl_buffer) {
+    free(link->dl_buffer);
+  }
+  if (link->ul_buffer) {
+    free(link->ul_buffer);
+  }
+}
+
+static void receive_sf(hub_link_t* link, cf_t* buffer, uint32_t sf_len)
+{
+  int n = rf_zmq_rx_baseband(&link->rx, buffer, sf_len);
+  if (n < SRSLTE_SUCCESS) {
+    // The other end is not connected (yet), keep the link running with silence
+    srslte_vec_cf_zero(buffer, sf_len);
+  }
+}
+
+static void ue_link_thread(hub_link_t* link, uint32_t sf_len, bool downlink)
+{
+  uint64_t last_sf = 0;
+
+  while (keep_running) {
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      while (sf_count == last_sf && keep_running) {
+        cvar_start.wait(lock);
+      }
+      last_sf = sf_count;
+    }
+    if (!keep_running) {
+      break;
+    }
+
+    srslte_timestamp_t ts = {};
+    srslte_timestamp_init_uint64(&ts, (last_sf - 1) * sf_len, base_srate);
+
+    if (downlink) {
+      // Apply this link channel to the eNb signal and forward it to the UE
+      cf_t* dl_in[SRSLTE_MAX_CHANNELS]  = {enb_buffer};
+      cf_t* dl_out[SRSLTE_MAX_CHANNELS] = {link->dl_buffer};
+      link->dl_channel->run(dl_in, dl_out, sf_len, ts);
+      rf_zmq_tx_baseband(&link->tx, link->dl_buffer, sf_len);
+    } else {
+      // Receive the UE signal and apply this link channel in place
+      receive_sf(link, link->ul_buffer, sf_len);
+      cf_t* ul[SRSLTE_MAX_CHANNELS] = {link->ul_buffer};
+      link->ul_channel->run(ul, ul, sf_len, ts);
+    }
+
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      nof_done++;
+    }
+    cvar_done.notify_one();
+  }
+}
+
+int main(int argc, char** argv)
+{
+  channel_args.fading_model = "none";
+  parse_args(argc, argv);
+
+  signal(SIGINT, int_handler);
+
+  uint32_t sf_len = base_srate / 1000;
+  if (NSAMPLES2NBYTES(sf_len) > ZMQ_MAX_BUFFER_SIZE) {
+    fprintf(stderr, "Error: base sampling rate %d Hz is too high\n", base_srate);
+    return SRSLTE_ERROR;
+  }
+
+  void* zmq_ctx = zmq_ctx_new();
+  if (!zmq_ctx) {
+    fprintf(stderr, "Error: creating ZMQ context\n");
+    return SRSLTE_ERROR;
+  }
+
+  hub_link_t              enb_link = {};
+  std::vector<hub_link_t> ue_links(ue_args.size());
+  cf_t*                   ul_sum = srslte_vec_cf_malloc(sf_len);
+  enb_buffer                     = srslte_vec_cf_malloc(sf_len);
+  if (!ul_sum || !enb_buffer || open_link(&enb_link, enb_args, "enb", zmq_ctx)) {
+    return SRSLTE_ERROR;
+  }
+
+  for (uint32_t i = 0; i < ue_links.size(); i++) {
+    hub_link_t& link = ue_links[i];
+    if (open_link(&link, ue_args[i], "ue", zmq_ctx)) {
+      return SRSLTE_ERROR;
+    }
+
+    // Every link direction gets its own random processes
+    link.dl_channel = srslte::channel_ptr(new srslte::channel(channel_args, 1, 2 * i));
+    link.ul_channel = srslte::channel_ptr(new srslte::channel(channel_args, 1, 2 * i + 1));
+    if (channel_args.enable) {
+      link.dl_channel->set_srate(base_srate);
+      link.ul_channel->set_srate(base_srate);
+    }
+
+    link.dl_buffer = srslte_vec_cf_malloc(sf_len);
+    link.ul_buffer = srslte_vec_cf_malloc(sf_len);
+    if (!link.dl_buffer || !link.ul_buffer) {
+      return SRSLTE_ERROR;
+    }
+    link.dl_thread = std::thread(ue_link_thread, &link, sf_len, true);
+    link.ul_thread = std::thread(ue_link_thread, &link, sf_len, false);
+  }
+
+  printf("Channel hub running with %zd UEs at %.2f MHz. Press Ctrl+C to stop.\n", ue_links.size(), base_srate / 1e6);
+
+  while (keep_running) {
+    // Receive the eNb downlink subframe and release the links
+    receive_sf(&enb_link, enb_buffer, sf_len);
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      nof_done = 0;
+      sf_count++;
+    }
+    cvar_start.notify_all();
+
+    // Wait for every link to forward its downlink and provide its uplink subframe
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      while (nof_done < 2 * ue_links.size() && keep_running) {
+        cvar_done.wait(lock);
+      }
+    }
+
+    // Superpose the uplink signals and forward them to the eNb
+    srslte_vec_cf_zero(ul_sum, sf_len);
+    for (hub_link_t& link : ue_links) {
+      srslte_vec_sum_ccc(ul_sum, link.ul_buffer, ul_sum, sf_len);
+    }
+    rf_zmq_tx_baseband(&enb_link.tx, ul_sum, sf_len);
+  }
+
+  // Unblock and join link threads
+  cvar_start.notify_all();
+  for (hub_link_t& link : ue_links) {
+    link.tx.running = false;
+    link.rx.running = false;
+    link.dl_thread.join();
+    link.ul_thread.join();
+    close_link(&link);
+  }
+  close_link(&enb_link);
+
+  free(ul_sum);
+  free(enb_buffer);
+  zmq_ctx_destroy(zmq_ctx);
+
+  printf("Bye\n");
+  return SRSLTE_SUCCESS;
+}
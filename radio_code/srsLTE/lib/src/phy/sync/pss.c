@@ -164,14 +164,13 @@ int srslte_pss_init_fft_offset_decim(srslte_pss_t* q,
       goto clean_and_exit;
     }
     srslte_vec_f_zero(q->conv_output_avg, buffer_size);
-#ifdef SRSLTE_PSS_ACCUMULATE_ABS
-    q->conv_output_abs = srslte_vec_f_malloc(buffer_size);
-    if (!q->conv_output_abs) {
-      ERROR("Error allocating memory\n");
-      goto clean_and_exit;
+    for (N_id_2 = 0; N_id_2 < 3; N_id_2++) {
+      q->conv_output_avg_N_id_2[N_id_2] = srslte_vec_f_malloc(buffer_size);
+      if (!q->conv_output_avg_N_id_2[N_id_2]) {
+        ERROR("Error allocating memory\n");
+        goto clean_and_exit;
+      }
     }
-    srslte_vec_f_zero(q->conv_output_abs, buffer_size);
-#endif
 
     for (N_id_2 = 0; N_id_2 < 3; N_id_2++) {
       q->pss_signal_time[N_id_2] = srslte_vec_cf_malloc(buffer_size);
@@ -259,10 +258,6 @@ int srslte_pss_resize(srslte_pss_t* q, uint32_t frame_size, uint32_t fft_size, i
     srslte_vec_cf_zero(q->conv_output, buffer_size);
     srslte_vec_f_zero(q->conv_output_avg, buffer_size);
 
-#ifdef SRSLTE_PSS_ACCUMULATE_ABS
-    srslte_vec_f_zero(q->conv_output_abs, buffer_size);
-#endif
-
     // Generate PSS sequences for this FFT size
     for (N_id_2 = 0; N_id_2 < 3; N_id_2++) {
       if (srslte_pss_init_N_id_2(q->pss_signal_freq[N_id_2], q->pss_signal_time[N_id_2], N_id_2, fft_size, offset)) {
@@ -302,6 +297,9 @@ void srslte_pss_free(srslte_pss_t* q)
       if (q->pss_signal_freq_full[i]) {
         free(q->pss_signal_freq_full[i]);
       }
+      if (q->conv_output_avg_N_id_2[i]) {
+        free(q->conv_output_avg_N_id_2[i]);
+      }
     }
 #ifdef CONVOLUTION_FFT
     srslte_conv_fft_cc_free(&q->conv_fft);
@@ -313,9 +311,6 @@ void srslte_pss_free(srslte_pss_t* q)
     if (q->conv_output) {
       free(q->conv_output);
     }
-    if (q->conv_output_abs) {
-      free(q->conv_output_abs);
-    }
     if (q->conv_output_avg) {
       free(q->conv_output_avg);
     }
@@ -337,6 +332,11 @@ void srslte_pss_reset(srslte_pss_t* q)
 {
   uint32_t buffer_size = q->fft_size + q->frame_size + 1;
   srslte_vec_f_zero(q->conv_output_avg, buffer_size);
+  for (int i = 0; i < 3; i++) {
+    if (q->conv_output_avg_N_id_2[i]) {
+      srslte_vec_f_zero(q->conv_output_avg_N_id_2[i], buffer_size);
+    }
+  }
 }
 
 /**
@@ -410,18 +410,18 @@ void srslte_pss_set_ema_alpha(srslte_pss_t* q, float alpha)
   q->ema_alpha = alpha;
 }
 
-float compute_peak_sidelobe(srslte_pss_t* q, uint32_t corr_peak_pos, uint32_t conv_output_len)
+static float compute_peak_sidelobe(const float* conv_output_avg, uint32_t corr_peak_pos, uint32_t conv_output_len)
 {
   // Find end of peak lobe to the right
   int pl_ub = corr_peak_pos + 1;
-  while (q->conv_output_avg[pl_ub + 1] <= q->conv_output_avg[pl_ub] && pl_ub < conv_output_len) {
+  while (conv_output_avg[pl_ub + 1] <= conv_output_avg[pl_ub] && pl_ub < conv_output_len) {
     pl_ub++;
   }
   // Find end of peak lobe to the left
   int pl_lb;
   if (corr_peak_pos > 2) {
     pl_lb = corr_peak_pos - 1;
-    while (q->conv_output_avg[pl_lb - 1] <= q->conv_output_avg[pl_lb] && pl_lb > 1) {
+    while (conv_output_avg[pl_lb - 1] <= conv_output_avg[pl_lb] && pl_lb > 1) {
       pl_lb--;
     }
   } else {
@@ -434,11 +434,108 @@ float compute_peak_sidelobe(srslte_pss_t* q, uint32_t corr_peak_pos, uint32_t co
   }
   int sl_distance_left = pl_lb;
 
-  int   sl_right        = pl_ub + srslte_vec_max_fi(&q->conv_output_avg[pl_ub], sl_distance_right);
-  int   sl_left         = srslte_vec_max_fi(q->conv_output_avg, sl_distance_left);
-  float side_lobe_value = SRSLTE_MAX(q->conv_output_avg[sl_right], q->conv_output_avg[sl_left]);
+  int   sl_right        = pl_ub + srslte_vec_max_fi(&conv_output_avg[pl_ub], sl_distance_right);
+  int   sl_left         = srslte_vec_max_fi(conv_output_avg, sl_distance_left);
+  float side_lobe_value = SRSLTE_MAX(conv_output_avg[sl_right], conv_output_avg[sl_left]);
+
+  return conv_output_avg[corr_peak_pos] / side_lobe_value;
+}
+
+/* Transforms the input to the frequency domain, after decimating it if enabled. Returns the transform, or NULL if the
+ * correlation is not done with FFTs.
+ */
+static const cf_t* pss_input_fft(srslte_pss_t* q, const cf_t* input)
+{
+#ifdef CONVOLUTION_FFT
+  if (q->frame_size >= q->fft_size) {
+    memcpy(q->tmp_input, input, (q->frame_size * q->decimate) * sizeof(cf_t));
+    const cf_t* conv_input = q->tmp_input;
+    if (q->decimate > 1) {
+      srslte_filt_decim_cc_execute(&(q->filter),
+                                   q->tmp_input,
+                                   q->filter.downsampled_input,
+                                   q->filter.filter_output,
+                                   (q->frame_size * q->decimate));
+      conv_input = q->filter.filter_output;
+    }
+    srslte_dft_run_c(&q->conv_fft.input_plan, conv_input, q->conv_fft.input_fft);
+    return q->conv_fft.input_fft;
+  }
+#endif
+  return NULL;
+}
 
-  return q->conv_output_avg[corr_peak_pos] / side_lobe_value;
+/* Correlates the input with the PSS sequence for N_id_2 into q->conv_output and returns the correlation length.
+ * If input_fft is not NULL it is the transform of the input computed by pss_input_fft().
+ *
+ * We do not reverse time-domain PSS signal because it's conjugate is symmetric.
+ * The conjugate operation on pss_signal_time has been done in srslte_pss_init_N_id_2
+ * This is why we can use FFT-based convolution
+ */
+static uint32_t pss_correlate(srslte_pss_t* q, const cf_t* input, const cf_t* input_fft, uint32_t N_id_2)
+{
+#ifdef CONVOLUTION_FFT
+  if (input_fft != NULL) {
+    srslte_vec_prod_ccc(input_fft, q->pss_signal_freq_full[N_id_2], q->conv_fft.output_fft, q->conv_fft.output_len);
+    srslte_dft_run_c(&q->conv_fft.output_plan, q->conv_fft.output_fft, q->conv_output);
+    return q->conv_fft.output_len - 1;
+  }
+#else
+  if (q->frame_size >= q->fft_size) {
+    return srslte_conv_cc(input, q->pss_signal_time[N_id_2], q->conv_output, q->frame_size, q->fft_size);
+  }
+#endif
+  for (int i = 0; i < q->frame_size; i++) {
+    q->conv_output[i] = srslte_vec_dot_prod_ccc(q->pss_signal_time[N_id_2], &input[i], q->fft_size);
+  }
+  return q->frame_size;
+}
+
+/* Averages the squared correlation in q->conv_output into conv_output_avg and returns the position of its maximum,
+ * already translated to input samples. The absolute value of the peak is stored in peak_value, if not NULL.
+ */
+static int pss_find_peak(srslte_pss_t* q,
+                         float*        conv_output_avg,
+                         uint32_t      conv_output_len,
+                         float*        peak_value,
+                         float*        corr_peak_value)
+{
+  // If enabled, average the absolute value from previous calls
+  if (q->ema_alpha < 1.0 && q->ema_alpha > 0.0) {
+    srslte_vec_abs_square_ema_cf(q->conv_output, q->ema_alpha, conv_output_avg, conv_output_len - 1);
+  } else {
+    srslte_vec_abs_square_cf(q->conv_output, conv_output_avg, conv_output_len - 1);
+  }
+
+  /* Find maximum of the absolute value of the correlation */
+  uint32_t corr_peak_pos = srslte_vec_max_fi(conv_output_avg, conv_output_len - 1);
+
+  // save absolute value
+  if (peak_value) {
+    *peak_value = conv_output_avg[corr_peak_pos];
+  }
+
+#ifdef SRSLTE_PSS_RETURN_PSR
+  if (corr_peak_value) {
+    *corr_peak_value = compute_peak_sidelobe(conv_output_avg, corr_peak_pos, conv_output_len);
+  }
+#else
+  if (corr_peak_value) {
+    *corr_peak_value = conv_output_avg[corr_peak_pos];
+  }
+#endif
+
+  if (q->decimate > 1) {
+    int decimation_correction = (q->filter.num_taps - 2);
+    corr_peak_pos             = corr_peak_pos - decimation_correction;
+    corr_peak_pos             = corr_peak_pos * q->decimate;
+  }
+
+  if (q->frame_size >= q->fft_size) {
+    return (int)corr_peak_pos;
+  } else {
+    return (int)corr_peak_pos + q->fft_size;
+  }
 }
 
 /** Performs time-domain PSS correlation.
@@ -454,89 +551,67 @@ int srslte_pss_find_pss(srslte_pss_t* q, const cf_t* input, float* corr_peak_val
 
   if (q != NULL && input != NULL) {
 
-    uint32_t corr_peak_pos;
-    uint32_t conv_output_len;
-
     if (!srslte_N_id_2_isvalid(q->N_id_2)) {
       ERROR("Error finding PSS peak, Must set N_id_2 first\n");
       return SRSLTE_ERROR;
     }
 
-    /* Correlate input with PSS sequence
-     *
-     * We do not reverse time-domain PSS signal because it's conjugate is symmetric.
-     * The conjugate operation on pss_signal_time has been done in srslte_pss_init_N_id_2
-     * This is why we can use FFT-based convolution
-     */
-    if (q->frame_size >= q->fft_size) {
-#ifdef CONVOLUTION_FFT
-      memcpy(q->tmp_input, input, (q->frame_size * q->decimate) * sizeof(cf_t));
-      if (q->decimate > 1) {
-        srslte_filt_decim_cc_execute(&(q->filter),
-                                     q->tmp_input,
-                                     q->filter.downsampled_input,
-                                     q->filter.filter_output,
-                                     (q->frame_size * q->decimate));
-        conv_output_len = srslte_conv_fft_cc_run_opt(
-            &q->conv_fft, q->filter.filter_output, q->pss_signal_freq_full[q->N_id_2], q->conv_output);
-      } else {
-        conv_output_len =
-            srslte_conv_fft_cc_run_opt(&q->conv_fft, q->tmp_input, q->pss_signal_freq_full[q->N_id_2], q->conv_output);
-      }
-
-#else
-      conv_output_len =
-          srslte_conv_cc(input, q->pss_signal_time[q->N_id_2], q->conv_output, q->frame_size, q->fft_size);
-#endif
-    } else {
-      for (int i = 0; i < q->frame_size; i++) {
-        q->conv_output[i] = srslte_vec_dot_prod_ccc(q->pss_signal_time[q->N_id_2], &input[i], q->fft_size);
-      }
-      conv_output_len = q->frame_size;
-    }
-
-    // Compute modulus square
-    srslte_vec_abs_square_cf(q->conv_output, q->conv_output_abs, conv_output_len - 1);
+    const cf_t* input_fft       = pss_input_fft(q, input);
+    uint32_t    conv_output_len = pss_correlate(q, input, input_fft, q->N_id_2);
 
-    // If enabled, average the absolute value from previous calls
-    if (q->ema_alpha < 1.0 && q->ema_alpha > 0.0) {
-      srslte_vec_sc_prod_fff(q->conv_output_abs, q->ema_alpha, q->conv_output_abs, conv_output_len - 1);
-      srslte_vec_sc_prod_fff(q->conv_output_avg, 1 - q->ema_alpha, q->conv_output_avg, conv_output_len - 1);
-
-      srslte_vec_sum_fff(q->conv_output_abs, q->conv_output_avg, q->conv_output_avg, conv_output_len - 1);
-    } else {
-      memcpy(q->conv_output_avg, q->conv_output_abs, sizeof(float) * (conv_output_len - 1));
-    }
-
-    /* Find maximum of the absolute value of the correlation */
-    corr_peak_pos = srslte_vec_max_fi(q->conv_output_avg, conv_output_len - 1);
+    ret = pss_find_peak(q, q->conv_output_avg, conv_output_len, &q->peak_value, corr_peak_value);
+  }
+  return ret;
+}
 
-    // save absolute value
-    q->peak_value = q->conv_output_avg[corr_peak_pos];
+/** Same as srslte_pss_find_pss() for an input that has just been passed to srslte_pss_find_pss() on prev, e.g. with
+ * another frequency offset. If both objects have the same dimensions, the transform of the input done by prev is
+ * reused and only the correlation with the PSS sequence of q is computed.
+ */
+int srslte_pss_find_pss_same_input(srslte_pss_t*       q,
+                                   const srslte_pss_t* prev,
+                                   const cf_t*         input,
+                                   float*              corr_peak_value)
+{
+  if (q == NULL || prev == NULL || input == NULL) {
+    return SRSLTE_ERROR_INVALID_INPUTS;
+  }
 
-#ifdef SRSLTE_PSS_RETURN_PSR
-    if (corr_peak_value) {
-      *corr_peak_value = compute_peak_sidelobe(q, corr_peak_pos, conv_output_len);
-    }
-#else
-    if (corr_peak_value) {
-      *corr_peak_value = q->conv_output_avg[corr_peak_pos];
+#ifdef CONVOLUTION_FFT
+  if (q->frame_size >= q->fft_size && q->frame_size == prev->frame_size && q->fft_size == prev->fft_size &&
+      q->decimate == prev->decimate && q->conv_fft.output_len == prev->conv_fft.output_len) {
+    if (!srslte_N_id_2_isvalid(q->N_id_2)) {
+      ERROR("Error finding PSS peak, Must set N_id_2 first\n");
+      return SRSLTE_ERROR;
     }
+    uint32_t conv_output_len = pss_correlate(q, input, prev->conv_fft.input_fft, q->N_id_2);
+    return pss_find_peak(q, q->conv_output_avg, conv_output_len, &q->peak_value, corr_peak_value);
+  }
 #endif
 
-    if (q->decimate > 1) {
-      int decimation_correction = (q->filter.num_taps - 2);
-      corr_peak_pos             = corr_peak_pos - decimation_correction;
-      corr_peak_pos             = corr_peak_pos * q->decimate;
-    }
+  return srslte_pss_find_pss(q, input, corr_peak_value);
+}
 
-    if (q->frame_size >= q->fft_size) {
-      ret = (int)corr_peak_pos;
-    } else {
-      ret = (int)corr_peak_pos + q->fft_size;
-    }
+/** Correlates the input with the PSS sequences of the three N_id_2 transforming the input once. For each N_id_2
+ * stores in peak_pos the position of the correlation peak, as returned by srslte_pss_find_pss(), and in
+ * corr_peak_value its value. The correlations are averaged independently of srslte_pss_find_pss().
+ */
+int srslte_pss_find_pss_all(srslte_pss_t* q, const cf_t* input, int peak_pos[3], float corr_peak_value[3])
+{
+  if (q == NULL || input == NULL || peak_pos == NULL) {
+    return SRSLTE_ERROR_INVALID_INPUTS;
   }
-  return ret;
+
+  const cf_t* input_fft = pss_input_fft(q, input);
+  for (uint32_t N_id_2 = 0; N_id_2 < 3; N_id_2++) {
+    uint32_t conv_output_len = pss_correlate(q, input, input_fft, N_id_2);
+    peak_pos[N_id_2]         = pss_find_peak(q,
+                                     q->conv_output_avg_N_id_2[N_id_2],
+                                     conv_output_len,
+                                     NULL,
+                                     corr_peak_value ? &corr_peak_value[N_id_2] : NULL);
+  }
+  return SRSLTE_SUCCESS;
 }
 
 /* Computes frequency-domain channel estimation of the PSS symbol
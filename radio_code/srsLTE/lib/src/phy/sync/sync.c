@@ -600,7 +600,9 @@ static int cfo_i_estimate(srslte_sync_t* q, const cf_t* input, int find_offset,
   srslte_pss_t* pss_obj[3]     = {&q->pss_i[0], &q->pss, &q->pss_i[1]};
   for (int cfo = 0; cfo < 3; cfo++) {
     srslte_pss_set_N_id_2(pss_obj[cfo], q->N_id_2);
-    int p = srslte_pss_find_pss(pss_obj[cfo], &input[find_offset], &peak_value);
+    // The three objects correlate the same input, so transform it only once
+    int p = cfo == 0 ? srslte_pss_find_pss(pss_obj[cfo], &input[find_offset], &peak_value)
+                     : srslte_pss_find_pss_same_input(pss_obj[cfo], pss_obj[0], &input[find_offset], &peak_value);
     if (p < 0) {
       return -1;
     }
@@ -619,6 +621,27 @@ static int cfo_i_estimate(srslte_sync_t* q, const cf_t* input, int find_offset,
   return 0;
 }
 
+/** Correlates the input with the PSS sequences of the three N_id_2 at once, after the CP-based CFO correction if it
+ * is enabled, and stores in psr the peak to side-lobe ratio of each N_id_2. Used to discard the N_id_2 without cells
+ * before searching them one by one. The state of srslte_sync_find() is not modified.
+ */
+int srslte_sync_find_pss_all(srslte_sync_t* q, const cf_t* input, float psr[3])
+{
+  if (q == NULL || input == NULL || psr == NULL || !fft_size_isvalid(q->fft_size)) {
+    return SRSLTE_ERROR_INVALID_INPUTS;
+  }
+
+  const cf_t* input_ptr = input;
+  if (q->cfo_cp_enable) {
+    float cfo_cp = cfo_cp_estimate(q, input_ptr);
+    srslte_cfo_correct(&q->cfo_corr_frame, input_ptr, q->temp, -cfo_cp / q->fft_size);
+    input_ptr = q->temp;
+  }
+
+  int peak_pos[3];
+  return srslte_pss_find_pss_all(&q->pss, input_ptr, peak_pos, psr);
+}
+
 /** Finds the PSS sequence previously defined by a call to srslte_sync_set_N_id_2()
  * around the position find_offset in the buffer input.
  *
@@ -84,6 +84,7 @@ int main(int argc, char** argv)
   int           cid, max_cid;
   uint32_t      find_idx;
   srslte_sync_t syncobj;
+  srslte_pss_t  pss;
   srslte_ofdm_t ifft;
   int           fft_size;
 
@@ -119,6 +120,12 @@ int main(int argc, char** argv)
 
   srslte_sync_set_cp(&syncobj, cp);
 
+  if (srslte_pss_init_fft(&pss, FLEN, fft_size)) {
+    ERROR("Error initiating PSS\n");
+    return -1;
+  }
+  srslte_pss_set_ema_alpha(&pss, 1.0);
+
   /* Set a very high threshold to make sure the correlation is ok */
   srslte_sync_set_threshold(&syncobj, 5.0);
   srslte_sync_set_sss_algorithm(&syncobj, SSS_PARTIAL_3);
@@ -159,6 +166,27 @@ int main(int argc, char** argv)
         ERROR("Error running srslte_sync_find\n");
         exit(-1);
       }
+      /* Correlating the three PSS at once must give the same result as one at a time */
+      int   peak_pos[3];
+      float peak_value[3];
+      if (srslte_pss_find_pss_all(&pss, fft_buffer, peak_pos, peak_value)) {
+        ERROR("Error running srslte_pss_find_pss_all\n");
+        exit(-1);
+      }
+      for (int i = 0; i < 3; i++) {
+        float value = 0;
+        srslte_pss_set_N_id_2(&pss, i);
+        int pos = srslte_pss_find_pss(&pss, fft_buffer, &value);
+        if (pos != peak_pos[i] || value != peak_value[i]) {
+          printf("PSS N_id_2=%d: find_pss_all %d/%.2f != find_pss %d/%.2f\n", i, peak_pos[i], peak_value[i], pos, value);
+          exit(-1);
+        }
+      }
+      if (peak_value[N_id_2] <= peak_value[(N_id_2 + 1) % 3] || peak_value[N_id_2] <= peak_value[(N_id_2 + 2) % 3]) {
+        printf("PSS N_id_2=%d not detected by find_pss_all\n", N_id_2);
+        exit(-1);
+      }
+
       find_sf = srslte_sync_get_sf_idx(&syncobj);
       printf("cell_id: %d find: %d, offset: %d, ns=%d find_ns=%d\n", cid, find_idx, offset, sf_idx, find_sf);
       if (find_idx != offset + FLEN / 2) {
@@ -181,6 +209,7 @@ int main(int argc, char** argv)
   free(buffer);
 
   srslte_sync_free(&syncobj);
+  srslte_pss_free(&pss);
   srslte_ofdm_tx_free(&ifft);
 
   printf("Ok\n");
@@ -188,6 +188,46 @@ int srslte_ue_cellsearch_set_nof_valid_frames(srslte_ue_cellsearch_t* q, uint32_
   }
 }
 
+void srslte_ue_cellsearch_set_pss_prescan(srslte_ue_cellsearch_t* q, bool enable)
+{
+  q->pss_prescan = enable;
+}
+
+/* Receives max_frames frames and correlates each of them with the three PSS sequences at once. Sets detected[N_id_2]
+ * if any frame reaches the find threshold for that N_id_2, so that the search can skip the N_id_2 without cells.
+ */
+static int cellsearch_pss_prescan(srslte_ue_cellsearch_t* q, bool detected[3])
+{
+  srslte_ue_sync_t* ue_sync = &q->ue_sync;
+
+  for (uint32_t N_id_2 = 0; N_id_2 < 3; N_id_2++) {
+    detected[N_id_2] = false;
+  }
+
+  srslte_sync_reset(&ue_sync->sfind);
+  for (uint32_t nof_frames = 0; nof_frames < q->max_frames; nof_frames++) {
+    if (ue_sync->recv_callback(ue_sync->stream, q->sf_buffer, ue_sync->frame_len, &ue_sync->last_timestamp) < 0) {
+      ERROR("Error receiving samples\n");
+      return SRSLTE_ERROR;
+    }
+
+    float psr[3];
+    if (srslte_sync_find_pss_all(&ue_sync->sfind, q->sf_buffer[0], psr)) {
+      ERROR("Error correlating PSS\n");
+      return SRSLTE_ERROR;
+    }
+    for (uint32_t N_id_2 = 0; N_id_2 < 3; N_id_2++) {
+      detected[N_id_2] |= psr[N_id_2] >= ue_sync->sfind.threshold;
+    }
+  }
+
+  INFO("CELL SEARCH: PSS prescan N_id_2=0: %s, N_id_2=1: %s, N_id_2=2: %s\n",
+       detected[0] ? "yes" : "no",
+       detected[1] ? "yes" : "no",
+       detected[2] ? "yes" : "no");
+  return SRSLTE_SUCCESS;
+}
+
 /* Decide the most likely cell based on the mode */
 static void get_cell(srslte_ue_cellsearch_t* q, uint32_t nof_detected_frames, srslte_ue_cellsearch_result_t* found_cell)
 {
@@ -264,8 +304,19 @@ int srslte_ue_cellsearch_scan(srslte_ue_cellsearch_t*       q,
   int      ret                = 0;
   float    max_peak_value     = -1.0;
   uint32_t nof_detected_cells = 0;
+  bool     detected[3]        = {true, true, true};
+
+  // File sources are read by ue_sync itself, so only prescan when receiving from the radio
+  if (q->pss_prescan && !q->ue_sync.file_mode) {
+    if (cellsearch_pss_prescan(q, detected)) {
+      return SRSLTE_ERROR;
+    }
+  }
 
   for (uint32_t N_id_2 = 0; N_id_2 < 3 && ret >= 0; N_id_2++) {
+    if (!detected[N_id_2]) {
+      continue;
+    }
     INFO("CELL SEARCH: Starting scan for N_id_2=%d\n", N_id_2);
     ret = srslte_ue_cellsearch_scan_N_id_2(q, N_id_2, &found_cells[N_id_2]);
     if (ret < 0) {
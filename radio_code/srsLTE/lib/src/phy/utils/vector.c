@@ -576,6 +576,11 @@ void srslte_vec_abs_square_cf(const cf_t* x, float* abs_square, const uint32_t l
   srslte_vec_abs_square_cf_simd(x, abs_square, len);
 }
 
+void srslte_vec_abs_square_ema_cf(const cf_t* x, const float alpha, float* y, const uint32_t len)
+{
+  srslte_vec_abs_square_ema_cf_simd(x, alpha, y, len);
+}
+
 uint32_t srslte_vec_max_fi(const float* x, const uint32_t len)
 {
   return srslte_vec_max_fi_simd(x, len);
@@ -1265,6 +1265,50 @@ void srslte_vec_abs_square_cf_simd(const cf_t* x, float* z, const int len)
   }
 }
 
+void srslte_vec_abs_square_ema_cf_simd(const cf_t* x, const float alpha, float* y, const int len)
+{
+  int i = 0;
+
+#if SRSLTE_SIMD_F_SIZE
+  simd_f_t a  = srslte_simd_f_set1(alpha);
+  simd_f_t a1 = srslte_simd_f_set1(1.0f - alpha);
+  if (SRSLTE_IS_ALIGNED(x) && SRSLTE_IS_ALIGNED(y)) {
+    for (; i < len - SRSLTE_SIMD_F_SIZE + 1; i += SRSLTE_SIMD_F_SIZE) {
+      simd_f_t x1 = srslte_simd_f_load((float*)&x[i]);
+      simd_f_t x2 = srslte_simd_f_load((float*)&x[i + SRSLTE_SIMD_F_SIZE / 2]);
+      simd_f_t y1 = srslte_simd_f_load(&y[i]);
+
+      simd_f_t mul1 = srslte_simd_f_mul(x1, x1);
+      simd_f_t mul2 = srslte_simd_f_mul(x2, x2);
+
+      simd_f_t z1 = srslte_simd_f_hadd(mul1, mul2);
+      z1          = srslte_simd_f_add(srslte_simd_f_mul(z1, a), srslte_simd_f_mul(y1, a1));
+
+      srslte_simd_f_store(&y[i], z1);
+    }
+  } else {
+    for (; i < len - SRSLTE_SIMD_F_SIZE + 1; i += SRSLTE_SIMD_F_SIZE) {
+      simd_f_t x1 = srslte_simd_f_loadu((float*)&x[i]);
+      simd_f_t x2 = srslte_simd_f_loadu((float*)&x[i + SRSLTE_SIMD_F_SIZE / 2]);
+      simd_f_t y1 = srslte_simd_f_loadu(&y[i]);
+
+      simd_f_t mul1 = srslte_simd_f_mul(x1, x1);
+      simd_f_t mul2 = srslte_simd_f_mul(x2, x2);
+
+      simd_f_t z1 = srslte_simd_f_hadd(mul1, mul2);
+      z1          = srslte_simd_f_add(srslte_simd_f_mul(z1, a), srslte_simd_f_mul(y1, a1));
+
+      srslte_simd_f_storeu(&y[i], z1);
+    }
+  }
+#endif
+
+  for (; i < len; i++) {
+    float abs_square = __real__(x[i]) * __real__(x[i]) + __imag__(x[i]) * __imag__(x[i]);
+    y[i]             = abs_square * alpha + y[i] * (1.0f - alpha);
+  }
+}
+
 void srslte_vec_sc_prod_cfc_simd(const cf_t* x, const float h, cf_t* z, const int len)
 {
   int i = 0;
@@ -168,6 +168,7 @@ void radio::stop()
   }
   if (is_initialized) {
     srslte_rf_close(&rf_device);
+    is_initialized = false;
   }
 }
 
@@ -93,6 +93,16 @@ void pdcp::write_sdu(uint32_t lcid, unique_byte_buffer_t sdu, bool blocking)
   }
 }
 
+void pdcp::write_sdu_burst(uint32_t lcid, unique_byte_buffer_list_t& sdus, bool blocking)
+{
+  if (valid_lcid(lcid)) {
+    pdcp_array.at(lcid)->write_sdu_burst(sdus, blocking);
+  } else {
+    pdcp_log->warning("Writing sdu burst: lcid=%d. Deallocating %zd sdus\n", lcid, sdus.size());
+    sdus.clear();
+  }
+}
+
 void pdcp::write_sdu_mch(uint32_t lcid, unique_byte_buffer_t sdu)
 {
   if (valid_mch_lcid(lcid)) {
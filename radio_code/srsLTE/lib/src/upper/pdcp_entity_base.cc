@@ -46,6 +46,22 @@ void pdcp_entity_base::config_security(as_security_config_t sec_cfg_)
   log->debug_hex(sec_cfg.k_up_enc.data(), 32, "K_up_enc");
   log->debug_hex(sec_cfg.k_rrc_int.data(), 32, "K_rrc_int");
   log->debug_hex(sec_cfg.k_up_int.data(), 32, "K_up_int");
+
+  // Expand the 128-bit keys (upper half of the derived keys) once instead of on every PDU
+  if (sec_cfg.cipher_algo == CIPHERING_ALGORITHM_ID_128_EEA2) {
+    rrc_enc_ctx.set_key(&sec_cfg.k_rrc_enc[16]);
+    up_enc_ctx.set_key(&sec_cfg.k_up_enc[16]);
+  } else {
+    rrc_enc_ctx.reset();
+    up_enc_ctx.reset();
+  }
+  if (sec_cfg.integ_algo == INTEGRITY_ALGORITHM_ID_128_EIA2) {
+    rrc_int_ctx.set_key(&sec_cfg.k_rrc_int[16]);
+    up_int_ctx.set_key(&sec_cfg.k_up_int[16]);
+  } else {
+    rrc_int_ctx.reset();
+    up_int_ctx.reset();
+  }
 }
 
 /****************************************************************************
@@ -53,13 +69,16 @@ void pdcp_entity_base::config_security(as_security_config_t sec_cfg_)
  ***************************************************************************/
 void pdcp_entity_base::integrity_generate(uint8_t* msg, uint32_t msg_len, uint32_t count, uint8_t* mac)
 {
-  uint8_t* k_int;
+  uint8_t*                k_int;
+  const security_aes_ctx* int_ctx;
 
   // If control plane use RRC integrity key. If data use user plane key
   if (is_srb()) {
-    k_int = sec_cfg.k_rrc_int.data();
+    k_int   = sec_cfg.k_rrc_int.data();
+    int_ctx = &rrc_int_ctx;
   } else {
-    k_int = sec_cfg.k_up_int.data();
+    k_int   = sec_cfg.k_up_int.data();
+    int_ctx = &up_int_ctx;
   }
 
   switch (sec_cfg.integ_algo) {
@@ -69,7 +88,7 @@ void pdcp_entity_base::integrity_generate(uint8_t* msg, uint32_t msg_len, uint32
       security_128_eia1(&k_int[16], count, cfg.bearer_id - 1, cfg.tx_direction, msg, msg_len, mac);
       break;
     case INTEGRITY_ALGORITHM_ID_128_EIA2:
-      security_128_eia2(&k_int[16], count, cfg.bearer_id - 1, cfg.tx_direction, msg, msg_len, mac);
+      security_128_eia2(*int_ctx, count, cfg.bearer_id - 1, cfg.tx_direction, msg, msg_len, mac);
       break;
     case INTEGRITY_ALGORITHM_ID_128_EIA3:
       security_128_eia3(&k_int[16], count, cfg.bearer_id - 1, cfg.tx_direction, msg, msg_len, mac);
@@ -88,15 +107,18 @@ void pdcp_entity_base::integrity_generate(uint8_t* msg, uint32_t msg_len, uint32
 
 bool pdcp_entity_base::integrity_verify(uint8_t* msg, uint32_t msg_len, uint32_t count, uint8_t* mac)
 {
-  uint8_t  mac_exp[4] = {};
-  bool     is_valid   = true;
-  uint8_t* k_int;
+  uint8_t                 mac_exp[4] = {};
+  bool                    is_valid   = true;
+  uint8_t*                k_int;
+  const security_aes_ctx* int_ctx;
 
   // If control plane use RRC integrity key. If data use user plane key
   if (is_srb()) {
-    k_int = sec_cfg.k_rrc_int.data();
+    k_int   = sec_cfg.k_rrc_int.data();
+    int_ctx = &rrc_int_ctx;
   } else {
-    k_int = sec_cfg.k_up_int.data();
+    k_int   = sec_cfg.k_up_int.data();
+    int_ctx = &up_int_ctx;
   }
 
   switch (sec_cfg.integ_algo) {
@@ -106,7 +128,7 @@ bool pdcp_entity_base::integrity_verify(uint8_t* msg, uint32_t msg_len, uint32_t
       security_128_eia1(&k_int[16], count, cfg.bearer_id - 1, cfg.rx_direction, msg, msg_len, mac_exp);
       break;
     case INTEGRITY_ALGORITHM_ID_128_EIA2:
-      security_128_eia2(&k_int[16], count, cfg.bearer_id - 1, cfg.rx_direction, msg, msg_len, mac_exp);
+      security_128_eia2(*int_ctx, count, cfg.bearer_id - 1, cfg.rx_direction, msg, msg_len, mac_exp);
       break;
     case INTEGRITY_ALGORITHM_ID_128_EIA3:
       security_128_eia3(&k_int[16], count, cfg.bearer_id - 1, cfg.rx_direction, msg, msg_len, mac_exp);
@@ -140,14 +162,17 @@ bool pdcp_entity_base::integrity_verify(uint8_t* msg, uint32_t msg_len, uint32_t
 
 void pdcp_entity_base::cipher_encrypt(uint8_t* msg, uint32_t msg_len, uint32_t count, uint8_t* ct)
 {
-  uint8_t* k_enc;
-  uint8_t  ct_tmp[PDCP_MAX_SDU_SIZE];
+  uint8_t*                k_enc;
+  const security_aes_ctx* enc_ctx;
+  uint8_t                 ct_tmp[PDCP_MAX_SDU_SIZE];
 
   // If control plane use RRC encrytion key. If data use user plane key
   if (is_srb()) {
-    k_enc = sec_cfg.k_rrc_enc.data();
+    k_enc   = sec_cfg.k_rrc_enc.data();
+    enc_ctx = &rrc_enc_ctx;
   } else {
-    k_enc = sec_cfg.k_up_enc.data();
+    k_enc   = sec_cfg.k_up_enc.data();
+    enc_ctx = &up_enc_ctx;
   }
 
   log->debug("Cipher encrypt input: COUNT: %" PRIu32 ", Bearer ID: %d, Direction %s\n",
@@ -164,8 +189,8 @@ void pdcp_entity_base::cipher_encrypt(uint8_t* msg, uint32_t msg_len, uint32_t c
       memcpy(ct, ct_tmp, msg_len);
       break;
     case CIPHERING_ALGORITHM_ID_128_EEA2:
-      security_128_eea2(&(k_enc[16]), count, cfg.bearer_id - 1, cfg.tx_direction, msg, msg_len, ct_tmp);
-      memcpy(ct, ct_tmp, msg_len);
+      // CTR mode can work in place
+      security_128_eea2(*enc_ctx, count, cfg.bearer_id - 1, cfg.tx_direction, msg, msg_len, ct);
       break;
     case CIPHERING_ALGORITHM_ID_128_EEA3:
       security_128_eea3(&(k_enc[16]), count, cfg.bearer_id - 1, cfg.tx_direction, msg, msg_len, ct_tmp);
@@ -179,14 +204,17 @@ void pdcp_entity_base::cipher_encrypt(uint8_t* msg, uint32_t msg_len, uint32_t c
 
 void pdcp_entity_base::cipher_decrypt(uint8_t* ct, uint32_t ct_len, uint32_t count, uint8_t* msg)
 {
-  uint8_t* k_enc;
-  uint8_t  msg_tmp[PDCP_MAX_SDU_SIZE];
+  uint8_t*                k_enc;
+  const security_aes_ctx* enc_ctx;
+  uint8_t                 msg_tmp[PDCP_MAX_SDU_SIZE];
 
   // If control plane use RRC encrytion key. If data use user plane key
   if (is_srb()) {
-    k_enc = sec_cfg.k_rrc_enc.data();
+    k_enc   = sec_cfg.k_rrc_enc.data();
+    enc_ctx = &rrc_enc_ctx;
   } else {
-    k_enc = sec_cfg.k_up_enc.data();
+    k_enc   = sec_cfg.k_up_enc.data();
+    enc_ctx = &up_enc_ctx;
   }
 
   log->debug("Cipher decrypt input: COUNT: %" PRIu32 ", Bearer ID: %d, Direction %s\n",
@@ -203,8 +231,7 @@ void pdcp_entity_base::cipher_decrypt(uint8_t* ct, uint32_t ct_len, uint32_t cou
       memcpy(msg, msg_tmp, ct_len);
       break;
     case CIPHERING_ALGORITHM_ID_128_EEA2:
-      security_128_eea2(&k_enc[16], count, cfg.bearer_id - 1, cfg.rx_direction, ct, ct_len, msg_tmp);
-      memcpy(msg, msg_tmp, ct_len);
+      security_128_eea2(*enc_ctx, count, cfg.bearer_id - 1, cfg.rx_direction, ct, ct_len, msg);
       break;
     case CIPHERING_ALGORITHM_ID_128_EEA3:
       security_128_eea3(&k_enc[16], count, cfg.bearer_id - 1, cfg.rx_direction, ct, ct_len, msg_tmp);
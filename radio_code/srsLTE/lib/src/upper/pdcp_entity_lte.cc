@@ -104,12 +104,7 @@ void pdcp_entity_lte::reset()
 // GW/RRC interface
 void pdcp_entity_lte::write_sdu(unique_byte_buffer_t sdu, bool blocking)
 {
-  // check for pending security config in transmit direction
-  if (enable_security_tx_sn != -1 && enable_security_tx_sn == static_cast<int32_t>(tx_count)) {
-    enable_integrity(DIRECTION_TX);
-    enable_encryption(DIRECTION_TX);
-    enable_security_tx_sn = -1;
-  }
+  check_security_tx();
 
   log->info_hex(sdu->msg,
                 sdu->N_bytes,
@@ -119,6 +114,47 @@ void pdcp_entity_lte::write_sdu(unique_byte_buffer_t sdu, bool blocking)
                 srslte_direction_text[integrity_direction],
                 srslte_direction_text[encryption_direction]);
 
+  process_tx_sdu(sdu);
+
+  rlc->write_sdu(lcid, std::move(sdu), blocking);
+}
+
+// Processes a burst of SDUs of this bearer and hands them to RLC in a single call
+void pdcp_entity_lte::write_sdu_burst(unique_byte_buffer_list_t& sdus, bool blocking)
+{
+  if (sdus.empty()) {
+    return;
+  }
+
+  log->info("TX %s SDU burst, %zd SDUs, SN=%d, integrity=%s, encryption=%s\n",
+            rrc->get_rb_name(lcid).c_str(),
+            sdus.size(),
+            tx_count,
+            srslte_direction_text[integrity_direction],
+            srslte_direction_text[encryption_direction]);
+
+  for (auto& sdu : sdus) {
+    check_security_tx();
+    log->debug_hex(sdu->msg, sdu->N_bytes, "TX %s SDU, SN=%d", rrc->get_rb_name(lcid).c_str(), tx_count);
+    process_tx_sdu(sdu);
+  }
+
+  rlc->write_sdu_burst(lcid, sdus, blocking);
+}
+
+// Check for pending security config in transmit direction
+void pdcp_entity_lte::check_security_tx()
+{
+  if (enable_security_tx_sn != -1 && enable_security_tx_sn == static_cast<int32_t>(tx_count)) {
+    enable_integrity(DIRECTION_TX);
+    enable_encryption(DIRECTION_TX);
+    enable_security_tx_sn = -1;
+  }
+}
+
+// Adds header and MAC, ciphers the SDU and advances TX COUNT
+void pdcp_entity_lte::process_tx_sdu(const unique_byte_buffer_t& sdu)
+{
   write_data_header(sdu, tx_count);
 
   // Append MAC (SRBs only)
@@ -138,8 +174,6 @@ void pdcp_entity_lte::write_sdu(unique_byte_buffer_t sdu, bool blocking)
     log->info_hex(sdu->msg, sdu->N_bytes, "TX %s SDU (encrypted)", rrc->get_rb_name(lcid).c_str());
   }
   tx_count++;
-
-  rlc->write_sdu(lcid, std::move(sdu), blocking);
 }
 
 // RLC interface
@@ -41,15 +41,15 @@ rlc::~rlc()
   {
     rwlock_write_guard lock(rwlock);
 
-    for (rlc_map_t::iterator it = rlc_array.begin(); it != rlc_array.end(); ++it) {
-      delete (it->second);
+    for (rlc_common*& rlc_entity : rlc_array) {
+      delete rlc_entity;
+      rlc_entity = nullptr;
     }
-    rlc_array.clear();
 
-    for (rlc_map_t::iterator it = rlc_array_mrb.begin(); it != rlc_array_mrb.end(); ++it) {
-      delete (it->second);
+    for (rlc_common*& rlc_entity : rlc_array_mrb) {
+      delete rlc_entity;
+      rlc_entity = nullptr;
     }
-    rlc_array_mrb.clear();
   }
 
   pthread_rwlock_destroy(&rwlock);
@@ -74,22 +74,30 @@ void rlc::init(srsue::pdcp_interface_rlc* pdcp_,
 
 void rlc::reset_metrics()
 {
-  for (rlc_map_t::iterator it = rlc_array.begin(); it != rlc_array.end(); ++it) {
-    it->second->reset_metrics();
+  for (rlc_common* rlc_entity : rlc_array) {
+    if (rlc_entity != nullptr) {
+      rlc_entity->reset_metrics();
+    }
   }
 
-  for (rlc_map_t::iterator it = rlc_array_mrb.begin(); it != rlc_array_mrb.end(); ++it) {
-    it->second->reset_metrics();
+  for (rlc_common* rlc_entity : rlc_array_mrb) {
+    if (rlc_entity != nullptr) {
+      rlc_entity->reset_metrics();
+    }
   }
 }
 
 void rlc::stop()
 {
-  for (rlc_map_t::iterator it = rlc_array.begin(); it != rlc_array.end(); ++it) {
-    it->second->stop();
+  for (rlc_common* rlc_entity : rlc_array) {
+    if (rlc_entity != nullptr) {
+      rlc_entity->stop();
+    }
   }
-  for (rlc_map_t::iterator it = rlc_array_mrb.begin(); it != rlc_array_mrb.end(); ++it) {
-    it->second->stop();
+  for (rlc_common* rlc_entity : rlc_array_mrb) {
+    if (rlc_entity != nullptr) {
+      rlc_entity->stop();
+    }
   }
 }
 
@@ -99,22 +107,28 @@ void rlc::get_metrics(rlc_metrics_t& m)
   get_time_interval(metrics_time);
   double secs = (double)metrics_time[0].tv_sec + metrics_time[0].tv_usec * 1e-6;
 
-  for (rlc_map_t::iterator it = rlc_array.begin(); it != rlc_array.end(); ++it) {
-    rlc_bearer_metrics_t metrics = it->second->get_metrics();
+  for (uint32_t lcid = 0; lcid < SRSLTE_N_RADIO_BEARERS; lcid++) {
+    if (rlc_array[lcid] == nullptr) {
+      continue;
+    }
+    rlc_bearer_metrics_t metrics = rlc_array[lcid]->get_metrics();
     rlc_log->info("LCID=%d, RX throughput: %4.6f Mbps. TX throughput: %4.6f Mbps.\n",
-                  it->first,
+                  lcid,
                   (metrics.num_rx_bytes * 8 / static_cast<double>(1e6)) / secs,
                   (metrics.num_tx_bytes * 8 / static_cast<double>(1e6)) / secs);
-    m.bearer[it->first] = metrics;
+    m.bearer[lcid] = metrics;
   }
 
   // Add multicast metrics
-  for (rlc_map_t::iterator it = rlc_array_mrb.begin(); it != rlc_array_mrb.end(); ++it) {
-    rlc_bearer_metrics_t metrics = it->second->get_metrics();
+  for (uint32_t lcid = 0; lcid < SRSLTE_N_MCH_LCIDS; lcid++) {
+    if (rlc_array_mrb[lcid] == nullptr) {
+      continue;
+    }
+    rlc_bearer_metrics_t metrics = rlc_array_mrb[lcid]->get_metrics();
     rlc_log->info("MCH_LCID=%d, RX throughput: %4.6f Mbps\n",
-                  it->first,
+                  lcid,
                   (metrics.num_rx_bytes * 8 / static_cast<double>(1e6)) / secs);
-    m.bearer[it->first] = metrics;
+    m.bearer[lcid] = metrics;
   }
 
   memcpy(&metrics_time[1], &metrics_time[2], sizeof(struct timeval));
@@ -124,12 +138,16 @@ void rlc::get_metrics(rlc_metrics_t& m)
 // Reestablish all RLC bearer
 void rlc::reestablish()
 {
-  for (rlc_map_t::iterator it = rlc_array.begin(); it != rlc_array.end(); ++it) {
-    it->second->reestablish();
+  for (rlc_common* rlc_entity : rlc_array) {
+    if (rlc_entity != nullptr) {
+      rlc_entity->reestablish();
+    }
   }
 
-  for (rlc_map_t::iterator it = rlc_array_mrb.begin(); it != rlc_array_mrb.end(); ++it) {
-    it->second->reestablish();
+  for (rlc_common* rlc_entity : rlc_array_mrb) {
+    if (rlc_entity != nullptr) {
+      rlc_entity->reestablish();
+    }
   }
 }
 
@@ -138,7 +156,7 @@ void rlc::reestablish(uint32_t lcid)
 {
   if (valid_lcid(lcid)) {
     rlc_log->info("Reestablishing LCID %d\n", lcid);
-    rlc_array.at(lcid)->reestablish();
+    rlc_array[lcid]->reestablish();
   } else {
     rlc_log->warning("RLC LCID %d doesn't exist. Deallocating SDU\n", lcid);
   }
@@ -151,11 +169,13 @@ void rlc::reset()
   {
     rwlock_write_guard lock(rwlock);
 
-    for (rlc_map_t::iterator it = rlc_array.begin(); it != rlc_array.end(); ++it) {
-      it->second->stop();
-      delete (it->second);
+    for (rlc_common*& rlc_entity : rlc_array) {
+      if (rlc_entity != nullptr) {
+        rlc_entity->stop();
+        delete rlc_entity;
+        rlc_entity = nullptr;
+      }
     }
-    rlc_array.clear();
     // the multicast bearer (MRB) is not removed here because eMBMS services continue to be streamed in idle mode (3GPP TS 23.246 version 14.1.0 Release 14 section 8)
   }
 
@@ -166,8 +186,10 @@ void rlc::reset()
 void rlc::empty_queue()
 {
   // Empty Tx queue, not needed for MCH bearers
-  for (rlc_map_t::iterator it = rlc_array.begin(); it != rlc_array.end(); ++it) {
-    it->second->empty_queue();
+  for (rlc_common* rlc_entity : rlc_array) {
+    if (rlc_entity != nullptr) {
+      rlc_entity->empty_queue();
+    }
   }
 }
 
@@ -184,16 +206,36 @@ void rlc::write_sdu(uint32_t lcid, unique_byte_buffer_t sdu, bool blocking)
   }
 
   if (valid_lcid(lcid)) {
-    rlc_array.at(lcid)->write_sdu_s(std::move(sdu), blocking);
+    rlc_array[lcid]->write_sdu_s(std::move(sdu), blocking);
   } else {
     rlc_log->warning("RLC LCID %d doesn't exist. Deallocating SDU\n", lcid);
   }
 }
 
+void rlc::write_sdu_burst(uint32_t lcid, unique_byte_buffer_list_t& sdus, bool blocking)
+{
+  if (not valid_lcid(lcid)) {
+    rlc_log->warning("RLC LCID %d doesn't exist. Deallocating %zd SDUs\n", lcid, sdus.size());
+    sdus.clear();
+    return;
+  }
+
+  rlc_common* rlc_entity = rlc_array[lcid];
+  for (auto& sdu : sdus) {
+    // TODO: rework build PDU logic to allow large SDUs (without concatenation)
+    if (sdu->N_bytes > RLC_MAX_SDU_SIZE) {
+      rlc_log->warning("Dropping too long SDU of size %d B (Max. size %d B).\n", sdu->N_bytes, RLC_MAX_SDU_SIZE);
+      continue;
+    }
+    rlc_entity->write_sdu_s(std::move(sdu), blocking);
+  }
+  sdus.clear();
+}
+
 void rlc::write_sdu_mch(uint32_t lcid, unique_byte_buffer_t sdu)
 {
   if (valid_lcid_mrb(lcid)) {
-    rlc_array_mrb.at(lcid)->write_sdu(std::move(sdu), false); // write in non-blocking mode by default
+    rlc_array_mrb[lcid]->write_sdu(std::move(sdu), false); // write in non-blocking mode by default
   } else {
     rlc_log->warning("RLC LCID %d doesn't exist. Deallocating SDU\n", lcid);
   }
@@ -204,7 +246,7 @@ bool rlc::rb_is_um(uint32_t lcid)
   bool ret = false;
 
   if (valid_lcid(lcid)) {
-    ret = rlc_array.at(lcid)->get_mode() == rlc_mode_t::um;
+    ret = rlc_array[lcid]->get_mode() == rlc_mode_t::um;
   } else {
     rlc_log->warning("LCID %d doesn't exist.\n", lcid);
   }
@@ -215,7 +257,7 @@ bool rlc::rb_is_um(uint32_t lcid)
 void rlc::discard_sdu(uint32_t lcid, uint32_t discard_sn)
 {
   if (valid_lcid(lcid)) {
-    rlc_array.at(lcid)->discard_sdu(discard_sn);
+    rlc_array[lcid]->discard_sdu(discard_sn);
   } else {
     rlc_log->warning("RLC LCID %d doesn't exist. Ignoring discard SDU\n", lcid);
   }
@@ -229,7 +271,7 @@ bool rlc::has_data(uint32_t lcid)
   bool has_data = false;
 
   if (valid_lcid(lcid)) {
-    has_data = rlc_array.at(lcid)->has_data();
+    has_data = rlc_array[lcid]->has_data();
   }
 
   return has_data;
@@ -239,7 +281,7 @@ bool rlc::is_suspended(const uint32_t lcid)
   bool ret = false;
 
   if (valid_lcid(lcid)) {
-    ret = rlc_array.at(lcid)->is_suspended();
+    ret = rlc_array[lcid]->is_suspended();
   }
 
   return ret;
@@ -251,10 +293,10 @@ uint32_t rlc::get_buffer_state(uint32_t lcid)
 
   rwlock_read_guard lock(rwlock);
   if (valid_lcid(lcid)) {
-    if (rlc_array.at(lcid)->is_suspended()) {
+    if (rlc_array[lcid]->is_suspended()) {
       ret = 0;
     } else {
-      ret = rlc_array.at(lcid)->get_buffer_state();
+      ret = rlc_array[lcid]->get_buffer_state();
     }
   }
 
@@ -268,7 +310,7 @@ uint32_t rlc::get_total_mch_buffer_state(uint32_t lcid)
   rwlock_read_guard lock(rwlock);
 
   if (valid_lcid_mrb(lcid)) {
-    ret = rlc_array_mrb.at(lcid)->get_buffer_state();
+    ret = rlc_array_mrb[lcid]->get_buffer_state();
   }
 
   return ret;
@@ -280,7 +322,7 @@ int rlc::read_pdu(uint32_t lcid, uint8_t* payload, uint32_t nof_bytes)
 
   rwlock_read_guard lock(rwlock);
   if (valid_lcid(lcid)) {
-    ret = rlc_array.at(lcid)->read_pdu(payload, nof_bytes);
+    ret = rlc_array[lcid]->read_pdu(payload, nof_bytes);
   } else {
     rlc_log->warning("LCID %d doesn't exist.\n", lcid);
   }
@@ -294,7 +336,7 @@ int rlc::read_pdu_mch(uint32_t lcid, uint8_t* payload, uint32_t nof_bytes)
 
   rwlock_read_guard lock(rwlock);
   if (valid_lcid_mrb(lcid)) {
-    ret = rlc_array_mrb.at(lcid)->read_pdu(payload, nof_bytes);
+    ret = rlc_array_mrb[lcid]->read_pdu(payload, nof_bytes);
   } else {
     rlc_log->warning("LCID %d doesn't exist.\n", lcid);
   }
@@ -305,7 +347,7 @@ int rlc::read_pdu_mch(uint32_t lcid, uint8_t* payload, uint32_t nof_bytes)
 void rlc::write_pdu(uint32_t lcid, uint8_t* payload, uint32_t nof_bytes)
 {
   if (valid_lcid(lcid)) {
-    rlc_array.at(lcid)->write_pdu_s(payload, nof_bytes);
+    rlc_array[lcid]->write_pdu_s(payload, nof_bytes);
   } else {
     rlc_log->warning("LCID %d doesn't exist. Dropping PDU.\n", lcid);
   }
@@ -343,7 +385,7 @@ void rlc::write_pdu_pcch(srslte::unique_byte_buffer_t pdu)
 void rlc::write_pdu_mch(uint32_t lcid, uint8_t* payload, uint32_t nof_bytes)
 {
   if (valid_lcid_mrb(lcid)) {
-    rlc_array_mrb.at(lcid)->write_pdu(payload, nof_bytes);
+    rlc_array_mrb[lcid]->write_pdu(payload, nof_bytes);
   }
 }
 
@@ -357,6 +399,11 @@ void rlc::add_bearer(uint32_t lcid, const rlc_config_t& cnfg)
 
   rlc_common* rlc_entity = NULL;
 
+  if (lcid >= SRSLTE_N_RADIO_BEARERS) {
+    rlc_log->error("Cannot add RLC entity - radio bearer id must be in [0:%d] - %d\n", SRSLTE_N_RADIO_BEARERS, lcid);
+    return;
+  }
+
   if (not valid_lcid(lcid)) {
     if (cnfg.rat == srslte_rat_t::lte) {
       switch (cnfg.rlc_mode) {
@@ -392,17 +439,14 @@ void rlc::add_bearer(uint32_t lcid, const rlc_config_t& cnfg)
       return;
     }
 
-    if (not rlc_array.insert(rlc_map_pair_t(lcid, rlc_entity)).second) {
-      rlc_log->error("Error inserting RLC entity in to array\n.");
-      goto delete_and_exit;
-    }
+    rlc_array[lcid] = rlc_entity;
     rlc_log->info("Added radio bearer %s in %s\n", rrc->get_rb_name(lcid).c_str(), to_string(cnfg.rlc_mode).c_str());
     rlc_entity = NULL;
   }
 
   // configure and add to array
-  if (cnfg.rlc_mode != rlc_mode_t::tm and rlc_array.find(lcid) != rlc_array.end()) {
-    if (not rlc_array.at(lcid)->configure(cnfg)) {
+  if (cnfg.rlc_mode != rlc_mode_t::tm and rlc_array[lcid] != nullptr) {
+    if (not rlc_array[lcid]->configure(cnfg)) {
       rlc_log->error("Error configuring RLC entity\n.");
       goto delete_and_exit;
     }
@@ -421,6 +465,11 @@ void rlc::add_bearer_mrb(uint32_t lcid)
   rwlock_write_guard lock(rwlock);
   rlc_common*        rlc_entity = NULL;
 
+  if (lcid >= SRSLTE_N_MCH_LCIDS) {
+    rlc_log->error("Cannot add RLC entity - MCH LCID must be in [0:%d] - %d\n", SRSLTE_N_MCH_LCIDS, lcid);
+    return;
+  }
+
   if (not valid_lcid_mrb(lcid)) {
     rlc_entity = new rlc_um_lte(rlc_log, lcid, pdcp, rrc, timers);
     // configure and add to array
@@ -428,12 +477,7 @@ void rlc::add_bearer_mrb(uint32_t lcid)
       rlc_log->error("Error configuring RLC entity\n.");
       goto delete_and_exit;
     }
-    if (rlc_array_mrb.count(lcid) == 0) {
-      if (not rlc_array_mrb.insert(rlc_map_pair_t(lcid, rlc_entity)).second) {
-        rlc_log->error("Error inserting RLC entity in to array\n.");
-        goto delete_and_exit;
-      }
-    }
+    rlc_array_mrb[lcid] = rlc_entity;
     rlc_log->warning("Added bearer MRB%d with mode RLC_UM\n", lcid);
     return;
   } else {
@@ -451,10 +495,9 @@ void rlc::del_bearer(uint32_t lcid)
   rwlock_write_guard lock(rwlock);
 
   if (valid_lcid(lcid)) {
-    rlc_map_t::iterator it = rlc_array.find(lcid);
-    it->second->stop();
-    delete (it->second);
-    rlc_array.erase(it);
+    rlc_array[lcid]->stop();
+    delete rlc_array[lcid];
+    rlc_array[lcid] = nullptr;
     rlc_log->warning("Deleted RLC bearer %s\n", rrc->get_rb_name(lcid).c_str());
   } else {
     rlc_log->error("Can't delete bearer %s. Bearer doesn't exist.\n", rrc->get_rb_name(lcid).c_str());
@@ -466,10 +509,9 @@ void rlc::del_bearer_mrb(uint32_t lcid)
   rwlock_write_guard lock(rwlock);
 
   if (valid_lcid_mrb(lcid)) {
-    rlc_map_t::iterator it = rlc_array_mrb.find(lcid);
-    it->second->stop();
-    delete (it->second);
-    rlc_array_mrb.erase(it);
+    rlc_array_mrb[lcid]->stop();
+    delete rlc_array_mrb[lcid];
+    rlc_array_mrb[lcid] = nullptr;
     rlc_log->warning("Deleted RLC MRB bearer %s\n", rrc->get_rb_name(lcid).c_str());
   } else {
     rlc_log->error("Can't delete bearer %s. Bearer doesn't exist.\n", rrc->get_rb_name(lcid).c_str());
@@ -481,16 +523,11 @@ void rlc::change_lcid(uint32_t old_lcid, uint32_t new_lcid)
   rwlock_write_guard lock(rwlock);
 
   // make sure old LCID exists and new LCID is still free
-  if (valid_lcid(old_lcid) && not valid_lcid(new_lcid)) {
+  if (valid_lcid(old_lcid) && new_lcid < SRSLTE_N_RADIO_BEARERS && not valid_lcid(new_lcid)) {
     // insert old rlc entity into new LCID
-    rlc_map_t::iterator it         = rlc_array.find(old_lcid);
-    rlc_common*         rlc_entity = it->second;
-    if (not rlc_array.insert(rlc_map_pair_t(new_lcid, rlc_entity)).second) {
-      rlc_log->error("Error inserting RLC entity into array\n.");
-      return;
-    }
+    rlc_array[new_lcid] = rlc_array[old_lcid];
     // erase from old position
-    rlc_array.erase(it);
+    rlc_array[old_lcid] = nullptr;
 
     if (valid_lcid(new_lcid) && not valid_lcid(old_lcid)) {
       rlc_log->info("Successfully changed LCID of RLC bearer from %d to %d\n", old_lcid, new_lcid);
@@ -508,7 +545,7 @@ void rlc::change_lcid(uint32_t old_lcid, uint32_t new_lcid)
 void rlc::suspend_bearer(uint32_t lcid)
 {
   if (valid_lcid(lcid)) {
-    if (rlc_array.at(lcid)->suspend()) {
+    if (rlc_array[lcid]->suspend()) {
       rlc_log->info("Suspended radio bearer %s\n", rrc->get_rb_name(lcid).c_str());
     } else {
       rlc_log->error("Error suspending RLC entity: bearer already suspended\n.");
@@ -522,7 +559,7 @@ void rlc::resume_bearer(uint32_t lcid)
 {
   rlc_log->info("Resuming radio bearer %s\n", rrc->get_rb_name(lcid).c_str());
   if (valid_lcid(lcid)) {
-    if (rlc_array.at(lcid)->resume()) {
+    if (rlc_array[lcid]->resume()) {
       rlc_log->info("Resumed radio bearer %s\n", rrc->get_rb_name(lcid).c_str());
     } else {
       rlc_log->error("Error resuming RLC entity: bearer not suspended\n.");
@@ -549,7 +586,7 @@ bool rlc::valid_lcid(uint32_t lcid)
     return false;
   }
 
-  if (rlc_array.find(lcid) == rlc_array.end()) {
+  if (rlc_array[lcid] == nullptr) {
     return false;
   }
 
@@ -563,7 +600,7 @@ bool rlc::valid_lcid_mrb(uint32_t lcid)
     return false;
   }
 
-  if (rlc_array_mrb.find(lcid) == rlc_array_mrb.end()) {
+  if (rlc_array_mrb[lcid] == nullptr) {
     return false;
   }
 
@@ -299,7 +299,7 @@ uint32_t rlc_am_lte::rlc_am_lte_tx::get_buffer_state()
                retx.is_segment ? "true" : "false",
                retx.so_start,
                retx.so_end);
-    if (tx_window.end() != tx_window.find(retx.sn)) {
+    if (tx_window.has_sn(retx.sn)) {
       int req_bytes = required_buffer_size(retx);
       if (req_bytes < 0) {
         log->error("In get_buffer_state(): Removing retx.sn=%d from queue\n", retx.sn);
@@ -441,15 +441,23 @@ void rlc_am_lte::rlc_am_lte_tx::retransmit_random_pdu()
 {
   if (not tx_window.empty()) {
     // randomly select PDU in tx window for retransmission
-    std::map<uint32_t, rlc_amd_tx_pdu_t>::iterator it = tx_window.begin();
-    std::advance(it, rand() % tx_window.size());
-    log->info("Schedule SN=%d for reTx.\n", it->first);
-    rlc_amd_retx_t retx = {};
-    retx.is_segment     = false;
-    retx.so_start       = 0;
-    retx.so_end         = it->second.buf->N_bytes;
-    retx.sn             = it->first;
-    retx_queue.push_back(retx);
+    uint32_t n = rand() % tx_window.size();
+    for (uint32_t sn = vt_a; sn != vt_s; sn = (sn + 1) % MOD) {
+      if (not tx_window.has_sn(sn)) {
+        continue;
+      }
+      if (n-- > 0) {
+        continue;
+      }
+      log->info("Schedule SN=%d for reTx.\n", sn);
+      rlc_amd_retx_t retx = {};
+      retx.is_segment     = false;
+      retx.so_start       = 0;
+      retx.so_end         = tx_window[sn].buf->N_bytes;
+      retx.sn             = sn;
+      retx_queue.push_back(retx);
+      break;
+    }
   }
 }
 
@@ -546,7 +554,7 @@ int rlc_am_lte::rlc_am_lte_tx::build_retx_pdu(uint8_t* payload, uint32_t nof_byt
   rlc_amd_retx_t retx = retx_queue.front();
 
   // Sanity check - drop any retx SNs not present in tx_window
-  while (tx_window.end() == tx_window.find(retx.sn)) {
+  while (not tx_window.has_sn(retx.sn)) {
     retx_queue.pop_front();
     if (!retx_queue.empty()) {
       retx = retx_queue.front();
@@ -788,9 +796,10 @@ int rlc_am_lte::rlc_am_lte_tx::build_data_pdu(uint8_t* payload, uint32_t nof_byt
     log->console("tx_window size: %zd PDUs\n", tx_window.size());
     log->console("vt_a = %d, vt_ms = %d, vt_s = %d, poll_sn = %d\n", vt_a, vt_ms, vt_s, poll_sn);
     log->console("retx_queue size: %zd PDUs\n", retx_queue.size());
-    std::map<uint32_t, rlc_amd_tx_pdu_t>::iterator txit;
-    for (txit = tx_window.begin(); txit != tx_window.end(); txit++) {
-      log->console("tx_window - SN: %d\n", txit->first);
+    for (uint32_t sn = vt_a; sn != vt_s; sn = (sn + 1) % MOD) {
+      if (tx_window.has_sn(sn)) {
+        log->console("tx_window - SN: %d\n", sn);
+      }
     }
     exit(-1);
 #else
@@ -916,11 +925,11 @@ int rlc_am_lte::rlc_am_lte_tx::build_data_pdu(uint8_t* payload, uint32_t nof_byt
   vt_s      = (vt_s + 1) % MOD;
 
   // Place PDU in tx_window, write header and TX
-  tx_window[header.sn].buf        = std::move(pdu);
-  tx_window[header.sn].header     = header;
-  tx_window[header.sn].is_acked   = false;
-  tx_window[header.sn].retx_count = 0;
-  const byte_buffer_t* buffer_ptr = tx_window[header.sn].buf.get();
+  rlc_amd_tx_pdu_t& tx_pdu        = tx_window.add_pdu(header.sn);
+  tx_pdu.buf                      = std::move(pdu);
+  tx_pdu.header                   = header;
+  tx_pdu.retx_count               = 0;
+  const byte_buffer_t* buffer_ptr = tx_pdu.buf.get();
 
   uint8_t* ptr = payload;
   rlc_am_write_data_pdu_header(&header, &ptr);
@@ -953,9 +962,8 @@ void rlc_am_lte::rlc_am_lte_tx::handle_control_pdu(uint8_t* payload, uint32_t no
   }
 
   // Handle ACKs and NACKs
-  std::map<uint32_t, rlc_amd_tx_pdu_t>::iterator it;
-  bool                                           update_vt_a = true;
-  uint32_t                                       i           = vt_a;
+  bool     update_vt_a = true;
+  uint32_t i           = vt_a;
 
   while (TX_MOD_BASE(i) < TX_MOD_BASE(status.ack_sn) && TX_MOD_BASE(i) < TX_MOD_BASE(vt_s)) {
     bool nack = false;
@@ -963,34 +971,34 @@ void rlc_am_lte::rlc_am_lte_tx::handle_control_pdu(uint8_t* payload, uint32_t no
       if (status.nacks[j].nack_sn == i) {
         nack        = true;
         update_vt_a = false;
-        it          = tx_window.find(i);
-        if (tx_window.end() != it) {
+        if (tx_window.has_sn(i)) {
+          rlc_amd_tx_pdu_t& tx_pdu = tx_window[i];
           if (!retx_queue_has_sn(i)) {
             rlc_amd_retx_t retx = {};
             retx.sn             = i;
             retx.is_segment     = false;
             retx.so_start       = 0;
-            retx.so_end         = it->second.buf->N_bytes;
+            retx.so_end         = tx_pdu.buf->N_bytes;
 
             if (status.nacks[j].has_so) {
               // sanity check
-              if (status.nacks[j].so_start >= it->second.buf->N_bytes) {
+              if (status.nacks[j].so_start >= tx_pdu.buf->N_bytes) {
                 // print error but try to send original PDU again
                 log->info("SO_start is larger than original PDU (%d >= %d)\n",
                           status.nacks[j].so_start,
-                          it->second.buf->N_bytes);
+                          tx_pdu.buf->N_bytes);
                 status.nacks[j].so_start = 0;
               }
 
               // check for special SO_end value
               if (status.nacks[j].so_end == 0x7FFF) {
-                status.nacks[j].so_end = it->second.buf->N_bytes;
+                status.nacks[j].so_end = tx_pdu.buf->N_bytes;
               } else {
                 retx.so_end = status.nacks[j].so_end + 1;
               }
 
-              if (status.nacks[j].so_start < it->second.buf->N_bytes &&
-                  status.nacks[j].so_end <= it->second.buf->N_bytes) {
+              if (status.nacks[j].so_start < tx_pdu.buf->N_bytes &&
+                  status.nacks[j].so_end <= tx_pdu.buf->N_bytes) {
                 retx.is_segment = true;
                 retx.so_start   = status.nacks[j].so_start;
               } else {
@@ -999,7 +1007,7 @@ void rlc_am_lte::rlc_am_lte_tx::handle_control_pdu(uint8_t* payload, uint32_t no
                              i,
                              status.nacks[j].so_start,
                              status.nacks[j].so_end,
-                             it->second.buf->N_bytes);
+                             tx_pdu.buf->N_bytes);
               }
             }
             retx_queue.push_back(retx);
@@ -1010,14 +1018,13 @@ void rlc_am_lte::rlc_am_lte_tx::handle_control_pdu(uint8_t* payload, uint32_t no
 
     if (!nack) {
       // ACKed SNs get marked and removed from tx_window if possible
-      if (tx_window.count(i) > 0) {
-        it = tx_window.find(i);
-        if (it != tx_window.end()) {
-          if (update_vt_a) {
-            tx_window.erase(it);
-            vt_a  = (vt_a + 1) % MOD;
-            vt_ms = (vt_ms + 1) % MOD;
-          }
+      if (tx_window.has_sn(i)) {
+        if (update_vt_a) {
+          tx_window.remove_pdu(i);
+          vt_a  = (vt_a + 1) % MOD;
+          vt_ms = (vt_ms + 1) % MOD;
+        } else {
+          tx_window.set_acked(i);
         }
       }
     }
@@ -1037,7 +1044,7 @@ void rlc_am_lte::rlc_am_lte_tx::debug_state()
 int rlc_am_lte::rlc_am_lte_tx::required_buffer_size(rlc_amd_retx_t retx)
 {
   if (!retx.is_segment) {
-    if (tx_window.count(retx.sn) == 1) {
+    if (tx_window.has_sn(retx.sn)) {
       if (tx_window[retx.sn].buf) {
         return rlc_am_packed_length(&tx_window[retx.sn].header) + tx_window[retx.sn].buf->N_bytes;
       } else {
@@ -1196,8 +1203,6 @@ void rlc_am_lte::rlc_am_lte_rx::stop()
  */
 void rlc_am_lte::rlc_am_lte_rx::handle_data_pdu(uint8_t* payload, uint32_t nof_bytes, rlc_amd_pdu_header_t& header)
 {
-  std::map<uint32_t, rlc_amd_rx_pdu_t>::iterator it;
-
   log->info_hex(payload, nof_bytes, "%s Rx data PDU SN=%d (%d B)", RB_NAME, header.sn, nof_bytes);
   log->debug("%s\n", rlc_amd_pdu_header_to_string(header).c_str());
 
@@ -1222,8 +1227,7 @@ void rlc_am_lte::rlc_am_lte_rx::handle_data_pdu(uint8_t* payload, uint32_t nof_b
     return;
   }
 
-  it = rx_window.find(header.sn);
-  if (rx_window.end() != it) {
+  if (rx_window.has_sn(header.sn)) {
     if (header.p) {
       log->info("%s Status packet requested through polling bit\n", RB_NAME);
       do_status = true;
@@ -1258,7 +1262,7 @@ void rlc_am_lte::rlc_am_lte_rx::handle_data_pdu(uint8_t* payload, uint32_t nof_b
   pdu.buf->N_bytes = nof_bytes;
   pdu.header       = header;
 
-  rx_window[header.sn] = std::move(pdu);
+  rx_window.add_pdu(header.sn) = std::move(pdu);
 
   // Update vr_h
   if (RX_MOD_BASE(header.sn) >= RX_MOD_BASE(vr_h)) {
@@ -1266,10 +1270,8 @@ void rlc_am_lte::rlc_am_lte_rx::handle_data_pdu(uint8_t* payload, uint32_t nof_b
   }
 
   // Update vr_ms
-  it = rx_window.find(vr_ms);
-  while (rx_window.end() != it) {
+  while (rx_window.has_sn(vr_ms)) {
     vr_ms = (vr_ms + 1) % MOD;
-    it    = rx_window.find(vr_ms);
   }
 
   // Check poll bit
@@ -1318,7 +1320,6 @@ void rlc_am_lte::rlc_am_lte_rx::handle_data_pdu_segment(uint8_t*              pa
                                                         uint32_t              nof_bytes,
                                                         rlc_amd_pdu_header_t& header)
 {
-  std::map<uint32_t, rlc_amd_rx_pdu_segments_t>::iterator it;
 
   log->info_hex(payload,
                 nof_bytes,
@@ -1362,8 +1363,7 @@ void rlc_am_lte::rlc_am_lte_rx::handle_data_pdu_segment(uint8_t*              pa
   segment.header       = header;
 
   // Check if we already have a segment from the same PDU
-  it = rx_segments.find(header.sn);
-  if (rx_segments.end() != it) {
+  if (rx_segments.has_sn(header.sn)) {
 
     if (header.p) {
       log->info("%s Status packet requested through polling bit\n", RB_NAME);
@@ -1372,8 +1372,8 @@ void rlc_am_lte::rlc_am_lte_rx::handle_data_pdu_segment(uint8_t*              pa
 
     // Add segment to PDU list and check for complete
     // NOTE: MAY MOVE. Preference would be to capture by value, and then move; but header is stack allocated
-    if (add_segment_and_check(&it->second, &segment)) {
-      rx_segments.erase(it);
+    if (add_segment_and_check(&rx_segments[header.sn], &segment)) {
+      rx_segments.remove_pdu(header.sn);
     }
 
   } else {
@@ -1381,7 +1381,7 @@ void rlc_am_lte::rlc_am_lte_rx::handle_data_pdu_segment(uint8_t*              pa
     // Create new PDU segment list and write to rx_segments
     rlc_amd_rx_pdu_segments_t pdu;
     pdu.segments.push_back(std::move(segment));
-    rx_segments[header.sn] = std::move(pdu);
+    rx_segments.add_pdu(header.sn) = std::move(pdu);
 
     // Update vr_h
     if (RX_MOD_BASE(header.sn) >= RX_MOD_BASE(vr_h)) {
@@ -1423,7 +1423,7 @@ void rlc_am_lte::rlc_am_lte_rx::reassemble_rx_sdus()
   }
 
   // Iterate through rx_window, assembling and delivering SDUs
-  while (rx_window.end() != rx_window.find(vr_r)) {
+  while (rx_window.has_sn(vr_r)) {
     // Handle any SDU segments
     for (uint32_t i = 0; i < rx_window[vr_r].header.N_li; i++) {
       len = rx_window[vr_r].header.li[i];
@@ -1517,21 +1517,20 @@ void rlc_am_lte::rlc_am_lte_rx::reassemble_rx_sdus()
     // Move the rx_window
     log->debug("Erasing SN=%d.\n", vr_r);
     // also erase any segments of this SN
-    std::map<uint32_t, rlc_amd_rx_pdu_segments_t>::iterator it;
-    it = rx_segments.find(vr_r);
-    if (rx_segments.end() != it) {
+    if (rx_segments.has_sn(vr_r)) {
       log->debug("Erasing segments of SN=%d\n", vr_r);
+      std::list<rlc_amd_rx_pdu_t>&          segments = rx_segments[vr_r].segments;
       std::list<rlc_amd_rx_pdu_t>::iterator segit;
-      for (segit = it->second.segments.begin(); segit != it->second.segments.end(); ++segit) {
+      for (segit = segments.begin(); segit != segments.end(); ++segit) {
         log->debug(" Erasing segment of SN=%d SO=%d Len=%d N_li=%d\n",
                    segit->header.sn,
                    segit->header.so,
                    segit->buf->N_bytes,
                    segit->header.N_li);
       }
-      it->second.segments.clear();
+      rx_segments.remove_pdu(vr_r);
     }
-    rx_window.erase(vr_r);
+    rx_window.remove_pdu(vr_r);
     vr_r  = (vr_r + 1) % MOD;
     vr_mr = (vr_mr + 1) % MOD;
   }
@@ -1602,11 +1601,9 @@ void rlc_am_lte::rlc_am_lte_rx::timer_expired(uint32_t timeout_id)
     log->debug("%s reordering timeout expiry - updating vr_ms (was %d)\n", RB_NAME, vr_ms);
 
     // 36.322 v10 Section 5.1.3.2.4
-    vr_ms                                             = vr_x;
-    std::map<uint32_t, rlc_amd_rx_pdu_t>::iterator it = rx_window.find(vr_ms);
-    while (rx_window.end() != it) {
+    vr_ms = vr_x;
+    while (rx_window.has_sn(vr_ms)) {
       vr_ms = (vr_ms + 1) % MOD;
-      it    = rx_window.find(vr_ms);
     }
 
     if (poll_received) {
@@ -1633,7 +1630,7 @@ int rlc_am_lte::rlc_am_lte_rx::get_status_pdu(rlc_status_pdu_t* status, const ui
   // We don't use segment NACKs - just NACK the full PDU
   uint32_t i = vr_r;
   while (RX_MOD_BASE(i) < RX_MOD_BASE(vr_ms) && status->N_nack < RLC_AM_WINDOW_SIZE) {
-    if (rx_window.find(i) == rx_window.end()) {
+    if (not rx_window.has_sn(i)) {
       status->nacks[status->N_nack].nack_sn = i;
       status->N_nack++;
     } else {
@@ -1673,7 +1670,7 @@ int rlc_am_lte::rlc_am_lte_rx::get_status_pdu_length()
   status.ack_sn           = vr_ms;
   uint32_t i              = vr_r;
   while (RX_MOD_BASE(i) < RX_MOD_BASE(vr_ms) && status.N_nack < RLC_AM_WINDOW_SIZE) {
-    if (rx_window.find(i) == rx_window.end()) {
+    if (not rx_window.has_sn(i)) {
       status.N_nack++;
     }
     i = (i + 1) % MOD;
@@ -1684,12 +1681,15 @@ int rlc_am_lte::rlc_am_lte_rx::get_status_pdu_length()
 
 void rlc_am_lte::rlc_am_lte_rx::print_rx_segments()
 {
-  std::map<uint32_t, rlc_amd_rx_pdu_segments_t>::iterator it;
-  std::stringstream                                       ss;
+  std::stringstream ss;
   ss << "rx_segments:" << std::endl;
-  for (it = rx_segments.begin(); it != rx_segments.end(); it++) {
+  for (uint32_t sn = vr_r; sn != vr_mr; sn = (sn + 1) % MOD) {
+    if (not rx_segments.has_sn(sn)) {
+      continue;
+    }
+    std::list<rlc_amd_rx_pdu_t>&          segments = rx_segments[sn].segments;
     std::list<rlc_amd_rx_pdu_t>::iterator segit;
-    for (segit = it->second.segments.begin(); segit != it->second.segments.end(); segit++) {
+    for (segit = segments.begin(); segit != segments.end(); segit++) {
       ss << "    SN:" << segit->header.sn << " SO:" << segit->header.so << " N:" << segit->buf->N_bytes
          << " N_li: " << segit->header.N_li << std::endl;
     }
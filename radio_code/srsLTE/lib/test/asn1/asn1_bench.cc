@@ -0,0 +1,266 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srslte/asn1/rrc_asn1.h"
+#include "srslte/asn1/s1ap_asn1.h"
+#include "srslte/common/test_common.h"
+#include <chrono>
+#include <random>
+#include <stdlib.h>
+#include <vector>
+
+using namespace asn1;
+
+/*
+ * Decoding and encoding rate of RRC and S1AP messages captured from srsENB/srsEPC runs, with the decoded PDUs
+ * allocated either on the heap or in an arena. Usage: asn1_bench [nof_iterations]
+ */
+
+struct recorded_msg_t {
+  const char*          name;
+  std::vector<uint8_t> bytes;
+};
+
+// S1AP PDUs
+static const std::vector<recorded_msg_t> s1ap_msgs = {
+    {"S1SetupRequest", {0x00, 0x11, 0x00, 0x2d, 0x00, 0x00, 0x04, 0x00, 0x3b, 0x00, 0x08, 0x00, 0x09, 0xf1, 0x07,
+                        0x00, 0x00, 0x19, 0xb0, 0x00, 0x3c, 0x40, 0x0a, 0x03, 0x80, 0x65, 0x6e, 0x62, 0x30, 0x30,
+                        0x31, 0x39, 0x62, 0x00, 0x40, 0x00, 0x07, 0x00, 0x00, 0x01, 0xc0, 0x09, 0xf1, 0x07, 0x00,
+                        0x89, 0x40, 0x01, 0x40}},
+    {"S1SetupResponse", {0x20, 0x11, 0x00, 0x26, 0x00, 0x00, 0x02, 0x00, 0x69, 0x00, 0x1a, 0x01, 0x40, 0x00,
+                         0xf1, 0x10, 0x00, 0xf1, 0x10, 0x00, 0xf1, 0x10, 0x00, 0xf1, 0x10, 0x00, 0xf1, 0x10,
+                         0x00, 0xf1, 0x10, 0x00, 0x00, 0x88, 0x88, 0x00, 0x7b, 0x00, 0x57, 0x40, 0x01, 0xff}},
+    {"InitialContextSetupRequest",
+     {0x00, 0x09, 0x00, 0x80, 0xc6, 0x00, 0x00, 0x06, 0x00, 0x00, 0x00, 0x02, 0x00, 0x64, 0x00, 0x08, 0x00, 0x02, 0x00,
+      0x01, 0x00, 0x42, 0x00, 0x0a, 0x18, 0x3b, 0x9a, 0xca, 0x00, 0x60, 0x3b, 0x9a, 0xca, 0x00, 0x00, 0x18, 0x00, 0x78,
+      0x00, 0x00, 0x34, 0x00, 0x73, 0x45, 0x00, 0x09, 0x3c, 0x0f, 0x80, 0x0a, 0x00, 0x21, 0xf0, 0xb7, 0x36, 0x1c, 0x56,
+      0x64, 0x27, 0x3e, 0x5b, 0x04, 0xb7, 0x02, 0x07, 0x42, 0x02, 0x3e, 0x06, 0x00, 0x09, 0xf1, 0x07, 0x00, 0x07, 0x00,
+      0x37, 0x52, 0x66, 0xc1, 0x01, 0x09, 0x1b, 0x07, 0x74, 0x65, 0x73, 0x74, 0x31, 0x32, 0x33, 0x06, 0x6d, 0x6e, 0x63,
+      0x30, 0x37, 0x30, 0x06, 0x6d, 0x63, 0x63, 0x39, 0x30, 0x31, 0x04, 0x67, 0x70, 0x72, 0x73, 0x05, 0x01, 0xc0, 0xa8,
+      0x03, 0x02, 0x27, 0x0e, 0x80, 0x80, 0x21, 0x0a, 0x03, 0x00, 0x00, 0x0a, 0x81, 0x06, 0x08, 0x08, 0x08, 0x08, 0x50,
+      0x0b, 0xf6, 0x09, 0xf1, 0x07, 0x80, 0x01, 0x01, 0xf6, 0x7e, 0x72, 0x69, 0x13, 0x09, 0xf1, 0x07, 0x00, 0x01, 0x23,
+      0x05, 0xf4, 0xf6, 0x7e, 0x72, 0x69, 0x00, 0x6b, 0x00, 0x05, 0x18, 0x00, 0x0c, 0x00, 0x00, 0x00, 0x49, 0x00, 0x20,
+      0x45, 0x25, 0xe4, 0x9a, 0x77, 0xc8, 0xd5, 0xcf, 0x26, 0x33, 0x63, 0xeb, 0x5b, 0xb9, 0xc3, 0x43, 0x9b, 0x9e, 0xb3,
+      0x86, 0x1f, 0xa8, 0xa7, 0xcf, 0x43, 0x54, 0x07, 0xae, 0x42, 0x2b, 0x63, 0xb9}}};
+
+// DL-DCCH messages
+static const std::vector<recorded_msg_t> rrc_dl_dcch_msgs = {
+    {"RRCConnectionReconfiguration",
+     {0x20, 0x16, 0x15, 0xC8, 0x40, 0x00, 0x03, 0xC2, 0x84, 0x18, 0x10, 0xA8, 0x04, 0xD7, 0x95, 0x14, 0xA2, 0x01, 0x02,
+      0x18, 0x9A, 0x01, 0x80, 0x14, 0x81, 0x0A, 0xCB, 0x84, 0x08, 0x00, 0xAD, 0x6D, 0xC4, 0x06, 0x08, 0xAF, 0x6D, 0xC7,
+      0xA0, 0xC0, 0x82, 0x00, 0x00, 0x0C, 0x38, 0x60, 0x20, 0x30, 0xC3, 0x00, 0x00, 0x10, 0x04, 0x40, 0x10, 0xC2, 0x3C,
+      0x2A, 0x06, 0x20, 0x30, 0x11, 0x10, 0x28, 0x13, 0xDA, 0x4E, 0x96, 0xDA, 0x80, 0x83, 0xA1, 0x00, 0xA4, 0x83, 0x00,
+      0x32, 0x7B, 0x08, 0x95, 0xAE, 0x00, 0x16, 0xA9, 0x00, 0xE0, 0x80, 0x84, 0x8C, 0x82, 0xBB, 0xB1, 0xB4, 0xBA, 0x18,
+      0x83, 0x36, 0xB7, 0x31, 0x98, 0x18, 0x98, 0x83, 0x36, 0xB1, 0xB1, 0x9A, 0x1B, 0x1B, 0x02, 0x33, 0xB8, 0x39, 0x39,
+      0x82, 0x80, 0x85, 0x7F, 0x80, 0x80, 0xAF, 0x03, 0x7F, 0x7F, 0x7D, 0x7D, 0x7F, 0x7F, 0x28, 0x05, 0xFB, 0x32, 0x7B,
+      0x08, 0xC0, 0x00, 0x01, 0xF8, 0x3E, 0x3C, 0xB1, 0xB2, 0x00, 0xC0, 0x30, 0x38, 0x1F, 0xFA, 0x9C, 0x08, 0x3E, 0xA2,
+      0x5F, 0x1C, 0xE1, 0xD0, 0x84}}};
+
+// UL-DCCH messages
+static const std::vector<recorded_msg_t> rrc_ul_dcch_msgs = {
+    {"MeasurementReport", {0x08, 0x10, 0x38, 0x74, 0x00, 0x0D, 0xBC, 0x80}}};
+
+// BCCH-DL-SCH messages
+static const std::vector<recorded_msg_t> rrc_bcch_msgs = {
+    {"SystemInformation", {0x00, 0x01, 0x49, 0x00, 0x12, 0x50, 0x40, 0x08, 0x00, 0x09, 0x40, 0x00, 0xA0,
+                           0x3F, 0x01, 0x00, 0x0A, 0x7F, 0xC9, 0x80, 0x01, 0x04, 0x28, 0x6C, 0x00, 0x0C}}};
+
+// Reference bit packing, one bit at a time
+static void ref_pack(std::vector<uint8_t>& buf, uint32_t bitpos, uint32_t val, uint32_t n_bits)
+{
+  for (uint32_t i = 0; i < n_bits; ++i, ++bitpos) {
+    uint8_t mask = 0x80u >> (bitpos % 8);
+    if ((val >> (n_bits - 1 - i)) & 1u) {
+      buf[bitpos / 8] |= mask;
+    } else {
+      buf[bitpos / 8] &= ~mask;
+    }
+  }
+}
+
+// Packs random fields with random lengths and alignments, and checks them against the reference
+int test_bit_packing()
+{
+  std::mt19937 rng(0);
+  for (uint32_t run = 0; run < 1000; ++run) {
+    std::vector<uint8_t> buf(64, 0), ref(64, 0), bytes(20);
+    std::vector<uint32_t> vals, lens;
+    bit_ref               bref(buf.data(), buf.size());
+    uint32_t              bitpos = 0;
+    while (true) {
+      uint32_t n_bits = rng() % 32;
+      uint32_t val    = rng();
+      if (bitpos + n_bits > 8 * 40) {
+        break;
+      }
+      TESTASSERT(bref.pack(val, n_bits) == SRSASN_SUCCESS);
+      ref_pack(ref, bitpos, val, n_bits);
+      bitpos += n_bits;
+      vals.push_back(n_bits > 0 ? val & ((1u << n_bits) - 1u) : 0);
+      lens.push_back(n_bits);
+    }
+    // Unaligned octet strings
+    for (uint8_t& b : bytes) {
+      b = rng();
+    }
+    TESTASSERT(bref.pack_bytes(bytes.data(), bytes.size()) == SRSASN_SUCCESS);
+    for (uint8_t b : bytes) {
+      ref_pack(ref, bitpos, b, 8);
+      bitpos += 8;
+    }
+    TESTASSERT(bref.distance() == (int)bitpos);
+    TESTASSERT(std::equal(buf.begin(), buf.begin() + bitpos / 8, ref.begin()));
+
+    // Unpack everything back, with the buffer end right after the last bit
+    cbit_ref cref(buf.data(), bitpos / 8 + 1);
+    for (uint32_t i = 0; i < vals.size(); ++i) {
+      uint32_t val;
+      TESTASSERT(cref.unpack(val, lens[i]) == SRSASN_SUCCESS);
+      TESTASSERT(val == vals[i]);
+    }
+    std::vector<uint8_t> bytes2(bytes.size());
+    TESTASSERT(cref.unpack_bytes(bytes2.data(), bytes2.size()) == SRSASN_SUCCESS);
+    TESTASSERT(bytes2 == bytes);
+    TESTASSERT(cref.distance() == (int)bitpos);
+  }
+
+  // 64-bit fields
+  uint8_t  buf[16] = {};
+  bit_ref  bref(buf, sizeof(buf));
+  uint64_t val     = 0x0123456789abcdefull;
+  TESTASSERT(bref.pack(1, 3) == SRSASN_SUCCESS);
+  TESTASSERT(bref.pack(val >> 32u, 30) == SRSASN_SUCCESS);
+  TESTASSERT(bref.pack(val >> 2u, 30) == SRSASN_SUCCESS);
+  TESTASSERT(bref.pack(val, 2) == SRSASN_SUCCESS);
+  cbit_ref cref(buf, 10);
+  uint64_t val2;
+  TESTASSERT(cref.unpack(val2, 3) == SRSASN_SUCCESS);
+  TESTASSERT(val2 == 1);
+  TESTASSERT(cref.unpack(val2, 62) == SRSASN_SUCCESS);
+  TESTASSERT(val2 == (val & 0x3fffffffffffffffull));
+  TESTASSERT(cref.unpack(val2, 64) != SRSASN_SUCCESS);
+
+  // Buffer limits
+  bit_ref small(buf, 2);
+  TESTASSERT(small.pack(0, 7) == SRSASN_SUCCESS);
+  TESTASSERT(small.pack(0, 9) == SRSASN_SUCCESS);
+  TESTASSERT(small.pack(0, 1) != SRSASN_SUCCESS);
+  cbit_ref csmall(buf, 2);
+  TESTASSERT(csmall.unpack(val2, 17) != SRSASN_SUCCESS);
+
+  return SRSLTE_SUCCESS;
+}
+
+template <typename Msg>
+int test_arena_decoding(const std::vector<recorded_msg_t>& msgs)
+{
+  mem_arena arena;
+  for (const recorded_msg_t& m : msgs) {
+    Msg      heap_msg;
+    cbit_ref bref(m.bytes.data(), m.bytes.size());
+    TESTASSERT(heap_msg.unpack(bref) == SRSASN_SUCCESS);
+    {
+      arena_pdu<Msg> pdu(arena);
+      cbit_ref       bref2(m.bytes.data(), m.bytes.size());
+      TESTASSERT(pdu.unpack(bref2) == SRSASN_SUCCESS);
+      TESTASSERT(arena.nof_bytes_used() > 0 or m.bytes.size() < 16);
+
+      // Copies outlive the arena
+      Msg copy = *pdu;
+      TESTASSERT(test_pack_unpack_consistency(*pdu) == SRSASN_SUCCESS);
+      uint8_t buf1[2048], buf2[2048];
+      bit_ref b1(buf1, sizeof(buf1)), b2(buf2, sizeof(buf2));
+      TESTASSERT(heap_msg.pack(b1) == SRSASN_SUCCESS);
+      TESTASSERT(copy.pack(b2) == SRSASN_SUCCESS);
+      TESTASSERT(b1.distance_bytes() == (int)m.bytes.size());
+      TESTASSERT(b1.distance() == b2.distance() and memcmp(buf1, buf2, b1.distance_bytes()) == 0);
+      TESTASSERT(memcmp(buf1, m.bytes.data(), m.bytes.size() - 1) == 0);
+    }
+    TESTASSERT(arena.nof_bytes_used() == 0);
+  }
+  return SRSLTE_SUCCESS;
+}
+
+// Decodes and encodes each message nof_iterations times and prints the rates in messages per second
+template <typename Msg>
+void bench_msgs(const char* type, const std::vector<recorded_msg_t>& msgs, uint32_t nof_iterations)
+{
+  using clock = std::chrono::steady_clock;
+  auto rate   = [nof_iterations](clock::time_point t0, clock::time_point t1) {
+    return nof_iterations / std::chrono::duration<double>(t1 - t0).count();
+  };
+  mem_arena arena;
+  uint8_t   buf[2048];
+
+  for (const recorded_msg_t& m : msgs) {
+    auto t0 = clock::now();
+    for (uint32_t i = 0; i < nof_iterations; ++i) {
+      Msg      msg;
+      cbit_ref bref(m.bytes.data(), m.bytes.size());
+      msg.unpack(bref);
+    }
+    auto t1 = clock::now();
+    for (uint32_t i = 0; i < nof_iterations; ++i) {
+      arena_pdu<Msg> msg(arena);
+      cbit_ref       bref(m.bytes.data(), m.bytes.size());
+      msg.unpack(bref);
+    }
+    auto t2 = clock::now();
+    Msg  msg;
+    {
+      cbit_ref bref(m.bytes.data(), m.bytes.size());
+      msg.unpack(bref);
+    }
+    auto t3 = clock::now();
+    for (uint32_t i = 0; i < nof_iterations; ++i) {
+      bit_ref bref(buf, sizeof(buf));
+      msg.pack(bref);
+    }
+    auto t4 = clock::now();
+    printf("%-12s %-28s %4zd bytes: unpack %9.0f msg/s, unpack (arena) %9.0f msg/s, pack %9.0f msg/s\n",
+           type,
+           m.name,
+           m.bytes.size(),
+           rate(t0, t1),
+           rate(t1, t2),
+           rate(t3, t4));
+  }
+}
+
+int main(int argc, char** argv)
+{
+  srslte::logmap::set_default_log_level(srslte::LOG_LEVEL_NONE);
+  uint32_t nof_iterations = (argc > 1) ? (uint32_t)strtoul(argv[1], nullptr, 10) : 1000;
+
+  TESTASSERT(test_bit_packing() == SRSLTE_SUCCESS);
+  TESTASSERT(test_arena_decoding<s1ap::s1ap_pdu_c>(s1ap_msgs) == SRSLTE_SUCCESS);
+  TESTASSERT(test_arena_decoding<rrc::dl_dcch_msg_s>(rrc_dl_dcch_msgs) == SRSLTE_SUCCESS);
+  TESTASSERT(test_arena_decoding<rrc::ul_dcch_msg_s>(rrc_ul_dcch_msgs) == SRSLTE_SUCCESS);
+  TESTASSERT(test_arena_decoding<rrc::bcch_dl_sch_msg_s>(rrc_bcch_msgs) == SRSLTE_SUCCESS);
+
+  bench_msgs<s1ap::s1ap_pdu_c>("S1AP", s1ap_msgs, nof_iterations);
+  bench_msgs<rrc::dl_dcch_msg_s>("DL-DCCH", rrc_dl_dcch_msgs, nof_iterations);
+  bench_msgs<rrc::ul_dcch_msg_s>("UL-DCCH", rrc_ul_dcch_msgs, nof_iterations);
+  bench_msgs<rrc::bcch_dl_sch_msg_s>("BCCH-DL-SCH", rrc_bcch_msgs, nof_iterations);
+
+  printf("Success\n");
+  return SRSLTE_SUCCESS;
+}
@@ -0,0 +1,214 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srslte/common/block_queue.h"
+#include "srslte/common/buffer_pool.h"
+#include "srslte/common/test_common.h"
+#include <atomic>
+#include <random>
+#include <thread>
+
+using namespace srslte;
+
+struct test_buffer_t {
+  std::atomic<uint32_t> owner{0};
+  uint32_t              payload = 0;
+};
+
+int test_single_thread()
+{
+  buffer_pool<test_buffer_t> pool(1024);
+  TESTASSERT(pool.nof_available_pdus() == 1024);
+
+  std::vector<test_buffer_t*> bufs;
+  for (uint32_t i = 0; i < 1024; i++) {
+    test_buffer_t* b = pool.allocate();
+    TESTASSERT(b != nullptr);
+    bufs.push_back(b);
+  }
+  TESTASSERT(pool.nof_available_pdus() == 0);
+  TESTASSERT(pool.allocate() == nullptr);
+
+  // all buffers are distinct
+  std::sort(bufs.begin(), bufs.end());
+  TESTASSERT(std::unique(bufs.begin(), bufs.end()) == bufs.end());
+
+  for (test_buffer_t* b : bufs) {
+    TESTASSERT(pool.deallocate(b));
+  }
+  TESTASSERT(pool.nof_available_pdus() == 1024);
+
+  // double free and foreign buffers are rejected
+  TESTASSERT(not pool.deallocate(bufs[0]));
+  test_buffer_t foreign;
+  TESTASSERT(not pool.deallocate(&foreign));
+  TESTASSERT(pool.nof_available_pdus() == 1024);
+
+  buffer_pool_stats_t stats = pool.get_stats();
+  TESTASSERT(stats.capacity == 1024);
+  TESTASSERT(stats.high_watermark == 1024);
+  return SRSLTE_SUCCESS;
+}
+
+// Buffers are allocated in one thread and freed in another, while both threads also allocate and free locally
+int test_multi_thread()
+{
+  const uint32_t             nof_threads = 8;
+  const uint32_t             nof_iter    = 200000;
+  buffer_pool<test_buffer_t> pool(4096);
+  std::atomic<bool>          error{false};
+  std::vector<std::thread>   threads;
+
+  srslte::block_queue<test_buffer_t*> handover;
+
+  for (uint32_t t = 0; t < nof_threads; t++) {
+    threads.emplace_back([&pool, &error, &handover, t, nof_iter]() {
+      std::mt19937                rng(t);
+      std::vector<test_buffer_t*> held;
+      for (uint32_t i = 0; i < nof_iter; i++) {
+        if (held.size() < 64 && (rng() % 2 == 0 || held.empty())) {
+          test_buffer_t* b = pool.allocate(nullptr, true);
+          // no other thread may own this buffer
+          uint32_t prev = b->owner.exchange(t + 1);
+          if (prev != 0) {
+            error = true;
+          }
+          held.push_back(b);
+        } else {
+          test_buffer_t* b = held.back();
+          held.pop_back();
+          b->owner = 0;
+          if (rng() % 4 == 0) {
+            // let another thread free it
+            handover.push(b);
+          } else if (not pool.deallocate(b)) {
+            error = true;
+          }
+        }
+        test_buffer_t* b = nullptr;
+        if (handover.try_pop(&b) && not pool.deallocate(b)) {
+          error = true;
+        }
+      }
+      for (test_buffer_t* b : held) {
+        b->owner = 0;
+        pool.deallocate(b);
+      }
+    });
+  }
+  for (std::thread& t : threads) {
+    t.join();
+  }
+  test_buffer_t* b = nullptr;
+  while (handover.try_pop(&b)) {
+    TESTASSERT(pool.deallocate(b));
+  }
+
+  TESTASSERT(not error);
+  TESTASSERT(pool.nof_available_pdus() == 4096);
+  pool.print_stats();
+  return SRSLTE_SUCCESS;
+}
+
+// A blocked allocation is served once another thread frees buffers
+int test_blocking()
+{
+  buffer_pool<test_buffer_t>  pool(256);
+  std::vector<test_buffer_t*> bufs;
+  for (uint32_t i = 0; i < 256; i++) {
+    bufs.push_back(pool.allocate());
+  }
+  TESTASSERT(pool.allocate() == nullptr);
+
+  // Frees that happen before the waiter is registered may stay in the freeing thread's cache, keep freeing
+  std::atomic<bool>     done{false};
+  std::atomic<uint32_t> nof_freed{0};
+  std::thread           t([&pool, &bufs, &done, &nof_freed]() {
+    while (not done && nof_freed < bufs.size()) {
+      usleep(5000);
+      pool.deallocate(bufs[bufs.size() - 1 - nof_freed]);
+      nof_freed++;
+    }
+  });
+  test_buffer_t* b = pool.allocate(nullptr, true);
+  done             = true;
+  t.join();
+  TESTASSERT(b != nullptr);
+
+  TESTASSERT(pool.deallocate(b));
+  for (uint32_t i = 0; i < bufs.size() - nof_freed; i++) {
+    TESTASSERT(pool.deallocate(bufs[i]));
+  }
+  TESTASSERT(pool.nof_available_pdus() == 256);
+  return SRSLTE_SUCCESS;
+}
+
+// Buffers left in the cache of a thread that stopped using the pool are still handed out
+int test_cached_by_idle_thread()
+{
+  buffer_pool<test_buffer_t> pool(1024);
+
+  // An idle thread keeps the buffers it freed in its cache
+  std::atomic<bool> cached{false};
+  std::atomic<bool> done{false};
+  std::thread       t([&pool, &cached, &done]() {
+    std::vector<test_buffer_t*> bufs;
+    for (uint32_t i = 0; i < 8; i++) {
+      bufs.push_back(pool.allocate());
+    }
+    for (test_buffer_t* b : bufs) {
+      pool.deallocate(b);
+    }
+    cached = true;
+    while (not done) {
+      usleep(1000);
+    }
+  });
+  while (not cached) {
+    usleep(1000);
+  }
+
+  std::vector<test_buffer_t*> bufs;
+  for (uint32_t i = 0; i < 1024; i++) {
+    test_buffer_t* b = pool.allocate(nullptr, i == 1023);
+    TESTASSERT(b != nullptr);
+    bufs.push_back(b);
+  }
+  TESTASSERT(pool.allocate() == nullptr);
+  done = true;
+  t.join();
+
+  for (test_buffer_t* b : bufs) {
+    TESTASSERT(pool.deallocate(b));
+  }
+  TESTASSERT(pool.nof_available_pdus() == 1024);
+  return SRSLTE_SUCCESS;
+}
+
+int main()
+{
+  TESTASSERT(test_single_thread() == SRSLTE_SUCCESS);
+  TESTASSERT(test_multi_thread() == SRSLTE_SUCCESS);
+  TESTASSERT(test_blocking() == SRSLTE_SUCCESS);
+  TESTASSERT(test_cached_by_idle_thread() == SRSLTE_SUCCESS);
+  printf("Success\n");
+  return SRSLTE_SUCCESS;
+}
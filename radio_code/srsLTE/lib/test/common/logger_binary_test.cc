@@ -0,0 +1,228 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#define NTHREADS 32
+#define NMSGS 1000
+
+#include "srslte/common/log_filter.h"
+#include "srslte/common/logger_binary.h"
+#include "srslte/common/logger_file.h"
+#include "srslte/common/test_common.h"
+#include <fstream>
+#include <sstream>
+#include <stdio.h>
+#include <thread>
+#include <vector>
+
+using namespace srslte;
+
+class fixed_time : public log_filter::time_itf
+{
+public:
+  srslte_timestamp_t get_time()
+  {
+    srslte_timestamp_t t = {};
+    t.full_secs          = 1234;
+    t.frac_secs          = 0.000567;
+    return t;
+  }
+};
+
+static std::string read_file(const std::string& filename)
+{
+  std::ifstream     f(filename);
+  std::stringstream ss;
+  ss << f.rdbuf();
+  return ss.str();
+}
+
+static void write_messages(logger* l)
+{
+  fixed_time clock;
+  uint8_t    hex[100];
+  for (uint32_t i = 0; i < sizeof(hex); i++) {
+    hex[i] = i;
+  }
+
+  log_filter mac("MAC", l, true);
+  mac.set_level(LOG_LEVEL_DEBUG);
+  mac.set_hex_limit(40);
+  mac.set_time_src(&clock, log_filter::TIME);
+  log_filter rrc("RRC", l, false);
+  rrc.set_level(LOG_LEVEL_INFO);
+  rrc.set_time_src(&clock, log_filter::EPOCH);
+
+  std::string name  = "dynamic";
+  int         value = 42;
+  mac.step(10241);
+  mac.info("ints %d %u %ld %lld %zu %x %#06x %hhu %c\n", -1, 2u, -3l, 4ll, (size_t)5, 0xbeef, 0x1f, 300, 'z');
+  mac.debug("strings %s %-8s| %.3s %s", "abc", "pad", "truncated", name.c_str());
+  mac.warning("floats %5.2f %e %g %.*f %Lf\n", 3.14159, 1e-9, 0.5, 3, 2.71828, (long double)1.5);
+  mac.error("pointer %p, star %*d, percent %%\n", (void*)&value, 6, value);
+  mac.info_hex(hex, sizeof(hex), "hex dump of %d bytes\n", (int)sizeof(hex));
+  mac.prepend_string("rnti=0x46 ");
+  mac.info("with prefix\n");
+  mac.debug("debug with prefix %d\n", 1);
+  rrc.info("positional %1$d, formatted by the caller\n", 7);
+  rrc.info_long("long message %s\n", std::string(2000, 'x').c_str());
+  rrc.debug("not logged %d\n", 2);
+  l->log_char("raw text\n");
+}
+
+// All outputs match logger_file
+int test_same_output()
+{
+  {
+    logger_file l;
+    l.init("logger_file.txt");
+    write_messages(&l);
+  }
+  {
+    logger_binary l;
+    l.init("logger_binary.txt", logger_binary::TEXT);
+    write_messages(&l);
+  }
+  {
+    logger_binary l;
+    l.init("logger_binary.bin", logger_binary::BINARY);
+    write_messages(&l);
+  }
+
+  FILE* in  = fopen("logger_binary.bin", "rb");
+  FILE* out = fopen("logger_binary_decoded.txt", "w");
+  TESTASSERT(in != nullptr and out != nullptr);
+  TESTASSERT(logger_binary::decode(in, out) == 11);
+  fclose(in);
+  fclose(out);
+
+  std::string expected = read_file("logger_file.txt");
+  std::string text     = read_file("logger_binary.txt");
+  std::string decoded  = read_file("logger_binary_decoded.txt");
+  printf("%s", text.c_str());
+
+  // logger_file truncates messages to log_filter::char_buff_size, except for *_long() messages
+  TESTASSERT(not expected.empty());
+  TESTASSERT(text == expected);
+  TESTASSERT(decoded == expected);
+  TESTASSERT(text.find("1234:000567 [MAC ] [I] [10241] ints -1 2 -3 4 5 beef 0x001f 44 z\n") != std::string::npos);
+  TESTASSERT(text.find("[MAC ] [D] [10241] strings abc pad     | tru dynamic\n") != std::string::npos);
+  TESTASSERT(text.find("1234000567 [RRC ] [I] positional 7, formatted by the caller\n") != std::string::npos);
+
+  remove("logger_file.txt");
+  remove("logger_binary.txt");
+  remove("logger_binary.bin");
+  remove("logger_binary_decoded.txt");
+  return SRSLTE_SUCCESS;
+}
+
+// Messages of concurrent threads are all written
+int test_multithread()
+{
+  {
+    logger_binary l;
+    l.init("logger_binary_mt.txt", logger_binary::TEXT);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < NTHREADS; t++) {
+      threads.emplace_back([&l, t]() {
+        char name[16];
+        snprintf(name, sizeof(name), "T%d", t);
+        log_filter filter(name, &l);
+        filter.set_level(LOG_LEVEL_INFO);
+        for (int i = 0; i < NMSGS; i++) {
+          filter.info("Thread %d: %d\n", t, i);
+          if (i % 100 == 0) {
+            usleep(100);
+          }
+        }
+      });
+    }
+    for (std::thread& t : threads) {
+      t.join();
+    }
+    TESTASSERT(l.get_nof_dropped() == 0);
+  }
+
+  std::vector<std::vector<bool> > written(NTHREADS, std::vector<bool>(NMSGS, false));
+  std::ifstream                   f("logger_binary_mt.txt");
+  std::string                     line;
+  int                             nof_lines = 0;
+  while (std::getline(f, line)) {
+    int    t, i;
+    size_t pos = line.find("Thread ");
+    if (pos != std::string::npos and sscanf(line.c_str() + pos, "Thread %d: %d", &t, &i) == 2) {
+      TESTASSERT(t < NTHREADS and i < NMSGS and not written[t][i]);
+      written[t][i] = true;
+      nof_lines++;
+    }
+  }
+  TESTASSERT(nof_lines == NTHREADS * NMSGS);
+  remove("logger_binary_mt.txt");
+  return SRSLTE_SUCCESS;
+}
+
+// A full ring drops messages without blocking, and every message is either written or counted as dropped
+int test_ring_full()
+{
+  const int nof_msgs = 100000;
+  uint64_t  dropped  = 0;
+  {
+    logger_binary l;
+    l.init("logger_binary_drop.txt", logger_binary::TEXT, -1, 0);
+    log_filter filter("DROP", &l);
+    filter.set_level(LOG_LEVEL_INFO);
+    for (int i = 0; i < nof_msgs; i++) {
+      filter.info("Message %d with some payload to fill the ring %s\n", i, "..............................");
+    }
+    // Let the backend drain the ring so that the closing message is not dropped
+    usleep(100000);
+    l.stop();
+    dropped = l.get_nof_dropped();
+  }
+
+  std::ifstream f("logger_binary_drop.txt");
+  std::string   line;
+  int           nof_written = 0;
+  uint64_t      nof_dropped = 0;
+  while (std::getline(f, line)) {
+    unsigned long long n;
+    if (line.find("[DROP] [I] Message ") != std::string::npos) {
+      nof_written++;
+    } else if (sscanf(line.c_str(), "Log: %llu messages dropped", &n) == 1) {
+      nof_dropped += n;
+    }
+  }
+  printf("Ring full test: %d messages written, %" PRIu64 " dropped\n", nof_written, dropped);
+  TESTASSERT(nof_dropped == dropped);
+  TESTASSERT(nof_written + dropped == nof_msgs);
+  remove("logger_binary_drop.txt");
+  return SRSLTE_SUCCESS;
+}
+
+int main(int argc, char** argv)
+{
+  TESTASSERT(test_same_output() == SRSLTE_SUCCESS);
+  TESTASSERT(test_multithread() == SRSLTE_SUCCESS);
+  TESTASSERT(test_ring_full() == SRSLTE_SUCCESS);
+
+  printf("Success\n");
+  return SRSLTE_SUCCESS;
+}
@@ -0,0 +1,265 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#define NTHREADS 8
+#define NPDUS 2000
+
+#include "srslte/common/mac_pcap.h"
+#include "srslte/common/test_common.h"
+#include <fstream>
+#include <sstream>
+#include <stdio.h>
+#include <thread>
+#include <vector>
+
+using namespace srslte;
+
+struct pcap_packet_t {
+  pcaprec_hdr_t        hdr;
+  std::vector<uint8_t> data;
+};
+
+// Reads the packets of a pcap file. Returns false if the file is malformed
+static bool read_pcap(const std::string& filename, std::vector<pcap_packet_t>& packets)
+{
+  std::ifstream     f(filename, std::ios::binary);
+  std::stringstream ss;
+  ss << f.rdbuf();
+  std::string content = ss.str();
+
+  if (content.size() < sizeof(pcap_hdr_t)) {
+    return false;
+  }
+  pcap_hdr_t file_hdr;
+  memcpy(&file_hdr, content.data(), sizeof(pcap_hdr_t));
+  if (file_hdr.magic_number != 0xa1b2c3d4 or file_hdr.network != MAC_LTE_DLT) {
+    return false;
+  }
+  size_t pos = sizeof(pcap_hdr_t);
+  while (pos < content.size()) {
+    pcap_packet_t p;
+    if (pos + sizeof(pcaprec_hdr_t) > content.size()) {
+      return false;
+    }
+    memcpy(&p.hdr, content.data() + pos, sizeof(pcaprec_hdr_t));
+    pos += sizeof(pcaprec_hdr_t);
+    if (p.hdr.incl_len != p.hdr.orig_len or pos + p.hdr.incl_len > content.size()) {
+      return false;
+    }
+    p.data.assign(content.data() + pos, content.data() + pos + p.hdr.incl_len);
+    pos += p.hdr.incl_len;
+    packets.push_back(std::move(p));
+  }
+  return true;
+}
+
+// Builds a DL-SCH PDU with one SDU of the given LCID followed by padding
+static std::vector<uint8_t> make_pdu(uint32_t lcid, uint32_t sdu_len, uint8_t fill)
+{
+  std::vector<uint8_t> pdu;
+  pdu.push_back(0x20 | lcid);
+  pdu.push_back(sdu_len & 0x7f);
+  pdu.push_back(0x1f);
+  pdu.insert(pdu.end(), sdu_len, fill);
+  return pdu;
+}
+
+static void write_pdus(mac_pcap& pcap)
+{
+  for (uint32_t i = 0; i < 100; i++) {
+    std::vector<uint8_t> pdu = make_pdu(i % 4, 10 + i, i);
+    pcap.write_dl_crnti(pdu.data(), pdu.size(), 0x46 + i % 3, true, i, 0);
+    pcap.write_ul_crnti(pdu.data(), pdu.size(), 0x46 + i % 3, i % 2, i + 4, 1);
+  }
+  uint8_t sib[20] = {};
+  pcap.write_dl_sirnti(sib, sizeof(sib), true, 5, 0);
+  pcap.write_dl_bch(sib, 3, false, 0, 0);
+  pcap.write_dl_pch(sib, 8, true, 9, 0);
+  pcap.write_dl_ranti(sib, 7, 2, true, 3, 0);
+}
+
+// The asynchronous writer must produce the same packets as the synchronous one
+int test_same_output()
+{
+  mac_pcap sync_pcap;
+  sync_pcap.open("mac_pcap_sync.pcap", 3);
+  write_pdus(sync_pcap);
+  sync_pcap.close();
+
+  mac_pcap async_pcap;
+  async_pcap.open_async("mac_pcap_async.pcap", 3);
+  write_pdus(async_pcap);
+  async_pcap.close();
+
+  std::vector<pcap_packet_t> sync_packets, async_packets;
+  TESTASSERT(read_pcap("mac_pcap_sync.pcap", sync_packets));
+  TESTASSERT(read_pcap("mac_pcap_async.pcap", async_packets));
+  TESTASSERT(sync_packets.size() == 204);
+  TESTASSERT(async_packets.size() == sync_packets.size());
+  for (uint32_t i = 0; i < sync_packets.size(); i++) {
+    TESTASSERT(async_packets[i].data == sync_packets[i].data);
+  }
+  TESTASSERT(async_pcap.get_nof_dropped() == 0);
+
+  remove("mac_pcap_sync.pcap");
+  remove("mac_pcap_async.pcap");
+  return SRSLTE_SUCCESS;
+}
+
+int test_filters()
+{
+  mac_pcap pcap;
+  TESTASSERT(pcap.set_filters("0x46,abc", "") == SRSLTE_ERROR);
+  TESTASSERT(pcap.set_filters("", "32") == SRSLTE_ERROR);
+
+  for (uint32_t async = 0; async < 2; async++) {
+    TESTASSERT(pcap.set_filters("0x46, 71", "2,29") == SRSLTE_SUCCESS);
+    if (async) {
+      pcap.open_async("mac_pcap_filter.pcap");
+    } else {
+      pcap.open("mac_pcap_filter.pcap");
+    }
+    write_pdus(pcap);
+
+    // LCID 2 follows a subheader with a 15-bit length field
+    uint8_t pdu[] = {0x21, 0x80, 0x02, 0x02, 0xaa, 0xbb};
+    pcap.write_dl_crnti(pdu, sizeof(pdu), 0x46, true, 0, 0);
+    pcap.close();
+
+    // 16 DL and 16 UL PDUs of RNTIs 0x46 and 0x47 carry LCID 2, plus the PDU above and the 4 common channel PDUs
+    std::vector<pcap_packet_t> packets;
+    TESTASSERT(read_pcap("mac_pcap_filter.pcap", packets));
+    TESTASSERT(packets.size() == 37);
+  }
+  remove("mac_pcap_filter.pcap");
+  return SRSLTE_SUCCESS;
+}
+
+static void write_thread_pdus(mac_pcap* pcap, uint16_t rnti, uint32_t pdu_len)
+{
+  std::vector<uint8_t> pdu = make_pdu(1, pdu_len, (uint8_t)rnti);
+  for (uint32_t i = 0; i < NPDUS; i++) {
+    pcap->write_dl_crnti(pdu.data(), pdu.size(), rnti, true, i, 0);
+  }
+}
+
+// RNTI and TTI of a packet, from the context written by mac_pcap
+static uint16_t packet_rnti(const pcap_packet_t& p)
+{
+  return (p.data[4] << 8) | p.data[5];
+}
+
+static uint32_t packet_tti(const pcap_packet_t& p)
+{
+  uint32_t sfn_sf = (p.data[10] << 8) | p.data[11];
+  return (sfn_sf >> 4) * 10 + (sfn_sf & 0xf);
+}
+
+int test_multithread()
+{
+  mac_pcap pcap;
+  pcap.open_async("mac_pcap_threads.pcap");
+  std::vector<std::thread> threads;
+  for (uint32_t i = 0; i < NTHREADS; i++) {
+    threads.emplace_back(write_thread_pdus, &pcap, 0x46 + i, 100);
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  pcap.close();
+
+  std::vector<pcap_packet_t> packets;
+  TESTASSERT(read_pcap("mac_pcap_threads.pcap", packets));
+  TESTASSERT(pcap.get_nof_dropped() == 0);
+  TESTASSERT(packets.size() == NTHREADS * NPDUS);
+
+  // Packets of each thread are in order and not corrupted
+  std::vector<uint32_t> count(NTHREADS, 0);
+  for (auto& p : packets) {
+    uint16_t rnti = packet_rnti(p);
+    TESTASSERT(rnti >= 0x46 and rnti < 0x46 + NTHREADS);
+    TESTASSERT(packet_tti(p) == count[rnti - 0x46]);
+    TESTASSERT(p.data.back() == (uint8_t)rnti);
+    count[rnti - 0x46]++;
+  }
+  remove("mac_pcap_threads.pcap");
+  return SRSLTE_SUCCESS;
+}
+
+int test_ring_full()
+{
+  mac_pcap pcap;
+  pcap.open_async("mac_pcap_drop.pcap", 0, -1, 0, 0);
+  std::vector<std::thread> threads;
+  for (uint32_t i = 0; i < NTHREADS; i++) {
+    threads.emplace_back(write_thread_pdus, &pcap, 0x46 + i, 1000);
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  pcap.close();
+
+  std::vector<pcap_packet_t> packets;
+  TESTASSERT(read_pcap("mac_pcap_drop.pcap", packets));
+  printf("Ring full test: %zd PDUs written, %" PRIu64 " dropped\n", packets.size(), pcap.get_nof_dropped());
+  TESTASSERT(packets.size() + pcap.get_nof_dropped() == NTHREADS * NPDUS);
+  remove("mac_pcap_drop.pcap");
+  return SRSLTE_SUCCESS;
+}
+
+int test_rotation()
+{
+  mac_pcap pcap;
+  pcap.open_async("mac_pcap_rotation.pcap", 0, 16);
+  write_thread_pdus(&pcap, 0x46, 100);
+  pcap.close();
+
+  std::vector<pcap_packet_t> packets;
+  std::string                filename = "mac_pcap_rotation.pcap";
+  uint32_t                   nof_files = 0;
+  for (FILE* f = fopen(filename.c_str(), "r"); f != nullptr; f = fopen(filename.c_str(), "r")) {
+    fseek(f, 0, SEEK_END);
+    TESTASSERT(ftell(f) <= 16 * 1024);
+    fclose(f);
+    TESTASSERT(read_pcap(filename, packets));
+    remove(filename.c_str());
+    filename = "mac_pcap_rotation.pcap." + std::to_string(++nof_files);
+  }
+  printf("Rotation test: %d files\n", nof_files);
+  TESTASSERT(nof_files > 1);
+  TESTASSERT(packets.size() == NPDUS);
+  for (uint32_t i = 0; i < packets.size(); i++) {
+    TESTASSERT(packet_tti(packets[i]) == i);
+  }
+  return SRSLTE_SUCCESS;
+}
+
+int main(int argc, char** argv)
+{
+  TESTASSERT(test_same_output() == SRSLTE_SUCCESS);
+  TESTASSERT(test_filters() == SRSLTE_SUCCESS);
+  TESTASSERT(test_multithread() == SRSLTE_SUCCESS);
+  TESTASSERT(test_ring_full() == SRSLTE_SUCCESS);
+  TESTASSERT(test_rotation() == SRSLTE_SUCCESS);
+
+  printf("Success\n");
+  return SRSLTE_SUCCESS;
+}
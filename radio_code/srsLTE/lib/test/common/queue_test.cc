@@ -22,6 +22,8 @@
 #include "srslte/common/move_callback.h"
 #include "srslte/common/multiqueue.h"
 #include "srslte/common/thread_pool.h"
+#include <array>
+#include <atomic>
 #include <iostream>
 #include <thread>
 #include <unistd.h>
@@ -216,6 +218,139 @@ int test_multiqueue_threading3()
   return 0;
 }
 
+int test_lockfree_multiqueue()
+{
+  std::cout << "\n=== TEST lock-free multiqueue test: start ===\n";
+
+  int number = 2;
+
+  lockfree_multiqueue_handler<int> multiqueue(4);
+  TESTASSERT(multiqueue.nof_queues() == 0)
+
+  // test push/pop and size for one queue
+  int qid1 = multiqueue.add_queue();
+  TESTASSERT(qid1 == 0 and multiqueue.is_queue_active(qid1))
+  TESTASSERT(multiqueue.size(qid1) == 0 and multiqueue.empty(qid1))
+  TESTASSERT(multiqueue.try_push(qid1, 5).first)
+  TESTASSERT(multiqueue.try_push(qid1, number))
+  TESTASSERT(multiqueue.size(qid1) == 2 and not multiqueue.empty(qid1))
+  TESTASSERT(multiqueue.wait_pop(&number) == qid1 and number == 5)
+  TESTASSERT(multiqueue.try_pop(&number) == qid1 and number == 2)
+  TESTASSERT(multiqueue.try_pop(&number) == -1)
+
+  // TEST: a full queue rejects pushes and gives the object back
+  for (int i = 0; i < 4; ++i) {
+    TESTASSERT(multiqueue.try_push(qid1, i))
+  }
+  std::pair<bool, int> ret = multiqueue.try_push(qid1, 10);
+  TESTASSERT(not ret.first and ret.second == 10)
+  multiqueue.erase_queue(qid1);
+  TESTASSERT(multiqueue.nof_queues() == 0 and not multiqueue.is_queue_active(qid1))
+  TESTASSERT(not multiqueue.try_push(qid1, 10).first)
+
+  // TEST: erased queues are reused empty
+  qid1 = multiqueue.add_queue();
+  TESTASSERT(qid1 == 0 and multiqueue.empty(qid1))
+
+  // TEST: round-robin between queues of equal priority, and higher priority queues first
+  int qid2 = multiqueue.add_queue();
+  int qid3 = multiqueue.add_queue(1);
+  TESTASSERT(multiqueue.nof_queues() == 3)
+  for (int i = 0; i < 3; ++i) {
+    TESTASSERT(multiqueue.try_push(qid1, i))
+    TESTASSERT(multiqueue.try_push(qid2, 10 + i).first)
+  }
+  TESTASSERT(multiqueue.try_push(qid3, 20).first)
+  TESTASSERT(multiqueue.wait_pop(&number) == qid3 and number == 20)
+  TESTASSERT(multiqueue.wait_pop(&number) == qid1 and number == 0)
+  TESTASSERT(multiqueue.wait_pop(&number) == qid2 and number == 10)
+  TESTASSERT(multiqueue.try_push(qid3, 21).first)
+  TESTASSERT(multiqueue.wait_pop(&number) == qid3 and number == 21)
+
+  // TEST: batch pop keeps the same order, and stops when the queues are empty
+  int batch[8];
+  TESTASSERT(multiqueue.try_push(qid3, 22).first)
+  TESTASSERT(multiqueue.wait_pop_batch(batch, 3) == 3)
+  TESTASSERT(batch[0] == 22 and batch[1] == 1 and batch[2] == 11)
+  TESTASSERT(multiqueue.wait_pop_batch(batch, 8) == 2)
+  TESTASSERT(batch[0] == 2 and batch[1] == 12)
+
+  std::cout << "outcome: Success\n";
+  std::cout << "=============================================\n";
+
+  return 0;
+}
+
+int test_lockfree_multiqueue_threading()
+{
+  std::cout << "\n=== TEST lock-free multiqueue threading test: start ===\n";
+  // Description: several threads push to the same queues with blocking pushes, while the main thread pops in batches.
+  // All objects arrive, and objects of the same thread keep their order
+
+  int                              capacity = 16, nof_threads = 4, nof_pushes = 100000;
+  lockfree_multiqueue_handler<int> multiqueue(capacity);
+  int                              qid1 = multiqueue.add_queue(), qid2 = multiqueue.add_queue(1);
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < nof_threads; ++t) {
+    threads.emplace_back([&multiqueue, t, nof_threads, nof_pushes, qid1, qid2]() {
+      for (int i = 0; i < nof_pushes; ++i) {
+        multiqueue.push((t % 2 == 0) ? qid1 : qid2, i * nof_threads + t);
+      }
+    });
+  }
+
+  std::vector<int> next_value(nof_threads, 0);
+  int              batch[32], nof_popped = 0;
+  while (nof_popped < nof_threads * nof_pushes) {
+    uint32_t n = multiqueue.wait_pop_batch(batch, 32);
+    TESTASSERT(n > 0)
+    for (uint32_t i = 0; i < n; ++i) {
+      int t = batch[i] % nof_threads;
+      TESTASSERT(batch[i] / nof_threads == next_value[t])
+      next_value[t]++;
+    }
+    nof_popped += n;
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  TESTASSERT(multiqueue.empty(qid1) and multiqueue.empty(qid2))
+
+  // TEST: reset() unblocks a producer waiting on a full queue
+  for (int i = 0; i < capacity; ++i) {
+    TESTASSERT(multiqueue.try_push(qid1, i))
+  }
+  std::atomic<bool> t1_running{true};
+  std::thread       t1([&multiqueue, qid1, capacity, &t1_running]() {
+    multiqueue.push(qid1, capacity);
+    t1_running = false;
+  });
+  usleep(1000);
+  TESTASSERT(t1_running and (int)multiqueue.size(qid1) == capacity)
+  multiqueue.reset();
+  t1.join();
+  TESTASSERT(not multiqueue.is_queue_active(qid1) and multiqueue.add_queue() == -1)
+
+  // TEST: reset() unblocks a consumer waiting on empty queues
+  lockfree_multiqueue_handler<int> multiqueue2(capacity);
+  multiqueue2.add_queue();
+  int         t2_ret = 0;
+  std::thread t2([&multiqueue2, &t2_ret]() {
+    int number;
+    t2_ret = multiqueue2.wait_pop(&number);
+  });
+  usleep(1000);
+  multiqueue2.reset();
+  t2.join();
+  TESTASSERT(t2_ret == -1)
+
+  std::cout << "outcome: Success\n";
+  std::cout << "=======================================================\n";
+
+  return 0;
+}
+
 int test_task_thread_pool()
 {
   std::cout << "\n====== TEST task thread pool test 1: start ======\n";
@@ -321,6 +456,144 @@ int test_task_thread_pool3()
   return 0;
 }
 
+int test_work_stealing_pool()
+{
+  std::cout << "\n====== TEST work stealing pool test: start ======\n";
+  // Description: several threads split jobs into task groups. Every task runs once, and wait() only returns after all
+  // the tasks of its group have finished
+
+  uint32_t           nof_threads = 3, nof_submitters = 4, nof_jobs = 200, nof_tasks = 8;
+  work_stealing_pool pool(nof_threads);
+  pool.start();
+
+  std::vector<std::vector<std::atomic<uint32_t> > > counts(nof_submitters);
+  std::vector<int>                                  success(nof_submitters, 1);
+  std::vector<std::thread>                          submitters;
+  for (uint32_t s = 0; s < nof_submitters; ++s) {
+    counts[s] = std::vector<std::atomic<uint32_t> >(nof_tasks);
+    submitters.emplace_back([&pool, &counts, &success, s, nof_jobs, nof_tasks]() {
+      for (uint32_t j = 0; j < nof_jobs; ++j) {
+        work_stealing_pool::task_group group;
+        for (uint32_t t = 0; t < nof_tasks; ++t) {
+          pool.run(group, [&counts, s, t]() {
+            if (t % 2 == 0) {
+              usleep(10);
+            }
+            counts[s][t]++;
+          });
+        }
+        pool.wait(group);
+        for (uint32_t t = 0; t < nof_tasks; ++t) {
+          if (counts[s][t] != j + 1) {
+            success[s] = 0;
+          }
+        }
+      }
+    });
+  }
+  for (auto& t : submitters) {
+    t.join();
+  }
+  for (uint32_t s = 0; s < nof_submitters; ++s) {
+    TESTASSERT(success[s])
+  }
+  printf("stolen tasks: %d\n", pool.nof_stolen_tasks());
+  pool.stop();
+
+  // TEST: without threads, tasks run when submitted
+  work_stealing_pool             inline_pool(0);
+  work_stealing_pool::task_group group;
+  int                            v = 0;
+  inline_pool.run(group, [&v]() { v = 1; });
+  TESTASSERT(v == 1)
+  inline_pool.wait(group);
+
+  std::cout << "outcome: Success\n";
+  std::cout << "=================================================\n";
+  return 0;
+}
+
+// Worker that, like a UE subframe worker, waits for the previous TTI of its pool to be done
+class ordered_worker : public thread_pool::worker
+{
+public:
+  ordered_worker(std::mutex* mutex_, std::condition_variable* cvar_, int* last_tti_) :
+    mutex(mutex_),
+    cvar(cvar_),
+    last_tti(last_tti_)
+  {
+  }
+  int tti = 0;
+
+protected:
+  void work_imp() override
+  {
+    std::unique_lock<std::mutex> lock(*mutex);
+    while (*last_tti != tti - 1) {
+      cvar->wait(lock);
+    }
+    *last_tti = tti;
+    cvar->notify_all();
+  }
+
+private:
+  std::mutex*              mutex;
+  std::condition_variable* cvar;
+  int*                     last_tti;
+};
+
+int test_thread_pool_executor()
+{
+  std::cout << "\n====== TEST thread pool executor test: start ======\n";
+  // Description: the workers of several pools run, in order, on the single thread of a shared executor
+
+  const uint32_t   nof_pools = 3, nof_workers = 3;
+  const int        nof_ttis  = 1000;
+  task_thread_pool executor(1);
+  executor.start();
+
+  std::vector<std::unique_ptr<thread_pool> >    pools;
+  std::vector<std::unique_ptr<ordered_worker> > workers;
+  std::vector<std::mutex>                       mutexes(nof_pools);
+  std::vector<std::condition_variable>          cvars(nof_pools);
+  std::vector<int>                              last_tti(nof_pools, -1);
+  for (uint32_t p = 0; p < nof_pools; ++p) {
+    pools.emplace_back(new thread_pool(nof_workers));
+    pools[p]->set_executor(&executor);
+    for (uint32_t i = 0; i < nof_workers; ++i) {
+      workers.emplace_back(new ordered_worker(&mutexes[p], &cvars[p], &last_tti[p]));
+      pools[p]->init_worker(i, workers.back().get());
+    }
+  }
+
+  std::vector<std::thread> drivers;
+  for (uint32_t p = 0; p < nof_pools; ++p) {
+    thread_pool* pool = pools[p].get();
+    drivers.emplace_back([pool, nof_ttis]() {
+      for (int tti = 0; tti < nof_ttis; ++tti) {
+        ordered_worker* w = (ordered_worker*)pool->wait_worker(tti);
+        w->tti            = tti;
+        pool->start_worker(w);
+      }
+    });
+  }
+  for (auto& t : drivers) {
+    t.join();
+  }
+  for (uint32_t p = 0; p < nof_pools; ++p) {
+    for (uint32_t i = 0; i < nof_workers; ++i) {
+      TESTASSERT(pools[p]->wait_worker_id(i) != nullptr)
+    }
+    TESTASSERT(last_tti[p] == nof_ttis - 1)
+    pools[p]->stop();
+  }
+  executor.stop();
+
+  std::cout << "outcome: Success\n";
+  std::cout << "=================================================\n";
+  return 0;
+}
+
 struct C {
   std::unique_ptr<int> val{new int{5}};
 };
@@ -409,10 +682,14 @@ int main()
   TESTASSERT(test_multiqueue_threading() == 0);
   TESTASSERT(test_multiqueue_threading2() == 0);
   TESTASSERT(test_multiqueue_threading3() == 0);
+  TESTASSERT(test_lockfree_multiqueue() == 0);
+  TESTASSERT(test_lockfree_multiqueue_threading() == 0);
 
   TESTASSERT(test_task_thread_pool() == 0);
   TESTASSERT(test_task_thread_pool2() == 0);
   TESTASSERT(test_task_thread_pool3() == 0);
+  TESTASSERT(test_work_stealing_pool() == 0);
+  TESTASSERT(test_thread_pool_executor() == 0);
 
   TESTASSERT(test_inplace_task() == 0);
 }
@@ -22,6 +22,7 @@
 #include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "srslte/common/liblte_security.h"
 #include "srslte/srslte.h"
@@ -446,6 +447,104 @@ void test_set_1_invalid()
   free(out);
 }
 
+// Precomputed key schedule, encrypting and decrypting in place
+void test_set_2_ctx()
+{
+  LIBLTE_ERROR_ENUM err_lte = LIBLTE_ERROR_INVALID_INPUTS;
+  int32             err_cmp = 0;
+
+  uint8_t  key[]     = {0x2b, 0xd6, 0x45, 0x9f, 0x82, 0xc4, 0x40, 0xe0, 0x95, 0x2c, 0x49, 0x10, 0x48, 0x05, 0xff, 0x48};
+  uint32_t count     = 0xc675a64b;
+  uint8_t  bearer    = 0x0c;
+  uint8_t  direction = 1;
+  uint32_t len_bits = 798, len_bytes = (len_bits + 7) / 8;
+  uint8_t msg[] = {0x7e, 0xc6, 0x12, 0x72, 0x74, 0x3b, 0xf1, 0x61, 0x47, 0x26, 0x44, 0x6a, 0x6c, 0x38, 0xce, 0xd1, 0x66,
+                   0xf6, 0xca, 0x76, 0xeb, 0x54, 0x30, 0x04, 0x42, 0x86, 0x34, 0x6c, 0xef, 0x13, 0x0f, 0x92, 0x92, 0x2b,
+                   0x03, 0x45, 0x0d, 0x3a, 0x99, 0x75, 0xe5, 0xbd, 0x2e, 0xa0, 0xeb, 0x55, 0xad, 0x8e, 0x1b, 0x19, 0x9e,
+                   0x3e, 0xc4, 0x31, 0x60, 0x20, 0xe9, 0xa1, 0xb2, 0x85, 0xe7, 0x62, 0x79, 0x53, 0x59, 0xb7, 0xbd, 0xfd,
+                   0x39, 0xbe, 0xf4, 0xb2, 0x48, 0x45, 0x83, 0xd5, 0xaf, 0xe0, 0x82, 0xae, 0xe6, 0x38, 0xbf, 0x5f, 0xd5,
+                   0xa6, 0x06, 0x19, 0x39, 0x01, 0xa0, 0x8f, 0x4a, 0xb4, 0x1a, 0xab, 0x9b, 0x13, 0x48, 0x80};
+  uint8_t ct[]  = {0x59, 0x61, 0x60, 0x53, 0x53, 0xc6, 0x4b, 0xdc, 0xa1, 0x5b, 0x19, 0x5e, 0x28, 0x85, 0x53, 0xa9, 0x10,
+                  0x63, 0x25, 0x06, 0xd6, 0x20, 0x0a, 0xa7, 0x90, 0xc4, 0xc8, 0x06, 0xc9, 0x99, 0x04, 0xcf, 0x24, 0x45,
+                  0xcc, 0x50, 0xbb, 0x1c, 0xf1, 0x68, 0xa4, 0x96, 0x73, 0x73, 0x4e, 0x08, 0x1b, 0x57, 0xe3, 0x24, 0xce,
+                  0x52, 0x59, 0xc0, 0xe7, 0x8d, 0x4c, 0xd9, 0x7b, 0x87, 0x09, 0x76, 0x50, 0x3c, 0x09, 0x43, 0xf2, 0xcb,
+                  0x5a, 0xe8, 0xf0, 0x52, 0xc7, 0xb7, 0xd3, 0x92, 0x23, 0x95, 0x87, 0xb8, 0x95, 0x60, 0x86, 0xbc, 0xab,
+                  0x18, 0x83, 0x60, 0x42, 0xe2, 0xe6, 0xce, 0x42, 0x43, 0x2a, 0x17, 0x10, 0x5c, 0x53, 0xd0};
+
+  LIBLTE_SECURITY_AES_CTX_STRUCT* ctx = liblte_security_aes_ctx_alloc(key);
+  assert(ctx != NULL);
+
+  uint8_t* buf = (uint8_t*)calloc(len_bytes, sizeof(uint8_t));
+  memcpy(buf, msg, len_bytes);
+
+  // encryption
+  err_lte = liblte_security_encryption_eea2(ctx, count, bearer, direction, buf, len_bits, buf);
+  assert(err_lte == LIBLTE_SUCCESS);
+
+  // compare cipher text
+  err_cmp = arrcmp(ct, buf, len_bytes);
+  assert(err_cmp == 0);
+
+  // decryption
+  err_lte = liblte_security_decryption_eea2(ctx, count, bearer, direction, buf, len_bits, buf);
+  assert(err_lte == LIBLTE_SUCCESS);
+
+  // compare plain text
+  err_cmp = arrcmp(msg, buf, len_bytes);
+  assert(err_cmp == 0);
+
+  free(buf);
+  liblte_security_aes_ctx_free(ctx);
+}
+
+// The library and AES-NI backends must give the same key stream for all lengths, including partial blocks and bytes
+void test_backend_lengths()
+{
+  uint8_t  key[]     = {0xd3, 0xc5, 0xd5, 0x92, 0x32, 0x7f, 0xb1, 0x1c, 0x40, 0x35, 0xc6, 0x68, 0x0a, 0xf8, 0xc6, 0xd1};
+  uint32_t count     = 0x398a59b4;
+  uint8_t  bearer    = 0x15;
+  uint8_t  direction = 1;
+  uint8_t  msg[256];
+  uint8_t  out_lib[256];
+  uint8_t  out_aesni[256];
+
+  for (uint32_t i = 0; i < sizeof(msg); i++) {
+    msg[i] = (uint8_t)(i * 37 + 11);
+  }
+
+  LIBLTE_SECURITY_AES_CTX_STRUCT* lib_ctx   = liblte_security_aes_ctx_alloc(key, LIBLTE_SECURITY_AES_BACKEND_LIBRARY);
+  LIBLTE_SECURITY_AES_CTX_STRUCT* aesni_ctx = liblte_security_aes_ctx_alloc(key, LIBLTE_SECURITY_AES_BACKEND_AESNI);
+  assert(lib_ctx != NULL);
+  if (aesni_ctx == NULL) {
+    printf("AES-NI not supported by this CPU, only the library backend is tested\n");
+  }
+
+  for (uint32_t len_bits = 1; len_bits <= 8 * sizeof(msg); len_bits++) {
+    uint32_t len_bytes = (len_bits + 7) / 8;
+
+    // The key-based function must match the library backend
+    uint8_t out[256];
+    assert(liblte_security_encryption_eea2(key, count, bearer, direction, msg, len_bits, out) == LIBLTE_SUCCESS);
+    assert(liblte_security_encryption_eea2(lib_ctx, count, bearer, direction, msg, len_bits, out_lib) ==
+           LIBLTE_SUCCESS);
+    assert(arrcmp(out, out_lib, len_bytes) == 0);
+
+    if (aesni_ctx != NULL) {
+      assert(liblte_security_encryption_eea2(aesni_ctx, count, bearer, direction, msg, len_bits, out_aesni) ==
+             LIBLTE_SUCCESS);
+      assert(arrcmp(out_lib, out_aesni, len_bytes) == 0);
+
+      // Deciphering with the other backend gives the plain text back
+      assert(liblte_security_decryption_eea2(lib_ctx, count, bearer, direction, out_aesni, len_bits, out) ==
+             LIBLTE_SUCCESS);
+      assert(arrcmp(msg, out, len_bits / 8) == 0);
+    }
+  }
+
+  liblte_security_aes_ctx_free(lib_ctx);
+  liblte_security_aes_ctx_free(aesni_ctx);
+}
+
 /*
  * Functions
  */
@@ -460,4 +559,6 @@ int main(int argc, char* argv[])
   test_set_6();
   test_set_1_block_size();
   test_set_1_invalid();
+  test_set_2_ctx();
+  test_backend_lengths();
 }
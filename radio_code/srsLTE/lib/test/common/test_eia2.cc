@@ -0,0 +1,114 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "srslte/common/liblte_security.h"
+#include "srslte/common/security.h"
+#include "srslte/srslte.h"
+
+/*
+ * Tests
+ *
+ * Document Reference: 33.401 V14.6.0 Annex C.2
+ *
+ */
+
+void test_set_2()
+{
+  uint8_t  key[]     = {0xd3, 0xc5, 0xd5, 0x92, 0x32, 0x7f, 0xb1, 0x1c, 0x40, 0x35, 0xc6, 0x68, 0x0a, 0xf8, 0xc6, 0xd1};
+  uint32_t count     = 0x398a59b4;
+  uint8_t  bearer    = 0x1a;
+  uint8_t  direction = 1;
+  uint32_t len_bits = 64, len_bytes = (len_bits + 7) / 8;
+  uint8_t  msg[] = {0x48, 0x45, 0x83, 0xd5, 0xaf, 0xe0, 0x82, 0xae};
+  uint8_t  mt[]  = {0xb9, 0x37, 0x87, 0xe6};
+
+  uint8_t mac[4];
+
+  // gen mac
+  srslte::security_128_eia2(key, count, bearer, direction, msg, len_bytes, mac);
+
+  for (int i = 0; i < 4; i++) {
+    assert(mac[i] == mt[i]);
+  }
+
+  // gen mac with precomputed key
+  srslte::security_aes_ctx ctx;
+  ctx.set_key(key);
+  srslte::security_128_eia2(ctx, count, bearer, direction, msg, len_bytes, mac);
+
+  for (int i = 0; i < 4; i++) {
+    assert(mac[i] == mt[i]);
+  }
+}
+
+// The library and AES-NI backends must give the same MAC for all message lengths, including full and partial last
+// blocks, and the same as the key-based function
+void test_backend_lengths()
+{
+  uint8_t  key[]     = {0x83, 0xfd, 0x23, 0xa2, 0x44, 0xa7, 0x4c, 0xf3, 0x58, 0xda, 0x30, 0x19, 0xf1, 0x72, 0x26, 0x35};
+  uint32_t count     = 0x36af6144;
+  uint8_t  bearer    = 0x0f;
+  uint8_t  direction = 1;
+  uint8_t  msg[256];
+
+  for (uint32_t i = 0; i < sizeof(msg); i++) {
+    msg[i] = (uint8_t)(i * 37 + 11);
+  }
+
+  LIBLTE_SECURITY_AES_CTX_STRUCT* lib_ctx   = liblte_security_aes_ctx_alloc(key, LIBLTE_SECURITY_AES_BACKEND_LIBRARY);
+  LIBLTE_SECURITY_AES_CTX_STRUCT* aesni_ctx = liblte_security_aes_ctx_alloc(key, LIBLTE_SECURITY_AES_BACKEND_AESNI);
+  assert(lib_ctx != NULL);
+  if (aesni_ctx == NULL) {
+    printf("AES-NI not supported by this CPU, only the library backend is tested\n");
+  }
+
+  for (uint32_t len = 1; len <= sizeof(msg); len++) {
+    uint8_t mac[4], mac_lib[4], mac_aesni[4];
+    assert(liblte_security_128_eia2(key, count, bearer, direction, msg, len, mac) == LIBLTE_SUCCESS);
+    assert(liblte_security_128_eia2(lib_ctx, count, bearer, direction, msg, len, mac_lib) == LIBLTE_SUCCESS);
+    for (int i = 0; i < 4; i++) {
+      assert(mac[i] == mac_lib[i]);
+    }
+    if (aesni_ctx != NULL) {
+      assert(liblte_security_128_eia2(aesni_ctx, count, bearer, direction, msg, len, mac_aesni) == LIBLTE_SUCCESS);
+      for (int i = 0; i < 4; i++) {
+        assert(mac_lib[i] == mac_aesni[i]);
+      }
+    }
+  }
+
+  liblte_security_aes_ctx_free(lib_ctx);
+  liblte_security_aes_ctx_free(aesni_ctx);
+}
+
+/*
+ * Functions
+ */
+
+int main(int argc, char* argv[])
+{
+  test_set_2();
+  test_backend_lengths();
+}
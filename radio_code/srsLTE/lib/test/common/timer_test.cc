@@ -20,8 +20,10 @@
  */
 
 #include "srslte/common/timers.h"
+#include <chrono>
 #include <iostream>
 #include <random>
+#include <set>
 #include <srslte/common/tti_sync_cv.h>
 #include <thread>
 
@@ -412,6 +414,146 @@ int timers_test6()
   return SRSLTE_SUCCESS;
 }
 
+/**
+ * Description: Timers expire at the right time when their timeout crosses the levels of the timing wheel
+ */
+int timers_test7()
+{
+  timer_handler timers;
+
+  // Start at an offset, so that timeouts do not align with the wheel slots
+  for (uint32_t i = 0; i < 100; ++i) {
+    timers.step_all();
+  }
+
+  std::vector<uint32_t>                    durations = {1, 255, 256, 257, 511, 65535, 65536, 65537, 70000, 200000};
+  std::vector<uint32_t>                    expiry(durations.size(), 0);
+  std::vector<timer_handler::unique_timer> utimers;
+  for (uint32_t i = 0; i < durations.size(); ++i) {
+    utimers.push_back(timers.get_unique_timer());
+    utimers[i].set(durations[i], [&timers, &expiry, i](uint32_t tid) { expiry[i] = timers.get_cur_time(); });
+    utimers[i].run();
+  }
+  uint32_t start = timers.get_cur_time();
+  for (uint32_t i = 0; i < durations.back(); ++i) {
+    timers.step_all();
+  }
+  for (uint32_t i = 0; i < durations.size(); ++i) {
+    TESTASSERT(expiry[i] == start + durations[i]);
+    TESTASSERT(utimers[i].is_expired());
+  }
+
+  // TEST: a timer re-run from its own callback, across several turns of the wheel
+  uint32_t nof_calls = 0;
+  utimers[0].set(300, [&utimers, &nof_calls](uint32_t tid) {
+    nof_calls++;
+    utimers[0].run();
+  });
+  utimers[0].run();
+  for (uint32_t i = 0; i < 3000; ++i) {
+    timers.step_all();
+  }
+  TESTASSERT(nof_calls == 10);
+
+  return SRSLTE_SUCCESS;
+}
+
+/**
+ * Description: Start, stop and expire a large number of timers, and measure the time spent in each operation
+ */
+int timers_test8()
+{
+  using std::chrono::duration_cast;
+  using std::chrono::high_resolution_clock;
+  using std::chrono::microseconds;
+
+  timer_handler timers;
+  uint32_t      nof_timers = 100000, max_duration = 1000;
+  std::mt19937  mt19937(4);
+  std::uniform_int_distribution<uint32_t> dur_dist(1, max_duration);
+
+  std::vector<timer_handler::unique_timer> utimers;
+  utimers.reserve(nof_timers);
+  uint32_t nof_calls = 0;
+  for (uint32_t i = 0; i < nof_timers; ++i) {
+    utimers.push_back(timers.get_unique_timer());
+    utimers[i].set(dur_dist(mt19937), [&nof_calls](uint32_t tid) { nof_calls++; });
+  }
+
+  auto tstart = high_resolution_clock::now();
+  for (uint32_t i = 0; i < nof_timers; ++i) {
+    utimers[i].run();
+  }
+  auto trun = high_resolution_clock::now();
+  for (uint32_t i = 0; i < nof_timers; i += 2) {
+    utimers[i].stop();
+  }
+  auto tstop = high_resolution_clock::now();
+  for (uint32_t i = 0; i < max_duration; ++i) {
+    timers.step_all();
+  }
+  auto tstep = high_resolution_clock::now();
+
+  TESTASSERT(nof_calls == nof_timers / 2);
+  TESTASSERT(timers.nof_running_timers() == 0);
+  printf("%d timers: run=%ld us, stop=%ld us, step=%ld us\n",
+         nof_timers,
+         (long)duration_cast<microseconds>(trun - tstart).count(),
+         (long)duration_cast<microseconds>(tstop - trun).count(),
+         (long)duration_cast<microseconds>(tstep - tstop).count());
+
+  return SRSLTE_SUCCESS;
+}
+
+/**
+ * Description: stop_all() stops the running timers, and keeps the released ones available for reuse
+ */
+int timers_test9()
+{
+  timer_handler timers;
+  uint32_t      nof_timers = 10, nof_calls = 0;
+
+  std::vector<timer_handler::unique_timer> utimers;
+  for (uint32_t i = 0; i < nof_timers; ++i) {
+    utimers.push_back(timers.get_unique_timer());
+    utimers[i].set(5, [&nof_calls](uint32_t tid) { nof_calls++; });
+    utimers[i].run();
+  }
+
+  // Release half of the timers, then stop the rest
+  std::set<uint32_t> released_ids;
+  for (uint32_t i = 0; i < nof_timers; i += 2) {
+    released_ids.insert(utimers[i].id());
+    utimers[i].release();
+  }
+  timers.stop_all();
+  TESTASSERT(timers.nof_running_timers() == 0);
+  TESTASSERT(timers.nof_timers() == nof_timers / 2);
+  for (uint32_t i = 0; i < 10; ++i) {
+    timers.step_all();
+  }
+  TESTASSERT(nof_calls == 0);
+
+  // The released timers are reused, instead of allocating new ones
+  for (uint32_t i = 0; i < nof_timers; i += 2) {
+    utimers[i] = timers.get_unique_timer();
+    TESTASSERT(released_ids.count(utimers[i].id()) == 1);
+  }
+  TESTASSERT(timers.nof_timers() == nof_timers);
+
+  // The stopped timers can run again
+  for (uint32_t i = 0; i < nof_timers; ++i) {
+    utimers[i].set(5, [&nof_calls](uint32_t tid) { nof_calls++; });
+    utimers[i].run();
+  }
+  for (uint32_t i = 0; i < 5; ++i) {
+    timers.step_all();
+  }
+  TESTASSERT(nof_calls == nof_timers);
+
+  return SRSLTE_SUCCESS;
+}
+
 int main()
 {
   TESTASSERT(timers_test1() == SRSLTE_SUCCESS);
@@ -420,6 +562,9 @@ int main()
   TESTASSERT(timers_test4() == SRSLTE_SUCCESS);
   TESTASSERT(timers_test5() == SRSLTE_SUCCESS);
   TESTASSERT(timers_test6() == SRSLTE_SUCCESS);
+  TESTASSERT(timers_test7() == SRSLTE_SUCCESS);
+  TESTASSERT(timers_test8() == SRSLTE_SUCCESS);
+  TESTASSERT(timers_test9() == SRSLTE_SUCCESS);
   printf("Success\n");
   return 0;
 }
@@ -0,0 +1,148 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+#include "pdcp_lte_test.h"
+
+/*
+ * Generic function to test transmission of a burst of SDUs.
+ * The last PDU of the burst is compared to the one produced by a single write_sdu() with the same COUNT.
+ */
+int test_tx_burst(uint32_t                            n_sdus,
+                  const pdcp_lte_initial_state&       init_state,
+                  uint8_t                             pdcp_sn_len,
+                  srslte::pdcp_rb_type_t              rb_type,
+                  const srslte::unique_byte_buffer_t& sdu,
+                  srslte::byte_buffer_pool*           pool,
+                  srslte::log_ref                     log)
+{
+  srslte::pdcp_config_t cfg = {1,
+                               rb_type,
+                               srslte::SECURITY_DIRECTION_UPLINK,
+                               srslte::SECURITY_DIRECTION_DOWNLINK,
+                               pdcp_sn_len,
+                               srslte::pdcp_t_reordering_t::ms500,
+                               srslte::pdcp_discard_timer_t::infinity};
+
+  pdcp_lte_test_helper     pdcp_hlp(cfg, sec_cfg, log);
+  srslte::pdcp_entity_lte* pdcp = &pdcp_hlp.pdcp;
+  rlc_dummy*               rlc  = &pdcp_hlp.rlc;
+  pdcp_hlp.set_pdcp_initial_state(init_state);
+
+  srslte::unique_byte_buffer_list_t burst;
+  for (uint32_t i = 0; i < n_sdus; ++i) {
+    srslte::unique_byte_buffer_t tx_sdu = srslte::allocate_unique_buffer(*pool);
+    *tx_sdu                             = *sdu;
+    burst.push_back(std::move(tx_sdu));
+  }
+  pdcp->write_sdu_burst(burst, true);
+
+  TESTASSERT(burst.empty());
+  TESTASSERT(rlc->rx_count == n_sdus);
+
+  srslte::unique_byte_buffer_t pdu_act = srslte::allocate_unique_buffer(*pool);
+  rlc->get_last_sdu(pdu_act);
+  srslte::unique_byte_buffer_t pdu_exp =
+      gen_expected_pdu(sdu, init_state.tx_count + n_sdus - 1, pdcp_sn_len, rb_type, sec_cfg, pool, log);
+  TESTASSERT(compare_two_packets(pdu_exp, pdu_act) == 0);
+  return 0;
+}
+
+/*
+ * TX Test: PDCP Entity with SN LEN = 5 and 12.
+ * PDCP entity configured with EIA2 and EEA2
+ */
+int test_tx_all(srslte::byte_buffer_pool* pool, srslte::log_ref log)
+{
+  srslte::unique_byte_buffer_t tst_sdu1 = allocate_unique_buffer(*pool);
+  tst_sdu1->append_bytes(sdu1, sizeof(sdu1));
+
+  /*
+   * TX Test 1: PDCP LTE Entity with SN LEN = 5
+   * Burst of 4 SDUs crossing the SN wraparound.
+   */
+  {
+    pdcp_lte_initial_state init_state = {};
+    init_state.tx_count               = 30;
+    TESTASSERT(test_tx_burst(4, init_state, srslte::PDCP_SN_LEN_5, srslte::PDCP_RB_IS_SRB, tst_sdu1, pool, log) == 0);
+  }
+
+  /*
+   * TX Test 2: PDCP LTE Entity with SN LEN = 12
+   * Burst of 64 SDUs crossing the SN wraparound.
+   */
+  {
+    pdcp_lte_initial_state init_state = {};
+    init_state.tx_count               = 4064;
+    TESTASSERT(test_tx_burst(64, init_state, srslte::PDCP_SN_LEN_12, srslte::PDCP_RB_IS_DRB, tst_sdu1, pool, log) ==
+               0);
+  }
+
+  /*
+   * TX Test 3: empty burst does not advance COUNT.
+   * The next single SDU must still be sent with COUNT 0.
+   */
+  {
+    srslte::pdcp_config_t cfg = {1,
+                                 srslte::PDCP_RB_IS_DRB,
+                                 srslte::SECURITY_DIRECTION_UPLINK,
+                                 srslte::SECURITY_DIRECTION_DOWNLINK,
+                                 srslte::PDCP_SN_LEN_12,
+                                 srslte::pdcp_t_reordering_t::ms500,
+                                 srslte::pdcp_discard_timer_t::infinity};
+    pdcp_lte_test_helper              pdcp_hlp(cfg, sec_cfg, log);
+    srslte::unique_byte_buffer_list_t burst;
+    pdcp_hlp.pdcp.write_sdu_burst(burst, true);
+    TESTASSERT(pdcp_hlp.rlc.rx_count == 0);
+
+    srslte::unique_byte_buffer_t tx_sdu = srslte::allocate_unique_buffer(*pool);
+    *tx_sdu                             = *tst_sdu1;
+    pdcp_hlp.pdcp.write_sdu(std::move(tx_sdu), true);
+    srslte::unique_byte_buffer_t pdu_act = srslte::allocate_unique_buffer(*pool);
+    pdcp_hlp.rlc.get_last_sdu(pdu_act);
+    srslte::unique_byte_buffer_t pdu_exp =
+        gen_expected_pdu(tst_sdu1, 0, srslte::PDCP_SN_LEN_12, srslte::PDCP_RB_IS_DRB, sec_cfg, pool, log);
+    TESTASSERT(compare_two_packets(pdu_exp, pdu_act) == 0);
+  }
+
+  return SRSLTE_SUCCESS;
+}
+
+// Setup all tests
+int run_all_tests(srslte::byte_buffer_pool* pool)
+{
+  // Setup log
+  srslte::log_ref log("PDCP LTE Test TX");
+  log->set_level(srslte::LOG_LEVEL_DEBUG);
+  log->set_hex_limit(128);
+
+  TESTASSERT(test_tx_all(pool, log) == 0);
+  return 0;
+}
+
+int main()
+{
+  if (run_all_tests(srslte::byte_buffer_pool::get_instance()) != SRSLTE_SUCCESS) {
+    fprintf(stderr, "pdcp_lte_tests_tx() failed\n");
+    return SRSLTE_ERROR;
+  }
+  srslte::byte_buffer_pool::cleanup();
+
+  return SRSLTE_SUCCESS;
+}
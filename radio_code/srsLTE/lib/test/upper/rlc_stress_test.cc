@@ -28,6 +28,7 @@
 #include <boost/program_options.hpp>
 #include <boost/program_options/parsers.hpp>
 #include <cassert>
+#include <chrono>
 #include <cstdlib>
 #include <iostream>
 #include <pthread.h>
@@ -180,6 +181,10 @@ public:
 
   void enqueue_task(srslte::move_task_t task) { pending_tasks.push(std::move(task)); }
 
+  // Valid once the thread has finished
+  uint64_t get_nof_ttis() { return nof_ttis; }
+  double   get_cpu_time_sec() { return cpu_time_sec; }
+
 private:
   void run_tx_tti(rlc_interface_mac* tx_rlc, rlc_interface_mac* rx_rlc, std::vector<unique_byte_buffer_t>& pdu_list)
   {
@@ -294,6 +299,7 @@ private:
 
       // step timer
       timers->step_all();
+      nof_ttis++;
 
       if (pending_tasks.try_pop(&task)) {
         task();
@@ -302,6 +308,11 @@ private:
     if (pending_tasks.try_pop(&task)) {
       task();
     }
+
+    // All RLC PDU processing happens in this thread
+    struct timespec ts = {};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    cpu_time_sec = ts.tv_sec + ts.tv_nsec * 1e-9;
   }
 
   rlc_interface_mac* rlc1;
@@ -316,6 +327,9 @@ private:
 
   srslte::block_queue<srslte::move_task_t> pending_tasks;
 
+  uint64_t nof_ttis     = 0;
+  double   cpu_time_sec = 0.0;
+
   std::mt19937                          mt19937;
   std::uniform_real_distribution<float> real_dist;
 };
@@ -486,6 +500,7 @@ void stress_test(stress_test_args_t args)
     rlc2.add_bearer(lcid, cnfg_);
   }
 
+  auto t_start = std::chrono::steady_clock::now();
   tester1.start(7);
   if (!args.single_tx) {
     tester2.start(7);
@@ -522,6 +537,7 @@ void stress_test(stress_test_args_t args)
   printf("Writers stopped.\n");
 
   mac.stop();
+  double elapsed_sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t_start).count();
   if (args.write_pcap) {
     pcap.close();
   }
@@ -543,6 +559,20 @@ void stress_test(stress_test_args_t args)
          static_cast<double>(tester2.get_nof_rx_pdus() / args.test_duration_sec),
          metrics.bearer[lcid].num_tx_bytes,
          metrics.bearer[lcid].num_rx_bytes);
+
+  // Throughput figures, all generated SDUs have the same size
+  uint64_t rx_sdus  = tester1.get_nof_rx_pdus() + tester2.get_nof_rx_pdus();
+  uint64_t rx_bytes = rx_sdus * args.sdu_size;
+  printf("Throughput: %.2f Mbit/s, %.0f SDUs/s over %.2fs\n",
+         rx_bytes * 8 / elapsed_sec / 1e6,
+         rx_sdus / elapsed_sec,
+         elapsed_sec);
+  if (mac.get_nof_ttis() > 0 && rx_bytes > 0) {
+    printf("MAC/RLC thread: %" PRIu64 " TTIs, %.2f us CPU per TTI, %.2f ns CPU per received byte\n",
+           mac.get_nof_ttis(),
+           mac.get_cpu_time_sec() * 1e6 / mac.get_nof_ttis(),
+           mac.get_cpu_time_sec() * 1e9 / rx_bytes);
+  }
 }
 
 int main(int argc, char** argv)
@@ -81,6 +81,7 @@ struct log_args_t {
   int         all_hex_limit;
   int         file_max_size;
   std::string filename;
+  std::string backend;
 };
 
 struct gui_args_t {
@@ -41,6 +41,7 @@ public:
   cf_t* get_buffer_rx(uint32_t antenna_idx);
   cf_t* get_buffer_tx(uint32_t antenna_idx);
   void  set_tti(uint32_t tti);
+  void  move_to_local_node();
 
   int      add_rnti(uint16_t rnti, bool is_pcell, bool is_temporal);
   void     rem_rnti(uint16_t rnti);
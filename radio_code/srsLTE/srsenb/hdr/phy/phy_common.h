@@ -68,6 +68,9 @@ public:
   // Common objects
   phy_args_t params = {};
 
+  // Runs the carrier sub-tasks of the workers. Without threads, the sub-tasks run in the worker itself
+  srslte::work_stealing_pool* subtask_pool = nullptr;
+
   uint32_t get_nof_carriers() { return static_cast<uint32_t>(cell_list.size()); };
   uint32_t get_nof_prb(uint32_t cc_idx)
   {
@@ -49,8 +49,12 @@ struct phy_args_t {
   float       max_prach_offset_us = 10;
   int         pusch_max_its       = 10;
   bool        pusch_8bit_decoder  = false;
+  bool        pdsch_coworker      = false;
   float       tx_amplitude        = 1.0f;
   int         nof_phy_threads     = 1;
+  int         nof_subtask_threads = 0;  ///< threads that run the carrier sub-tasks of the PHY workers
+  std::string worker_cpus         = ""; ///< comma-separated CPU cores for the PHY workers, empty for no pinning
+  std::string subtask_cpus        = ""; ///< comma-separated CPU cores for the sub-task threads
   std::string equalizer_mode      = "mmse";
   float       estimator_fil_w     = 1.0f;
   bool        pusch_meas_epre     = true;
@@ -57,11 +57,15 @@ public:
 private:
   void work_imp() final;
 
+  template <typename F>
+  void for_each_cc(const F& f);
+
   /* Common objects */
   srslte::log* log_h     = nullptr;
   phy_common*  phy       = nullptr;
   bool         initiated = false;
   bool         running   = false;
+  bool         numa_done = false;
   std::mutex   work_mutex;
 
   uint32_t           tti_rx = 0, tti_tx_dl = 0, tti_tx_ul = 0;
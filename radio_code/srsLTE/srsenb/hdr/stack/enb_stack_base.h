@@ -22,6 +22,7 @@
 #ifndef SRSLTE_ENB_STACK_BASE_H
 #define SRSLTE_ENB_STACK_BASE_H
 
+#include <stdint.h>
 #include <string>
 
 namespace srsenb {
@@ -29,6 +30,11 @@ namespace srsenb {
 typedef struct {
   bool        enable;
   std::string filename;
+  bool        async;
+  int         max_file_size;
+  uint32_t    rotation_period;
+  std::string filter_rnti;
+  std::string filter_lcid;
 } pcap_args_t;
 
 typedef struct {
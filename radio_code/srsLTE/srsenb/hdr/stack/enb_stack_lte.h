@@ -138,6 +138,7 @@ private:
   // components that layers depend on (need to be destroyed after layers)
   srslte::timer_handler                           timers;
   std::unique_ptr<srslte::rx_multisocket_handler> rx_sockets;
+  srsenb::ue_slot_index                           ue_index; // UE slots shared by PDCP, RLC and GTP-U
 
   srsenb::mac       mac;
   srslte::mac_pcap  mac_pcap;
@@ -164,7 +165,8 @@ private:
   phy_interface_stack_lte* phy = nullptr;
 
   // state
-  bool                    started = false;
+  static const uint32_t   max_task_batch = 16; ///< tasks popped at once by the stack thread
+  bool                    started        = false;
   srslte::task_multiqueue pending_tasks;
   int enb_queue_id = -1, sync_queue_id = -1, mme_queue_id = -1, gtpu_queue_id = -1, mac_queue_id = -1,
       stack_queue_id = -1;
@@ -82,16 +82,33 @@ public:
   std::string result_to_string(bool verbose = false) const;
 
 private:
+  //! CCE mask packed in two words, so that allocation states can be compared and hashed cheaply
+  struct cce_mask_t {
+    uint64_t w[2] = {0, 0};
+
+    cce_mask_t() = default;
+    cce_mask_t(uint32_t start, uint32_t len);
+    bool       intersects(const cce_mask_t& other) const { return ((w[0] & other.w[0]) | (w[1] & other.w[1])) != 0; }
+    cce_mask_t operator|(const cce_mask_t& other) const;
+    bool       operator==(const cce_mask_t& other) const { return w[0] == other.w[0] and w[1] == other.w[1]; }
+    uint32_t   hash() const;
+  };
+  static_assert(sched_interface::max_cce <= 128, "cce_mask_t holds up to 128 CCEs");
+
   struct alloc_tree_t {
     struct node_t {
-      int     parent_idx;
-      alloc_t node;
-      node_t(int i, const alloc_t& a) : parent_idx(i), node(a) {}
+      int        parent_idx;
+      alloc_t    node;
+      cce_mask_t total; ///< Same as node.total_mask, used for collision checks and pruning
+      node_t(int i, const alloc_t& a, const cce_mask_t& t) : parent_idx(i), node(a), total(t) {}
     };
     // state
     size_t              nof_cces;
     std::vector<node_t> dci_alloc_tree;
     size_t              prev_start = 0, prev_end = 0;
+    size_t              nof_dcis = 0;    ///< Number of DCI records (tree levels) allocated
+    bool                greedy   = true; ///< In greedy mode, the tree holds a single allocation route
+    std::vector<int>    leaf_table;      ///< Open-addressing hash set of the new leaves' total masks
 
     explicit alloc_tree_t(size_t nof_cces_) : nof_cces(nof_cces_) {}
     size_t nof_leaves() const { return prev_end - prev_start; }
@@ -107,12 +124,8 @@ private:
   const sched_dci_cce_t* get_cce_loc_table(alloc_type_t alloc_type, sched_ue* user, uint32_t cfix) const;
 
   // PDCCH allocation algorithm
-  bool        alloc_dci_record(const alloc_record_t& record, uint32_t cfix);
-  static bool add_tree_node_leaves(alloc_tree_t&          tree,
-                                   int                    node_idx,
-                                   const alloc_record_t&  dci_record,
-                                   const sched_dci_cce_t& dci_locs,
-                                   uint32_t               tti_tx_dl);
+  bool alloc_dci_record(const alloc_record_t& record, uint32_t cfix);
+  bool add_tree_level(alloc_tree_t& tree, const alloc_record_t& record, uint32_t cfix, size_t max_leaves);
 
   // consts
   const sched_cell_params_t* cc_cfg = nullptr;
@@ -121,8 +134,9 @@ private:
   // tti vars
   const tti_params_t*         tti_params   = nullptr;
   uint32_t                    current_cfix = 0;
-  std::vector<alloc_tree_t>   alloc_trees;     ///< List of PDCCH alloc trees, where index is the cfi index
-  std::vector<alloc_record_t> dci_record_list; ///< Keeps a record of all the PDCCH allocations done so far
+  size_t                      max_states   = 0; ///< Cap on the PDCCH allocation combinations kept per tree level
+  std::vector<alloc_tree_t>   alloc_trees;      ///< List of PDCCH alloc trees, where index is the cfi index
+  std::vector<alloc_record_t> dci_record_list;  ///< Keeps a record of all the PDCCH allocations done so far
 };
 
 //! manages a subframe grid resources, namely CCE and DL/UL RB allocations
@@ -384,6 +384,9 @@ private:
   std::map<uint16_t, std::unique_ptr<ue> >       users; // NOTE: has to have fixed addr
   std::map<uint32_t, asn1::rrc::paging_record_s> pending_paging;
 
+  // Storage of the dynamic members of received UL-CCCH and UL-DCCH messages
+  asn1::mem_arena rx_arena;
+
   cell_ctxt_t* find_cell_ctxt(uint32_t cell_id);
 
   void     process_release_complete(uint16_t rnti);
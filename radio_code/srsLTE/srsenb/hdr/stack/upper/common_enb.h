@@ -31,6 +31,7 @@
 namespace srsenb {
 
 #define ENB_METRICS_MAX_USERS 64
+#define SRSENB_MAX_UES 1024
 #define SRSENB_RRC_MAX_N_PLMN_IDENTITIES 6
 
 #define SRSENB_N_SRB 3
@@ -19,15 +19,16 @@
  *
  */
 
-#include <map>
 #include <string.h>
 
 #include "common_enb.h"
 #include "srslte/common/buffer_pool.h"
 #include "srslte/common/logmap.h"
+#include "srslte/common/network_utils.h"
 #include "srslte/common/threads.h"
 #include "srslte/interfaces/enb_interfaces.h"
 #include "srslte/srslte.h"
+#include "ue_slot_map.h"
 
 #ifndef SRSENB_GTPU_H
 #define SRSENB_GTPU_H
@@ -37,7 +38,7 @@ namespace srsenb {
 class gtpu final : public gtpu_interface_rrc, public gtpu_interface_pdcp
 {
 public:
-  gtpu();
+  explicit gtpu(ue_slot_index* ue_index = nullptr);
 
   int  init(std::string               gtp_bind_addr_,
             std::string               mme_addr_,
@@ -58,6 +59,8 @@ public:
 
   // stack interface
   void handle_gtpu_s1u_rx_packet(srslte::unique_byte_buffer_t pdu, const sockaddr_in& addr);
+  void handle_gtpu_s1u_rx_burst(srslte::unique_byte_buffer_list_t& pdus, const std::vector<sockaddr_in>& addrs);
+  void flush_tx();
   void handle_gtpu_m1u_rx_packet(srslte::unique_byte_buffer_t pdu, const sockaddr_in& addr);
 
 private:
@@ -103,12 +106,19 @@ private:
     uint32_t teids_out[SRSENB_N_RADIO_BEARERS];
     uint32_t spgw_addrs[SRSENB_N_RADIO_BEARERS];
   } bearer_map;
-  std::map<uint16_t, bearer_map> rnti_bearers;
+  ue_slot_map<bearer_map> rnti_bearers;
 
   // Socket file descriptor
   int fd = -1;
 
+  // UL PDUs waiting to be sent in a single sendmmsg call
+  srslte::net_utils::udp_tx_batch tx_batch;
+
   void echo_response(in_addr_t addr, in_port_t port, uint16_t seq);
+  bool read_s1u_data_pdu(const srslte::unique_byte_buffer_t& pdu,
+                         const sockaddr_in&                  addr,
+                         uint16_t*                           rnti,
+                         uint16_t*                           lcid);
 
   /****************************************************************************
    * TEID to RNIT/LCID helper functions
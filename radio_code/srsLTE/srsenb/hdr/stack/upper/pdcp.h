@@ -23,7 +23,7 @@
 #include "srslte/interfaces/enb_interfaces.h"
 #include "srslte/interfaces/ue_interfaces.h"
 #include "srslte/upper/pdcp.h"
-#include <map>
+#include "ue_slot_map.h"
 
 #ifndef SRSENB_PDCP_H
 #define SRSENB_PDCP_H
@@ -33,7 +33,7 @@ namespace srsenb {
 class pdcp : public pdcp_interface_rlc, public pdcp_interface_gtpu, public pdcp_interface_rrc
 {
 public:
-  pdcp(srslte::task_handler_interface* task_executor_, const char* logname);
+  pdcp(srslte::task_handler_interface* task_executor_, const char* logname, ue_slot_index* ue_index = nullptr);
   virtual ~pdcp() {}
   void init(rlc_interface_pdcp* rlc_, rrc_interface_pdcp* rrc_, gtpu_interface_pdcp* gtpu_);
   void stop();
@@ -47,6 +47,7 @@ public:
   void add_user(uint16_t rnti) override;
   void rem_user(uint16_t rnti) override;
   void write_sdu(uint16_t rnti, uint32_t lcid, srslte::unique_byte_buffer_t sdu) override;
+  void write_sdu_burst(uint16_t rnti, uint32_t lcid, srslte::unique_byte_buffer_list_t& sdus) override;
   void add_bearer(uint16_t rnti, uint32_t lcid, srslte::pdcp_config_t cnfg) override;
   void config_security(uint16_t rnti, uint32_t lcid, srslte::as_security_config_t cfg_sec) override;
   void enable_integrity(uint16_t rnti, uint32_t lcid) override;
@@ -62,6 +63,7 @@ private:
     srsenb::rlc_interface_pdcp* rlc;
     // rlc_interface_pdcp
     void write_sdu(uint32_t lcid, srslte::unique_byte_buffer_t sdu, bool blocking);
+    void write_sdu_burst(uint32_t lcid, srslte::unique_byte_buffer_list_t& sdus, bool blocking);
     void discard_sdu(uint32_t lcid, uint32_t discard_sn);
     bool rb_is_um(uint32_t lcid);
   };
@@ -101,7 +103,7 @@ private:
 
   void clear_user(user_interface* ue);
 
-  std::map<uint32_t, user_interface> users;
+  ue_slot_map<user_interface> users;
 
   rlc_interface_pdcp*             rlc;
   rrc_interface_pdcp*             rrc;
@@ -22,7 +22,7 @@
 #include "srslte/interfaces/enb_interfaces.h"
 #include "srslte/interfaces/ue_interfaces.h"
 #include "srslte/upper/rlc.h"
-#include <map>
+#include "ue_slot_map.h"
 
 #ifndef SRSENB_RLC_H
 #define SRSENB_RLC_H
@@ -39,6 +39,7 @@ namespace srsenb {
 class rlc : public rlc_interface_mac, public rlc_interface_rrc, public rlc_interface_pdcp
 {
 public:
+  explicit rlc(ue_slot_index* ue_index = nullptr) : users(ue_index) {}
   void init(pdcp_interface_rlc*    pdcp_,
             rrc_interface_rlc*     rrc_,
             mac_interface_rlc*     mac_,
@@ -58,6 +59,7 @@ public:
 
   // rlc_interface_pdcp
   void        write_sdu(uint16_t rnti, uint32_t lcid, srslte::unique_byte_buffer_t sdu);
+  void        write_sdu_burst(uint16_t rnti, uint32_t lcid, srslte::unique_byte_buffer_list_t& sdus);
   void        discard_sdu(uint16_t rnti, uint32_t lcid, uint32_t discard_sn);
   bool        rb_is_um(uint16_t rnti, uint32_t lcid);
   std::string get_rb_name(uint32_t lcid);
@@ -88,8 +90,8 @@ private:
 
   pthread_rwlock_t rwlock;
 
-  std::map<uint32_t, user_interface> users;
-  std::vector<mch_service_t>         mch_services;
+  ue_slot_map<user_interface> users;
+  std::vector<mch_service_t>  mch_services;
 
   mac_interface_rlc*        mac;
   pdcp_interface_rlc*       pdcp;
@@ -121,6 +121,9 @@ private:
 
   asn1::s1ap::s1_setup_resp_s s1setupresponse;
 
+  // Storage of the dynamic members of received PDUs
+  asn1::mem_arena rx_arena;
+
   void build_tai_cgi();
   bool connect_mme();
   bool setup_s1();
@@ -0,0 +1,238 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/******************************************************************************
+ * File:        ue_slot_map.h
+ * Description: UE context storage for the eNB upper layers. A UE is given
+ *              a compact slot by a ue_slot_index, which the layers of one
+ *              stack share, and each layer keeps its contexts in a flat
+ *              array indexed by that slot. Per-packet lookups are one RNTI
+ *              table read plus one array access, and the same UE has the
+ *              same slot in PDCP, RLC and GTP-U.
+ *****************************************************************************/
+
+#ifndef SRSENB_UE_SLOT_MAP_H
+#define SRSENB_UE_SLOT_MAP_H
+
+#include "common_enb.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+namespace srsenb {
+
+/**
+ * Translates RNTIs to UE slots. A slot is taken when the first layer adds the UE and is returned when the last
+ * layer removes it. Lookups are lock-free, so layers running on other threads (e.g. RLC, which the MAC workers use)
+ * can read the index while the stack thread adds and removes UEs.
+ */
+class ue_slot_index
+{
+public:
+  static const uint16_t no_slot = UINT16_MAX;
+
+  explicit ue_slot_index(uint32_t max_ues_ = SRSENB_MAX_UES) :
+    max_ues(max_ues_),
+    rnti_to_slot(new std::atomic<uint16_t>[NOF_RNTIS]),
+    refcount(max_ues_, 0)
+  {
+    for (uint32_t i = 0; i < NOF_RNTIS; i++) {
+      rnti_to_slot[i].store(no_slot, std::memory_order_relaxed);
+    }
+    free_slots.reserve(max_ues);
+    for (uint32_t i = max_ues; i > 0; --i) {
+      free_slots.push_back(i - 1);
+    }
+  }
+  ue_slot_index(const ue_slot_index&) = delete;
+  ue_slot_index& operator=(const ue_slot_index&) = delete;
+
+  uint16_t get_slot(uint16_t rnti) const { return rnti_to_slot[rnti].load(std::memory_order_acquire); }
+  uint32_t get_max_ues() const { return max_ues; }
+
+  // Takes a reference to the slot of the UE, allocating one if no layer holds the UE yet. Returns no_slot if full
+  uint16_t acquire(uint16_t rnti)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    uint16_t                    slot = rnti_to_slot[rnti].load(std::memory_order_relaxed);
+    if (slot == no_slot) {
+      if (free_slots.empty()) {
+        return no_slot;
+      }
+      slot = free_slots.back();
+      free_slots.pop_back();
+      rnti_to_slot[rnti].store(slot, std::memory_order_release);
+    }
+    refcount[slot]++;
+    return slot;
+  }
+
+  // Drops a reference taken with acquire(). The slot is freed when no layer holds the UE
+  void release(uint16_t rnti)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    uint16_t                    slot = rnti_to_slot[rnti].load(std::memory_order_relaxed);
+    if (slot == no_slot) {
+      return;
+    }
+    if (--refcount[slot] == 0) {
+      rnti_to_slot[rnti].store(no_slot, std::memory_order_release);
+      free_slots.push_back(slot);
+    }
+  }
+
+private:
+  static const uint32_t NOF_RNTIS = UINT16_MAX + 1;
+
+  const uint32_t                           max_ues;
+  std::mutex                               mutex;
+  std::unique_ptr<std::atomic<uint16_t>[]> rnti_to_slot;
+  std::vector<uint16_t>                    refcount;
+  std::vector<uint16_t>                    free_slots;
+};
+
+/**
+ * Per-layer UE contexts, stored in the slots given by a ue_slot_index. If no index is passed, the map uses a
+ * private one with MAX_UES slots.
+ */
+template <typename T, uint32_t MAX_UES = SRSENB_MAX_UES>
+class ue_slot_map
+{
+  static_assert(MAX_UES < UINT16_MAX, "UE slots are stored as uint16_t");
+
+public:
+  static const uint16_t no_slot = ue_slot_index::no_slot;
+
+  explicit ue_slot_map(ue_slot_index* index_ = nullptr) :
+    own_index(index_ == nullptr ? new ue_slot_index(MAX_UES) : nullptr),
+    index(index_ == nullptr ? own_index.get() : index_),
+    slots(new slot_t[index->get_max_ues()]),
+    active(index->get_max_ues(), 0)
+  {
+  }
+  ~ue_slot_map() { clear(); }
+  ue_slot_map(const ue_slot_map&) = delete;
+  ue_slot_map& operator=(const ue_slot_map&) = delete;
+
+  // Returns the context of the UE, or nullptr if the UE is not in this map
+  T* find(uint16_t rnti)
+  {
+    uint16_t slot = index->get_slot(rnti);
+    return (slot == no_slot or not slots[slot].used) ? nullptr : slots[slot].get();
+  }
+  const T* find(uint16_t rnti) const
+  {
+    uint16_t slot = index->get_slot(rnti);
+    return (slot == no_slot or not slots[slot].used) ? nullptr : slots[slot].get();
+  }
+  bool contains(uint16_t rnti) const { return find(rnti) != nullptr; }
+
+  // Default-constructs a context for the UE in its slot. Returns nullptr if the UE exists or there is no free slot.
+  // The context keeps its address until the UE is erased
+  T* insert(uint16_t rnti)
+  {
+    if (contains(rnti)) {
+      return nullptr;
+    }
+    uint16_t slot = index->acquire(rnti);
+    if (slot == no_slot) {
+      return nullptr;
+    }
+    new (&slots[slot].storage) T();
+    slots[slot].rnti       = rnti;
+    slots[slot].used       = true;
+    slots[slot].active_idx = nof_active;
+    active[nof_active++]   = slot;
+    return slots[slot].get();
+  }
+
+  bool erase(uint16_t rnti)
+  {
+    uint16_t slot = index->get_slot(rnti);
+    if (slot == no_slot or not slots[slot].used) {
+      return false;
+    }
+    slots[slot].get()->~T();
+    slots[slot].used = false;
+
+    // Keep the list of active slots dense
+    uint16_t last                  = active[--nof_active];
+    active[slots[slot].active_idx] = last;
+    slots[last].active_idx         = slots[slot].active_idx;
+
+    index->release(rnti);
+    return true;
+  }
+
+  void clear()
+  {
+    while (nof_active > 0) {
+      erase(slots[active[nof_active - 1]].rnti);
+    }
+  }
+
+  // Slot of the UE, a compact index in [0, max UEs) shared by all maps that use the same ue_slot_index
+  uint16_t get_slot(uint16_t rnti) const { return contains(rnti) ? index->get_slot(rnti) : no_slot; }
+  T&       at_slot(uint16_t slot) { return *slots[slot].get(); }
+  uint16_t slot_rnti(uint16_t slot) const { return slots[slot].rnti; }
+
+  uint32_t size() const { return nof_active; }
+  bool     empty() const { return nof_active == 0; }
+  bool     full() const { return nof_active == index->get_max_ues(); }
+
+  // Calls f(rnti, context) for every UE. f must not insert or erase UEs
+  template <typename F>
+  void for_each(F&& f)
+  {
+    for (uint32_t i = 0; i < nof_active; i++) {
+      slot_t& s = slots[active[i]];
+      f(s.rnti, *s.get());
+    }
+  }
+
+private:
+  struct slot_t {
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+    uint16_t                                                   rnti       = 0;
+    uint16_t                                                   active_idx = 0;
+    bool                                                       used       = false;
+
+    T*       get() { return reinterpret_cast<T*>(&storage); }
+    const T* get() const { return reinterpret_cast<const T*>(&storage); }
+  };
+
+  std::unique_ptr<ue_slot_index> own_index;
+  ue_slot_index*                 index;
+  std::unique_ptr<slot_t[]>      slots;
+  std::vector<uint16_t>          active;
+  uint32_t                       nof_active = 0;
+};
+
+template <typename T, uint32_t MAX_UES>
+const uint16_t ue_slot_map<T, MAX_UES>::no_slot;
+
+} // namespace srsenb
+
+#endif // SRSENB_UE_SLOT_MAP_H
@@ -121,10 +121,16 @@ void parse_args(all_args_t* args, int argc, char* argv[])
 
     ("log.filename",      bpo::value<string>(&args->log.filename)->default_value("/tmp/ue.log"),"Log filename")
     ("log.file_max_size", bpo::value<int>(&args->log.file_max_size)->default_value(-1), "Maximum file size (in kilobytes). When passed, multiple files are created. Default -1 (single file)")
+    ("log.backend",       bpo::value<string>(&args->log.backend)->default_value("file"), "Log backend: file, async (text file, written from per-thread buffers) or binary (binary file for srslte_log_decoder)")
 
     /* PCAP */
     ("pcap.enable",    bpo::value<bool>(&args->stack.mac_pcap.enable)->default_value(false),         "Enable MAC packet captures for wireshark")
     ("pcap.filename",  bpo::value<string>(&args->stack.mac_pcap.filename)->default_value("enb_mac.pcap"), "MAC layer capture filename")
+    ("pcap.async",           bpo::value<bool>(&args->stack.mac_pcap.async)->default_value(false), "Write MAC packet captures from a background thread instead of the MAC threads")
+    ("pcap.max_file_size",   bpo::value<int>(&args->stack.mac_pcap.max_file_size)->default_value(-1), "Maximum MAC capture file size (in kilobytes) in async mode. When passed, multiple files are created. Default -1 (single file)")
+    ("pcap.rotation_period", bpo::value<uint32_t>(&args->stack.mac_pcap.rotation_period)->default_value(0), "Start a new MAC capture file every rotation_period seconds in async mode. Default 0 (single file)")
+    ("pcap.filter_rnti",     bpo::value<string>(&args->stack.mac_pcap.filter_rnti)->default_value(""), "Comma-separated list of C-RNTIs to capture. Default empty (all)")
+    ("pcap.filter_lcid",     bpo::value<string>(&args->stack.mac_pcap.filter_lcid)->default_value(""), "Comma-separated list of LCIDs to capture. Default empty (all)")
     ("pcap.s1ap_enable",   bpo::value<bool>(&args->stack.s1ap_pcap.enable)->default_value(false),         "Enable S1AP packet captures for wireshark")
     ("pcap.s1ap_filename", bpo::value<string>(&args->stack.s1ap_pcap.filename)->default_value("enb_s1ap.pcap"), "S1AP layer capture filename")
 
@@ -136,6 +142,8 @@ void parse_args(all_args_t* args, int argc, char* argv[])
     ("scheduler.max_aggr_level", bpo::value<int>(&args->stack.mac.sched.max_aggr_level)->default_value(-1), "Optional maximum aggregation level index (l=log2(L)) ")
     ("scheduler.max_nof_ctrl_symbols", bpo::value<uint32_t>(&args->stack.mac.sched.max_nof_ctrl_symbols)->default_value(3), "Number of control symbols")
     ("scheduler.min_nof_ctrl_symbols", bpo::value<uint32_t>(&args->stack.mac.sched.min_nof_ctrl_symbols)->default_value(1), "Minimum number of control symbols")
+    ("scheduler.pdcch_max_states", bpo::value<uint32_t>(&args->stack.mac.sched.pdcch_max_states)->default_value(64), "Maximum number of PDCCH CCE allocation combinations kept per DCI")
+    ("scheduler.pdcch_greedy", bpo::value<bool>(&args->stack.mac.sched.pdcch_greedy)->default_value(false), "Allocate DCIs greedily and only search all CCE combinations on failure")
 
     /* Downlink Channel emulator section */
     ("channel.dl.enable", bpo::value<bool>(&args->phy.dl_channel_args.enable)->default_value(false), "Enable/Disable internal Downlink channel emulator")
@@ -181,9 +189,13 @@ void parse_args(all_args_t* args, int argc, char* argv[])
     ("expert.metrics_csv_filename", bpo::value<string>(&args->general.metrics_csv_filename)->default_value("/tmp/enb_metrics.csv"), "Metrics CSV filename")
     ("expert.pusch_max_its", bpo::value<int>(&args->phy.pusch_max_its)->default_value(8), "Maximum number of turbo decoder iterations")
     ("expert.pusch_8bit_decoder", bpo::value<bool>(&args->phy.pusch_8bit_decoder)->default_value(false), "Use 8-bit for LLR representation and turbo decoder trellis computation (Experimental)")
+    ("expert.pdsch_coworker", bpo::value<bool>(&args->phy.pdsch_coworker)->default_value(false), "Encode the second PDSCH codeword in a dedicated thread (Experimental)")
     ("expert.pusch_meas_evm", bpo::value<bool>(&args->phy.pusch_meas_evm)->default_value(false), "Enable/Disable PUSCH EVM measure")
     ("expert.tx_amplitude", bpo::value<float>(&args->phy.tx_amplitude)->default_value(0.6), "Transmit amplitude factor")
     ("expert.nof_phy_threads", bpo::value<int>(&args->phy.nof_phy_threads)->default_value(3), "Number of PHY threads")
+    ("expert.nof_phy_subtask_threads", bpo::value<int>(&args->phy.nof_subtask_threads)->default_value(0), "Number of threads that process the carriers of a subframe in parallel (carrier aggregation only)")
+    ("expert.phy_worker_cpus", bpo::value<string>(&args->phy.worker_cpus)->default_value(""), "Comma-separated CPU cores the PHY threads are pinned to")
+    ("expert.phy_subtask_cpus", bpo::value<string>(&args->phy.subtask_cpus)->default_value(""), "Comma-separated CPU cores the PHY sub-task threads are pinned to")
     ("expert.link_failure_nof_err", bpo::value<int>(&args->stack.mac.link_failure_nof_err)->default_value(100), "Number of PUSCH failures after which a radio-link failure is triggered")
     ("expert.max_prach_offset_us", bpo::value<float>(&args->phy.max_prach_offset_us)->default_value(30), "Maximum allowed RACH offset (in us)")
     ("expert.equalizer_mode", bpo::value<string>(&args->phy.equalizer_mode)->default_value("mmse"), "Equalizer mode")
@@ -291,6 +303,11 @@ void parse_args(all_args_t* args, int argc, char* argv[])
     exit(1);
   }
 
+  if (args->log.backend != "file" && args->log.backend != "async" && args->log.backend != "binary") {
+    cout << "Error parsing log.backend: " << args->log.backend << " - must be file, async or binary." << endl;
+    exit(1);
+  }
+
   // Apply all_level to any unset layers
   if (vm.count("log.all_level")) {
     if (!vm.count("log.rf_level")) {
@@ -410,9 +427,14 @@ int main(int argc, char* argv[])
   srslte::logger* logger = nullptr;
   if (args.log.filename == "stdout") {
     logger = &logger_stdout;
-  } else {
+  } else if (args.log.backend == "file") {
     logger_file.init(args.log.filename, args.log.file_max_size);
     logger = &logger_file;
+  } else {
+    logger_binary.init(args.log.filename,
+                       args.log.backend == "binary" ? srslte::logger_binary::BINARY : srslte::logger_binary::TEXT,
+                       args.log.file_max_size);
+    logger = &logger_binary;
   }
   srslte::logmap::set_default_logger(logger);
   srslte::logmap::get("COMMON")->set_level(srslte::LOG_LEVEL_INFO);
@@ -158,6 +158,13 @@ void cc_worker::init(phy_common* phy_, srslte::log* log_h_, uint32_t cc_idx_)
     enb_ul.pusch.llr_is_8bit        = true;
     enb_ul.pusch.ul_sch.llr_is_8bit = true;
   }
+
+  if (phy->params.pdsch_coworker) {
+    if (srslte_pdsch_enable_coworker(&enb_dl.pdsch)) {
+      ERROR("Error enabling PDSCH encoder coworker\n");
+      exit(-1);
+    }
+  }
   initiated = true;
 
 #ifdef DEBUG_WRITE_FILE
@@ -181,6 +188,19 @@ cf_t* cc_worker::get_buffer_tx(uint32_t antenna_idx)
   return signal_buffer_tx[antenna_idx];
 }
 
+// Moves the baseband buffers to the NUMA node of the calling thread, which must be pinned to a core
+void cc_worker::move_to_local_node()
+{
+  uint32_t sf_len = SRSLTE_SF_LEN_PRB(phy->get_nof_prb(cc_idx));
+  for (uint32_t p = 0; p < phy->get_nof_ports(cc_idx); p++) {
+    if (threads_move_to_local_node(signal_buffer_rx[p], 2 * sf_len * sizeof(cf_t)) or
+        threads_move_to_local_node(signal_buffer_tx[p], 2 * sf_len * sizeof(cf_t))) {
+      Warning("Could not move the buffers of carrier %d to the local NUMA node\n", cc_idx);
+      return;
+    }
+  }
+}
+
 void cc_worker::set_tti(uint32_t tti_)
 {
   tti_rx    = tti_;
@@ -19,6 +19,7 @@
  *
  */
 
+#include <algorithm>
 #include <pthread.h>
 #include <sstream>
 #include <string.h>
@@ -59,6 +60,24 @@ phy::~phy()
   stop();
 }
 
+// Parses a comma-separated list of CPU cores, such as "2,3,4"
+static std::vector<int> parse_cpu_list(const std::string& list)
+{
+  std::vector<int>  cpus;
+  std::stringstream ss(list);
+  std::string       item;
+  while (std::getline(ss, item, ',')) {
+    char* end = nullptr;
+    long  cpu = strtol(item.c_str(), &end, 10);
+    if (end == item.c_str() or cpu < 0) {
+      fprintf(stderr, "Ignoring invalid CPU core '%s'\n", item.c_str());
+      continue;
+    }
+    cpus.push_back((int)cpu);
+  }
+  return cpus;
+}
+
 void phy::parse_common_config(const phy_cfg_t& cfg)
 {
   // PRACH configuration
@@ -116,9 +135,25 @@ int phy::init(const phy_args_t&            args,
 
   parse_common_config(cfg);
 
+  // Threads that run the carrier sub-tasks of the workers. A subframe is only split per carrier, so they are not
+  // created for a single carrier, where they would never get any work
+  int nof_subtask_threads = std::max(args.nof_subtask_threads, 0);
+  if (nof_subtask_threads > 0 and cfg.phy_cell_cfg.size() < 2) {
+    log_h->console("Ignoring nof_phy_subtask_threads=%d, sub-tasks only help with more than one carrier\n",
+                   nof_subtask_threads);
+    nof_subtask_threads = 0;
+  }
+  subtask_pool.reset(new srslte::work_stealing_pool(nof_subtask_threads));
+  subtask_pool->start(WORKERS_THREAD_PRIO, parse_cpu_list(args.subtask_cpus));
+  workers_common.subtask_pool = subtask_pool.get();
+
   // Add workers to workers pool and start threads
+  std::vector<int> worker_cpus = parse_cpu_list(args.worker_cpus);
   for (uint32_t i = 0; i < nof_workers; i++) {
     workers[i].init(&workers_common, log_vec.at(i).get());
+    if (not worker_cpus.empty()) {
+      workers[i].set_cpu(worker_cpus[i % worker_cpus.size()]);
+    }
     workers_pool.init_worker(i, &workers[i], WORKERS_THREAD_PRIO);
   }
 
@@ -143,6 +178,7 @@ void phy::stop()
     tx_rx.stop();
     workers_common.stop();
     workers_pool.stop();
+    subtask_pool->stop();
     prach.stop();
 
     initialized = false;
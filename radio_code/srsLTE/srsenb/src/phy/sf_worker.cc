@@ -153,10 +153,40 @@ uint32_t sf_worker::get_nof_rnti()
   return cc_workers[0]->get_nof_rnti();
 }
 
+// Runs f(cc) for every carrier. Carriers other than the first are handed to the sub-task threads, which idle threads
+// steal from each other, while this worker runs the first one. The work of a carrier is not split further: its PDSCH
+// encoding and PUSCH decoding share the scratch state of the carrier enb_dl/enb_ul objects
+template <typename F>
+void sf_worker::for_each_cc(const F& f)
+{
+  srslte::work_stealing_pool* pool = phy->subtask_pool;
+  if (pool == nullptr or pool->nof_threads() == 0 or cc_workers.size() == 1) {
+    for (uint32_t cc = 0; cc < cc_workers.size(); cc++) {
+      f(cc);
+    }
+    return;
+  }
+
+  srslte::work_stealing_pool::task_group group;
+  for (uint32_t cc = 1; cc < cc_workers.size(); cc++) {
+    pool->run(group, [&f, cc]() { f(cc); });
+  }
+  f(0);
+  pool->wait(group);
+}
+
 void sf_worker::work_imp()
 {
   std::lock_guard<std::mutex> lock(work_mutex);
 
+  // The worker thread is pinned by now, so its buffers can be moved next to it
+  if (not numa_done and get_cpu() >= 0) {
+    for (auto& w : cc_workers) {
+      w->move_to_local_node();
+    }
+    numa_done = true;
+  }
+
   srslte_ul_sf_cfg_t ul_sf = {};
   srslte_dl_sf_cfg_t dl_sf = {};
 
@@ -194,9 +224,7 @@ void sf_worker::work_imp()
   ul_sf.tti = tti_rx;
 
   // Process UL
-  for (uint32_t cc = 0; cc < cc_workers.size(); cc++) {
-    cc_workers[cc]->work_ul(ul_sf, ul_grants[cc]);
-  }
+  for_each_cc([this, &ul_sf, &ul_grants](uint32_t cc) { cc_workers[cc]->work_ul(ul_sf, ul_grants[cc]); });
 
   // Get DL scheduling for the TX TTI from MAC
   if (sf_type == SRSLTE_SF_NORM) {
@@ -234,10 +262,11 @@ void sf_worker::work_imp()
   phy->ue_db.clear_tti_pending_ack(tti_tx_ul);
 
   // Process DL
-  for (uint32_t cc = 0; cc < cc_workers.size(); cc++) {
-    dl_sf.cfi = dl_grants[cc].cfi;
-    cc_workers[cc]->work_dl(dl_sf, dl_grants[cc], ul_grants_tx[cc], &mbsfn_cfg);
-  }
+  for_each_cc([this, &dl_sf, &dl_grants, &ul_grants_tx, &mbsfn_cfg](uint32_t cc) {
+    srslte_dl_sf_cfg_t cc_dl_sf = dl_sf;
+    cc_dl_sf.cfi                = dl_grants[cc].cfi;
+    cc_workers[cc]->work_dl(cc_dl_sf, dl_grants[cc], ul_grants_tx[cc], &mbsfn_cfg);
+  });
 
   // Save grants
   phy->set_ul_grants(t_tx_ul, ul_grants_tx);
@@ -23,6 +23,7 @@
 #include "srsenb/hdr/enb.h"
 #include "srslte/common/network_utils.h"
 #include "srslte/srslte.h"
+#include <array>
 #include <srslte/interfaces/enb_metrics_interface.h>
 
 using namespace srslte;
@@ -32,11 +33,13 @@ namespace srsenb {
 enb_stack_lte::enb_stack_lte(srslte::logger* logger_) :
   timers(128),
   logger(logger_),
-  pdcp(this, "PDCP"),
+  rlc(&ue_index),
+  pdcp(this, "PDCP", &ue_index),
+  gtpu(&ue_index),
   thread("STACK")
 {
   enb_queue_id   = pending_tasks.add_queue();
-  sync_queue_id  = pending_tasks.add_queue();
+  sync_queue_id  = pending_tasks.add_queue(1); // TTI ticks are handled before other pending tasks
   mme_queue_id   = pending_tasks.add_queue();
   gtpu_queue_id  = pending_tasks.add_queue();
   mac_queue_id   = pending_tasks.add_queue();
@@ -92,7 +95,17 @@ int enb_stack_lte::init(const stack_args_t& args_, const rrc_cfg_t& rrc_cfg_)
 
   // Set up pcap and trace
   if (args.mac_pcap.enable) {
-    mac_pcap.open(args.mac_pcap.filename.c_str());
+    if (mac_pcap.set_filters(args.mac_pcap.filter_rnti, args.mac_pcap.filter_lcid) != SRSLTE_SUCCESS) {
+      return SRSLTE_ERROR;
+    }
+    if (args.mac_pcap.async) {
+      mac_pcap.open_async(args.mac_pcap.filename.c_str(),
+                          0,
+                          args.mac_pcap.max_file_size,
+                          args.mac_pcap.rotation_period);
+    } else {
+      mac_pcap.open(args.mac_pcap.filename.c_str());
+    }
     mac.start_pcap(&mac_pcap);
   }
   if (args.s1ap_pcap.enable) {
@@ -157,10 +170,11 @@ void enb_stack_lte::stop_impl()
   rx_sockets->stop();
 
   s1ap.stop();
-  gtpu.stop();
   mac.stop();
   rlc.stop();
   pdcp.stop();
+  // GTP-U goes after the layers that feed its S1-U tx batch
+  gtpu.stop();
   rrc.stop();
 
   if (args.mac_pcap.enable) {
@@ -198,10 +212,19 @@ bool enb_stack_lte::get_metrics(stack_metrics_t* metrics)
 
 void enb_stack_lte::run_thread()
 {
+  std::array<srslte::move_task_t, max_task_batch> tasks;
   while (started) {
-    srslte::move_task_t task{};
-    if (pending_tasks.wait_pop(&task) >= 0) {
-      task();
+    uint32_t nof_tasks = pending_tasks.wait_pop_batch(tasks.data(), tasks.size());
+    for (uint32_t i = 0; i < nof_tasks; ++i) {
+      // tasks popped after stop_impl() are dropped, as the queues would have been erased
+      if (started) {
+        tasks[i]();
+      }
+      tasks[i] = srslte::move_task_t{};
+    }
+    if (nof_tasks > 0) {
+      // UL user-plane PDUs produced by the batch leave together
+      gtpu.flush_tx();
     }
   }
 }
@@ -236,13 +259,14 @@ void enb_stack_lte::remove_mme_socket(int fd)
 
 void enb_stack_lte::add_gtpu_s1u_socket_handler(int fd)
 {
-  auto gtpu_s1u_handler = [this](srslte::unique_byte_buffer_t pdu, const sockaddr_in& from) {
-    auto task_handler = [this, from](srslte::unique_byte_buffer_t& t) {
-      gtpu.handle_gtpu_s1u_rx_packet(std::move(t), from);
+  // All datagrams read in one go are handled by a single stack task
+  auto gtpu_s1u_handler = [this](srslte::unique_byte_buffer_list_t& pdus, const std::vector<sockaddr_in>& from) {
+    auto task_handler = [this, from](srslte::unique_byte_buffer_list_t& t) {
+      gtpu.handle_gtpu_s1u_rx_burst(t, from);
     };
-    pending_tasks.push(gtpu_queue_id, std::bind(task_handler, std::move(pdu)));
+    pending_tasks.push(gtpu_queue_id, std::bind(task_handler, std::move(pdus)));
   };
-  rx_sockets->add_socket_pdu_handler(fd, gtpu_s1u_handler);
+  rx_sockets->add_socket_pdu_burst_handler(fd, gtpu_s1u_handler);
 }
 
 void enb_stack_lte::add_gtpu_m1u_socket_handler(int fd)
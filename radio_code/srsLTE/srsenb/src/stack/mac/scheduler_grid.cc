@@ -60,22 +60,53 @@ tti_params_t::tti_params_t(uint32_t tti_rx_) :
  *             PDCCH Allocation Methods
  *******************************************************/
 
+pdcch_grid_t::cce_mask_t::cce_mask_t(uint32_t start, uint32_t len)
+{
+  for (uint32_t i = start; i < start + len; ++i) {
+    w[i / 64] |= (uint64_t)1u << (i % 64);
+  }
+}
+
+pdcch_grid_t::cce_mask_t pdcch_grid_t::cce_mask_t::operator|(const cce_mask_t& other) const
+{
+  cce_mask_t ret;
+  ret.w[0] = w[0] | other.w[0];
+  ret.w[1] = w[1] | other.w[1];
+  return ret;
+}
+
+uint32_t pdcch_grid_t::cce_mask_t::hash() const
+{
+  uint64_t h = (w[0] ^ (w[1] * 0x9E3779B97F4A7C15ull)) * 0xFF51AFD7ED558CCDull;
+  return (uint32_t)(h >> 32u);
+}
+
 void pdcch_grid_t::alloc_tree_t::reset()
 {
   prev_start = 0;
   prev_end   = 0;
+  nof_dcis   = 0;
+  greedy     = true;
   dci_alloc_tree.clear();
 }
 
 void pdcch_grid_t::init(const sched_cell_params_t& cell_params_)
 {
-  cc_cfg = &cell_params_;
-  log_h  = srslte::logmap::get("MAC ");
+  cc_cfg     = &cell_params_;
+  log_h      = srslte::logmap::get("MAC ");
+  max_states = std::max(cc_cfg->sched_cfg->pdcch_max_states, 1u);
+
+  // The leaf hash set is kept at most half full
+  size_t table_size = 1;
+  while (table_size < 2 * max_states) {
+    table_size <<= 1u;
+  }
 
   // init alloc trees
   alloc_trees.reserve(cc_cfg->sched_cfg->max_nof_ctrl_symbols);
   for (uint32_t i = 0; i < cc_cfg->sched_cfg->max_nof_ctrl_symbols; ++i) {
     alloc_trees.emplace_back(cc_cfg->nof_cce_table[i]);
+    alloc_trees.back().leaf_table.resize(table_size);
   }
 }
 
@@ -137,90 +168,112 @@ bool pdcch_grid_t::alloc_dci(alloc_type_t alloc_type, uint32_t aggr_idx, sched_u
 
 bool pdcch_grid_t::alloc_dci_record(const alloc_record_t& record, uint32_t cfix)
 {
-  bool  ret  = false;
   auto& tree = alloc_trees[cfix];
 
-  // Get DCI Location Table
-  const sched_dci_cce_t* dci_locs = get_cce_loc_table(record.alloc_type, record.user, cfix);
-  if (dci_locs == nullptr or dci_locs->nof_loc[record.aggr_idx] == 0) {
-    return ret;
+  if (not cc_cfg->sched_cfg->pdcch_greedy or not tree.greedy) {
+    return add_tree_level(tree, record, cfix, max_states);
   }
 
-  if (tree.prev_end > 0) {
-    for (size_t j = tree.prev_start; j < tree.prev_end; ++j) {
-      ret |= add_tree_node_leaves(tree, (int)j, record, *dci_locs, tti_params->tti_tx_dl);
-    }
-  } else {
-    ret = add_tree_node_leaves(tree, -1, record, *dci_locs, tti_params->tti_tx_dl);
+  // Greedy mode: place the DCI in the first position that is free in the current route
+  if (add_tree_level(tree, record, cfix, 1)) {
+    return true;
   }
 
-  if (ret) {
-    tree.prev_start = tree.prev_end;
-    tree.prev_end   = tree.dci_alloc_tree.size();
+  // The route has no room for the DCI. Rebuild the tree with all the combinations of the DCIs allocated so far. The
+  // greedy route is always the first combination found, so the rebuild can not fail
+  size_t nof_dcis = tree.nof_dcis;
+  tree.reset();
+  tree.greedy = false;
+  for (size_t i = 0; i < nof_dcis; ++i) {
+    if (not add_tree_level(tree, dci_record_list[i], cfix, max_states)) {
+      log_h->error("SCHED: Failed to rebuild PDCCH allocation tree\n");
+      return false;
+    }
   }
-
-  return ret;
+  return add_tree_level(tree, record, cfix, max_states);
 }
 
-//! Algorithm to compute a valid PDCCH allocation
-bool pdcch_grid_t::add_tree_node_leaves(alloc_tree_t&          tree,
-                                        int                    parent_node_idx,
-                                        const alloc_record_t&  dci_record,
-                                        const sched_dci_cce_t& dci_locs,
-                                        uint32_t               tti_tx_dl)
+//! Algorithm to compute the valid PDCCH allocations. Every leaf of the tree is expanded with the positions of the new
+//! DCI that do not collide with the CCEs of the leaf route. All the routes of a tree level hold the same DCIs, so two
+//! leaves with the same CCE mask are equivalent for the DCIs still to come and only the first one is kept. The number
+//! of leaves of the new level is capped at max_leaves
+bool pdcch_grid_t::add_tree_level(alloc_tree_t& tree, const alloc_record_t& record, uint32_t cfix, size_t max_leaves)
 {
-  bool ret = false;
-
-  alloc_t alloc;
-  alloc.rnti      = (dci_record.user != nullptr) ? dci_record.user->get_rnti() : (uint16_t)0u;
-  alloc.dci_pos.L = dci_record.aggr_idx;
-
-  // get cumulative pdcch mask
-  pdcch_mask_t cum_mask;
-  if (parent_node_idx >= 0) {
-    cum_mask = tree.dci_alloc_tree[parent_node_idx].node.total_mask;
-  } else {
-    cum_mask.resize(tree.nof_cces);
+  // Get DCI Location Table
+  const sched_dci_cce_t* dci_locs = get_cce_loc_table(record.alloc_type, record.user, cfix);
+  if (dci_locs == nullptr or dci_locs->nof_loc[record.aggr_idx] == 0) {
+    return false;
   }
 
-  uint32_t nof_locs = dci_locs.nof_loc[dci_record.aggr_idx];
+  // Get the candidate positions of the DCI
+  const static uint32_t max_locs  = sizeof(dci_locs->cce_start[0]) / sizeof(dci_locs->cce_start[0][0]);
+  uint32_t              L         = 1u << record.aggr_idx;
+  uint32_t              nof_locs  = std::min(dci_locs->nof_loc[record.aggr_idx], max_locs);
+  uint32_t              nof_cands = 0;
+  uint32_t              cand_pos[max_locs];
+  cce_mask_t            cand_mask[max_locs];
+  pdcch_mask_t          cand_pdcch_mask[max_locs];
   for (uint32_t i = 0; i < nof_locs; ++i) {
-    uint32_t startpos = dci_locs.cce_start[dci_record.aggr_idx][i];
+    uint32_t startpos = dci_locs->cce_start[record.aggr_idx][i];
 
-    if (dci_record.alloc_type == alloc_type_t::DL_DATA and dci_record.user->pucch_sr_collision(tti_tx_dl, startpos)) {
+    if (record.alloc_type == alloc_type_t::DL_DATA and record.user->pucch_sr_collision(tti_params->tti_tx_dl, startpos)) {
       // will cause a collision in the PUCCH
       continue;
     }
+    cand_pos[nof_cands]  = startpos;
+    cand_mask[nof_cands] = cce_mask_t(startpos, L);
+    cand_pdcch_mask[nof_cands].resize(tree.nof_cces);
+    cand_pdcch_mask[nof_cands].fill(startpos, startpos + L);
+    nof_cands++;
+  }
 
-    pdcch_mask_t alloc_mask(tree.nof_cces);
-    alloc_mask.fill(startpos, startpos + (1u << dci_record.aggr_idx));
-    if ((cum_mask & alloc_mask).any()) {
-      // there is collision. Try another mask
-      continue;
-    }
-
-    // Allocation successful
-    alloc.current_mask = alloc_mask;
-    alloc.total_mask   = cum_mask | alloc_mask;
-    alloc.dci_pos.ncce = startpos;
+  alloc_t alloc;
+  alloc.rnti      = (record.user != nullptr) ? record.user->get_rnti() : (uint16_t)0u;
+  alloc.dci_pos.L = record.aggr_idx;
+
+  // The first DCI is allocated from the tree root (parent index -1)
+  int    parent_start = tree.prev_end > 0 ? (int)tree.prev_start : -1;
+  int    parent_end   = tree.prev_end > 0 ? (int)tree.prev_end : 0;
+  size_t nof_leaves   = 0;
+  size_t table_mask   = tree.leaf_table.size() - 1;
+  std::fill(tree.leaf_table.begin(), tree.leaf_table.end(), -1);
+
+  for (int p = parent_start; p < parent_end and nof_leaves < max_leaves; ++p) {
+    cce_mask_t cum_mask = p >= 0 ? tree.dci_alloc_tree[p].total : cce_mask_t{};
+
+    for (uint32_t i = 0; i < nof_cands and nof_leaves < max_leaves; ++i) {
+      if (cum_mask.intersects(cand_mask[i])) {
+        // there is collision. Try another mask
+        continue;
+      }
+      cce_mask_t total = cum_mask | cand_mask[i];
 
-    // Prune if repetition
-    uint32_t j = tree.prev_end;
-    for (; j < tree.dci_alloc_tree.size(); ++j) {
-      if (tree.dci_alloc_tree[j].node.total_mask == alloc.total_mask) {
-        break;
+      // Prune if repetition
+      size_t slot = total.hash() & table_mask;
+      while (tree.leaf_table[slot] >= 0 and not(tree.dci_alloc_tree[tree.leaf_table[slot]].total == total)) {
+        slot = (slot + 1) & table_mask;
       }
+      if (tree.leaf_table[slot] >= 0) {
+        continue;
+      }
+      tree.leaf_table[slot] = (int)tree.dci_alloc_tree.size();
+
+      // Register allocation
+      alloc.current_mask = cand_pdcch_mask[i];
+      alloc.total_mask   = p >= 0 ? tree.dci_alloc_tree[p].node.total_mask | alloc.current_mask : alloc.current_mask;
+      alloc.dci_pos.ncce = cand_pos[i];
+      tree.dci_alloc_tree.emplace_back(p, alloc, total);
+      nof_leaves++;
     }
-    if (j < tree.dci_alloc_tree.size()) {
-      continue;
-    }
-
-    // Register allocation
-    tree.dci_alloc_tree.emplace_back(parent_node_idx, alloc);
-    ret = true;
   }
 
-  return ret;
+  if (nof_leaves == 0) {
+    return false;
+  }
+  tree.prev_start = tree.prev_end;
+  tree.prev_end   = tree.dci_alloc_tree.size();
+  tree.nof_dcis++;
+  return true;
 }
 
 bool pdcch_grid_t::set_cfi(uint32_t cfi)
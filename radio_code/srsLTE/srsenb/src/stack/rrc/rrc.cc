@@ -590,9 +590,10 @@ void rrc::parse_ul_ccch(uint16_t rnti, srslte::unique_byte_buffer_t pdu)
   uint16_t old_rnti = 0;
 
   if (pdu) {
-    ul_ccch_msg_s  ul_ccch_msg;
-    asn1::cbit_ref bref(pdu->msg, pdu->N_bytes);
-    if (ul_ccch_msg.unpack(bref) != asn1::SRSASN_SUCCESS or
+    asn1::arena_pdu<ul_ccch_msg_s> rx_pdu(rx_arena);
+    ul_ccch_msg_s&                 ul_ccch_msg = *rx_pdu;
+    asn1::cbit_ref                 bref(pdu->msg, pdu->N_bytes);
+    if (rx_pdu.unpack(bref) != asn1::SRSASN_SUCCESS or
         ul_ccch_msg.msg.type().value != ul_ccch_msg_type_c::types_opts::c1) {
       rrc_log->error("Failed to unpack UL-CCCH message\n");
       return;
@@ -1187,9 +1188,10 @@ void rrc::ue::parse_ul_dcch(uint32_t lcid, srslte::unique_byte_buffer_t pdu)
 {
   set_activity();
 
-  ul_dcch_msg_s  ul_dcch_msg;
-  asn1::cbit_ref bref(pdu->msg, pdu->N_bytes);
-  if (ul_dcch_msg.unpack(bref) != asn1::SRSASN_SUCCESS or
+  asn1::arena_pdu<ul_dcch_msg_s> rx_pdu(parent->rx_arena);
+  ul_dcch_msg_s&                 ul_dcch_msg = *rx_pdu;
+  asn1::cbit_ref                 bref(pdu->msg, pdu->N_bytes);
+  if (rx_pdu.unpack(bref) != asn1::SRSASN_SUCCESS or
       ul_dcch_msg.msg.type().value != ul_dcch_msg_type_c::types_opts::c1) {
     parent->rrc_log->error("Failed to unpack UL-DCCH message\n");
     return;
@@ -31,7 +31,7 @@
 using namespace srslte;
 namespace srsenb {
 
-gtpu::gtpu() : m1u(this), gtpu_log("GTPU") {}
+gtpu::gtpu(ue_slot_index* ue_index) : m1u(this), gtpu_log("GTPU"), rnti_bearers(ue_index) {}
 
 int gtpu::init(std::string                  gtp_bind_addr_,
                std::string                  mme_addr_,
@@ -90,8 +90,10 @@ int gtpu::init(std::string                  gtp_bind_addr_,
   return SRSLTE_SUCCESS;
 }
 
+// Called from the stack thread once PDCP is stopped, so no UL PDU is added to the batch after this flush
 void gtpu::stop()
 {
+  flush_tx();
   if (fd) {
     close(fd);
   }
@@ -116,23 +118,37 @@ void gtpu::write_pdu(uint16_t rnti, uint32_t lcid, srslte::unique_byte_buffer_t
     gtpu_log->debug("S1-U PDU -- IP dst addr %s\n", srslte::gtpu_ntoa(ip_pkt->daddr).c_str());
   }
 
+  bearer_map* bearers = rnti_bearers.find(rnti);
+  if (bearers == nullptr) {
+    gtpu_log->error("Unrecognized RNTI for UL PDU: 0x%x - dropping packet\n", rnti);
+    return;
+  }
+
   gtpu_header_t header;
   header.flags        = GTPU_FLAGS_VERSION_V1 | GTPU_FLAGS_GTP_PROTOCOL;
   header.message_type = GTPU_MSG_DATA_PDU;
   header.length       = pdu->N_bytes;
-  header.teid         = rnti_bearers[rnti].teids_out[lcid];
+  header.teid         = bearers->teids_out[lcid];
 
   struct sockaddr_in servaddr;
   servaddr.sin_family      = AF_INET;
-  servaddr.sin_addr.s_addr = htonl(rnti_bearers[rnti].spgw_addrs[lcid]);
+  servaddr.sin_addr.s_addr = htonl(bearers->spgw_addrs[lcid]);
   servaddr.sin_port        = htons(GTPU_PORT);
 
   if (!gtpu_write_header(&header, pdu.get(), gtpu_log)) {
     gtpu_log->error("Error writing GTP-U Header. Flags 0x%x, Message Type 0x%x\n", header.flags, header.message_type);
     return;
   }
-  if (sendto(fd, pdu->msg, pdu->N_bytes, MSG_EOR, (struct sockaddr*)&servaddr, sizeof(struct sockaddr_in)) < 0) {
-    perror("sendto");
+  if (not tx_batch.push(fd, std::move(pdu), servaddr)) {
+    gtpu_log->error("Error sending S1-U PDUs\n");
+  }
+}
+
+// Sends the UL PDUs queued by write_pdu(). Called by the stack once it is done with a task.
+void gtpu::flush_tx()
+{
+  if (not tx_batch.empty() and not tx_batch.flush()) {
+    gtpu_log->error("Error sending S1-U PDUs\n");
   }
 }
 
@@ -154,30 +170,42 @@ void gtpu::add_bearer(uint16_t rnti, uint32_t lcid, uint32_t addr, uint32_t teid
   }
 
   // Initialize maps if it's a new RNTI
-  if (rnti_bearers.count(rnti) == 0) {
+  bearer_map* bearers = rnti_bearers.find(rnti);
+  if (bearers == nullptr) {
+    bearers = rnti_bearers.insert(rnti);
+    if (bearers == nullptr) {
+      if (gtpu_log) {
+        gtpu_log->error("Can't add bearer for rnti: 0x%x. Maximum number of users reached\n", rnti);
+      }
+      return;
+    }
     for (int i = 0; i < SRSENB_N_RADIO_BEARERS; i++) {
-      rnti_bearers[rnti].teids_in[i]   = 0;
-      rnti_bearers[rnti].teids_out[i]  = 0;
-      rnti_bearers[rnti].spgw_addrs[i] = 0;
+      bearers->teids_in[i]   = 0;
+      bearers->teids_out[i]  = 0;
+      bearers->spgw_addrs[i] = 0;
     }
   }
 
-  rnti_bearers[rnti].teids_in[lcid]   = *teid_in;
-  rnti_bearers[rnti].teids_out[lcid]  = teid_out;
-  rnti_bearers[rnti].spgw_addrs[lcid] = addr;
+  bearers->teids_in[lcid]   = *teid_in;
+  bearers->teids_out[lcid]  = teid_out;
+  bearers->spgw_addrs[lcid] = addr;
 }
 
 void gtpu::rem_bearer(uint16_t rnti, uint32_t lcid)
 {
   gtpu_log->info("Removing bearer for rnti: 0x%x, lcid: %d\n", rnti, lcid);
 
-  rnti_bearers[rnti].teids_in[lcid]  = 0;
-  rnti_bearers[rnti].teids_out[lcid] = 0;
+  bearer_map* bearers = rnti_bearers.find(rnti);
+  if (bearers == nullptr) {
+    return;
+  }
+  bearers->teids_in[lcid]  = 0;
+  bearers->teids_out[lcid] = 0;
 
   // Remove RNTI if all bearers are removed
   bool rem = true;
   for (int i = 0; i < SRSENB_N_RADIO_BEARERS; i++) {
-    if (rnti_bearers[rnti].teids_in[i] != 0) {
+    if (bearers->teids_in[i] != 0) {
       rem = false;
     }
   }
@@ -192,12 +220,54 @@ void gtpu::rem_user(uint16_t rnti)
 }
 
 void gtpu::handle_gtpu_s1u_rx_packet(srslte::unique_byte_buffer_t pdu, const sockaddr_in& addr)
+{
+  uint16_t rnti = 0;
+  uint16_t lcid = 0;
+  if (read_s1u_data_pdu(pdu, addr, &rnti, &lcid)) {
+    pdcp->write_sdu(rnti, lcid, std::move(pdu));
+  }
+}
+
+// Consecutive DL PDUs of the same bearer are handed to PDCP as a single burst
+void gtpu::handle_gtpu_s1u_rx_burst(srslte::unique_byte_buffer_list_t& pdus, const std::vector<sockaddr_in>& addrs)
+{
+  srslte::unique_byte_buffer_list_t burst;
+  uint16_t                          burst_rnti = 0;
+  uint16_t                          burst_lcid = 0;
+
+  burst.reserve(pdus.size());
+  for (uint32_t i = 0; i < pdus.size(); i++) {
+    srslte::unique_byte_buffer_t& pdu  = pdus[i];
+    uint16_t                      rnti = 0;
+    uint16_t                      lcid = 0;
+    if (not read_s1u_data_pdu(pdu, addrs[i], &rnti, &lcid)) {
+      continue;
+    }
+    if (not burst.empty() && (rnti != burst_rnti || lcid != burst_lcid)) {
+      pdcp->write_sdu_burst(burst_rnti, burst_lcid, burst);
+      burst.clear();
+    }
+    burst_rnti = rnti;
+    burst_lcid = lcid;
+    burst.push_back(std::move(pdu));
+  }
+  if (not burst.empty()) {
+    pdcp->write_sdu_burst(burst_rnti, burst_lcid, burst);
+  }
+  pdus.clear();
+}
+
+// Parses an S1-U packet. Returns true if it is a DL data PDU for a known bearer, with the GTPU header removed
+bool gtpu::read_s1u_data_pdu(const srslte::unique_byte_buffer_t& pdu,
+                             const sockaddr_in&                  addr,
+                             uint16_t*                           rnti,
+                             uint16_t*                           lcid)
 {
   gtpu_log->debug("Received %d bytes from S1-U interface\n", pdu->N_bytes);
 
   gtpu_header_t header;
   if (not gtpu_read_header(pdu.get(), &header, gtpu_log)) {
-    return;
+    return false;
   }
 
   switch (header.message_type) {
@@ -206,30 +276,33 @@ void gtpu::handle_gtpu_s1u_rx_packet(srslte::unique_byte_buffer_t pdu, const soc
       echo_response(addr.sin_addr.s_addr, addr.sin_port, header.seq_number);
       break;
     case GTPU_MSG_DATA_PDU: {
-      uint16_t rnti = 0;
-      uint16_t lcid = 0;
-      teidin_to_rntilcid(header.teid, &rnti, &lcid);
+      // The TEID encodes the RNTI and LCID, so the bearer is found without searching
+      teidin_to_rntilcid(header.teid, rnti, lcid);
 
-      bool user_exists = (rnti_bearers.count(rnti) > 0);
+      const bearer_map* bearers = rnti_bearers.find(*rnti);
+      if (bearers == nullptr) {
+        gtpu_log->error("Unrecognized RNTI for DL PDU: 0x%x - dropping packet\n", *rnti);
+        return false;
+      }
 
-      if (not user_exists) {
-        gtpu_log->error("Unrecognized RNTI for DL PDU: 0x%x - dropping packet\n", rnti);
-        return;
+      if (*lcid < SRSENB_N_SRB || *lcid >= SRSENB_N_RADIO_BEARERS) {
+        gtpu_log->error("Invalid LCID for DL PDU: %d - dropping packet\n", *lcid);
+        return false;
       }
 
-      if (lcid < SRSENB_N_SRB || lcid >= SRSENB_N_RADIO_BEARERS) {
-        gtpu_log->error("Invalid LCID for DL PDU: %d - dropping packet\n", lcid);
-        return;
+      if (bearers->teids_in[*lcid] != header.teid) {
+        gtpu_log->error("Unrecognized TEID for DL PDU: 0x%x - dropping packet\n", header.teid);
+        return false;
       }
 
       gtpu_log->info_hex(
-          pdu->msg, pdu->N_bytes, "RX GTPU PDU rnti=0x%x, lcid=%d, n_bytes=%d", rnti, lcid, pdu->N_bytes);
-
-      pdcp->write_sdu(rnti, lcid, std::move(pdu));
-    } break;
+          pdu->msg, pdu->N_bytes, "RX GTPU PDU rnti=0x%x, lcid=%d, n_bytes=%d", *rnti, *lcid, pdu->N_bytes);
+      return true;
+    }
     default:
       break;
   }
+  return false;
 }
 
 void gtpu::handle_gtpu_m1u_rx_packet(srslte::unique_byte_buffer_t pdu, const sockaddr_in& addr)
@@ -24,7 +24,8 @@
 
 namespace srsenb {
 
-pdcp::pdcp(srslte::task_handler_interface* task_executor_, const char* logname) :
+pdcp::pdcp(srslte::task_handler_interface* task_executor_, const char* logname, ue_slot_index* ue_index) :
+  users(ue_index),
   task_executor(task_executor_),
   log_h(logname),
   pool(srslte::byte_buffer_pool::get_instance())
@@ -40,26 +41,30 @@ void pdcp::init(rlc_interface_pdcp* rlc_, rrc_interface_pdcp* rrc_, gtpu_interfa
 
 void pdcp::stop()
 {
-  for (std::map<uint32_t, user_interface>::iterator iter = users.begin(); iter != users.end(); ++iter) {
-    clear_user(&iter->second);
-  }
+  users.for_each([this](uint16_t rnti, user_interface& ue) { clear_user(&ue); });
   users.clear();
 }
 
 void pdcp::add_user(uint16_t rnti)
 {
-  if (users.count(rnti) == 0) {
-    srslte::pdcp* obj = new srslte::pdcp(task_executor, log_h->get_service_name().c_str());
-    obj->init(&users[rnti].rlc_itf, &users[rnti].rrc_itf, &users[rnti].gtpu_itf);
-    users[rnti].rlc_itf.rnti  = rnti;
-    users[rnti].gtpu_itf.rnti = rnti;
-    users[rnti].rrc_itf.rnti  = rnti;
-
-    users[rnti].rrc_itf.rrc   = rrc;
-    users[rnti].rlc_itf.rlc   = rlc;
-    users[rnti].gtpu_itf.gtpu = gtpu;
-    users[rnti].pdcp          = obj;
+  if (users.contains(rnti)) {
+    return;
+  }
+  user_interface* ue = users.insert(rnti);
+  if (ue == nullptr) {
+    log_h->error("Can't add user 0x%x. Maximum number of users (%d) reached\n", rnti, SRSENB_MAX_UES);
+    return;
   }
+  srslte::pdcp* obj = new srslte::pdcp(task_executor, log_h->get_service_name().c_str());
+  obj->init(&ue->rlc_itf, &ue->rrc_itf, &ue->gtpu_itf);
+  ue->rlc_itf.rnti  = rnti;
+  ue->gtpu_itf.rnti = rnti;
+  ue->rrc_itf.rnti  = rnti;
+
+  ue->rrc_itf.rrc   = rrc;
+  ue->rlc_itf.rlc   = rlc;
+  ue->gtpu_itf.gtpu = gtpu;
+  ue->pdcp          = obj;
 }
 
 // Private unlocked deallocation of user
@@ -72,45 +77,55 @@ void pdcp::clear_user(user_interface* ue)
 
 void pdcp::rem_user(uint16_t rnti)
 {
-  if (users.count(rnti)) {
-    clear_user(&users[rnti]);
+  user_interface* ue = users.find(rnti);
+  if (ue != nullptr) {
+    clear_user(ue);
     users.erase(rnti);
   }
 }
 
 void pdcp::add_bearer(uint16_t rnti, uint32_t lcid, srslte::pdcp_config_t cfg)
 {
-  if (users.count(rnti)) {
+  user_interface* ue = users.find(rnti);
+  if (ue != nullptr) {
     if (rnti != SRSLTE_MRNTI) {
-      users[rnti].pdcp->add_bearer(lcid, cfg);
+      ue->pdcp->add_bearer(lcid, cfg);
     } else {
-      users[rnti].pdcp->add_bearer_mrb(lcid, cfg);
+      ue->pdcp->add_bearer_mrb(lcid, cfg);
     }
   }
 }
 
 void pdcp::reset(uint16_t rnti)
 {
-  if (users.count(rnti)) {
-    users[rnti].pdcp->reset();
+  user_interface* ue = users.find(rnti);
+  if (ue != nullptr) {
+    ue->pdcp->reset();
   }
 }
 
 void pdcp::config_security(uint16_t rnti, uint32_t lcid, srslte::as_security_config_t sec_cfg)
 {
-  if (users.count(rnti)) {
-    users[rnti].pdcp->config_security(lcid, sec_cfg);
+  user_interface* ue = users.find(rnti);
+  if (ue != nullptr) {
+    ue->pdcp->config_security(lcid, sec_cfg);
   }
 }
 
 void pdcp::enable_integrity(uint16_t rnti, uint32_t lcid)
 {
-  users[rnti].pdcp->enable_integrity(lcid, srslte::DIRECTION_TXRX);
+  user_interface* ue = users.find(rnti);
+  if (ue != nullptr) {
+    ue->pdcp->enable_integrity(lcid, srslte::DIRECTION_TXRX);
+  }
 }
 
 void pdcp::enable_encryption(uint16_t rnti, uint32_t lcid)
 {
-  users[rnti].pdcp->enable_encryption(lcid, srslte::DIRECTION_TXRX);
+  user_interface* ue = users.find(rnti);
+  if (ue != nullptr) {
+    ue->pdcp->enable_encryption(lcid, srslte::DIRECTION_TXRX);
+  }
 }
 
 bool pdcp::get_bearer_status(uint16_t  rnti,
@@ -120,31 +135,44 @@ bool pdcp::get_bearer_status(uint16_t  rnti,
                              uint16_t* ulsn,
                              uint16_t* ulhfn)
 {
-  if (users.count(rnti) == 0) {
+  user_interface* ue = users.find(rnti);
+  if (ue == nullptr) {
     return false;
   }
-  return users[rnti].pdcp->get_bearer_status(lcid, dlsn, dlhfn, ulsn, ulhfn);
+  return ue->pdcp->get_bearer_status(lcid, dlsn, dlhfn, ulsn, ulhfn);
 }
 
 void pdcp::write_pdu(uint16_t rnti, uint32_t lcid, srslte::unique_byte_buffer_t sdu)
 {
-  if (users.count(rnti)) {
-    users[rnti].pdcp->write_pdu(lcid, std::move(sdu));
+  user_interface* ue = users.find(rnti);
+  if (ue != nullptr) {
+    ue->pdcp->write_pdu(lcid, std::move(sdu));
   }
 }
 
 void pdcp::write_sdu(uint16_t rnti, uint32_t lcid, srslte::unique_byte_buffer_t sdu)
 {
-  if (users.count(rnti)) {
+  user_interface* ue = users.find(rnti);
+  if (ue != nullptr) {
     if (rnti != SRSLTE_MRNTI) {
       // TODO: expose blocking mode as function param
-      users[rnti].pdcp->write_sdu(lcid, std::move(sdu), false);
+      ue->pdcp->write_sdu(lcid, std::move(sdu), false);
     } else {
-      users[rnti].pdcp->write_sdu_mch(lcid, std::move(sdu));
+      ue->pdcp->write_sdu_mch(lcid, std::move(sdu));
     }
   }
 }
 
+void pdcp::write_sdu_burst(uint16_t rnti, uint32_t lcid, srslte::unique_byte_buffer_list_t& sdus)
+{
+  user_interface* ue = users.find(rnti);
+  if (ue != nullptr && rnti != SRSLTE_MRNTI) {
+    ue->pdcp->write_sdu_burst(lcid, sdus, false);
+  } else {
+    pdcp_interface_gtpu::write_sdu_burst(rnti, lcid, sdus);
+  }
+}
+
 void pdcp::user_interface_gtpu::write_pdu(uint32_t lcid, srslte::unique_byte_buffer_t pdu)
 {
   gtpu->write_pdu(rnti, lcid, std::move(pdu));
@@ -155,6 +183,11 @@ void pdcp::user_interface_rlc::write_sdu(uint32_t lcid, srslte::unique_byte_buff
   rlc->write_sdu(rnti, lcid, std::move(sdu));
 }
 
+void pdcp::user_interface_rlc::write_sdu_burst(uint32_t lcid, srslte::unique_byte_buffer_list_t& sdus, bool blocking)
+{
+  rlc->write_sdu_burst(rnti, lcid, sdus);
+}
+
 void pdcp::user_interface_rlc::discard_sdu(uint32_t lcid, uint32_t discard_sn)
 {
   rlc->discard_sdu(rnti, lcid, discard_sn);
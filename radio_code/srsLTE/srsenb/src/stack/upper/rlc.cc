@@ -44,9 +44,7 @@ void rlc::init(pdcp_interface_rlc*    pdcp_,
 void rlc::stop()
 {
   pthread_rwlock_wrlock(&rwlock);
-  for (auto& user : users) {
-    user.second.rlc->stop();
-  }
+  users.for_each([](uint16_t rnti, user_interface& user) { user.rlc->stop(); });
   users.clear();
   pthread_rwlock_unlock(&rwlock);
   pthread_rwlock_destroy(&rwlock);
@@ -54,15 +52,20 @@ void rlc::stop()
 
 void rlc::add_user(uint16_t rnti)
 {
-  pthread_rwlock_rdlock(&rwlock);
-  if (users.count(rnti) == 0) {
-    std::unique_ptr<srslte::rlc> obj(new srslte::rlc(log_h->get_service_name().c_str()));
-    obj->init(&users[rnti], &users[rnti], timers, RB_ID_SRB0);
-    users[rnti].rnti   = rnti;
-    users[rnti].pdcp   = pdcp;
-    users[rnti].rrc    = rrc;
-    users[rnti].rlc    = std::move(obj);
-    users[rnti].parent = this;
+  pthread_rwlock_wrlock(&rwlock);
+  if (not users.contains(rnti)) {
+    user_interface* user = users.insert(rnti);
+    if (user != nullptr) {
+      std::unique_ptr<srslte::rlc> obj(new srslte::rlc(log_h->get_service_name().c_str()));
+      obj->init(user, user, timers, RB_ID_SRB0);
+      user->rnti   = rnti;
+      user->pdcp   = pdcp;
+      user->rrc    = rrc;
+      user->rlc    = std::move(obj);
+      user->parent = this;
+    } else {
+      log_h->error("Can't add rnti=0x%x. Maximum number of users (%d) reached\n", rnti, SRSENB_MAX_UES);
+    }
   }
   pthread_rwlock_unlock(&rwlock);
 }
@@ -70,8 +73,9 @@ void rlc::add_user(uint16_t rnti)
 void rlc::rem_user(uint16_t rnti)
 {
   pthread_rwlock_wrlock(&rwlock);
-  if (users.count(rnti)) {
-    users[rnti].rlc->stop();
+  user_interface* user = users.find(rnti);
+  if (user != nullptr) {
+    user->rlc->stop();
     users.erase(rnti);
   } else {
     log_h->error("Removing rnti=0x%x. Already removed\n", rnti);
@@ -82,8 +86,9 @@ void rlc::rem_user(uint16_t rnti)
 void rlc::clear_buffer(uint16_t rnti)
 {
   pthread_rwlock_rdlock(&rwlock);
-  if (users.count(rnti)) {
-    users[rnti].rlc->empty_queue();
+  user_interface* user = users.find(rnti);
+  if (user != nullptr) {
+    user->rlc->empty_queue();
     for (int i = 0; i < SRSLTE_N_RADIO_BEARERS; i++) {
       mac->rlc_buffer_state(rnti, i, 0, 0);
     }
@@ -95,8 +100,9 @@ void rlc::clear_buffer(uint16_t rnti)
 void rlc::add_bearer(uint16_t rnti, uint32_t lcid, srslte::rlc_config_t cnfg)
 {
   pthread_rwlock_rdlock(&rwlock);
-  if (users.count(rnti)) {
-    users[rnti].rlc->add_bearer(lcid, cnfg);
+  user_interface* user = users.find(rnti);
+  if (user != nullptr) {
+    user->rlc->add_bearer(lcid, cnfg);
   }
   pthread_rwlock_unlock(&rwlock);
 }
@@ -104,8 +110,9 @@ void rlc::add_bearer(uint16_t rnti, uint32_t lcid, srslte::rlc_config_t cnfg)
 void rlc::add_bearer_mrb(uint16_t rnti, uint32_t lcid)
 {
   pthread_rwlock_rdlock(&rwlock);
-  if (users.count(rnti)) {
-    users[rnti].rlc->add_bearer_mrb(lcid);
+  user_interface* user = users.find(rnti);
+  if (user != nullptr) {
+    user->rlc->add_bearer_mrb(lcid);
   }
   pthread_rwlock_unlock(&rwlock);
 }
@@ -113,9 +120,10 @@ void rlc::add_bearer_mrb(uint16_t rnti, uint32_t lcid)
 bool rlc::has_bearer(uint16_t rnti, uint32_t lcid)
 {
   pthread_rwlock_rdlock(&rwlock);
-  bool result = false;
-  if (users.count(rnti)) {
-    result = users[rnti].rlc->has_bearer(lcid);
+  bool            result = false;
+  user_interface* user   = users.find(rnti);
+  if (user != nullptr) {
+    result = user->rlc->has_bearer(lcid);
   }
   pthread_rwlock_unlock(&rwlock);
   return result;
@@ -124,9 +132,10 @@ bool rlc::has_bearer(uint16_t rnti, uint32_t lcid)
 bool rlc::suspend_bearer(uint16_t rnti, uint32_t lcid)
 {
   pthread_rwlock_rdlock(&rwlock);
-  bool result = false;
-  if (users.count(rnti)) {
-    users[rnti].rlc->suspend_bearer(lcid);
+  bool            result = false;
+  user_interface* user   = users.find(rnti);
+  if (user != nullptr) {
+    user->rlc->suspend_bearer(lcid);
     result = true;
   }
   pthread_rwlock_unlock(&rwlock);
@@ -136,9 +145,10 @@ bool rlc::suspend_bearer(uint16_t rnti, uint32_t lcid)
 bool rlc::resume_bearer(uint16_t rnti, uint32_t lcid)
 {
   pthread_rwlock_rdlock(&rwlock);
-  bool result = false;
-  if (users.count(rnti)) {
-    users[rnti].rlc->resume_bearer(lcid);
+  bool            result = false;
+  user_interface* user   = users.find(rnti);
+  if (user != nullptr) {
+    user->rlc->resume_bearer(lcid);
     result = true;
   }
   pthread_rwlock_unlock(&rwlock);
@@ -156,13 +166,14 @@ int rlc::read_pdu(uint16_t rnti, uint32_t lcid, uint8_t* payload, uint32_t nof_b
   uint32_t tx_queue;
 
   pthread_rwlock_rdlock(&rwlock);
-  if (users.count(rnti)) {
+  user_interface* user = users.find(rnti);
+  if (user != nullptr) {
     if (rnti != SRSLTE_MRNTI) {
-      ret      = users[rnti].rlc->read_pdu(lcid, payload, nof_bytes);
-      tx_queue = users[rnti].rlc->get_buffer_state(lcid);
+      ret      = user->rlc->read_pdu(lcid, payload, nof_bytes);
+      tx_queue = user->rlc->get_buffer_state(lcid);
     } else {
-      ret      = users[rnti].rlc->read_pdu_mch(lcid, payload, nof_bytes);
-      tx_queue = users[rnti].rlc->get_total_mch_buffer_state(lcid);
+      ret      = user->rlc->read_pdu_mch(lcid, payload, nof_bytes);
+      tx_queue = user->rlc->get_total_mch_buffer_state(lcid);
     }
     // In the eNodeB, there is no polling for buffer state from the scheduler, thus
     // communicate buffer state every time a PDU is read
@@ -180,12 +191,13 @@ int rlc::read_pdu(uint16_t rnti, uint32_t lcid, uint8_t* payload, uint32_t nof_b
 void rlc::write_pdu(uint16_t rnti, uint32_t lcid, uint8_t* payload, uint32_t nof_bytes)
 {
   pthread_rwlock_rdlock(&rwlock);
-  if (users.count(rnti)) {
-    users[rnti].rlc->write_pdu(lcid, payload, nof_bytes);
+  user_interface* user = users.find(rnti);
+  if (user != nullptr) {
+    user->rlc->write_pdu(lcid, payload, nof_bytes);
 
     // In the eNodeB, there is no polling for buffer state from the scheduler, thus
     // communicate buffer state every time a new PDU is written
-    uint32_t tx_queue   = users[rnti].rlc->get_buffer_state(lcid);
+    uint32_t tx_queue   = user->rlc->get_buffer_state(lcid);
     uint32_t retx_queue = 0;
     log_h->debug("Buffer state PDCP: rnti=0x%x, lcid=%d, tx_queue=%d\n", rnti, lcid, tx_queue);
     mac->rlc_buffer_state(rnti, lcid, tx_queue, retx_queue);
@@ -198,13 +210,14 @@ void rlc::write_sdu(uint16_t rnti, uint32_t lcid, srslte::unique_byte_buffer_t s
   uint32_t tx_queue;
 
   pthread_rwlock_rdlock(&rwlock);
-  if (users.count(rnti)) {
+  user_interface* user = users.find(rnti);
+  if (user != nullptr) {
     if (rnti != SRSLTE_MRNTI) {
-      users[rnti].rlc->write_sdu(lcid, std::move(sdu), false);
-      tx_queue = users[rnti].rlc->get_buffer_state(lcid);
+      user->rlc->write_sdu(lcid, std::move(sdu), false);
+      tx_queue = user->rlc->get_buffer_state(lcid);
     } else {
-      users[rnti].rlc->write_sdu_mch(lcid, std::move(sdu));
-      tx_queue = users[rnti].rlc->get_total_mch_buffer_state(lcid);
+      user->rlc->write_sdu_mch(lcid, std::move(sdu));
+      tx_queue = user->rlc->get_total_mch_buffer_state(lcid);
     }
     // In the eNodeB, there is no polling for buffer state from the scheduler, thus
     // communicate buffer state every time a new SDU is written
@@ -216,12 +229,30 @@ void rlc::write_sdu(uint16_t rnti, uint32_t lcid, srslte::unique_byte_buffer_t s
   pthread_rwlock_unlock(&rwlock);
 }
 
+void rlc::write_sdu_burst(uint16_t rnti, uint32_t lcid, srslte::unique_byte_buffer_list_t& sdus)
+{
+  pthread_rwlock_rdlock(&rwlock);
+  user_interface* user = users.find(rnti);
+  if (user != nullptr && rnti != SRSLTE_MRNTI) {
+    user->rlc->write_sdu_burst(lcid, sdus, false);
+
+    // Report the buffer state once for the whole burst
+    uint32_t tx_queue   = user->rlc->get_buffer_state(lcid);
+    uint32_t retx_queue = 0;
+    mac->rlc_buffer_state(rnti, lcid, tx_queue, retx_queue);
+    log_h->info("Buffer state: rnti=0x%x, lcid=%d, tx_queue=%d\n", rnti, lcid, tx_queue);
+  }
+  pthread_rwlock_unlock(&rwlock);
+  sdus.clear();
+}
+
 void rlc::discard_sdu(uint16_t rnti, uint32_t lcid, uint32_t discard_sn)
 {
   pthread_rwlock_rdlock(&rwlock);
-  if (users.count(rnti)) {
-    users[rnti].rlc->discard_sdu(lcid, discard_sn);
-    uint32_t tx_queue = users[rnti].rlc->get_buffer_state(lcid);
+  user_interface* user = users.find(rnti);
+  if (user != nullptr) {
+    user->rlc->discard_sdu(lcid, discard_sn);
+    uint32_t tx_queue = user->rlc->get_buffer_state(lcid);
 
     // In the eNodeB, there is no polling for buffer state from the scheduler, thus
     // communicate buffer state every time a new SDU is discarded
@@ -236,8 +267,9 @@ bool rlc::rb_is_um(uint16_t rnti, uint32_t lcid)
 {
   bool ret = false;
   pthread_rwlock_rdlock(&rwlock);
-  if (users.count(rnti)) {
-    ret = users[rnti].rlc->rb_is_um(lcid);
+  user_interface* user = users.find(rnti);
+  if (user != nullptr) {
+    ret = user->rlc->rb_is_um(lcid);
   }
   pthread_rwlock_unlock(&rwlock);
   return ret;
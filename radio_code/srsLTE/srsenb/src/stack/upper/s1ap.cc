@@ -514,23 +514,23 @@ bool s1ap::handle_s1ap_rx_pdu(srslte::byte_buffer_t* pdu)
     pcap->write_s1ap(pdu->msg, pdu->N_bytes);
   }
 
-  s1ap_pdu_c     rx_pdu;
-  asn1::cbit_ref bref(pdu->msg, pdu->N_bytes);
+  asn1::arena_pdu<s1ap_pdu_c> rx_pdu(rx_arena);
+  asn1::cbit_ref              bref(pdu->msg, pdu->N_bytes);
 
   if (rx_pdu.unpack(bref) != asn1::SRSASN_SUCCESS) {
     s1ap_log->error("Failed to unpack received PDU\n");
     return false;
   }
 
-  switch (rx_pdu.type().value) {
+  switch (rx_pdu->type().value) {
     case s1ap_pdu_c::types_opts::init_msg:
-      return handle_initiatingmessage(rx_pdu.init_msg());
+      return handle_initiatingmessage(rx_pdu->init_msg());
     case s1ap_pdu_c::types_opts::successful_outcome:
-      return handle_successfuloutcome(rx_pdu.successful_outcome());
+      return handle_successfuloutcome(rx_pdu->successful_outcome());
     case s1ap_pdu_c::types_opts::unsuccessful_outcome:
-      return handle_unsuccessfuloutcome(rx_pdu.unsuccessful_outcome());
+      return handle_unsuccessfuloutcome(rx_pdu->unsuccessful_outcome());
     default:
-      s1ap_log->error("Unhandled PDU type %d\n", rx_pdu.type().value);
+      s1ap_log->error("Unhandled PDU type %d\n", rx_pdu->type().value);
       return false;
   }
 
@@ -22,6 +22,8 @@
 #include "scheduler_test_common.h"
 #include "srsenb/hdr/stack/mac/scheduler_grid.h"
 #include "srslte/common/test_common.h"
+#include <chrono>
+#include <memory>
 
 using namespace srsenb;
 // const uint32_t seed = std::chrono::system_clock::now().time_since_epoch().count();
@@ -144,10 +146,123 @@ int test_pdcch_one_ue()
   return SRSLTE_SUCCESS;
 }
 
+// Allocates DCIs for many UEs per TTI, and checks the resulting allocation
+int test_pdcch_many_ues(const sched_interface::sched_args_t& sched_args, uint32_t nof_ues)
+{
+  using rand_uint           = std::uniform_int_distribution<uint32_t>;
+  const uint32_t ENB_CC_IDX = 0;
+  uint32_t       nof_ttis   = 100;
+  uint32_t       nof_prb    = prb_list[rand_uint{2, 5}(get_rand_gen())];
+
+  std::vector<sched_cell_params_t> cell_params(1);
+  sched_interface::ue_cfg_t        ue_cfg   = generate_default_ue_cfg();
+  sched_interface::cell_cfg_t      cell_cfg = generate_default_cell_cfg(nof_prb);
+  TESTASSERT(cell_params[ENB_CC_IDX].set_cfg(ENB_CC_IDX, cell_cfg, sched_args));
+
+  std::vector<std::unique_ptr<sched_ue>> ues(nof_ues);
+  for (uint32_t i = 0; i < nof_ues; ++i) {
+    ues[i].reset(new sched_ue{});
+    ues[i]->init(70 + i, cell_params);
+    ues[i]->set_cfg(ue_cfg);
+  }
+
+  pdcch_grid_t pdcch;
+  pdcch.init(cell_params[PCell_IDX]);
+  srslte::tti_point start_tti{rand_uint{0, 10240}(get_rand_gen())};
+
+  for (uint32_t tti_counter = 0; tti_counter < nof_ttis; ++tti_counter) {
+    tti_params_t tti_params{(start_tti + tti_counter).to_uint()};
+    pdcch.new_tti(tti_params);
+
+    uint32_t nof_success = 0;
+    for (auto& u : ues) {
+      uint32_t     aggr_idx   = rand_uint{0, 2}(get_rand_gen());
+      alloc_type_t alloc_type = rand_uint{0, 1}(get_rand_gen()) == 0 ? alloc_type_t::DL_DATA : alloc_type_t::UL_DATA;
+      if (pdcch.alloc_dci(alloc_type, aggr_idx, u.get())) {
+        nof_success++;
+      }
+      TESTASSERT(pdcch.nof_allocs() == nof_success);
+      TESTASSERT(nof_success == 0 or pdcch.nof_alloc_combinations() <= std::max(sched_args.pdcch_max_states, 1u));
+    }
+    TESTASSERT(nof_success > 0);
+
+    // The allocations must not overlap, and must sum up to the total mask
+    pdcch_grid_t::alloc_result_t pdcch_result;
+    pdcch_mask_t                 pdcch_mask, sum_mask(pdcch.nof_cces());
+    pdcch.get_allocs(&pdcch_result, &pdcch_mask, 0);
+    TESTASSERT(pdcch_result.size() == pdcch.nof_allocs());
+    for (const auto& alloc : pdcch_result) {
+      TESTASSERT(alloc->current_mask.count() == 1u << alloc->dci_pos.L);
+      TESTASSERT((alloc->current_mask & sum_mask).none());
+      sum_mask |= alloc->current_mask;
+      TESTASSERT(alloc->total_mask == sum_mask);
+    }
+    TESTASSERT(pdcch_mask == sum_mask);
+  }
+
+  return SRSLTE_SUCCESS;
+}
+
+// Measures the PDCCH allocation time for an increasing number of DCIs per TTI
+void bench_pdcch_alloc(const sched_interface::sched_args_t& sched_args, const char* name)
+{
+  const uint32_t ENB_CC_IDX = 0;
+  const uint32_t nof_ttis   = 1000;
+  const uint32_t max_ues    = 32;
+
+  std::vector<sched_cell_params_t> cell_params(1);
+  sched_interface::ue_cfg_t        ue_cfg   = generate_default_ue_cfg();
+  sched_interface::cell_cfg_t      cell_cfg = generate_default_cell_cfg(100);
+  cell_params[ENB_CC_IDX].set_cfg(ENB_CC_IDX, cell_cfg, sched_args);
+
+  std::vector<std::unique_ptr<sched_ue>> ues(max_ues);
+  for (uint32_t i = 0; i < max_ues; ++i) {
+    ues[i].reset(new sched_ue{});
+    ues[i]->init(70 + i, cell_params);
+    ues[i]->set_cfg(ue_cfg);
+  }
+  pdcch_grid_t pdcch;
+  pdcch.init(cell_params[PCell_IDX]);
+
+  printf("PDCCH allocation, %s (max_states=%d):\n", name, sched_args.pdcch_max_states);
+  for (uint32_t nof_dcis = 1; nof_dcis <= max_ues; nof_dcis *= 2) {
+    uint64_t nof_allocs = 0;
+    auto     tic        = std::chrono::steady_clock::now();
+    for (uint32_t tti = 0; tti < nof_ttis; ++tti) {
+      tti_params_t tti_params{tti};
+      pdcch.new_tti(tti_params);
+      for (uint32_t i = 0; i < nof_dcis; ++i) {
+        pdcch.alloc_dci(alloc_type_t::DL_DATA, i % 3, ues[i].get());
+      }
+      nof_allocs += pdcch.nof_allocs();
+    }
+    auto toc = std::chrono::steady_clock::now();
+    printf("  %2d DCIs: %8.2f usec/TTI, %5.2f DCIs allocated\n",
+           nof_dcis,
+           std::chrono::duration_cast<std::chrono::nanoseconds>(toc - tic).count() / 1000.0 / nof_ttis,
+           nof_allocs / (double)nof_ttis);
+  }
+}
+
 int main()
 {
   srsenb::set_randseed(seed);
   printf("This is the chosen seed: %u\n", seed);
 
   TESTASSERT(test_pdcch_one_ue() == SRSLTE_SUCCESS);
+
+  sched_interface::sched_args_t sched_args{};
+  TESTASSERT(test_pdcch_many_ues(sched_args, 16) == SRSLTE_SUCCESS);
+  sched_args.pdcch_max_states = 8;
+  TESTASSERT(test_pdcch_many_ues(sched_args, 16) == SRSLTE_SUCCESS);
+  sched_args.pdcch_greedy = true;
+  TESTASSERT(test_pdcch_many_ues(sched_args, 16) == SRSLTE_SUCCESS);
+
+  sched_args = {};
+  bench_pdcch_alloc(sched_args, "full search");
+  sched_args.pdcch_greedy = true;
+  bench_pdcch_alloc(sched_args, "greedy first");
+  sched_args.pdcch_greedy     = false;
+  sched_args.pdcch_max_states = 256;
+  bench_pdcch_alloc(sched_args, "full search");
 }
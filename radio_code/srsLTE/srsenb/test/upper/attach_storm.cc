@@ -0,0 +1,1084 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/******************************************************************************
+ * File:        attach_storm.cc
+ * Description: Attach storm load generator. Emulates UEs at RRC/NAS level
+ *              against the eNB RRC and S1AP, which talk to a running MME.
+ *              There is no PHY, MAC, RLC or PDCP: RRC PDUs are exchanged
+ *              directly between the eNB RRC and the emulated UEs over an
+ *              ideal radio. Each UE runs the srsUE NAS and USIM, performs
+ *              RACH, RRC Connection Setup, NAS attach, security mode and
+ *              default bearer setup, and detaches after a hold time. UEs are
+ *              started at a fixed rate and the latency of each phase is
+ *              reported as percentiles.
+ *****************************************************************************/
+
+#include "srsenb/hdr/enb.h"
+#include "srsenb/hdr/global_variables.h"
+#include "srsenb/hdr/stack/rrc/rrc.h"
+#include "srsenb/hdr/stack/upper/s1ap.h"
+#include "srsenb/src/enb_cfg_parser.h"
+#include "srsenb/test/common/dummy_classes.h"
+#include "srslte/common/logmap.h"
+#include "srslte/common/network_utils.h"
+#include "srslte/interfaces/ue_interfaces.h"
+#include "srsue/hdr/stack/upper/nas.h"
+#include "srsue/hdr/stack/upper/usim.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <fstream>
+#include <getopt.h>
+#include <signal.h>
+#include <thread>
+#include <unordered_map>
+
+using namespace srsenb;
+using namespace asn1::rrc;
+
+using storm_clock = std::chrono::steady_clock;
+
+static std::atomic<bool> running{true};
+
+void sig_int_handler(int signo)
+{
+  running = false;
+}
+
+struct storm_args_t {
+  std::string            repository_dir;
+  std::string            user_db;
+  std::string            mme_addr      = "127.0.1.100";
+  std::string            s1c_bind_addr = "127.0.1.1";
+  uint32_t               nof_ues       = 1000;
+  double                 rate          = 100;
+  uint32_t               max_active    = 0;
+  uint32_t               hold_ms       = 0;
+  uint32_t               timeout_ms    = 10000;
+  srslte::LOG_LEVEL_ENUM log_level     = srslte::LOG_LEVEL_WARNING;
+};
+
+void usage(char* prog)
+{
+  printf("Usage: %s [nrctTmbv] -i repository_dir -d user_db\n", prog);
+  printf("\t-i Directory with sib.conf.example, rr.conf.example and drb.conf.example\n");
+  printf("\t-d HSS user database used by the MME, UEs take their credentials from it\n");
+  printf("\t-n Number of UE attaches [Default 1000]\n");
+  printf("\t-r Attach rate in UEs per second [Default 100]\n");
+  printf("\t-c Maximum number of UEs connected at the same time [Default number of users in the database]\n");
+  printf("\t-t Time a UE stays attached before detaching, in ms [Default 0]\n");
+  printf("\t-T Attach and detach timeout, in ms [Default 10000]\n");
+  printf("\t-m MME address [Default 127.0.1.100]\n");
+  printf("\t-b S1-C bind address [Default 127.0.1.1]\n");
+  printf("\t-v Set log level to info, twice for debug\n");
+}
+
+void parse_args(storm_args_t* args, int argc, char** argv)
+{
+  int opt;
+  while ((opt = getopt(argc, argv, "i:d:n:r:c:t:T:m:b:vh")) != -1) {
+    switch (opt) {
+      case 'i':
+        args->repository_dir = optarg;
+        break;
+      case 'd':
+        args->user_db = optarg;
+        break;
+      case 'n':
+        args->nof_ues = (uint32_t)strtoul(optarg, nullptr, 10);
+        break;
+      case 'r':
+        args->rate = strtod(optarg, nullptr);
+        break;
+      case 'c':
+        args->max_active = (uint32_t)strtoul(optarg, nullptr, 10);
+        break;
+      case 't':
+        args->hold_ms = (uint32_t)strtoul(optarg, nullptr, 10);
+        break;
+      case 'T':
+        args->timeout_ms = (uint32_t)strtoul(optarg, nullptr, 10);
+        break;
+      case 'm':
+        args->mme_addr = optarg;
+        break;
+      case 'b':
+        args->s1c_bind_addr = optarg;
+        break;
+      case 'v':
+        args->log_level = args->log_level == srslte::LOG_LEVEL_WARNING ? srslte::LOG_LEVEL_INFO
+                                                                        : srslte::LOG_LEVEL_DEBUG;
+        break;
+      default:
+        usage(argv[0]);
+        exit(-1);
+    }
+  }
+  if (args->repository_dir.empty() or args->user_db.empty() or args->rate <= 0) {
+    usage(argv[0]);
+    exit(-1);
+  }
+}
+
+// Subscriber of the HSS user database, in the format of srsepc user_db.csv
+struct subscriber_t {
+  std::string algo;
+  std::string imsi;
+  std::string k;
+  bool        using_op;
+  std::string op;
+};
+
+int read_user_db(const std::string& filename, std::vector<subscriber_t>& subs)
+{
+  std::ifstream file(filename);
+  if (not file.is_open()) {
+    fprintf(stderr, "Error opening user database %s\n", filename.c_str());
+    return SRSLTE_ERROR;
+  }
+
+  std::string line;
+  while (std::getline(file, line)) {
+    if (line.empty() or line[0] == '#') {
+      continue;
+    }
+    std::vector<std::string> split;
+    std::istringstream       line_stream(line);
+    std::string              column;
+    while (std::getline(line_stream, column, ',')) {
+      split.push_back(column);
+    }
+    // Name,Auth,IMSI,Key,OP_Type,OP/OPc,AMF,SQN,QCI,IP_alloc
+    if (split.size() != 10) {
+      fprintf(stderr, "Skipping malformed user database line: %s\n", line.c_str());
+      continue;
+    }
+    subscriber_t sub;
+    sub.algo     = split[1] == "mil" ? "milenage" : "xor";
+    sub.imsi     = split[2];
+    sub.k        = split[3];
+    sub.using_op = split[4] == "op";
+    sub.op       = split[5];
+    subs.push_back(sub);
+  }
+  return subs.empty() ? SRSLTE_ERROR : SRSLTE_SUCCESS;
+}
+
+// Latency samples of one attach phase, in ms
+class latency_stats
+{
+public:
+  void add(storm_clock::duration d) { samples.push_back(std::chrono::duration<double, std::milli>(d).count()); }
+
+  void print(const char* name)
+  {
+    if (samples.empty()) {
+      printf("  %-18s %9s %9s %9s %9s\n", name, "-", "-", "-", "-");
+      return;
+    }
+    std::sort(samples.begin(), samples.end());
+    printf("  %-18s %9.1f %9.1f %9.1f %9.1f\n", name, percentile(50), percentile(90), percentile(99), samples.back());
+  }
+
+private:
+  // Nearest-rank percentile, samples must be sorted
+  double percentile(double p) const
+  {
+    size_t rank = (size_t)ceil(p / 100 * samples.size());
+    return samples[std::max(rank, (size_t)1) - 1];
+  }
+
+  std::vector<double> samples;
+};
+
+class loadgen;
+
+/**********************************************************************
+ * Emulated UE: srsUE NAS and USIM on top of a minimal RRC
+ *********************************************************************/
+
+class emulated_ue final : public srsue::rrc_interface_nas, public srsue::gw_interface_nas
+{
+public:
+  enum class state_t { attaching, attached, detaching, failed, done };
+  enum fail_cause_t { no_resources = 0, rejected, released, timeout, nof_fail_causes };
+
+  emulated_ue(loadgen* parent_, uint32_t sub_idx_);
+
+  void start();
+  void run_tti() { nas.run_tti(); }
+  void handle_dl(uint32_t lcid, srslte::unique_byte_buffer_t pdu);
+  void fail(fail_cause_t cause);
+  void detach();
+
+  // rrc_interface_nas
+  void        write_sdu(srslte::unique_byte_buffer_t sdu) override;
+  uint16_t    get_mcc() override;
+  uint16_t    get_mnc() override;
+  void        enable_capabilities() override {}
+  bool        plmn_search() override;
+  void        plmn_select(srslte::plmn_id_t plmn_id) override {}
+  bool        connection_request(srslte::establishment_cause_t cause,
+                                 srslte::unique_byte_buffer_t  dedicated_info_nas) override;
+  void        set_ue_identity(srslte::s_tmsi_t s_tmsi) override {}
+  bool        is_connected() override { return connected; }
+  void        paging_completed(bool outcome) override {}
+  std::string get_rb_name(uint32_t lcid) override { return lcid < RB_ID_N_ITEMS ? rb_id_text[lcid] : "INVALID"; }
+  uint32_t    get_lcid_for_eps_bearer(const uint32_t& eps_bearer_id) override { return eps_bearer_id - 2; }
+
+  // gw_interface_nas
+  int setup_if_addr(uint32_t lcid, uint8_t pdn_type, uint32_t ip_addr, uint8_t* ipv6_if_id, char* err_str) override
+  {
+    return SRSLTE_SUCCESS;
+  }
+  int apply_traffic_flow_template(const uint8_t&                                 eps_bearer_id,
+                                  const uint8_t&                                 lcid,
+                                  const LIBLTE_MME_TRAFFIC_FLOW_TEMPLATE_STRUCT* tft) override
+  {
+    return SRSLTE_SUCCESS;
+  }
+  void set_test_loop_mode(const test_loop_mode_state_t mode, const uint32_t ip_pdu_delay_ms) override {}
+
+  const uint32_t          sub_idx;
+  uint16_t                rnti     = SRSLTE_INVALID_RNTI;
+  state_t                 state    = state_t::attaching;
+  bool                    rlf_sent = false;
+  storm_clock::time_point t_start, t_setup, t_sec_mode, t_attached, deadline;
+
+private:
+  void handle_dl_ccch(const dl_ccch_msg_s& msg);
+  void handle_dl_dcch(const dl_dcch_msg_s& msg);
+  void send_ue_cap_info(uint8_t transaction_id);
+  void write_nas_pdu(const asn1::dyn_octstring& nas_pdu);
+  template <class Msg>
+  void send_ul(uint32_t lcid, const Msg& msg);
+
+  loadgen*                     parent;
+  srsue::usim                  usim;
+  srsue::nas                   nas;
+  srslte::unique_byte_buffer_t pending_nas_pdu;
+  bool                         connected = false;
+};
+
+/**********************************************************************
+ * Load generator: eNB RRC and S1AP with stubbed lower layers
+ *********************************************************************/
+
+class loadgen final : public srslte::task_handler_interface, public stack_interface_s1ap_lte
+{
+public:
+  explicit loadgen(const storm_args_t& args_);
+
+  int  init();
+  int  run();
+  void stop();
+
+  // UE events
+  bool rach(emulated_ue* ue);
+  void deliver_dl(uint16_t rnti, uint32_t lcid, srslte::unique_byte_buffer_t pdu);
+  void ue_attached(emulated_ue* ue);
+  void ue_failed(emulated_ue* ue, emulated_ue::fail_cause_t cause);
+  void ue_removed(uint16_t rnti);
+  void alloc_failed(uint16_t rnti) { last_alloc_failed = rnti; }
+  void write_ul(uint16_t rnti, uint32_t lcid, srslte::unique_byte_buffer_t pdu)
+  {
+    rrc.write_pdu(rnti, lcid, std::move(pdu));
+  }
+
+  // task_handler_interface
+  srslte::timer_handler::unique_timer    get_unique_timer() override { return timers.get_unique_timer(); }
+  srslte::task_multiqueue::queue_handler make_task_queue() override { return pending_tasks.get_queue_handler(); }
+  void defer_callback(uint32_t duration_ms, std::function<void()> func) override
+  {
+    timers.defer_callback(duration_ms, func);
+  }
+  void defer_task(srslte::move_task_t task) override { ue_tasks.push_back(std::move(task)); }
+  void enqueue_background_task(std::function<void(uint32_t)> f) override { f(0); }
+  void notify_background_task_result(srslte::move_task_t task) override { task(); }
+
+  // stack_interface_s1ap_lte
+  void add_mme_socket(int fd) override;
+  void remove_mme_socket(int fd) override;
+
+  // Cell and subscribers, as seen by the UEs
+  const storm_args_t                     args;
+  std::vector<subscriber_t>              subs;
+  srsue::rrc_interface_nas::found_plmn_t cell_plmn = {};
+  uint8_t                                band      = 0;
+  srslte::byte_buffer_pool*              pool      = nullptr;
+  srslte::log_ref                        log_h;
+
+private:
+  // Lower layers that pass RRC PDUs to the emulated UEs
+  class mac_storm final : public mac_dummy
+  {
+  public:
+    explicit mac_storm(loadgen* parent_);
+    uint16_t allocate_rnti() override;
+    int      ue_rem(uint16_t rnti) override;
+    int      bearer_ue_rem(uint16_t rnti, uint32_t lc_id) override;
+    void     free_rnti(uint16_t rnti) { free_rntis.push_back(rnti); }
+    bool     has_free_rnti() const { return not free_rntis.empty(); }
+
+  private:
+    loadgen*             parent;
+    std::deque<uint16_t> free_rntis;
+  };
+  class rlc_storm final : public rlc_dummy
+  {
+  public:
+    explicit rlc_storm(loadgen* parent_) : parent(parent_) {}
+    void write_sdu(uint16_t rnti, uint32_t lcid, srslte::unique_byte_buffer_t sdu) override
+    {
+      parent->deliver_dl(rnti, lcid, std::move(sdu));
+    }
+
+  private:
+    loadgen* parent;
+  };
+  class pdcp_storm final : public pdcp_dummy
+  {
+  public:
+    explicit pdcp_storm(loadgen* parent_) : parent(parent_) {}
+    void write_sdu(uint16_t rnti, uint32_t lcid, srslte::unique_byte_buffer_t sdu) override
+    {
+      parent->deliver_dl(rnti, lcid, std::move(sdu));
+    }
+
+  private:
+    loadgen* parent;
+  };
+  class gtpu_storm final : public gtpu_dummy
+  {
+  public:
+    void add_bearer(uint16_t rnti, uint32_t lcid, uint32_t addr, uint32_t teid_out, uint32_t* teid_in) override
+    {
+      *teid_in = next_teid++;
+    }
+
+  private:
+    uint32_t next_teid = 1;
+  };
+
+  struct metrics_t {
+    uint32_t                nof_started                              = 0;
+    uint32_t                nof_attached                             = 0;
+    uint32_t                nof_failed                               = 0;
+    uint32_t                nof_stuck                                = 0;
+    uint32_t                fail_cause[emulated_ue::nof_fail_causes] = {};
+    storm_clock::time_point t_first_start, t_last_attach;
+    latency_stats           rrc_setup, nas_sec, as_sec_bearer, attach;
+  };
+
+  void tti_clock();
+  void process_radio();
+  void start_ues();
+  void check_ues(storm_clock::time_point now);
+  void finish_ue(emulated_ue* ue);
+  void print_report();
+
+  // eNB. The timers outlive the layers that hold them
+  srslte::timer_handler                           timers{128};
+  srslte::task_multiqueue                         pending_tasks;
+  int                                             mme_queue_id = -1;
+  std::unique_ptr<srslte::rx_multisocket_handler> rx_sockets;
+  srsenb::all_args_t                              enb_args = {};
+  rrc_cfg_t                                       rrc_cfg  = {};
+  phy_dummy                                       phy;
+  mac_storm                                       mac;
+  rlc_storm                                       rlc;
+  pdcp_storm                                      pdcp;
+  gtpu_storm                                      gtpu;
+  srsenb::rrc                                     rrc;
+  srsenb::s1ap                                    s1ap;
+  uint16_t                                        last_alloc_failed = SRSLTE_INVALID_RNTI;
+
+  // UEs. Finished UEs are freed after a delay, as their NAS may still have deferred callbacks pending
+  typedef std::pair<storm_clock::time_point, std::unique_ptr<emulated_ue> > retired_ue_t;
+  std::vector<std::unique_ptr<emulated_ue> > ues;
+  std::vector<emulated_ue*>                  active_ues;
+  std::deque<retired_ue_t>                   retired_ues;
+  std::unordered_map<uint16_t, emulated_ue*> ue_by_rnti;
+  std::deque<uint32_t>                       free_subs;
+  std::deque<srslte::move_task_t>            ue_tasks;
+  uint32_t                                   max_active   = 0;
+  double                                     start_credit = 0;
+
+  metrics_t metrics;
+};
+
+/**********************************************************************
+ * Emulated UE
+ *********************************************************************/
+
+emulated_ue::emulated_ue(loadgen* parent_, uint32_t sub_idx_) :
+  sub_idx(sub_idx_),
+  parent(parent_),
+  usim(srslte::logmap::get("USIM").get()),
+  nas(parent_)
+{
+}
+
+void emulated_ue::start()
+{
+  const subscriber_t& sub = parent->subs[sub_idx];
+
+  srsue::usim_args_t usim_args;
+  usim_args.mode     = "soft";
+  usim_args.algo     = sub.algo;
+  usim_args.using_op = sub.using_op;
+  usim_args.op       = sub.using_op ? sub.op : "";
+  usim_args.opc      = sub.using_op ? "" : sub.op;
+  usim_args.imsi     = sub.imsi;
+  usim_args.imei     = "353490069873319";
+  usim_args.k        = sub.k;
+  usim.init(&usim_args);
+
+  srsue::nas_args_t nas_args;
+  nas_args.apn_protocol      = "ipv4";
+  nas_args.force_imsi_attach = true;
+  nas_args.eia               = "1,2,3";
+  nas_args.eea               = "0,1,2,3";
+  nas.init(&usim, this, this, nas_args);
+
+  t_start = storm_clock::now();
+  nas.start_attach_proc(nullptr, srslte::establishment_cause_t::mo_sig);
+}
+
+void emulated_ue::fail(fail_cause_t cause)
+{
+  if (state != state_t::attaching) {
+    return;
+  }
+  state    = state_t::failed;
+  deadline = storm_clock::now() + std::chrono::milliseconds(parent->args.timeout_ms);
+  parent->ue_failed(this, cause);
+}
+
+void emulated_ue::detach()
+{
+  state    = state_t::detaching;
+  deadline = storm_clock::now() + std::chrono::milliseconds(parent->args.timeout_ms);
+  nas.detach_request(true);
+}
+
+uint16_t emulated_ue::get_mcc()
+{
+  return parent->cell_plmn.plmn_id.to_number().first;
+}
+
+uint16_t emulated_ue::get_mnc()
+{
+  return parent->cell_plmn.plmn_id.to_number().second;
+}
+
+bool emulated_ue::plmn_search()
+{
+  if (state != state_t::attaching) {
+    return false;
+  }
+  // The cell is always found, the result is reported once the NAS procedure has started
+  parent->defer_task([this]() { nas.plmn_search_completed(&parent->cell_plmn, 1); });
+  return true;
+}
+
+bool emulated_ue::connection_request(srslte::establishment_cause_t cause,
+                                     srslte::unique_byte_buffer_t  dedicated_info_nas)
+{
+  if (state != state_t::attaching or rnti != SRSLTE_INVALID_RNTI) {
+    return false;
+  }
+  if (not parent->rach(this)) {
+    fail(no_resources);
+    return false;
+  }
+  pending_nas_pdu = std::move(dedicated_info_nas);
+
+  ul_ccch_msg_s              ul_ccch_msg;
+  rrc_conn_request_r8_ies_s* rrc_conn_req =
+      &ul_ccch_msg.msg.set_c1().set_rrc_conn_request().crit_exts.set_rrc_conn_request_r8();
+  rrc_conn_req->ue_id.set_random_value();
+  uint64_t random_id = 0;
+  for (uint32_t i = 0; i < 5; i++) { // 40 bits
+    random_id |= ((uint64_t)rand() & 0xFF) << i * 8;
+  }
+  rrc_conn_req->ue_id.random_value().from_number(random_id);
+  rrc_conn_req->establishment_cause = (establishment_cause_opts::options)cause;
+  send_ul(RB_ID_SRB0, ul_ccch_msg);
+  return true;
+}
+
+void emulated_ue::write_sdu(srslte::unique_byte_buffer_t sdu)
+{
+  if (not connected) {
+    parent->log_h->warning("Dropping NAS PDU of rnti=0x%x, RRC is not connected\n", rnti);
+    return;
+  }
+  ul_dcch_msg_s              ul_dcch_msg;
+  ul_info_transfer_r8_ies_s* ul_info =
+      &ul_dcch_msg.msg.set_c1().set_ul_info_transfer().crit_exts.set_c1().set_ul_info_transfer_r8();
+  ul_info->ded_info_type.set_ded_info_nas().resize(sdu->N_bytes);
+  memcpy(ul_info->ded_info_type.ded_info_nas().data(), sdu->msg, sdu->N_bytes);
+  send_ul(RB_ID_SRB1, ul_dcch_msg);
+}
+
+void emulated_ue::handle_dl(uint32_t lcid, srslte::unique_byte_buffer_t pdu)
+{
+  asn1::cbit_ref bref(pdu->msg, pdu->N_bytes);
+  if (lcid == RB_ID_SRB0) {
+    dl_ccch_msg_s dl_ccch_msg;
+    if (dl_ccch_msg.unpack(bref) != asn1::SRSASN_SUCCESS or
+        dl_ccch_msg.msg.type().value != dl_ccch_msg_type_c::types_opts::c1) {
+      parent->log_h->error("Failed to unpack DL-CCCH message of rnti=0x%x\n", rnti);
+      return;
+    }
+    handle_dl_ccch(dl_ccch_msg);
+  } else {
+    dl_dcch_msg_s dl_dcch_msg;
+    if (dl_dcch_msg.unpack(bref) != asn1::SRSASN_SUCCESS or
+        dl_dcch_msg.msg.type().value != dl_dcch_msg_type_c::types_opts::c1) {
+      parent->log_h->error("Failed to unpack DL-DCCH message of rnti=0x%x\n", rnti);
+      return;
+    }
+    handle_dl_dcch(dl_dcch_msg);
+  }
+}
+
+void emulated_ue::handle_dl_ccch(const dl_ccch_msg_s& msg)
+{
+  switch (msg.msg.c1().type().value) {
+    case dl_ccch_msg_type_c::c1_c_::types::rrc_conn_setup: {
+      t_setup   = storm_clock::now();
+      connected = true;
+
+      ul_dcch_msg_s                     ul_dcch_msg;
+      rrc_conn_setup_complete_r8_ies_s* setup_complete =
+          &ul_dcch_msg.msg.set_c1().set_rrc_conn_setup_complete().crit_exts.set_c1().set_rrc_conn_setup_complete_r8();
+      ul_dcch_msg.msg.c1().rrc_conn_setup_complete().rrc_transaction_id =
+          msg.msg.c1().rrc_conn_setup().rrc_transaction_id;
+      setup_complete->sel_plmn_id = 1;
+      setup_complete->ded_info_nas.resize(pending_nas_pdu->N_bytes);
+      memcpy(setup_complete->ded_info_nas.data(), pending_nas_pdu->msg, pending_nas_pdu->N_bytes);
+      pending_nas_pdu.reset();
+      send_ul(RB_ID_SRB1, ul_dcch_msg);
+
+      nas.connection_request_completed(true);
+      break;
+    }
+    case dl_ccch_msg_type_c::c1_c_::types::rrc_conn_reject:
+      fail(rejected);
+      nas.connection_request_completed(false);
+      break;
+    default:
+      parent->log_h->warning("Ignoring DL-CCCH %s of rnti=0x%x\n", msg.msg.c1().type().to_string().c_str(), rnti);
+      break;
+  }
+}
+
+void emulated_ue::handle_dl_dcch(const dl_dcch_msg_s& msg)
+{
+  const dl_dcch_msg_type_c::c1_c_& c1 = msg.msg.c1();
+  switch (c1.type().value) {
+    case dl_dcch_msg_type_c::c1_c_::types::dl_info_transfer:
+      write_nas_pdu(c1.dl_info_transfer().crit_exts.c1().dl_info_transfer_r8().ded_info_type.ded_info_nas());
+      break;
+    case dl_dcch_msg_type_c::c1_c_::types::security_mode_cmd: {
+      t_sec_mode = storm_clock::now();
+      ul_dcch_msg_s ul_dcch_msg;
+      ul_dcch_msg.msg.set_c1().set_security_mode_complete().crit_exts.set_security_mode_complete_r8();
+      ul_dcch_msg.msg.c1().security_mode_complete().rrc_transaction_id = c1.security_mode_cmd().rrc_transaction_id;
+      send_ul(RB_ID_SRB1, ul_dcch_msg);
+      break;
+    }
+    case dl_dcch_msg_type_c::c1_c_::types::ue_cap_enquiry:
+      send_ue_cap_info(c1.ue_cap_enquiry().rrc_transaction_id);
+      break;
+    case dl_dcch_msg_type_c::c1_c_::types::rrc_conn_recfg: {
+      ul_dcch_msg_s ul_dcch_msg;
+      ul_dcch_msg.msg.set_c1().set_rrc_conn_recfg_complete().crit_exts.set_rrc_conn_recfg_complete_r8();
+      ul_dcch_msg.msg.c1().rrc_conn_recfg_complete().rrc_transaction_id = c1.rrc_conn_recfg().rrc_transaction_id;
+      send_ul(RB_ID_SRB1, ul_dcch_msg);
+
+      // The Attach Accept is piggybacked in the reconfiguration
+      const rrc_conn_recfg_r8_ies_s& recfg_r8 = c1.rrc_conn_recfg().crit_exts.c1().rrc_conn_recfg_r8();
+      for (const asn1::dyn_octstring& nas_pdu : recfg_r8.ded_info_nas_list) {
+        write_nas_pdu(nas_pdu);
+      }
+      break;
+    }
+    case dl_dcch_msg_type_c::c1_c_::types::rrc_conn_release:
+      connected = false;
+      fail(released);
+      nas.left_rrc_connected();
+      break;
+    default:
+      parent->log_h->warning("Ignoring DL-DCCH %s of rnti=0x%x\n", c1.type().to_string().c_str(), rnti);
+      break;
+  }
+}
+
+void emulated_ue::write_nas_pdu(const asn1::dyn_octstring& nas_pdu)
+{
+  srslte::unique_byte_buffer_t pdu = srslte::allocate_unique_buffer(*parent->pool, true);
+  memcpy(pdu->msg, nas_pdu.data(), nas_pdu.size());
+  pdu->N_bytes = nas_pdu.size();
+  nas.write_pdu(RB_ID_SRB1, std::move(pdu));
+
+  // The Attach Complete has been sent once the NAS is registered
+  if (state == state_t::attaching and nas.is_attached()) {
+    state = state_t::attached;
+    parent->ue_attached(this);
+  }
+}
+
+void emulated_ue::send_ue_cap_info(uint8_t transaction_id)
+{
+  // Release 8, category 4 UE supporting the band of the cell
+  ue_eutra_cap_s cap;
+  cap.access_stratum_release = access_stratum_release_e::rel8;
+  cap.ue_category            = 4;
+  cap.rf_params.supported_band_list_eutra.resize(1);
+  cap.rf_params.supported_band_list_eutra[0].band_eutra  = parent->band;
+  cap.rf_params.supported_band_list_eutra[0].half_duplex = false;
+  cap.meas_params.band_list_eutra.resize(1);
+  cap.meas_params.band_list_eutra[0].inter_freq_band_list.resize(1);
+  cap.meas_params.band_list_eutra[0].inter_freq_band_list[0].inter_freq_need_for_gaps = true;
+  cap.feature_group_inds_present                                                       = true;
+  cap.feature_group_inds.from_number(0xe6041000);
+
+  uint8_t       buf[64] = {};
+  asn1::bit_ref bref(buf, sizeof(buf));
+  cap.pack(bref);
+  bref.align_bytes_zero();
+  auto cap_len = (uint32_t)bref.distance_bytes(buf);
+
+  ul_dcch_msg_s         ul_dcch_msg;
+  ue_cap_info_r8_ies_s* info = &ul_dcch_msg.msg.set_c1().set_ue_cap_info().crit_exts.set_c1().set_ue_cap_info_r8();
+  ul_dcch_msg.msg.c1().ue_cap_info().rrc_transaction_id = transaction_id;
+  info->ue_cap_rat_container_list.resize(1);
+  info->ue_cap_rat_container_list[0].rat_type = rat_type_e::eutra;
+  info->ue_cap_rat_container_list[0].ue_cap_rat_container.resize(cap_len);
+  memcpy(info->ue_cap_rat_container_list[0].ue_cap_rat_container.data(), buf, cap_len);
+  send_ul(RB_ID_SRB1, ul_dcch_msg);
+}
+
+template <class Msg>
+void emulated_ue::send_ul(uint32_t lcid, const Msg& msg)
+{
+  srslte::unique_byte_buffer_t pdu = srslte::allocate_unique_buffer(*parent->pool, true);
+  asn1::bit_ref                bref(pdu->msg, pdu->get_tailroom());
+  if (msg.pack(bref) != asn1::SRSASN_SUCCESS) {
+    parent->log_h->error("Failed to pack UL message of rnti=0x%x\n", rnti);
+    return;
+  }
+  bref.align_bytes_zero();
+  pdu->N_bytes = (uint32_t)bref.distance_bytes(pdu->msg);
+  parent->write_ul(rnti, lcid, std::move(pdu));
+}
+
+/**********************************************************************
+ * Lower layer stubs
+ *********************************************************************/
+
+loadgen::mac_storm::mac_storm(loadgen* parent_) : parent(parent_)
+{
+  // The SCOPE per-UE resources are indexed by rnti, so only a fixed range of RNTIs is valid
+  const uint32_t nof_rntis = sizeof(ue_resources) / sizeof(ue_resources[0]);
+  for (uint32_t i = 0; i < nof_rntis; ++i) {
+    free_rntis.push_back(FIRST_VALID_USER_RNTI + i);
+  }
+}
+
+uint16_t loadgen::mac_storm::allocate_rnti()
+{
+  if (free_rntis.empty()) {
+    return SRSLTE_INVALID_RNTI;
+  }
+  uint16_t rnti = free_rntis.front();
+  free_rntis.pop_front();
+  return rnti;
+}
+
+int loadgen::mac_storm::ue_rem(uint16_t rnti)
+{
+  parent->ue_removed(rnti);
+  return SRSLTE_SUCCESS;
+}
+
+int loadgen::mac_storm::bearer_ue_rem(uint16_t rnti, uint32_t lc_id)
+{
+  // Removing SRB0 of a user that was just added means the RRC could not allocate its PUCCH resources
+  if (lc_id == 0) {
+    parent->alloc_failed(rnti);
+  }
+  return SRSLTE_SUCCESS;
+}
+
+/**********************************************************************
+ * Load generator
+ *********************************************************************/
+
+loadgen::loadgen(const storm_args_t& args_) :
+  args(args_),
+  pool(srslte::byte_buffer_pool::get_instance()),
+  log_h("STORM"),
+  mac(this),
+  rlc(this),
+  pdcp(this)
+{
+}
+
+int loadgen::init()
+{
+  if (read_user_db(args.user_db, subs) != SRSLTE_SUCCESS) {
+    fprintf(stderr, "No users found in %s\n", args.user_db.c_str());
+    return SRSLTE_ERROR;
+  }
+  for (uint32_t i = 0; i < subs.size(); ++i) {
+    free_subs.push_back(i);
+  }
+  // Each UE needs its own subscriber and RNTI while it is connected
+  max_active = std::min((uint32_t)subs.size(), (uint32_t)(sizeof(ue_resources) / sizeof(ue_resources[0])));
+  if (args.max_active > 0) {
+    max_active = std::min(max_active, args.max_active);
+  }
+
+  // eNB configuration
+  enb_args.enb_files.sib_config         = args.repository_dir + "/sib.conf.example";
+  enb_args.enb_files.rr_config          = args.repository_dir + "/rr.conf.example";
+  enb_args.enb_files.drb_config         = args.repository_dir + "/drb.conf.example";
+  enb_args.enb.enb_id                   = 0x19B;
+  enb_args.enb.dl_earfcn                = 3400;
+  enb_args.enb.n_prb                    = 50;
+  enb_args.enb.transmission_mode        = 1;
+  enb_args.enb.nof_ports                = 1;
+  enb_args.general.eia_pref_list        = "EIA2, EIA1, EIA0";
+  enb_args.general.eea_pref_list        = "EEA0, EEA2, EEA1";
+  enb_args.general.rrc_inactivity_timer = 30000;
+  srslte::string_to_mcc("001", &enb_args.stack.s1ap.mcc);
+  srslte::string_to_mnc("01", &enb_args.stack.s1ap.mnc);
+  phy_cfg_t phy_cfg;
+  if (enb_conf_sections::parse_cfg_files(&enb_args, &rrc_cfg, &phy_cfg) != SRSLTE_SUCCESS) {
+    fprintf(stderr, "Error parsing eNB configuration files in %s\n", args.repository_dir.c_str());
+    return SRSLTE_ERROR;
+  }
+  enb_args.stack.s1ap.mme_addr      = args.mme_addr;
+  enb_args.stack.s1ap.s1c_bind_addr = args.s1c_bind_addr;
+  enb_args.stack.s1ap.gtp_bind_addr = args.s1c_bind_addr;
+  enb_args.stack.s1ap.enb_name      = "srsenb01";
+
+  cell_plmn.plmn_id.from_number(enb_args.stack.s1ap.mcc, enb_args.stack.s1ap.mnc);
+  cell_plmn.tac = enb_args.stack.s1ap.tac;
+  band          = srslte_band_get_band(rrc_cfg.cell_list.at(0).dl_earfcn);
+
+  mme_queue_id = pending_tasks.add_queue();
+  rx_sockets.reset(new srslte::rx_multisocket_handler("STORMSOCKETS", log_h));
+
+  rrc.init(rrc_cfg, &phy, &mac, &rlc, &pdcp, &s1ap, &gtpu, &timers);
+  if (s1ap.init(enb_args.stack.s1ap, &rrc, &timers, this) != SRSLTE_SUCCESS) {
+    fprintf(stderr, "Couldn't initialize S1AP\n");
+    return SRSLTE_ERROR;
+  }
+  return SRSLTE_SUCCESS;
+}
+
+void loadgen::stop()
+{
+  rx_sockets->stop();
+  s1ap.stop();
+  rrc.stop();
+}
+
+void loadgen::add_mme_socket(int fd)
+{
+  // S1AP PDUs are handled in the main loop, like the eNB stack does in its thread
+  auto mme_rx_handler =
+      [this](srslte::unique_byte_buffer_t pdu, const sockaddr_in& from, const sctp_sndrcvinfo& sri, int flags) {
+        auto task_handler = [this, from, sri, flags](srslte::unique_byte_buffer_t& t) {
+          s1ap.handle_mme_rx_msg(std::move(t), from, sri, flags);
+        };
+        pending_tasks.push(mme_queue_id, std::bind(task_handler, std::move(pdu)));
+      };
+  rx_sockets->add_socket_sctp_pdu_handler(fd, mme_rx_handler);
+}
+
+void loadgen::remove_mme_socket(int fd)
+{
+  rx_sockets->remove_socket(fd);
+}
+
+int loadgen::run()
+{
+  printf("Waiting for S1 Setup with MME %s...\n", args.mme_addr.c_str());
+  storm_clock::time_point s1_deadline = storm_clock::now() + std::chrono::seconds(15);
+  while (running and not s1ap.is_mme_connected()) {
+    if (storm_clock::now() > s1_deadline) {
+      fprintf(stderr, "S1 Setup with MME %s failed\n", args.mme_addr.c_str());
+      return SRSLTE_ERROR;
+    }
+    tti_clock();
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  printf("Starting %d attaches at %.1f UEs/s, at most %d UEs connected\n", args.nof_ues, args.rate, max_active);
+  metrics.t_first_start           = storm_clock::now();
+  storm_clock::time_point next_tti = metrics.t_first_start;
+  while (running and (metrics.nof_started < args.nof_ues or not active_ues.empty())) {
+    start_ues();
+    tti_clock();
+    check_ues(storm_clock::now());
+
+    next_tti += std::chrono::milliseconds(1);
+    std::this_thread::sleep_until(next_tti);
+  }
+
+  print_report();
+  return (metrics.nof_failed == 0 and metrics.nof_attached == args.nof_ues) ? SRSLTE_SUCCESS : SRSLTE_ERROR;
+}
+
+void loadgen::tti_clock()
+{
+  srslte::move_task_t task;
+  while (pending_tasks.try_pop(&task) >= 0) {
+    task();
+  }
+  process_radio();
+
+  timers.step_all();
+  // Backwards, as a UE that finishes is removed from the list
+  for (size_t i = active_ues.size(); i-- > 0;) {
+    active_ues[i]->run_tti();
+  }
+  process_radio();
+}
+
+// Ideal radio: RRC PDUs are exchanged until neither side has anything left to send
+void loadgen::process_radio()
+{
+  while (true) {
+    rrc.tti_clock();
+    if (ue_tasks.empty()) {
+      break;
+    }
+    while (not ue_tasks.empty()) {
+      srslte::move_task_t task = std::move(ue_tasks.front());
+      ue_tasks.pop_front();
+      task();
+    }
+  }
+}
+
+void loadgen::start_ues()
+{
+  // Attaches not started because too many UEs are connected are not made up for later
+  start_credit = std::min(start_credit + args.rate / 1000, std::max(1.0, args.rate / 1000));
+  while (start_credit >= 1 and metrics.nof_started < args.nof_ues and active_ues.size() < max_active and
+         not free_subs.empty() and mac.has_free_rnti()) {
+    start_credit -= 1;
+    uint32_t sub_idx = free_subs.front();
+    free_subs.pop_front();
+
+    ues.emplace_back(new emulated_ue(this, sub_idx));
+    emulated_ue* ue = ues.back().get();
+    active_ues.push_back(ue);
+    metrics.nof_started++;
+    ue->start();
+  }
+}
+
+void loadgen::check_ues(storm_clock::time_point now)
+{
+  while (not retired_ues.empty() and now > retired_ues.front().first) {
+    retired_ues.pop_front();
+  }
+
+  for (size_t i = active_ues.size(); i-- > 0;) {
+    emulated_ue* ue = active_ues[i];
+    switch (ue->state) {
+      case emulated_ue::state_t::attaching:
+        if (now - ue->t_start > std::chrono::milliseconds(args.timeout_ms)) {
+          ue->fail(emulated_ue::timeout);
+        }
+        break;
+      case emulated_ue::state_t::attached:
+        if (now - ue->t_attached >= std::chrono::milliseconds(args.hold_ms)) {
+          ue->detach();
+        }
+        break;
+      case emulated_ue::state_t::detaching:
+      case emulated_ue::state_t::failed:
+        if (now > ue->deadline) {
+          if (not ue->rlf_sent and ue->rnti != SRSLTE_INVALID_RNTI) {
+            // The UE went silent, let the eNB release it
+            ue->rlf_sent = true;
+            ue->deadline = now + std::chrono::milliseconds(args.timeout_ms);
+            rrc.rl_failure(ue->rnti);
+          } else {
+            // The RNTI is not reused, as the eNB may still hold the user
+            log_h->warning("rnti=0x%x was not removed by the eNB\n", ue->rnti);
+            metrics.nof_stuck++;
+            ue_by_rnti.erase(ue->rnti);
+            ue->rnti = SRSLTE_INVALID_RNTI;
+            finish_ue(ue);
+          }
+        }
+        break;
+      default:
+        break;
+    }
+  }
+}
+
+bool loadgen::rach(emulated_ue* ue)
+{
+  ue->rnti = mac.allocate_rnti();
+  if (ue->rnti == SRSLTE_INVALID_RNTI) {
+    return false;
+  }
+  ue_by_rnti[ue->rnti] = ue;
+
+  // Same initial configuration as the MAC uses for a new user after a PRACH
+  sched_interface::ue_cfg_t ue_cfg = {};
+  ue_cfg.supported_cc_list.emplace_back();
+  ue_cfg.supported_cc_list.back().active     = true;
+  ue_cfg.supported_cc_list.back().enb_cc_idx = 0;
+  ue_cfg.ue_bearers[0].direction             = sched_interface::ue_bearer_cfg_t::BOTH;
+  ue_cfg.dl_cfg.tm                           = SRSLTE_TM1;
+  last_alloc_failed                          = SRSLTE_INVALID_RNTI;
+  rrc.add_user(ue->rnti, ue_cfg);
+  return last_alloc_failed != ue->rnti;
+}
+
+void loadgen::deliver_dl(uint16_t rnti, uint32_t lcid, srslte::unique_byte_buffer_t pdu)
+{
+  // Handled once the eNB RRC returns, as the UE replies go back into it
+  auto task = [this, rnti, lcid](srslte::unique_byte_buffer_t& t) {
+    auto it = ue_by_rnti.find(rnti);
+    if (it != ue_by_rnti.end()) {
+      it->second->handle_dl(lcid, std::move(t));
+    }
+  };
+  ue_tasks.push_back(std::bind(task, std::move(pdu)));
+}
+
+void loadgen::ue_attached(emulated_ue* ue)
+{
+  storm_clock::time_point now = storm_clock::now();
+  metrics.nof_attached++;
+  metrics.t_last_attach = now;
+  metrics.rrc_setup.add(ue->t_setup - ue->t_start);
+  metrics.nas_sec.add(ue->t_sec_mode - ue->t_setup);
+  metrics.as_sec_bearer.add(now - ue->t_sec_mode);
+  metrics.attach.add(now - ue->t_start);
+  ue->t_attached = now;
+}
+
+void loadgen::ue_failed(emulated_ue* ue, emulated_ue::fail_cause_t cause)
+{
+  log_h->info("Attach of rnti=0x%x failed, cause %d\n", ue->rnti, cause);
+  metrics.nof_failed++;
+  metrics.fail_cause[cause]++;
+  if (ue->rnti == SRSLTE_INVALID_RNTI) {
+    finish_ue(ue);
+  } else if (cause != emulated_ue::released) {
+    // The eNB keeps the user until it detects the radio link failure
+    ue->rlf_sent = true;
+    rrc.rl_failure(ue->rnti);
+  }
+}
+
+void loadgen::ue_removed(uint16_t rnti)
+{
+  auto it = ue_by_rnti.find(rnti);
+  if (it == ue_by_rnti.end()) {
+    return;
+  }
+  emulated_ue* ue = it->second;
+  if (ue->state == emulated_ue::state_t::attaching) {
+    ue->fail(emulated_ue::released);
+  }
+  finish_ue(ue);
+}
+
+void loadgen::finish_ue(emulated_ue* ue)
+{
+  if (ue->rnti != SRSLTE_INVALID_RNTI) {
+    ue_by_rnti.erase(ue->rnti);
+    mac.free_rnti(ue->rnti);
+  }
+  ue->state = emulated_ue::state_t::done;
+  free_subs.push_back(ue->sub_idx);
+  active_ues.erase(std::find(active_ues.begin(), active_ues.end(), ue));
+
+  // Not freed yet, this may run from within a call of the UE. The delay is longer than any callback the NAS defers
+  const std::chrono::milliseconds retire_delay(5000);
+  auto it = std::find_if(ues.begin(), ues.end(), [ue](const std::unique_ptr<emulated_ue>& u) { return u.get() == ue; });
+  retired_ues.emplace_back(storm_clock::now() + retire_delay, std::move(*it));
+  ues.erase(it);
+}
+
+void loadgen::print_report()
+{
+  using seconds_t       = std::chrono::duration<double>;
+  double attach_seconds = seconds_t(metrics.t_last_attach - metrics.t_first_start).count();
+  double total_seconds  = seconds_t(storm_clock::now() - metrics.t_first_start).count();
+
+  printf("\nAttach storm: %d UEs started in %.1f s\n", metrics.nof_started, total_seconds);
+  printf("  Attached:  %d (%.1f UEs/s)\n",
+         metrics.nof_attached,
+         attach_seconds > 0 ? metrics.nof_attached / attach_seconds : 0.0);
+  printf("  Failed:    %d (no resources %d, rejected %d, released %d, timeout %d)\n",
+         metrics.nof_failed,
+         metrics.fail_cause[emulated_ue::no_resources],
+         metrics.fail_cause[emulated_ue::rejected],
+         metrics.fail_cause[emulated_ue::released],
+         metrics.fail_cause[emulated_ue::timeout]);
+  if (metrics.nof_stuck > 0) {
+    printf("  Not removed by the eNB: %d\n", metrics.nof_stuck);
+  }
+
+  printf("\n  %-18s %9s %9s %9s %9s\n", "Latency (ms)", "p50", "p90", "p99", "max");
+  metrics.rrc_setup.print("RRC setup");
+  metrics.nas_sec.print("Auth+NAS security");
+  metrics.as_sec_bearer.print("AS sec+bearer");
+  metrics.attach.print("Attach");
+}
+
+int main(int argc, char** argv)
+{
+  storm_args_t args;
+  parse_args(&args, argc, argv);
+
+  signal(SIGINT, sig_int_handler);
+  signal(SIGTERM, sig_int_handler);
+
+  srslte::logmap::set_default_log_level(args.log_level);
+
+  loadgen storm(args);
+  if (storm.init() != SRSLTE_SUCCESS) {
+    return SRSLTE_ERROR;
+  }
+  int ret = storm.run();
+  storm.stop();
+  return ret;
+}
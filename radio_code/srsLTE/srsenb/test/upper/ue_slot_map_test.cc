@@ -0,0 +1,160 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srsenb/hdr/stack/upper/ue_slot_map.h"
+#include "srslte/common/test_common.h"
+#include "srslte/phy/common/phy_common.h"
+#include <memory>
+
+using namespace srsenb;
+
+// Counts live contexts to check that the map constructs and destroys them
+struct ue_ctx_t {
+  static int nof_alive;
+  uint32_t   val = 0;
+  ue_ctx_t() { nof_alive++; }
+  ~ue_ctx_t() { nof_alive--; }
+};
+int ue_ctx_t::nof_alive = 0;
+
+int test_insert_find_erase()
+{
+  std::unique_ptr<ue_slot_map<ue_ctx_t, 4> > users(new ue_slot_map<ue_ctx_t, 4>());
+
+  TESTASSERT(users->empty());
+  TESTASSERT(users->find(0x46) == nullptr);
+
+  ue_ctx_t* ue = users->insert(0x46);
+  TESTASSERT(ue != nullptr);
+  TESTASSERT(ue_ctx_t::nof_alive == 1);
+  ue->val = 1;
+  TESTASSERT(users->insert(0x46) == nullptr);
+  TESTASSERT(users->find(0x46) == ue);
+  TESTASSERT(users->contains(0x46));
+  TESTASSERT(users->slot_rnti(users->get_slot(0x46)) == 0x46);
+  TESTASSERT(&users->at_slot(users->get_slot(0x46)) == ue);
+
+  // Edge RNTIs map as any other
+  TESTASSERT(users->insert(SRSLTE_MRNTI) != nullptr);
+  TESTASSERT(users->insert(0) != nullptr);
+  TESTASSERT(users->insert(0x47) != nullptr);
+  TESTASSERT(users->full());
+  TESTASSERT(users->insert(0x48) == nullptr);
+  TESTASSERT(ue_ctx_t::nof_alive == 4);
+
+  // Existing contexts keep their address when others are removed
+  TESTASSERT(users->erase(0));
+  TESTASSERT(not users->erase(0));
+  TESTASSERT(users->find(0) == nullptr);
+  TESTASSERT(users->find(0x46) == ue and ue->val == 1);
+  TESTASSERT(users->size() == 3);
+  TESTASSERT(ue_ctx_t::nof_alive == 3);
+
+  // Freed slots are reused
+  TESTASSERT(users->insert(0x48) != nullptr);
+  TESTASSERT(users->get_slot(0x48) < 4);
+
+  users->clear();
+  TESTASSERT(users->empty());
+  TESTASSERT(ue_ctx_t::nof_alive == 0);
+  TESTASSERT(users->find(0x46) == nullptr);
+  return SRSLTE_SUCCESS;
+}
+
+int test_for_each()
+{
+  std::unique_ptr<ue_slot_map<ue_ctx_t> > users(new ue_slot_map<ue_ctx_t>());
+
+  for (uint16_t rnti = SRSLTE_CRNTI_START; rnti < SRSLTE_CRNTI_START + SRSENB_MAX_UES; rnti++) {
+    TESTASSERT(users->insert(rnti) != nullptr);
+    users->find(rnti)->val = rnti;
+  }
+  TESTASSERT(users->full());
+
+  // Remove every other UE and check that the iteration visits exactly the remaining ones
+  for (uint16_t rnti = SRSLTE_CRNTI_START; rnti < SRSLTE_CRNTI_START + SRSENB_MAX_UES; rnti += 2) {
+    TESTASSERT(users->erase(rnti));
+  }
+  uint32_t count = 0;
+  bool     ok    = true;
+  users->for_each([&count, &ok](uint16_t rnti, ue_ctx_t& ue) {
+    ok &= (ue.val == rnti) and ((rnti - SRSLTE_CRNTI_START) % 2 == 1);
+    count++;
+  });
+  TESTASSERT(ok);
+  TESTASSERT(count == SRSENB_MAX_UES / 2);
+  TESTASSERT(users->size() == SRSENB_MAX_UES / 2);
+
+  users.reset();
+  TESTASSERT(ue_ctx_t::nof_alive == 0);
+  return SRSLTE_SUCCESS;
+}
+
+int test_shared_index()
+{
+  ue_slot_index                          index(2);
+  ue_slot_map<ue_ctx_t>                  layer1(&index);
+  ue_slot_map<uint32_t>                  layer2(&index);
+  std::unique_ptr<ue_slot_map<ue_ctx_t> > layer3(new ue_slot_map<ue_ctx_t>(&index));
+
+  // A UE has the same slot in every layer that holds it
+  TESTASSERT(layer1.insert(0x46) != nullptr);
+  TESTASSERT(layer2.find(0x46) == nullptr);
+  TESTASSERT(layer2.get_slot(0x46) == ue_slot_index::no_slot);
+  TESTASSERT(layer2.insert(0x46) != nullptr);
+  TESTASSERT(layer1.get_slot(0x46) == layer2.get_slot(0x46));
+  TESTASSERT(index.get_slot(0x46) == layer1.get_slot(0x46));
+
+  // The capacity is shared, a UE known to any layer takes a slot
+  TESTASSERT(layer3->insert(0x47) != nullptr);
+  TESTASSERT(layer1.insert(0x48) == nullptr);
+  TESTASSERT(layer1.full() == false and layer1.size() == 1);
+
+  // The slot stays with the UE until the last layer removes it
+  uint16_t slot = index.get_slot(0x46);
+  TESTASSERT(layer1.erase(0x46));
+  TESTASSERT(layer1.find(0x46) == nullptr);
+  TESTASSERT(index.get_slot(0x46) == slot);
+  TESTASSERT(layer1.insert(0x48) == nullptr);
+  TESTASSERT(layer2.erase(0x46));
+  TESTASSERT(index.get_slot(0x46) == ue_slot_index::no_slot);
+  TESTASSERT(layer1.insert(0x48) != nullptr);
+  TESTASSERT(index.get_slot(0x48) == slot);
+  TESTASSERT(layer2.find(0x48) == nullptr);
+
+  // Destroying a layer returns its references
+  layer3.reset();
+  TESTASSERT(index.get_slot(0x47) == ue_slot_index::no_slot);
+  layer1.clear();
+  TESTASSERT(index.get_slot(0x48) == ue_slot_index::no_slot);
+  TESTASSERT(ue_ctx_t::nof_alive == 0);
+  return SRSLTE_SUCCESS;
+}
+
+int main()
+{
+  TESTASSERT(test_insert_find_erase() == SRSLTE_SUCCESS);
+  TESTASSERT(test_for_each() == SRSLTE_SUCCESS);
+  TESTASSERT(test_shared_index() == SRSLTE_SUCCESS);
+
+  printf("\nSuccess\n");
+  return SRSLTE_SUCCESS;
+}
@@ -23,6 +23,11 @@
  * File:        hss.h
  * Description: Top-level HSS class. Creates and links all
  *              interfaces and helpers.
+ *              Users are kept in a hash table indexed by IMSI. SQN
+ *              updates are appended to a journal next to the user
+ *              database file, which is rewritten only when the journal
+ *              is compacted. The database is reloaded when the file
+ *              changes.
  *****************************************************************************/
 
 #ifndef SRSEPC_HSS_H
@@ -36,6 +41,9 @@
 #include <cstddef>
 #include <fstream>
 #include <map>
+#include <mutex>
+#include <pthread.h>
+#include <unordered_map>
 
 #define LTE_FDD_ENB_IND_HE_N_BITS 5
 #define LTE_FDD_ENB_IND_HE_MASK 0x1FUL
@@ -48,6 +56,7 @@ typedef struct {
   std::string db_file;
   uint16_t    mcc;
   uint16_t    mnc;
+  bool        db_reload;
 } hss_args_t;
 
 enum hss_auth_algo { HSS_ALGO_XOR, HSS_ALGO_MILENAGE };
@@ -86,14 +95,28 @@ public:
 
   virtual bool resync_sqn(uint64_t imsi, uint8_t* auts);
 
+  // Reloads the user database if the file changed and compacts the SQN journal once it grows. Called periodically.
+  // Returns true if the user database was reloaded
+  bool check_db_file();
+
   std::map<std::string, uint64_t> get_ip_to_imsi() const;
 
 private:
+  typedef std::unordered_map<uint64_t, std::unique_ptr<hss_ue_ctx_t> > ue_ctx_map_t;
+
+  static const uint32_t nof_ue_ctx_locks = 64;
+
   hss();
   virtual ~hss();
   static hss* m_instance;
 
-  std::map<uint64_t, std::unique_ptr<hss_ue_ctx_t> > m_imsi_to_ue_ctx;
+  // Held for reading while a UE context is used and for writing while the database is replaced
+  mutable pthread_rwlock_t db_lock;
+  ue_ctx_map_t             m_imsi_to_ue_ctx;
+
+  // Protect the SQN and last RAND of the UE contexts, indexed by IMSI
+  std::mutex  ue_ctx_mutex[nof_ue_ctx_locks];
+  std::mutex& get_ue_ctx_mutex(uint64_t imsi) { return ue_ctx_mutex[imsi % nof_ue_ctx_locks]; }
 
   void gen_rand(uint8_t rand_[16]);
 
@@ -112,13 +135,29 @@ private:
   void increment_sqn(uint8_t* sqn, uint8_t* next_sqn);
 
   bool          set_auth_algo(std::string auth_algo);
-  bool          read_db_file(std::string db_file);
+  bool          read_db_file(std::string db_file, ue_ctx_map_t& ue_ctx_map, std::map<std::string, uint64_t>& ip_to_imsi);
   bool          write_db_file(std::string db_file);
+  bool          reload_db_file();
+  bool          db_file_changed();
   hss_ue_ctx_t* get_ue_ctx(uint64_t imsi);
 
+  // SQN journal
+  bool replay_sqn_journal(const std::string& filename, bool keep_higher);
+  void append_sqn_journal(const hss_ue_ctx_t* ue_ctx);
+  void compact_sqn_journal();
+
   std::string hex_string(uint8_t* hex, int size);
 
   std::string db_file;
+  bool        db_reload        = false;
+  uint64_t    db_file_ino      = 0;
+  int64_t     db_file_mtime_ns = 0;
+  int64_t     db_file_size     = 0;
+
+  std::mutex  journal_mutex;
+  std::string journal_filename;
+  FILE*       journal_file    = nullptr;
+  uint32_t    journal_entries = 0;
 
   /*Logs*/
   srslte::log_filter* m_hss_log;
@@ -23,6 +23,11 @@
  * File:        mme.h
  * Description: Top-level MME class. Creates and links all
  *              interfaces and helpers.
+ *              The MME thread receives the S1-MME and S11 messages and
+ *              waits on the NAS timers. Optionally, the UE contexts are
+ *              split into shards, each one processed by a worker thread,
+ *              and the MME thread hands every UE message to the worker
+ *              of its shard.
  *****************************************************************************/
 
 #ifndef SRSEPC_MME_H
@@ -30,11 +35,18 @@
 
 #include "s1ap.h"
 #include "srslte/common/buffer_pool.h"
+#include "srslte/common/lockfree_multiqueue.h"
 #include "srslte/common/log.h"
 #include "srslte/common/log_filter.h"
 #include "srslte/common/logger_file.h"
 #include "srslte/common/threads.h"
+#include <atomic>
 #include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <pthread.h>
+#include <vector>
 
 namespace srsepc {
 
@@ -48,8 +60,19 @@ typedef struct {
   int                 fd;
   uint64_t            imsi;
   enum nas_timer_type type;
+  uint32_t            shard; // Shard of the UE context that started the timer
 } mme_timer_t;
 
+// Message handed by the MME thread to the worker that owns the UE context
+typedef struct {
+  enum { S1AP_PDU, S11_PDU, NAS_TIMER, CALLBACK } type;
+  srslte::unique_byte_buffer_t pdu;
+  struct sctp_sndrcvinfo       sri;
+  enum nas_timer_type          timer_type;
+  uint64_t                     imsi;
+  std::function<void()>        callback;
+} mme_task_t;
+
 class mme : public srslte::thread, public mme_interface_nas
 {
 public:
@@ -69,19 +92,40 @@ public:
   virtual bool is_nas_timer_running(enum nas_timer_type type, uint64_t imsi);
   virtual bool remove_nas_timer(enum nas_timer_type type, uint64_t imsi);
 
+  // Runs the callback in the thread of a shard of the UE contexts, later if that is a worker
+  void run_in_shard(uint32_t shard, std::function<void()> callback);
+
 private:
+  class worker;
+
   mme();
   virtual ~mme();
   static mme* m_instance;
   s1ap*       m_s1ap;
   mme_gtpc*   m_mme_gtpc;
 
-  bool                      m_running;
+  std::atomic<bool>         m_running;
   srslte::byte_buffer_pool* m_pool;
-  fd_set                    m_set;
+  int                       m_wakeup_fd; // Wakes up the MME thread to stop, or to wait on a new timer
 
-  // Timer map
+  // Timer map. Timers are started by the thread that processes the UE, and waited on by the MME thread
+  std::mutex               m_timers_mutex;
   std::vector<mme_timer_t> timers;
+  std::vector<int>         m_removed_timer_fds; // Closed by the MME thread, which may be waiting on them
+
+  // Workers of the shards of the UE contexts. With none, the MME thread processes every message
+  std::vector<std::unique_ptr<worker> > m_workers;
+  std::atomic<uint32_t>                 m_nof_pending_tasks; // Pushed to the workers and not processed yet
+  // Held for reading while a worker processes a message, and for writing while the eNB contexts change
+  pthread_rwlock_t m_ctx_lock;
+
+  void handle_s1ap_rx_pdu(srslte::unique_byte_buffer_t pdu, const struct sctp_sndrcvinfo& enb_sri);
+  void handle_s11_pdu(srslte::unique_byte_buffer_t pdu);
+  void handle_expired_timer(const mme_timer_t& timer);
+  void push_task(uint32_t shard, mme_task_t&& task);
+  void handle_task(mme_task_t& task);
+  void delete_enb_ctx(int32_t assoc_id);
+  void wake_up();
 
   // Timer Methods
   void handle_timer_expire(int timer_fd);
@@ -22,12 +22,16 @@
 #define SRSEPC_MME_GTPC_H
 
 #include "nas.h"
+#include "s1ap_common.h"
 #include "srslte/asn1/gtpc.h"
 #include "srslte/common/buffer_pool.h"
 #include "srslte/common/log.h"
 #include "srslte/common/log_filter.h"
+#include <mutex>
 #include <sys/socket.h>
 #include <sys/un.h>
+#include <unordered_map>
+#include <vector>
 
 namespace srsepc {
 
@@ -69,9 +73,13 @@ private:
   srslte::log_filter* m_mme_gtpc_log;
   s1ap*               m_s1ap;
 
-  uint32_t                            m_next_ctrl_teid;
-  std::map<uint32_t, uint64_t>        m_mme_ctr_teid_to_imsi;
-  std::map<uint64_t, struct gtpc_ctx> m_imsi_to_gtpc_ctx;
+  // The control TEIDs, allocated by the thread of each shard
+  shard_id_allocator m_ctrl_teids;
+
+  // Protects the GTP-C contexts, which are used by all the MME workers
+  std::mutex                                    m_ctx_mutex;
+  std::unordered_map<uint32_t, uint64_t>        m_mme_ctr_teid_to_imsi;
+  std::unordered_map<uint64_t, struct gtpc_ctx> m_imsi_to_gtpc_ctx;
 
   int                m_s11;
   struct sockaddr_un m_mme_addr, m_spgw_addr;
@@ -79,13 +87,10 @@ private:
 
   bool     init_s11();
   uint32_t get_new_ctrl_teid();
+  bool     find_imsi(uint32_t mme_ctrl_teid, uint64_t* imsi);
+  bool     find_gtpc_ctx(uint64_t imsi, gtpc_ctx_t* gtpc_ctx);
 };
 
-inline uint32_t mme_gtpc::get_new_ctrl_teid()
-{
-  return m_next_ctrl_teid++;
-}
-
 inline int mme_gtpc::get_s11()
 {
   return m_s11;
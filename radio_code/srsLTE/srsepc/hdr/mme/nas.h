@@ -288,6 +288,9 @@ private:
   // Timer functions
   bool start_t3413();
   bool expire_t3413();
+
+  // Identity response, once the old UE context is deleted
+  bool send_identity_authentication_request();
 };
 
 } // namespace srsepc
@@ -36,20 +36,86 @@
 #include "srslte/common/s1ap_pcap.h"
 #include "srslte/interfaces/epc_interfaces.h"
 #include <arpa/inet.h>
+#include <atomic>
+#include <functional>
 #include <map>
+#include <mutex>
 #include <netinet/sctp.h>
 #include <set>
 #include <strings.h>
 #include <sys/socket.h>
 #include <sys/types.h>
 #include <unistd.h>
+#include <unordered_map>
+#include <vector>
 
 namespace srsepc {
 
 const uint16_t S1MME_PORT = 36412;
 
+// Number of independently locked partitions of the UE context tables
+const uint32_t S1AP_NOF_CTX_TABLE_PARTITIONS = 64;
+
 using s1ap_pdu_t = asn1::s1ap::s1ap_pdu_c;
 
+/**
+ * Hash table split into independently locked partitions. Any MME thread can look up a UE, and threads only contend
+ * when they touch the same partition.
+ */
+template <typename K, typename V>
+class s1ap_ctx_table
+{
+public:
+  bool find(const K& key, V* value)
+  {
+    partition_t&                partition = get_partition(key);
+    std::lock_guard<std::mutex> lock(partition.mutex);
+    auto                        it = partition.map.find(key);
+    if (it == partition.map.end()) {
+      return false;
+    }
+    *value = it->second;
+    return true;
+  }
+
+  // Returns false if the key is already present
+  bool insert(const K& key, const V& value)
+  {
+    partition_t&                partition = get_partition(key);
+    std::lock_guard<std::mutex> lock(partition.mutex);
+    return partition.map.insert(std::make_pair(key, value)).second;
+  }
+
+  bool erase(const K& key)
+  {
+    partition_t&                partition = get_partition(key);
+    std::lock_guard<std::mutex> lock(partition.mutex);
+    return partition.map.erase(key) > 0;
+  }
+
+  // Removes all the entries and returns them
+  std::vector<std::pair<K, V> > take_all()
+  {
+    std::vector<std::pair<K, V> > entries;
+    for (partition_t& partition : partitions) {
+      std::lock_guard<std::mutex> lock(partition.mutex);
+      entries.insert(entries.end(), partition.map.begin(), partition.map.end());
+      partition.map.clear();
+    }
+    return entries;
+  }
+
+private:
+  typedef struct {
+    std::mutex               mutex;
+    std::unordered_map<K, V> map;
+  } partition_t;
+
+  partition_t& get_partition(const K& key) { return partitions[std::hash<K>()(key) % S1AP_NOF_CTX_TABLE_PARTITIONS]; }
+
+  partition_t partitions[S1AP_NOF_CTX_TABLE_PARTITIONS];
+};
+
 class s1ap : public s1ap_interface_nas, public s1ap_interface_gtpc, public s1ap_interface_mme
 {
 public:
@@ -69,6 +135,16 @@ public:
   void handle_initiating_message(const asn1::s1ap::init_msg_s& msg, struct sctp_sndrcvinfo* enb_sri);
   void handle_successful_outcome(const asn1::s1ap::successful_outcome_s& msg);
 
+  // The UE contexts are split into shards, each processed by a single thread. The identifiers allocated to a UE by
+  // the MME encode its shard, so that its messages can be routed without looking the UE up
+  void            init_shards(uint32_t nof_workers);
+  uint32_t        get_nof_shards();
+  uint32_t        get_id_shard(uint32_t id);
+  static uint32_t get_current_shard();
+  static void     set_current_shard(uint32_t shard);
+  // Shard that must process a received S1AP PDU, or -1 if the PDU is not associated to a UE
+  int get_rx_pdu_shard(srslte::byte_buffer_t* pdu, const struct sctp_sndrcvinfo* enb_sri);
+
   void activate_eps_bearer(uint64_t imsi, uint8_t ebi);
 
   void print_enb_ctx_info(const std::string& prefix, const enb_ctx_t& enb_ctx);
@@ -89,6 +165,9 @@ public:
   bool         release_ue_ecm_ctx(uint32_t mme_ue_s1ap_id);
   void         release_ues_ecm_ctx_in_enb(int32_t enb_assoc);
   virtual bool delete_ue_ctx(uint64_t imsi);
+  virtual void delete_ue_ctx_in_owner_shard(uint64_t                  imsi,
+                                            uint32_t                  mme_ue_s1ap_id,
+                                            std::function<void(nas*)> on_deleted);
 
   uint32_t         allocate_m_tmsi(uint64_t imsi);
   virtual uint64_t find_imsi_from_m_tmsi(uint32_t m_tmsi);
@@ -102,7 +181,7 @@ public:
   s1ap_ctx_mngmt_proc* m_s1ap_ctx_mngmt_proc;
   s1ap_paging*         m_s1ap_paging;
 
-  std::map<uint32_t, uint64_t>   m_tmsi_to_imsi;
+  // Only changed while no MME worker is processing a UE
   std::map<uint16_t, enb_ctx_t*> m_active_enbs;
 
   // Interfaces
@@ -117,9 +196,19 @@ public:
   virtual bool expire_nas_timer(enum nas_timer_type type, uint64_t imsi);
 
 private:
+  // UE context, and the shard that owns it
+  typedef struct {
+    nas*     nas_ctx;
+    uint32_t shard;
+  } imsi_ctx_t;
+
   s1ap();
   virtual ~s1ap();
 
+  uint32_t get_initial_ue_message_shard(const asn1::s1ap::init_ue_msg_s& init_ue,
+                                        const struct sctp_sndrcvinfo*     enb_sri);
+  uint32_t get_imsi_shard(uint64_t imsi);
+
   static s1ap* m_instance;
 
   uint32_t                  m_plmn;
@@ -128,19 +217,23 @@ private:
   hss_interface_nas*                     m_hss;
   int                                    m_s1mme;
   std::map<int32_t, uint16_t>            m_sctp_to_enb_id;
+  std::mutex                             m_enb_ues_mutex; // Protects the UE sets of the eNBs
   std::map<int32_t, std::set<uint32_t> > m_enb_assoc_to_ue_ids;
 
-  std::map<uint64_t, nas*> m_imsi_to_nas_ctx;
-  std::map<uint32_t, nas*> m_mme_ue_s1ap_id_to_nas_ctx;
+  s1ap_ctx_table<uint64_t, imsi_ctx_t> m_imsi_to_nas_ctx;
+  s1ap_ctx_table<uint32_t, nas*>       m_mme_ue_s1ap_id_to_nas_ctx;
+  s1ap_ctx_table<uint32_t, uint64_t>   m_tmsi_to_imsi;
 
-  uint32_t m_next_mme_ue_s1ap_id;
-  uint32_t m_next_m_tmsi;
+  // The MME UE S1AP Ids, allocated by the thread of each shard
+  shard_id_allocator    m_mme_ue_s1ap_ids;
+  std::atomic<uint32_t> m_next_m_tmsi;
 
   // GTP-C Interface
   mme_gtpc* m_mme_gtpc;
 
   // PCAP
   bool              m_pcap_enable;
+  std::mutex        m_pcap_mutex;
   srslte::s1ap_pcap m_pcap;
 };
 
@@ -149,5 +242,15 @@ inline uint32_t s1ap::get_plmn()
   return m_plmn;
 }
 
+inline uint32_t s1ap::get_nof_shards()
+{
+  return m_mme_ue_s1ap_ids.get_nof_shards();
+}
+
+inline uint32_t s1ap::get_id_shard(uint32_t id)
+{
+  return m_mme_ue_s1ap_ids.get_shard(id);
+}
+
 } // namespace srsepc
 #endif // SRSEPC_S1AP_H
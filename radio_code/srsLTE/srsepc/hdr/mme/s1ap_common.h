@@ -28,6 +28,7 @@
 #include "srslte/common/security.h"
 #include <netinet/sctp.h>
 #include <string.h>
+#include <vector>
 
 namespace srsepc {
 
@@ -49,6 +50,7 @@ typedef struct {
   std::string                         pcap_filename;
   srslte::CIPHERING_ALGORITHM_ID_ENUM encryption_algo;
   srslte::INTEGRITY_ALGORITHM_ID_ENUM integrity_algo;
+  uint32_t                            nof_workers; // Threads that process the UE contexts, 0 for the MME thread
 } s1ap_args_t;
 
 typedef struct {
@@ -65,6 +67,36 @@ typedef struct {
   struct sctp_sndrcvinfo                              sri;
 } enb_ctx_t;
 
+/**
+ * Allocates identifiers that encode the shard of the UE contexts they belong to. Shard s allocates the identifiers
+ * s + 1 + k * nof_shards, so 0 is never allocated. Each shard must only be used by the thread that processes it.
+ */
+class shard_id_allocator
+{
+public:
+  void init(uint32_t nof_shards)
+  {
+    next_id.resize(nof_shards);
+    for (uint32_t i = 0; i < nof_shards; i++) {
+      next_id[i] = i + 1;
+    }
+  }
+
+  uint32_t get_nof_shards() const { return next_id.size(); }
+
+  uint32_t allocate(uint32_t shard)
+  {
+    uint32_t id = next_id[shard];
+    next_id[shard] += next_id.size();
+    return id;
+  }
+
+  uint32_t get_shard(uint32_t id) const { return id == 0 ? 0 : (id - 1) % next_id.size(); }
+
+private:
+  std::vector<uint32_t> next_id;
+};
+
 } // namespace srsepc
 
 #endif // SRSEPC_S1AP_COMMON_H
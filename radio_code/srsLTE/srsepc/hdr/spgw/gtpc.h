@@ -44,6 +44,7 @@ public:
 
   int init_s11(spgw_args_t* args);
   int init_ue_ip(spgw_args_t* args, const std::map<std::string, uint64_t>& ip_to_imsi);
+  int update_ue_ip(const std::map<std::string, uint64_t>& ip_to_imsi);
 
   int       get_s11();
   uint64_t  get_new_ctrl_teid();
@@ -91,6 +92,7 @@ public:
   std::map<uint32_t, spgw_tunnel_ctx*> m_teid_to_tunnel_ctx; // Map control TEID to tunnel ctx. Usefull to get
                                                              // reply ctrl TEID, UE IP, etc.
 
+  in_addr_t                          m_sgi_addr;
   std::set<uint32_t>                 m_ue_ip_addr_pool;
   std::map<uint64_t, struct in_addr> m_imsi_to_ip;
 
@@ -26,15 +26,34 @@
 #include "srslte/asn1/gtpc.h"
 #include "srslte/common/buffer_pool.h"
 #include "srslte/common/logmap.h"
+#include "srslte/common/network_utils.h"
+#include "srslte/common/threads.h"
 #include "srslte/interfaces/epc_interfaces.h"
 #include <cstddef>
+#include <memory>
+#include <mutex>
 #include <queue>
+#include <unordered_map>
+#include <vector>
 
 namespace srsepc {
 
+// Number of independently locked partitions of the UE IP -> tunnel table
+const uint32_t SPGW_NOF_TUNNEL_SHARDS = 64;
+
 class spgw::gtpu : public gtpu_interface_gtpc
 {
 public:
+  // User plane state owned by one thread: its SGi TUN queue, its S1-U socket and its downlink TX batch
+  typedef struct up_thread_ctx {
+    int                               sgi         = -1;
+    int                               s1u         = -1;
+    bool                              ctrl_thread = false;
+    srslte::net_utils::udp_tx_batch   tx_batch;
+    srslte::unique_byte_buffer_list_t s1u_msgs;
+    std::vector<sockaddr_in>          s1u_addrs;
+  } up_thread_ctx_t;
+
   gtpu();
   virtual ~gtpu();
   int  init(spgw_args_t* args, spgw* spgw, gtpc_interface_gtpu* gtpc, srslte::log_ref gtpu_log);
@@ -42,12 +61,25 @@ public:
 
   int init_sgi(spgw_args_t* args);
   int init_s1u(spgw_args_t* args);
+  int init_workers(spgw_args_t* args);
   int get_sgi();
   int get_s1u();
+  int get_handoff_fd();
+
+  // Number of dedicated user plane threads. With none, the SP-GW thread also serves SGi and S1-U
+  uint32_t         get_nof_workers();
+  up_thread_ctx_t& get_ctrl_ctx();
 
-  void handle_sgi_pdu(srslte::byte_buffer_t* msg);
-  void handle_s1u_pdu(srslte::byte_buffer_t* msg);
-  void send_s1u_pdu(srslte::gtp_fteid_t enb_fteid, srslte::byte_buffer_t* msg);
+  // Read every datagram pending on the context's SGi queue or S1-U socket
+  void handle_sgi_ready(up_thread_ctx_t& ctx);
+  void handle_s1u_ready(up_thread_ctx_t& ctx);
+  // Serve the downlink PDUs that user plane threads passed to the SP-GW thread for paging
+  void handle_paging_handoff(up_thread_ctx_t& ctx);
+
+  void handle_sgi_pdu(srslte::byte_buffer_t* msg, up_thread_ctx_t& ctx);
+  void handle_s1u_pdu(srslte::byte_buffer_t* msg, up_thread_ctx_t& ctx);
+  void send_s1u_pdu(srslte::gtp_fteid_t enb_fteid, srslte::byte_buffer_t* msg, up_thread_ctx_t& ctx);
+  void flush_s1u(up_thread_ctx_t& ctx);
 
   virtual in_addr_t get_s1u_addr();
 
@@ -67,15 +99,41 @@ public:
   int         m_s1u;
   sockaddr_in m_s1u_addr;
 
-  std::map<in_addr_t, srslte::gtp_fteid_t> m_ip_to_usr_teid; // Map IP to User-plane TEID for downlink traffic
-  std::map<in_addr_t, uint32_t>            m_ip_to_ctr_teid; // IP to control TEID map. Important to check if
-                                                             // UE is attached without an active user-plane
-                                                             // for downlink notifications.
-
   srslte::log_ref m_gtpu_log;
 
 private:
+  class up_worker;
+
+  // Downlink eNB F-TEID, and the control TEID used to page UEs that are attached without an active user-plane
+  typedef struct {
+    bool                usr_found     = false;
+    srslte::gtp_fteid_t dw_user_fteid = {};
+    bool                ctr_found     = false;
+    uint32_t            up_ctrl_teid  = 0;
+  } ue_tunnel_t;
+
+  typedef struct {
+    std::mutex                                 mutex;
+    std::unordered_map<in_addr_t, ue_tunnel_t> tunnels;
+  } tunnel_shard_t;
+
+  tunnel_shard_t& get_tunnel_shard(in_addr_t ue_ipv4);
+  int             open_sgi_queue(const std::string& if_name, bool multi_queue);
+  int             open_s1u_socket(bool reuse_port);
+  void            init_up_ctx(up_thread_ctx_t& ctx, int sgi, int s1u, bool ctrl_thread);
+
   srslte::byte_buffer_pool* m_pool;
+
+  // UE IP -> tunnel map, looked up by every user plane thread and updated by GTP-C
+  tunnel_shard_t m_tunnel_shards[SPGW_NOF_TUNNEL_SHARDS];
+
+  up_thread_ctx_t                         m_ctrl_ctx;
+  std::vector<std::unique_ptr<up_worker>> m_workers;
+
+  // Downlink PDUs for UEs that need paging, passed from user plane threads to the SP-GW thread
+  std::mutex                          m_handoff_mutex;
+  std::vector<srslte::byte_buffer_t*> m_handoff_queue;
+  int                                 m_handoff_fd;
 };
 
 inline int spgw::gtpu::get_sgi()
@@ -88,6 +146,21 @@ inline int spgw::gtpu::get_s1u()
   return m_s1u;
 }
 
+inline int spgw::gtpu::get_handoff_fd()
+{
+  return m_handoff_fd;
+}
+
+inline uint32_t spgw::gtpu::get_nof_workers()
+{
+  return m_workers.size();
+}
+
+inline spgw::gtpu::up_thread_ctx_t& spgw::gtpu::get_ctrl_ctx()
+{
+  return m_ctrl_ctx;
+}
+
 inline in_addr_t spgw::gtpu::get_s1u_addr()
 {
   return m_s1u_addr.sin_addr.s_addr;
@@ -34,7 +34,10 @@
 #include "srslte/common/logger_file.h"
 #include "srslte/common/logmap.h"
 #include "srslte/common/threads.h"
+#include <atomic>
 #include <cstddef>
+#include <map>
+#include <mutex>
 #include <queue>
 
 namespace srsepc {
@@ -48,6 +51,7 @@ typedef struct {
   std::string sgi_if_addr;
   std::string sgi_if_name;
   uint32_t    max_paging_queue;
+  uint32_t    nof_up_workers;
 } spgw_args_t;
 
 typedef struct spgw_tunnel_ctx {
@@ -78,6 +82,9 @@ public:
   void         stop();
   void         run_thread();
 
+  // Replaces the static UE IPs, e.g. after the HSS reloaded the user database. Applied by the SP-GW thread
+  void update_static_ips(const std::map<std::string, uint64_t>& ip_to_imsi);
+
 private:
   spgw();
   virtual ~spgw();
@@ -86,7 +93,11 @@ private:
   spgw_tunnel_ctx_t* create_gtp_ctx(struct srslte::gtpc_create_session_request* cs_req);
   bool               delete_gtp_ctx(uint32_t ctrl_teid);
 
-  bool                      m_running;
+  void apply_static_ips();
+
+  std::atomic<bool>         m_running;
+  int                       m_stop_fd; // Wakes up the SP-GW thread on stop and on static IP updates
+  int                       m_epoll_fd;
   srslte::byte_buffer_pool* m_pool;
   mme_gtpc*                 m_mme_gtpc;
 
@@ -94,6 +105,11 @@ private:
   gtpc* m_gtpc;
   gtpu* m_gtpu;
 
+  // Static IPs waiting to be applied by the SP-GW thread
+  std::mutex                      m_static_ip_mutex;
+  std::map<std::string, uint64_t> m_pending_ip_to_imsi;
+  bool                            m_static_ip_pending = false;
+
   // Logs
   srslte::log_filter* m_spgw_log;
 };
@@ -19,12 +19,15 @@
  *
  */
 #include "srsepc/hdr/hss/hss.h"
+#include "srslte/common/rwlock_guard.h"
 #include "srslte/common/security.h"
+#include <algorithm>
 #include <inttypes.h> // for printing uint64_t
 #include <iomanip>
 #include <sstream>
 #include <stdlib.h> /* srand, rand */
 #include <string>
+#include <sys/stat.h>
 #include <time.h>
 
 namespace srsepc {
@@ -32,13 +35,18 @@ namespace srsepc {
 hss*            hss::m_instance    = NULL;
 pthread_mutex_t hss_instance_mutex = PTHREAD_MUTEX_INITIALIZER;
 
+// The journal is compacted into the database file once it has more entries than users, and at least this many
+static const uint32_t min_journal_compaction = 1024;
+
 hss::hss()
 {
+  pthread_rwlock_init(&db_lock, nullptr);
   return;
 }
 
 hss::~hss()
 {
+  pthread_rwlock_destroy(&db_lock);
   return;
 }
 
@@ -69,7 +77,10 @@ int hss::init(hss_args_t* hss_args, srslte::log_filter* hss_log)
   m_hss_log = hss_log;
 
   /*Read user information from DB*/
-  if (read_db_file(hss_args->db_file) == false) {
+  db_file   = hss_args->db_file;
+  db_reload = hss_args->db_reload;
+  db_file_changed();
+  if (read_db_file(hss_args->db_file, m_imsi_to_ue_ctx, m_ip_to_imsi) == false) {
     m_hss_log->console("Error reading user database file %s\n", hss_args->db_file.c_str());
     return -1;
   }
@@ -77,7 +88,18 @@ int hss::init(hss_args_t* hss_args, srslte::log_filter* hss_log)
   mcc = hss_args->mcc;
   mnc = hss_args->mnc;
 
-  db_file = hss_args->db_file;
+  /*Apply the SQNs stored since the DB file was last written. A ".old" journal is left by an interrupted compaction*/
+  journal_filename = db_file + ".sqn";
+  bool replayed    = replay_sqn_journal(journal_filename + ".old", true);
+  replayed         = replay_sqn_journal(journal_filename, false) or replayed;
+  if (replayed) {
+    compact_sqn_journal();
+  } else {
+    journal_file = fopen(journal_filename.c_str(), "a");
+  }
+  if (journal_file == nullptr) {
+    m_hss_log->warning("Could not open SQN journal %s. SQNs are only stored on exit\n", journal_filename.c_str());
+  }
 
   m_hss_log->info("HSS Initialized. DB file %s, MCC: %d, MNC: %d\n", hss_args->db_file.c_str(), mcc, mnc);
   m_hss_log->console("HSS Initialized.\n");
@@ -86,11 +108,83 @@ int hss::init(hss_args_t* hss_args, srslte::log_filter* hss_log)
 
 void hss::stop()
 {
-  write_db_file(db_file);
+  compact_sqn_journal();
+  std::lock_guard<std::mutex> lock(journal_mutex);
+  if (journal_file != nullptr) {
+    fclose(journal_file);
+    journal_file = nullptr;
+    remove(journal_filename.c_str());
+  }
   return;
 }
 
-bool hss::read_db_file(std::string db_filename)
+bool hss::check_db_file()
+{
+  bool reloaded = false;
+  if (db_reload and db_file_changed()) {
+    reloaded = reload_db_file();
+  }
+
+  uint32_t nof_entries = 0;
+  {
+    std::lock_guard<std::mutex> lock(journal_mutex);
+    nof_entries = journal_entries;
+  }
+  uint32_t nof_users = 0;
+  {
+    srslte::rwlock_read_guard lock(db_lock);
+    nof_users = m_imsi_to_ue_ctx.size();
+  }
+  if (nof_entries >= std::max(nof_users, min_journal_compaction)) {
+    compact_sqn_journal();
+  }
+  return reloaded;
+}
+
+// Returns true if the DB file is not the one last read or written, and remembers the current one
+bool hss::db_file_changed()
+{
+  struct stat st = {};
+  if (stat(db_file.c_str(), &st) != 0) {
+    return false;
+  }
+  int64_t mtime_ns = (int64_t)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+  bool    changed  = st.st_ino != db_file_ino or mtime_ns != db_file_mtime_ns or st.st_size != db_file_size;
+  db_file_ino      = st.st_ino;
+  db_file_mtime_ns = mtime_ns;
+  db_file_size     = st.st_size;
+  return changed;
+}
+
+bool hss::reload_db_file()
+{
+  ue_ctx_map_t                    ue_ctx_map;
+  std::map<std::string, uint64_t> ip_to_imsi;
+  if (not read_db_file(db_file, ue_ctx_map, ip_to_imsi)) {
+    m_hss_log->error("Error reloading user database file %s. Keeping the current users\n", db_file.c_str());
+    m_hss_log->console("Error reloading user database file %s. Keeping the current users\n", db_file.c_str());
+    return false;
+  }
+
+  // The SQN of the users that were already known is newer than the one in the file
+  srslte::rwlock_write_guard lock(db_lock);
+  for (auto& it : ue_ctx_map) {
+    ue_ctx_map_t::iterator old_it = m_imsi_to_ue_ctx.find(it.first);
+    if (old_it != m_imsi_to_ue_ctx.end()) {
+      it.second->set_sqn(old_it->second->sqn);
+      it.second->set_last_rand(old_it->second->last_rand);
+    }
+  }
+  m_imsi_to_ue_ctx.swap(ue_ctx_map);
+  m_ip_to_imsi.swap(ip_to_imsi);
+  m_hss_log->info("Reloaded user database file %s. %zd users\n", db_file.c_str(), m_imsi_to_ue_ctx.size());
+  m_hss_log->console("Reloaded user database. %zd users\n", m_imsi_to_ue_ctx.size());
+  return true;
+}
+
+bool hss::read_db_file(std::string                      db_filename,
+                       ue_ctx_map_t&                    ue_ctx_map,
+                       std::map<std::string, uint64_t>& ip_to_imsi)
 {
   std::ifstream m_db_file;
 
@@ -156,7 +250,7 @@ bool hss::read_db_file(std::string db_filename)
       } else {
         char buf[128] = {0};
         if (inet_pton(AF_INET, split[9].c_str(), buf)) {
-          if (m_ip_to_imsi.insert(std::make_pair(split[9], ue_ctx->imsi)).second) {
+          if (ip_to_imsi.insert(std::make_pair(split[9], ue_ctx->imsi)).second) {
             ue_ctx->static_ip_addr = split[9];
             m_hss_log->info("static ip addr %s\n", ue_ctx->static_ip_addr.c_str());
           } else {
@@ -168,7 +262,7 @@ bool hss::read_db_file(std::string db_filename)
           return false;
         }
       }
-      m_imsi_to_ue_ctx.insert(std::make_pair(ue_ctx->imsi, std::move(ue_ctx)));
+      ue_ctx_map.insert(std::make_pair(ue_ctx->imsi, std::move(ue_ctx)));
     }
   }
 
@@ -189,11 +283,13 @@ bool hss::write_db_file(std::string db_filename)
 
   std::ofstream m_db_file;
 
-  m_db_file.open(db_filename.c_str(), std::ofstream::out);
+  // Write to a temporary file first, so that the DB file is never left half written
+  std::string tmp_filename = db_filename + ".tmp";
+  m_db_file.open(tmp_filename.c_str(), std::ofstream::out);
   if (!m_db_file.is_open()) {
     return false;
   }
-  m_hss_log->info("Opened DB file: %s\n", db_filename.c_str());
+  m_hss_log->info("Opened DB file: %s\n", tmp_filename.c_str());
 
   // Write comment info
   m_db_file << "#                                                                                           \n"
@@ -216,40 +312,53 @@ bool hss::write_db_file(std::string db_filename)
             << "#                                                                                           \n"
             << "# Note: Lines starting by '#' are ignored and will be overwritten                           \n";
 
-  std::map<uint64_t, std::unique_ptr<hss_ue_ctx_t> >::iterator it = m_imsi_to_ue_ctx.begin();
-  while (it != m_imsi_to_ue_ctx.end()) {
-    m_db_file << it->second->name;
+  srslte::rwlock_read_guard   lock(db_lock);
+  std::vector<hss_ue_ctx_t*> ue_ctxs;
+  ue_ctxs.reserve(m_imsi_to_ue_ctx.size());
+  for (auto& it : m_imsi_to_ue_ctx) {
+    ue_ctxs.push_back(it.second.get());
+  }
+  std::sort(ue_ctxs.begin(), ue_ctxs.end(), [](hss_ue_ctx_t* a, hss_ue_ctx_t* b) { return a->imsi < b->imsi; });
+
+  for (hss_ue_ctx_t* ue_ctx : ue_ctxs) {
+    {
+      std::lock_guard<std::mutex> ue_lock(get_ue_ctx_mutex(ue_ctx->imsi));
+      memcpy(sqn, ue_ctx->sqn, 6);
+    }
+    m_db_file << ue_ctx->name;
     m_db_file << ",";
-    m_db_file << (it->second->algo == HSS_ALGO_XOR ? "xor" : "mil");
+    m_db_file << (ue_ctx->algo == HSS_ALGO_XOR ? "xor" : "mil");
     m_db_file << ",";
-    m_db_file << std::setfill('0') << std::setw(15) << it->second->imsi;
+    m_db_file << std::setfill('0') << std::setw(15) << ue_ctx->imsi;
     m_db_file << ",";
-    m_db_file << hex_string(it->second->key, 16);
+    m_db_file << hex_string(ue_ctx->key, 16);
     m_db_file << ",";
-    if (it->second->op_configured) {
+    if (ue_ctx->op_configured) {
       m_db_file << "op,";
-      m_db_file << hex_string(it->second->op, 16);
+      m_db_file << hex_string(ue_ctx->op, 16);
     } else {
       m_db_file << "opc,";
-      m_db_file << hex_string(it->second->opc, 16);
+      m_db_file << hex_string(ue_ctx->opc, 16);
     }
     m_db_file << ",";
-    m_db_file << hex_string(it->second->amf, 2);
+    m_db_file << hex_string(ue_ctx->amf, 2);
     m_db_file << ",";
-    m_db_file << hex_string(it->second->sqn, 6);
+    m_db_file << hex_string(sqn, 6);
     m_db_file << ",";
-    m_db_file << it->second->qci;
-    if (it->second->static_ip_addr != "0.0.0.0") {
+    m_db_file << ue_ctx->qci;
+    if (ue_ctx->static_ip_addr != "0.0.0.0") {
       m_db_file << ",";
-      m_db_file << it->second->static_ip_addr;
+      m_db_file << ue_ctx->static_ip_addr;
     } else {
       m_db_file << ",dynamic";
     }
-    m_db_file << std::endl;
-    it++;
+    m_db_file << "\n";
   }
-  if (m_db_file.is_open()) {
-    m_db_file.close();
+  m_db_file.close();
+  if (m_db_file.fail() or rename(tmp_filename.c_str(), db_filename.c_str()) != 0) {
+    m_hss_log->error("Error writing DB file %s\n", db_filename.c_str());
+    remove(tmp_filename.c_str());
+    return false;
   }
   return true;
 }
@@ -258,13 +367,15 @@ bool hss::gen_auth_info_answer(uint64_t imsi, uint8_t* k_asme, uint8_t* autn, ui
 {
 
   m_hss_log->debug("Generating AUTH info answer\n");
-  hss_ue_ctx_t* ue_ctx = get_ue_ctx(imsi);
+  srslte::rwlock_read_guard lock(db_lock);
+  hss_ue_ctx_t*             ue_ctx = get_ue_ctx(imsi);
   if (ue_ctx == nullptr) {
     m_hss_log->console("User not found at HSS. IMSI: %015" PRIu64 "\n", imsi);
     m_hss_log->error("User not found at HSS. IMSI: %015" PRIu64 "\n", imsi);
     return false;
   }
 
+  std::lock_guard<std::mutex> ue_lock(get_ue_ctx_mutex(imsi));
   switch (ue_ctx->algo) {
     case HSS_ALGO_XOR:
       gen_auth_info_answer_xor(ue_ctx, k_asme, autn, rand, xres);
@@ -274,6 +385,7 @@ bool hss::gen_auth_info_answer(uint64_t imsi, uint8_t* k_asme, uint8_t* autn, ui
       break;
   }
   increment_ue_sqn(ue_ctx);
+  append_sqn_journal(ue_ctx);
   return true;
 }
 
@@ -432,7 +544,8 @@ void hss::gen_auth_info_answer_xor(hss_ue_ctx_t* ue_ctx, uint8_t* k_asme, uint8_
 
 bool hss::gen_update_loc_answer(uint64_t imsi, uint8_t* qci)
 {
-  std::map<uint64_t, std::unique_ptr<hss_ue_ctx_t> >::iterator ue_ctx_it = m_imsi_to_ue_ctx.find(imsi);
+  srslte::rwlock_read_guard    lock(db_lock);
+  ue_ctx_map_t::const_iterator ue_ctx_it = m_imsi_to_ue_ctx.find(imsi);
   if (ue_ctx_it == m_imsi_to_ue_ctx.end()) {
     m_hss_log->info("User not found. IMSI: %015" PRIu64 "\n", imsi);
     m_hss_log->console("User not found at HSS. IMSI: %015" PRIu64 "\n", imsi);
@@ -447,13 +560,15 @@ bool hss::gen_update_loc_answer(uint64_t imsi, uint8_t* qci)
 bool hss::resync_sqn(uint64_t imsi, uint8_t* auts)
 {
   m_hss_log->debug("Re-syncing SQN\n");
-  hss_ue_ctx_t* ue_ctx = get_ue_ctx(imsi);
+  srslte::rwlock_read_guard lock(db_lock);
+  hss_ue_ctx_t*             ue_ctx = get_ue_ctx(imsi);
   if (ue_ctx == nullptr) {
     m_hss_log->console("User not found at HSS. IMSI: %015" PRIu64 "\n", imsi);
     m_hss_log->error("User not found at HSS. IMSI: %015" PRIu64 "\n", imsi);
     return false;
   }
 
+  std::lock_guard<std::mutex> ue_lock(get_ue_ctx_mutex(imsi));
   switch (ue_ctx->algo) {
     case HSS_ALGO_XOR:
       resync_sqn_xor(ue_ctx, auts);
@@ -464,6 +579,7 @@ bool hss::resync_sqn(uint64_t imsi, uint8_t* auts)
   }
 
   increment_seq_after_resync(ue_ctx);
+  append_sqn_journal(ue_ctx);
   return true;
 }
 
@@ -602,9 +718,10 @@ void hss::gen_rand(uint8_t rand_[16])
   return;
 }
 
+// Must be called with db_lock held
 hss_ue_ctx_t* hss::get_ue_ctx(uint64_t imsi)
 {
-  std::map<uint64_t, std::unique_ptr<hss_ue_ctx_t> >::iterator ue_ctx_it = m_imsi_to_ue_ctx.find(imsi);
+  ue_ctx_map_t::iterator ue_ctx_it = m_imsi_to_ue_ctx.find(imsi);
   if (ue_ctx_it == m_imsi_to_ue_ctx.end()) {
     m_hss_log->info("User not found. IMSI: %015" PRIu64 "\n", imsi);
     return nullptr;
@@ -650,7 +767,79 @@ std::string hss::hex_string(uint8_t* hex, int size)
 
 std::map<std::string, uint64_t> hss::get_ip_to_imsi(void) const
 {
+  srslte::rwlock_read_guard lock(db_lock);
   return m_ip_to_imsi;
 }
 
+/* SQN journal. Each line holds the IMSI and the SQN of a user after an update */
+bool hss::replay_sqn_journal(const std::string& filename, bool keep_higher)
+{
+  std::ifstream journal(filename.c_str(), std::ifstream::in);
+  if (!journal.is_open()) {
+    return false;
+  }
+
+  uint32_t    nof_entries = 0;
+  std::string line;
+  while (std::getline(journal, line)) {
+    std::vector<std::string> split = split_string(line, ',');
+    if (split.size() != 2 or split[1].size() != 12) {
+      // The last line may be incomplete if the EPC did not exit cleanly
+      m_hss_log->warning("Ignoring malformed SQN journal entry \"%s\"\n", line.c_str());
+      continue;
+    }
+    uint64_t imsi = strtoull(split[0].c_str(), nullptr, 10);
+    uint8_t  sqn[6];
+    get_uint_vec_from_hex_str(split[1], sqn, 6);
+    hss_ue_ctx_t* ue_ctx = get_ue_ctx(imsi);
+    if (ue_ctx == nullptr) {
+      continue;
+    }
+    if (not keep_higher or memcmp(sqn, ue_ctx->sqn, 6) > 0) {
+      ue_ctx->set_sqn(sqn);
+    }
+    nof_entries++;
+  }
+  m_hss_log->info("Replayed %d entries of SQN journal %s\n", nof_entries, filename.c_str());
+  return true;
+}
+
+// Must be called with the lock of the UE context held, so that the entries of a user are in order
+void hss::append_sqn_journal(const hss_ue_ctx_t* ue_ctx)
+{
+  char line[64];
+  int  len = snprintf(line, sizeof(line), "%015" PRIu64 ",", ue_ctx->imsi);
+  for (uint32_t i = 0; i < 6; i++) {
+    len += snprintf(line + len, sizeof(line) - len, "%02x", ue_ctx->sqn[i]);
+  }
+  line[len++] = '\n';
+
+  std::lock_guard<std::mutex> lock(journal_mutex);
+  if (journal_file != nullptr) {
+    fwrite(line, 1, len, journal_file);
+    fflush(journal_file);
+    journal_entries++;
+  }
+}
+
+// Writes the current SQNs to the DB file and starts an empty journal
+void hss::compact_sqn_journal()
+{
+  // Updates from now on go to a new journal. The old one is kept until the DB file has its SQNs
+  std::string old_journal = journal_filename + ".old";
+  {
+    std::lock_guard<std::mutex> lock(journal_mutex);
+    if (journal_file != nullptr) {
+      fclose(journal_file);
+    }
+    rename(journal_filename.c_str(), old_journal.c_str());
+    journal_file    = fopen(journal_filename.c_str(), "a");
+    journal_entries = 0;
+  }
+  if (write_db_file(db_file)) {
+    remove(old_journal.c_str());
+  }
+  db_file_changed();
+}
+
 } // namespace srsepc
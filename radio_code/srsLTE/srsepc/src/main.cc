@@ -80,7 +80,9 @@ void parse_args(all_args_t* args, int argc, char* argv[])
   string   encryption_algo;
   string   integrity_algo;
   uint16_t paging_timer     = 0;
+  uint32_t nof_mme_workers  = 0;
   uint32_t max_paging_queue = 0;
+  uint32_t nof_up_workers   = 0;
   string   spgw_bind_addr;
   string   sgi_if_addr;
   string   sgi_if_name;
@@ -112,11 +114,14 @@ void parse_args(all_args_t* args, int argc, char* argv[])
     ("mme.encryption_algo", bpo::value<string>(&encryption_algo)->default_value("EEA0"),     "Set preferred encryption algorithm for NAS layer ")
     ("mme.integrity_algo",  bpo::value<string>(&integrity_algo)->default_value("EIA1"),      "Set preferred integrity protection algorithm for NAS")
     ("mme.paging_timer",    bpo::value<uint16_t>(&paging_timer)->default_value(2),           "Set paging timer value in seconds (T3413)")
+    ("mme.nof_workers",     bpo::value<uint32_t>(&nof_mme_workers)->default_value(0),        "Number of threads that process the UE contexts (0: the MME thread processes them)")
     ("hss.db_file",         bpo::value<string>(&hss_db_file)->default_value("ue_db.csv"),    ".csv file that stores UE's keys")
+    ("hss.db_reload",       bpo::value<bool>(&args->hss_args.db_reload)->default_value(true), "Reload the .csv file when it changes")
     ("spgw.gtpu_bind_addr", bpo::value<string>(&spgw_bind_addr)->default_value("127.0.0.1"), "IP address of SP-GW for the S1-U connection")
     ("spgw.sgi_if_addr",    bpo::value<string>(&sgi_if_addr)->default_value("176.16.0.1"),   "IP address of TUN interface for the SGi connection")
     ("spgw.sgi_if_name",    bpo::value<string>(&sgi_if_name)->default_value("srs_spgw_sgi"), "Name of TUN interface for the SGi connection")
     ("spgw.max_paging_queue", bpo::value<uint32_t>(&max_paging_queue)->default_value(100), "Max number of packets in paging queue")
+    ("spgw.nof_up_workers",   bpo::value<uint32_t>(&nof_up_workers)->default_value(0),     "Number of user plane worker threads (0: user plane runs on the SP-GW thread)")
 
     ("pcap.enable",   bpo::value<bool>(&args->mme_args.s1ap_args.pcap_enable)->default_value(false),         "Enable S1AP PCAP")
     ("pcap.filename", bpo::value<string>(&args->mme_args.s1ap_args.pcap_filename)->default_value("/tmp/epc.pcap"), "PCAP filename")
@@ -269,10 +274,12 @@ void parse_args(all_args_t* args, int argc, char* argv[])
   args->mme_args.s1ap_args.dns_addr      = dns_addr;
   args->mme_args.s1ap_args.mme_apn       = mme_apn;
   args->mme_args.s1ap_args.paging_timer  = paging_timer;
+  args->mme_args.s1ap_args.nof_workers   = nof_mme_workers;
   args->spgw_args.gtpu_bind_addr         = spgw_bind_addr;
   args->spgw_args.sgi_if_addr            = sgi_if_addr;
   args->spgw_args.sgi_if_name            = sgi_if_name;
   args->spgw_args.max_paging_queue       = max_paging_queue;
+  args->spgw_args.nof_up_workers         = nof_up_workers;
   args->hss_args.db_file                 = hss_db_file;
 
   // Apply all_level to any unset layers
@@ -456,6 +463,9 @@ int main(int argc, char* argv[])
   spgw->start();
   while (running) {
     sleep(1);
+    if (hss->check_db_file()) {
+      spgw->update_static_ips(hss->get_ip_to_imsi());
+    }
   }
 
   mme->stop();
@@ -20,25 +20,75 @@
  */
 
 #include "srsepc/hdr/mme/mme.h"
+#include "srslte/common/rwlock_guard.h"
 #include <arpa/inet.h>
 #include <inttypes.h> // for printing uint64_t
 #include <netinet/sctp.h>
+#include <sys/eventfd.h>
 #include <sys/socket.h>
 #include <sys/types.h>
+#include <thread>
 
 namespace srsepc {
 
 mme*            mme::m_instance    = NULL;
 pthread_mutex_t mme_instance_mutex = PTHREAD_MUTEX_INITIALIZER;
 
-mme::mme() : m_running(false), thread("MME")
+/*
+ * Worker thread that processes the messages of one shard of the UE contexts
+ */
+class mme::worker : public srslte::thread
+{
+public:
+  worker(mme* parent_, uint32_t id_) : thread("MME_WORKER" + std::to_string(id_)), parent(parent_), id(id_)
+  {
+    queue_id = tasks.add_queue();
+  }
+
+  void push(mme_task_t&& task) { tasks.push(queue_id, std::move(task)); }
+  bool is_idle() { return tasks.empty(queue_id); }
+
+  void stop()
+  {
+    tasks.reset();
+    wait_thread_finish();
+  }
+
+private:
+  void run_thread() override
+  {
+    s1ap::set_current_shard(id);
+    mme_task_t task;
+    while (tasks.wait_pop(&task) >= 0) {
+      parent->handle_task(task);
+      task.pdu.reset();
+      task.callback = nullptr;
+      parent->m_nof_pending_tasks--;
+    }
+  }
+
+  mme*                                            parent;
+  uint32_t                                        id;
+  int                                             queue_id;
+  srslte::lockfree_multiqueue_handler<mme_task_t> tasks;
+};
+
+mme::mme() : m_running(false), m_wakeup_fd(-1), m_nof_pending_tasks(0), thread("MME")
 {
   m_pool = srslte::byte_buffer_pool::get_instance();
+
+  // Writers are preferred, so that eNB procedures are not starved by the workers
+  pthread_rwlockattr_t attr;
+  pthread_rwlockattr_init(&attr);
+  pthread_rwlockattr_setkind_np(&attr, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+  pthread_rwlock_init(&m_ctx_lock, &attr);
+  pthread_rwlockattr_destroy(&attr);
   return;
 }
 
 mme::~mme()
 {
+  pthread_rwlock_destroy(&m_ctx_lock);
   return;
 }
 
@@ -86,35 +136,72 @@ int mme::init(mme_args_t*         args,
     exit(-1);
   }
 
+  m_wakeup_fd = eventfd(0, EFD_NONBLOCK);
+  if (m_wakeup_fd == -1) {
+    m_s1ap_log->error("Error creating MME eventfd: %s\n", strerror(errno));
+    return -1;
+  }
+
+  /*Init workers, one per shard of the UE contexts*/
+  for (uint32_t i = 0; i < args->s1ap_args.nof_workers; i++) {
+    m_workers.emplace_back(new worker(this, i));
+    m_workers.back()->start();
+  }
+
   /*Log successful initialization*/
   m_s1ap_log->info("MME Initialized. MCC: 0x%x, MNC: 0x%x\n", args->s1ap_args.mcc, args->s1ap_args.mnc);
   m_s1ap_log->console("MME Initialized. MCC: 0x%x, MNC: 0x%x\n", args->s1ap_args.mcc, args->s1ap_args.mnc);
+  if (!m_workers.empty()) {
+    m_s1ap_log->console("MME UE contexts processed by %zd workers\n", m_workers.size());
+  }
   return 0;
 }
 
 void mme::stop()
 {
   if (m_running) {
-    m_s1ap->stop();
-    m_s1ap->cleanup();
+    // Stop receiving messages, then let the workers finish the ones they have. As these may hand further tasks to
+    // other workers, the workers are only stopped once no task is pending
     m_running = false;
-    thread_cancel();
+    wake_up();
     wait_thread_finish();
+    while (m_nof_pending_tasks > 0) {
+      std::this_thread::yield();
+    }
+    for (std::unique_ptr<worker>& w : m_workers) {
+      w->stop();
+    }
+    m_workers.clear();
+    m_s1ap->stop();
+    m_s1ap->cleanup();
+  }
+  if (m_wakeup_fd != -1) {
+    close(m_wakeup_fd);
+    m_wakeup_fd = -1;
   }
   return;
 }
 
+void mme::wake_up()
+{
+  uint64_t one = 1;
+  if (write(m_wakeup_fd, &one, sizeof(one)) < 0) {
+    m_s1ap_log->error("Error waking up the MME thread: %s\n", strerror(errno));
+  }
+}
+
 void mme::run_thread()
 {
-  srslte::byte_buffer_t* pdu = m_pool->allocate("mme::run_thread");
-  uint32_t               sz  = SRSLTE_MAX_BUFFER_SIZE_BYTES - SRSLTE_BUFFER_HEADER_OFFSET;
+  uint32_t sz = SRSLTE_MAX_BUFFER_SIZE_BYTES - SRSLTE_BUFFER_HEADER_OFFSET;
 
   struct sockaddr_in     enb_addr;
   struct sctp_sndrcvinfo sri;
   socklen_t              fromlen = sizeof(enb_addr);
   bzero(&enb_addr, sizeof(enb_addr));
-  int rd_sz;
-  int msg_flags = 0;
+  int                      rd_sz;
+  int                      msg_flags = 0;
+  fd_set                   set;
+  std::vector<mme_timer_t> expired_timers;
 
   // Mark the thread as running
   m_running = true;
@@ -124,27 +211,44 @@ void mme::run_thread()
   int s11   = m_mme_gtpc->get_s11();
 
   while (m_running) {
-    pdu->clear();
-    int max_fd = std::max(s1mme, s11);
+    int max_fd = std::max(std::max(s1mme, s11), m_wakeup_fd);
 
-    FD_ZERO(&m_set);
-    FD_SET(s1mme, &m_set);
-    FD_SET(s11, &m_set);
+    FD_ZERO(&set);
+    FD_SET(s1mme, &set);
+    FD_SET(s11, &set);
+    FD_SET(m_wakeup_fd, &set);
 
     // Add timers to select
-    for (std::vector<mme_timer_t>::iterator it = timers.begin(); it != timers.end(); ++it) {
-      FD_SET(it->fd, &m_set);
-      max_fd = std::max(max_fd, it->fd);
-      m_s1ap_log->debug("Adding Timer fd %d to fd_set\n", it->fd);
+    {
+      std::lock_guard<std::mutex> lock(m_timers_mutex);
+      for (int fd : m_removed_timer_fds) {
+        close(fd);
+      }
+      m_removed_timer_fds.clear();
+      for (std::vector<mme_timer_t>::iterator it = timers.begin(); it != timers.end(); ++it) {
+        FD_SET(it->fd, &set);
+        max_fd = std::max(max_fd, it->fd);
+        m_s1ap_log->debug("Adding Timer fd %d to fd_set\n", it->fd);
+      }
     }
 
     m_s1ap_log->debug("Waiting for S1-MME or S11 Message\n");
-    int n = select(max_fd + 1, &m_set, NULL, NULL, NULL);
+    int n = select(max_fd + 1, &set, NULL, NULL, NULL);
     if (n == -1) {
       m_s1ap_log->error("Error from select\n");
     } else if (n) {
+      // Woken up to stop, or to wait on a new timer
+      if (FD_ISSET(m_wakeup_fd, &set)) {
+        uint64_t count;
+        rd_sz = read(m_wakeup_fd, &count, sizeof(count));
+      }
       // Handle S1-MME
-      if (FD_ISSET(s1mme, &m_set)) {
+      if (FD_ISSET(s1mme, &set)) {
+        srslte::unique_byte_buffer_t pdu = srslte::allocate_unique_buffer(*m_pool, "mme::run_thread");
+        if (pdu == nullptr) {
+          m_s1ap_log->error("Fatal Error: Couldn't allocate buffer for S1AP PDU.\n");
+          continue;
+        }
         rd_sz = sctp_recvmsg(s1mme, pdu->msg, sz, (struct sockaddr*)&enb_addr, &fromlen, &sri, &msg_flags);
         if (rd_sz == -1 && errno != EAGAIN) {
           m_s1ap_log->error("Error reading from SCTP socket: %s", strerror(errno));
@@ -158,34 +262,46 @@ void mme::run_thread()
             if (notification->sn_header.sn_type == SCTP_SHUTDOWN_EVENT) {
               m_s1ap_log->info("SCTP Association Shutdown. Association: %d\n", sri.sinfo_assoc_id);
               m_s1ap_log->console("SCTP Association Shutdown. Association: %d\n", sri.sinfo_assoc_id);
-              m_s1ap->delete_enb_ctx(sri.sinfo_assoc_id);
+              delete_enb_ctx(sri.sinfo_assoc_id);
             }
           } else {
             // Received data
             pdu->N_bytes = rd_sz;
             m_s1ap_log->info("Received S1AP msg. Size: %d\n", pdu->N_bytes);
-            m_s1ap->handle_s1ap_rx_pdu(pdu, &sri);
+            handle_s1ap_rx_pdu(std::move(pdu), sri);
           }
         }
       }
       // Handle S11
-      if (FD_ISSET(s11, &m_set)) {
+      if (FD_ISSET(s11, &set)) {
+        srslte::unique_byte_buffer_t pdu = srslte::allocate_unique_buffer(*m_pool, "mme::run_thread");
+        if (pdu == nullptr) {
+          m_s1ap_log->error("Fatal Error: Couldn't allocate buffer for S11 PDU.\n");
+          continue;
+        }
         pdu->N_bytes = recvfrom(s11, pdu->msg, SRSLTE_MAX_BUFFER_SIZE_BYTES, 0, NULL, NULL);
-        m_mme_gtpc->handle_s11_pdu(pdu);
+        handle_s11_pdu(std::move(pdu));
       }
       // Handle NAS Timers
-      for (std::vector<mme_timer_t>::iterator it = timers.begin(); it != timers.end();) {
-        if (FD_ISSET(it->fd, &m_set)) {
-          m_s1ap_log->info("Timer expired\n");
-          uint64_t exp;
-          rd_sz = read(it->fd, &exp, sizeof(uint64_t));
-          m_s1ap->expire_nas_timer(it->type, it->imsi);
-          close(it->fd);
-          timers.erase(it);
-        } else {
-          ++it;
+      expired_timers.clear();
+      {
+        std::lock_guard<std::mutex> lock(m_timers_mutex);
+        for (std::vector<mme_timer_t>::iterator it = timers.begin(); it != timers.end();) {
+          if (FD_ISSET(it->fd, &set)) {
+            m_s1ap_log->info("Timer expired\n");
+            uint64_t exp;
+            rd_sz = read(it->fd, &exp, sizeof(uint64_t));
+            close(it->fd);
+            expired_timers.push_back(*it);
+            it = timers.erase(it);
+          } else {
+            ++it;
+          }
         }
       }
+      for (const mme_timer_t& timer : expired_timers) {
+        handle_expired_timer(timer);
+      }
     } else {
       m_s1ap_log->debug("No data from select.\n");
     }
@@ -193,6 +309,113 @@ void mme::run_thread()
   return;
 }
 
+/*
+ * Message dispatching
+ */
+void mme::handle_s1ap_rx_pdu(srslte::unique_byte_buffer_t pdu, const struct sctp_sndrcvinfo& enb_sri)
+{
+  struct sctp_sndrcvinfo sri = enb_sri;
+  if (m_workers.empty()) {
+    m_s1ap->handle_s1ap_rx_pdu(pdu.get(), &sri);
+    return;
+  }
+
+  int shard = m_s1ap->get_rx_pdu_shard(pdu.get(), &enb_sri);
+  if (shard < 0) {
+    // eNB procedures change contexts that all the workers use
+    srslte::rwlock_write_guard lock(m_ctx_lock);
+    m_s1ap->handle_s1ap_rx_pdu(pdu.get(), &sri);
+    return;
+  }
+
+  mme_task_t task;
+  task.type = mme_task_t::S1AP_PDU;
+  task.pdu  = std::move(pdu);
+  task.sri  = enb_sri;
+  push_task(shard, std::move(task));
+}
+
+void mme::handle_s11_pdu(srslte::unique_byte_buffer_t pdu)
+{
+  if (m_workers.empty()) {
+    m_mme_gtpc->handle_s11_pdu(pdu.get());
+    return;
+  }
+
+  // The MME control TEID of the message encodes the shard of the UE
+  srslte::gtpc_pdu* gtpc_pdu = (srslte::gtpc_pdu*)pdu->msg;
+  uint32_t          shard    = m_s1ap->get_id_shard(gtpc_pdu->header.teid);
+
+  mme_task_t task;
+  task.type = mme_task_t::S11_PDU;
+  task.pdu  = std::move(pdu);
+  push_task(shard, std::move(task));
+}
+
+void mme::handle_expired_timer(const mme_timer_t& timer)
+{
+  if (m_workers.empty()) {
+    m_s1ap->expire_nas_timer(timer.type, timer.imsi);
+    return;
+  }
+
+  mme_task_t task;
+  task.type       = mme_task_t::NAS_TIMER;
+  task.timer_type = timer.type;
+  task.imsi       = timer.imsi;
+  push_task(timer.shard, std::move(task));
+}
+
+void mme::run_in_shard(uint32_t shard, std::function<void()> callback)
+{
+  if (m_workers.empty()) {
+    callback();
+    return;
+  }
+
+  mme_task_t task;
+  task.type     = mme_task_t::CALLBACK;
+  task.callback = std::move(callback);
+  push_task(shard, std::move(task));
+}
+
+void mme::push_task(uint32_t shard, mme_task_t&& task)
+{
+  m_nof_pending_tasks++;
+  m_workers[shard]->push(std::move(task));
+}
+
+void mme::handle_task(mme_task_t& task)
+{
+  srslte::rwlock_read_guard lock(m_ctx_lock);
+  switch (task.type) {
+    case mme_task_t::S1AP_PDU:
+      m_s1ap->handle_s1ap_rx_pdu(task.pdu.get(), &task.sri);
+      break;
+    case mme_task_t::S11_PDU:
+      m_mme_gtpc->handle_s11_pdu(task.pdu.get());
+      break;
+    case mme_task_t::NAS_TIMER:
+      m_s1ap->expire_nas_timer(task.timer_type, task.imsi);
+      break;
+    case mme_task_t::CALLBACK:
+      task.callback();
+      break;
+  }
+}
+
+void mme::delete_enb_ctx(int32_t assoc_id)
+{
+  // The messages received from the eNB before the shutdown are processed first
+  for (std::unique_ptr<worker>& w : m_workers) {
+    while (!w->is_idle()) {
+      std::this_thread::yield();
+    }
+  }
+  srslte::rwlock_write_guard lock(m_ctx_lock);
+  m_s1ap->delete_enb_ctx(assoc_id);
+}
+
 /*
  * Timer Handling
  */
@@ -201,16 +424,25 @@ bool mme::add_nas_timer(int timer_fd, nas_timer_type type, uint64_t imsi)
   m_s1ap_log->debug("Adding NAS timer to MME. IMSI %" PRIu64 ", Type %d, Fd: %d\n", imsi, type, timer_fd);
 
   mme_timer_t timer;
-  timer.fd   = timer_fd;
-  timer.type = type;
-  timer.imsi = imsi;
+  timer.fd    = timer_fd;
+  timer.type  = type;
+  timer.imsi  = imsi;
+  timer.shard = s1ap::get_current_shard();
 
-  timers.push_back(timer);
+  {
+    std::lock_guard<std::mutex> lock(m_timers_mutex);
+    timers.push_back(timer);
+  }
+  // A worker must wake up the MME thread, so that it waits on the timer too
+  if (!m_workers.empty()) {
+    wake_up();
+  }
   return true;
 }
 
 bool mme::is_nas_timer_running(nas_timer_type type, uint64_t imsi)
 {
+  std::lock_guard<std::mutex>        lock(m_timers_mutex);
   std::vector<mme_timer_t>::iterator it;
   for (it = timers.begin(); it != timers.end(); ++it) {
     if (it->type == type && it->imsi == imsi) {
@@ -222,6 +454,7 @@ bool mme::is_nas_timer_running(nas_timer_type type, uint64_t imsi)
 
 bool mme::remove_nas_timer(nas_timer_type type, uint64_t imsi)
 {
+  std::lock_guard<std::mutex>        lock(m_timers_mutex);
   std::vector<mme_timer_t>::iterator it;
   for (it = timers.begin(); it != timers.end(); ++it) {
     if (it->type == type && it->imsi == imsi) {
@@ -233,10 +466,9 @@ bool mme::remove_nas_timer(nas_timer_type type, uint64_t imsi)
     return false;
   }
 
-  // removing timer
+  // removing timer. The MME thread closes its fd, since it may be waiting on it
   m_s1ap_log->debug("Removing NAS timer from MME. IMSI %" PRIu64 ", Type %d, Fd: %d\n", imsi, type, it->fd);
-  FD_CLR(it->fd, &m_set);
-  close(it->fd);
+  m_removed_timer_fds.push_back(it->fd);
   timers.erase(it);
   return true;
 }
@@ -66,10 +66,11 @@ bool mme_gtpc::init(srslte::log_filter* mme_gtpc_log)
   /*Init log*/
   m_mme_gtpc_log = mme_gtpc_log;
 
-  m_next_ctrl_teid = 1;
-
   m_s1ap = s1ap::get_instance();
 
+  // Like the MME UE S1AP Ids, the control TEIDs encode the shard of the UE
+  m_ctrl_teids.init(m_s1ap->get_nof_shards());
+
   if (!init_s11()) {
     m_mme_gtpc_log->error("Error Initializing MME S11 Interface\n");
     return false;
@@ -120,6 +121,33 @@ bool mme_gtpc::init_s11()
   return true;
 }
 
+uint32_t mme_gtpc::get_new_ctrl_teid()
+{
+  return m_ctrl_teids.allocate(s1ap::get_current_shard());
+}
+
+bool mme_gtpc::find_imsi(uint32_t mme_ctrl_teid, uint64_t* imsi)
+{
+  std::lock_guard<std::mutex>                      lock(m_ctx_mutex);
+  std::unordered_map<uint32_t, uint64_t>::iterator it = m_mme_ctr_teid_to_imsi.find(mme_ctrl_teid);
+  if (it == m_mme_ctr_teid_to_imsi.end()) {
+    return false;
+  }
+  *imsi = it->second;
+  return true;
+}
+
+bool mme_gtpc::find_gtpc_ctx(uint64_t imsi, gtpc_ctx_t* gtpc_ctx)
+{
+  std::lock_guard<std::mutex>                        lock(m_ctx_mutex);
+  std::unordered_map<uint64_t, gtpc_ctx_t>::iterator it = m_imsi_to_gtpc_ctx.find(imsi);
+  if (it == m_imsi_to_gtpc_ctx.end()) {
+    return false;
+  }
+  *gtpc_ctx = it->second;
+  return true;
+}
+
 bool mme_gtpc::send_s11_pdu(const srslte::gtpc_pdu& pdu)
 {
   int n;
@@ -185,7 +213,6 @@ bool mme_gtpc::send_create_session_request(uint64_t imsi)
   cs_req->sender_f_teid.teid = get_new_ctrl_teid();
   cs_req->sender_f_teid.ipv4 = m_mme_gtpc_ip;
 
-  m_mme_gtpc_log->info("Next MME control TEID: %d\n", m_next_ctrl_teid);
   m_mme_gtpc_log->info("Allocated MME control TEID: %d\n", cs_req->sender_f_teid.teid);
   m_mme_gtpc_log->console("Creating Session Response -- IMSI: %" PRIu64 "\n", imsi);
   m_mme_gtpc_log->console("Creating Session Response -- MME control TEID: %d\n", cs_req->sender_f_teid.teid);
@@ -200,31 +227,36 @@ bool mme_gtpc::send_create_session_request(uint64_t imsi)
   // Bearer QoS
   cs_req->eps_bearer_context_created.ebi = 5;
 
-  // Check whether this UE is already registed
-  std::map<uint64_t, struct gtpc_ctx>::iterator it = m_imsi_to_gtpc_ctx.find(imsi);
-  if (it != m_imsi_to_gtpc_ctx.end()) {
-    m_mme_gtpc_log->warning("Create Session Request being called for an UE with an active GTP-C connection.\n");
-    m_mme_gtpc_log->warning("Deleting previous GTP-C connection.\n");
-    std::map<uint32_t, uint64_t>::iterator jt = m_mme_ctr_teid_to_imsi.find(it->second.mme_ctr_fteid.teid);
-    if (jt == m_mme_ctr_teid_to_imsi.end()) {
-      m_mme_gtpc_log->error("Could not find IMSI from MME Ctrl TEID. MME Ctr TEID: %d\n",
-                            it->second.mme_ctr_fteid.teid);
-    } else {
-      m_mme_ctr_teid_to_imsi.erase(jt);
+  {
+    std::lock_guard<std::mutex> lock(m_ctx_mutex);
+
+    // Check whether this UE is already registed
+    std::unordered_map<uint64_t, struct gtpc_ctx>::iterator it = m_imsi_to_gtpc_ctx.find(imsi);
+    if (it != m_imsi_to_gtpc_ctx.end()) {
+      m_mme_gtpc_log->warning("Create Session Request being called for an UE with an active GTP-C connection.\n");
+      m_mme_gtpc_log->warning("Deleting previous GTP-C connection.\n");
+      std::unordered_map<uint32_t, uint64_t>::iterator jt = m_mme_ctr_teid_to_imsi.find(it->second.mme_ctr_fteid.teid);
+      if (jt == m_mme_ctr_teid_to_imsi.end()) {
+        m_mme_gtpc_log->error("Could not find IMSI from MME Ctrl TEID. MME Ctr TEID: %d\n",
+                              it->second.mme_ctr_fteid.teid);
+      } else {
+        m_mme_ctr_teid_to_imsi.erase(jt);
+      }
+      m_imsi_to_gtpc_ctx.erase(it);
+      // No need to send delete session request to the SPGW.
+      // The create session request will be interpreted as a new request and SPGW will delete locally in existing
+      // context.
     }
-    m_imsi_to_gtpc_ctx.erase(it);
-    // No need to send delete session request to the SPGW.
-    // The create session request will be interpreted as a new request and SPGW will delete locally in existing context.
-  }
 
-  // Save RX Control TEID
-  m_mme_ctr_teid_to_imsi.insert(std::pair<uint32_t, uint64_t>(cs_req->sender_f_teid.teid, imsi));
+    // Save RX Control TEID
+    m_mme_ctr_teid_to_imsi.insert(std::pair<uint32_t, uint64_t>(cs_req->sender_f_teid.teid, imsi));
 
-  // Save GTP-C context
-  gtpc_ctx_t gtpc_ctx;
-  bzero(&gtpc_ctx, sizeof(gtpc_ctx_t));
-  gtpc_ctx.mme_ctr_fteid = cs_req->sender_f_teid;
-  m_imsi_to_gtpc_ctx.insert(std::pair<uint64_t, gtpc_ctx_t>(imsi, gtpc_ctx));
+    // Save GTP-C context
+    gtpc_ctx_t gtpc_ctx;
+    bzero(&gtpc_ctx, sizeof(gtpc_ctx_t));
+    gtpc_ctx.mme_ctr_fteid = cs_req->sender_f_teid;
+    m_imsi_to_gtpc_ctx.insert(std::pair<uint64_t, gtpc_ctx_t>(imsi, gtpc_ctx));
+  }
 
   // Send msg to SPGW
   send_s11_pdu(cs_req_pdu);
@@ -248,12 +280,11 @@ bool mme_gtpc::handle_create_session_response(srslte::gtpc_pdu* cs_resp_pdu)
   }
 
   // Get IMSI from the control TEID
-  std::map<uint32_t, uint64_t>::iterator id_it = m_mme_ctr_teid_to_imsi.find(cs_resp_pdu->header.teid);
-  if (id_it == m_mme_ctr_teid_to_imsi.end()) {
+  uint64_t imsi = 0;
+  if (!find_imsi(cs_resp_pdu->header.teid, &imsi)) {
     m_mme_gtpc_log->warning("Could not find IMSI from Ctrl TEID.\n");
     return false;
   }
-  uint64_t imsi = id_it->second;
 
   m_mme_gtpc_log->info("MME GTPC Ctrl TEID %" PRIu64 ", IMSI %" PRIu64 "\n", cs_resp_pdu->header.teid, imsi);
 
@@ -298,14 +329,17 @@ bool mme_gtpc::handle_create_session_response(srslte::gtpc_pdu* cs_resp_pdu)
   m_mme_gtpc_log->console("SPGW Allocated IP %s to IMSI %015" PRIu64 "\n", inet_ntoa(emm_ctx->ue_ip), emm_ctx->imsi);
 
   // Save SGW ctrl F-TEID in GTP-C context
-  std::map<uint64_t, struct gtpc_ctx>::iterator it_g = m_imsi_to_gtpc_ctx.find(imsi);
-  if (it_g == m_imsi_to_gtpc_ctx.end()) {
-    // Could not find GTP-C Context
-    m_mme_gtpc_log->error("Could not find GTP-C context\n");
-    return false;
+  {
+    std::lock_guard<std::mutex>                             lock(m_ctx_mutex);
+    std::unordered_map<uint64_t, struct gtpc_ctx>::iterator it_g = m_imsi_to_gtpc_ctx.find(imsi);
+    if (it_g == m_imsi_to_gtpc_ctx.end()) {
+      // Could not find GTP-C Context
+      m_mme_gtpc_log->error("Could not find GTP-C context\n");
+      return false;
+    }
+    gtpc_ctx_t* gtpc_ctx    = &it_g->second;
+    gtpc_ctx->sgw_ctr_fteid = sgw_ctr_fteid;
   }
-  gtpc_ctx_t* gtpc_ctx    = &it_g->second;
-  gtpc_ctx->sgw_ctr_fteid = sgw_ctr_fteid;
 
   // Set EPS bearer context
   // TODO default EPS bearer is hard-coded
@@ -322,12 +356,12 @@ bool mme_gtpc::send_modify_bearer_request(uint64_t imsi, uint16_t erab_to_modify
   m_mme_gtpc_log->info("Sending GTP-C Modify bearer request\n");
   srslte::gtpc_pdu mb_req_pdu;
 
-  std::map<uint64_t, gtpc_ctx_t>::iterator it = m_imsi_to_gtpc_ctx.find(imsi);
-  if (it == m_imsi_to_gtpc_ctx.end()) {
+  gtpc_ctx_t gtpc_ctx;
+  if (!find_gtpc_ctx(imsi, &gtpc_ctx)) {
     m_mme_gtpc_log->error("Modify bearer request for UE without GTP-C connection\n");
     return false;
   }
-  srslte::gtp_fteid_t sgw_ctr_fteid = it->second.sgw_ctr_fteid;
+  srslte::gtp_fteid_t sgw_ctr_fteid = gtpc_ctx.sgw_ctr_fteid;
 
   srslte::gtpc_header* header = &mb_req_pdu.header;
   header->teid_present        = true;
@@ -351,16 +385,16 @@ bool mme_gtpc::send_modify_bearer_request(uint64_t imsi, uint16_t erab_to_modify
 
 void mme_gtpc::handle_modify_bearer_response(srslte::gtpc_pdu* mb_resp_pdu)
 {
-  uint32_t                               mme_ctrl_teid = mb_resp_pdu->header.teid;
-  std::map<uint32_t, uint64_t>::iterator imsi_it       = m_mme_ctr_teid_to_imsi.find(mme_ctrl_teid);
-  if (imsi_it == m_mme_ctr_teid_to_imsi.end()) {
+  uint32_t mme_ctrl_teid = mb_resp_pdu->header.teid;
+  uint64_t imsi          = 0;
+  if (!find_imsi(mme_ctrl_teid, &imsi)) {
     m_mme_gtpc_log->error("Could not find IMSI from control TEID\n");
     return;
   }
 
   uint8_t ebi = mb_resp_pdu->choice.modify_bearer_response.eps_bearer_context_modified.ebi;
   m_mme_gtpc_log->debug("Activating EPS bearer with id %d\n", ebi);
-  m_s1ap->activate_eps_bearer(imsi_it->second, ebi);
+  m_s1ap->activate_eps_bearer(imsi, ebi);
 
   return;
 }
@@ -372,15 +406,26 @@ bool mme_gtpc::send_delete_session_request(uint64_t imsi)
   srslte::gtp_fteid_t sgw_ctr_fteid;
   srslte::gtp_fteid_t mme_ctr_fteid;
 
-  // Get S-GW Ctr TEID
-  std::map<uint64_t, gtpc_ctx_t>::iterator it_ctx = m_imsi_to_gtpc_ctx.find(imsi);
-  if (it_ctx == m_imsi_to_gtpc_ctx.end()) {
-    m_mme_gtpc_log->error("Could not find GTP-C context to remove\n");
-    return false;
+  // Get S-GW Ctr TEID and delete GTP-C context
+  {
+    std::lock_guard<std::mutex>                        lock(m_ctx_mutex);
+    std::unordered_map<uint64_t, gtpc_ctx_t>::iterator it_ctx = m_imsi_to_gtpc_ctx.find(imsi);
+    if (it_ctx == m_imsi_to_gtpc_ctx.end()) {
+      m_mme_gtpc_log->error("Could not find GTP-C context to remove\n");
+      return false;
+    }
+    sgw_ctr_fteid = it_ctx->second.sgw_ctr_fteid;
+    mme_ctr_fteid = it_ctx->second.mme_ctr_fteid;
+
+    std::unordered_map<uint32_t, uint64_t>::iterator it_imsi = m_mme_ctr_teid_to_imsi.find(mme_ctr_fteid.teid);
+    if (it_imsi == m_mme_ctr_teid_to_imsi.end()) {
+      m_mme_gtpc_log->error("Could not find IMSI from MME ctr TEID");
+    } else {
+      m_mme_ctr_teid_to_imsi.erase(it_imsi);
+    }
+    m_imsi_to_gtpc_ctx.erase(it_ctx);
   }
 
-  sgw_ctr_fteid               = it_ctx->second.sgw_ctr_fteid;
-  mme_ctr_fteid               = it_ctx->second.mme_ctr_fteid;
   srslte::gtpc_header* header = &del_req_pdu.header;
   header->teid_present        = true;
   header->teid                = sgw_ctr_fteid.teid;
@@ -392,15 +437,6 @@ bool mme_gtpc::send_delete_session_request(uint64_t imsi)
 
   // Send msg to SPGW
   send_s11_pdu(del_req_pdu);
-
-  // Delete GTP-C context
-  std::map<uint32_t, uint64_t>::iterator it_imsi = m_mme_ctr_teid_to_imsi.find(mme_ctr_fteid.teid);
-  if (it_imsi == m_mme_ctr_teid_to_imsi.end()) {
-    m_mme_gtpc_log->error("Could not find IMSI from MME ctr TEID");
-  } else {
-    m_mme_ctr_teid_to_imsi.erase(it_imsi);
-  }
-  m_imsi_to_gtpc_ctx.erase(it_ctx);
   return true;
 }
 
@@ -412,12 +448,12 @@ void mme_gtpc::send_release_access_bearers_request(uint64_t imsi)
   srslte::gtp_fteid_t sgw_ctr_fteid;
 
   // Get S-GW Ctr TEID
-  std::map<uint64_t, gtpc_ctx_t>::iterator it_ctx = m_imsi_to_gtpc_ctx.find(imsi);
-  if (it_ctx == m_imsi_to_gtpc_ctx.end()) {
+  gtpc_ctx_t gtpc_ctx;
+  if (!find_gtpc_ctx(imsi, &gtpc_ctx)) {
     m_mme_gtpc_log->error("Could not find GTP-C context to remove\n");
     return;
   }
-  sgw_ctr_fteid = it_ctx->second.sgw_ctr_fteid;
+  sgw_ctr_fteid = gtpc_ctx.sgw_ctr_fteid;
 
   // Set GTP-C header
   srslte::gtpc_header* header = &rel_req_pdu.header;
@@ -438,8 +474,8 @@ bool mme_gtpc::handle_downlink_data_notification(srslte::gtpc_pdu* dl_not_pdu)
 {
   uint32_t                                 mme_ctrl_teid = dl_not_pdu->header.teid;
   srslte::gtpc_downlink_data_notification* dl_not        = &dl_not_pdu->choice.downlink_data_notification;
-  std::map<uint32_t, uint64_t>::iterator   imsi_it       = m_mme_ctr_teid_to_imsi.find(mme_ctrl_teid);
-  if (imsi_it == m_mme_ctr_teid_to_imsi.end()) {
+  uint64_t                                 imsi          = 0;
+  if (!find_imsi(mme_ctrl_teid, &imsi)) {
     m_mme_gtpc_log->error("Could not find IMSI from control TEID\n");
     return false;
   }
@@ -449,9 +485,9 @@ bool mme_gtpc::handle_downlink_data_notification(srslte::gtpc_pdu* dl_not_pdu)
     return false;
   }
   uint8_t ebi = dl_not->eps_bearer_id;
-  m_mme_gtpc_log->debug("Downlink Data Notification -- IMSI: %015" PRIu64 ", EBI %d\n", imsi_it->second, ebi);
+  m_mme_gtpc_log->debug("Downlink Data Notification -- IMSI: %015" PRIu64 ", EBI %d\n", imsi, ebi);
 
-  m_s1ap->send_paging(imsi_it->second, ebi);
+  m_s1ap->send_paging(imsi, ebi);
   return true;
 }
 
@@ -463,12 +499,12 @@ void mme_gtpc::send_downlink_data_notification_acknowledge(uint64_t imsi, enum s
   bzero(&not_ack_pdu, sizeof(srslte::gtpc_pdu));
 
   // get s-gw ctr teid
-  std::map<uint64_t, gtpc_ctx_t>::iterator it_ctx = m_imsi_to_gtpc_ctx.find(imsi);
-  if (it_ctx == m_imsi_to_gtpc_ctx.end()) {
+  gtpc_ctx_t gtpc_ctx;
+  if (!find_gtpc_ctx(imsi, &gtpc_ctx)) {
     m_mme_gtpc_log->error("could not find gtp-c context to remove\n");
     return;
   }
-  sgw_ctr_fteid = it_ctx->second.sgw_ctr_fteid;
+  sgw_ctr_fteid = gtpc_ctx.sgw_ctr_fteid;
 
   // set gtp-c header
   srslte::gtpc_header* header = &not_ack_pdu.header;
@@ -493,12 +529,12 @@ bool mme_gtpc::send_downlink_data_notification_failure_indication(uint64_t imsi,
   bzero(&not_fail_pdu, sizeof(srslte::gtpc_pdu));
 
   // get s-gw ctr teid
-  std::map<uint64_t, gtpc_ctx_t>::iterator it_ctx = m_imsi_to_gtpc_ctx.find(imsi);
-  if (it_ctx == m_imsi_to_gtpc_ctx.end()) {
+  gtpc_ctx_t gtpc_ctx;
+  if (!find_gtpc_ctx(imsi, &gtpc_ctx)) {
     m_mme_gtpc_log->error("could not find gtp-c context to send paging failure\n");
     return false;
   }
-  sgw_ctr_fteid = it_ctx->second.sgw_ctr_fteid;
+  sgw_ctr_fteid = gtpc_ctx.sgw_ctr_fteid;
 
   // set gtp-c header
   srslte::gtpc_header* header = &not_fail_pdu.header;
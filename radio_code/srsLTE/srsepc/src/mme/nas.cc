@@ -1094,7 +1094,6 @@ bool nas::handle_esm_information_response(srslte::byte_buffer_t* nas_rx)
 
 bool nas::handle_identity_response(srslte::byte_buffer_t* nas_rx)
 {
-  srslte::byte_buffer_t*            nas_tx;
   LIBLTE_MME_ID_RESPONSE_MSG_STRUCT id_resp;
 
   LIBLTE_ERROR_ENUM err = liblte_mme_unpack_identity_response_msg((LIBLTE_BYTE_MSG_STRUCT*)nas_rx, &id_resp);
@@ -1123,12 +1122,23 @@ bool nas::handle_identity_response(srslte::byte_buffer_t* nas_rx)
   // Identity reponse from unknown GUTI atach. Assigning new eKSI.
   m_sec_ctx.eksi = 0;
 
-  // Make sure UE context was not previously stored in IMSI map
-  nas* nas_ctx = m_s1ap->find_nas_ctx_from_imsi(imsi);
-  if (nas_ctx != nullptr) {
+  // Make sure UE context was not previously stored in IMSI map. The old context may belong to another shard, so this
+  // one is only stored once the old one is deleted
+  if (m_s1ap->find_nas_ctx_from_imsi(imsi) != nullptr) {
     m_nas_log->warning("UE context already exists.\n");
-    m_s1ap->delete_ue_ctx(imsi);
+    m_s1ap->delete_ue_ctx_in_owner_shard(imsi, m_ecm_ctx.mme_ue_s1ap_id, [](nas* nas_ctx) {
+      if (nas_ctx != nullptr) {
+        nas_ctx->send_identity_authentication_request();
+      }
+    });
+    return true;
   }
+  return send_identity_authentication_request();
+}
+
+bool nas::send_identity_authentication_request()
+{
+  srslte::byte_buffer_t* nas_tx;
 
   // Store UE context im IMSI map
   m_s1ap->add_nas_ctx_to_imsi_map(this);
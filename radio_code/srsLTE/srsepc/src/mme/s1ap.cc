@@ -20,9 +20,12 @@
  */
 
 #include "srsepc/hdr/mme/s1ap.h"
+#include "srsepc/hdr/mme/mme.h"
 #include "srslte/asn1/gtpc.h"
 #include "srslte/common/bcd_helpers.h"
+#include "srslte/common/int_helpers.h"
 #include "srslte/common/liblte_security.h"
+#include <algorithm>
 #include <cmath>
 #include <inttypes.h> // for printing uint64_t
 
@@ -31,8 +34,15 @@ namespace srsepc {
 s1ap*           s1ap::m_instance    = NULL;
 pthread_mutex_t s1ap_instance_mutex = PTHREAD_MUTEX_INITIALIZER;
 
-s1ap::s1ap() : m_s1mme(-1), m_next_mme_ue_s1ap_id(1), m_mme_gtpc(NULL), m_pool(NULL)
+// Shard of the UE contexts processed by the calling thread
+static thread_local uint32_t current_shard = 0;
+
+// Storage of the dynamic members of the PDUs received by the calling thread
+static thread_local asn1::mem_arena rx_arena;
+
+s1ap::s1ap() : m_s1mme(-1), m_mme_gtpc(NULL), m_pool(srslte::byte_buffer_pool::get_instance())
 {
+  init_shards(0);
   return;
 }
 
@@ -63,12 +73,12 @@ void s1ap::cleanup(void)
 
 int s1ap::init(s1ap_args_t s1ap_args, srslte::log_filter* nas_log, srslte::log_filter* s1ap_log)
 {
-  m_pool = srslte::byte_buffer_pool::get_instance();
-
   m_s1ap_args = s1ap_args;
   srslte::s1ap_mccmnc_to_plmn(s1ap_args.mcc, s1ap_args.mnc, &m_plmn);
   m_next_m_tmsi = rand();
 
+  init_shards(s1ap_args.nof_workers);
+
   // Init log
   m_nas_log  = nas_log;
   m_s1ap_log = s1ap_log;
@@ -113,12 +123,11 @@ void s1ap::stop()
     m_active_enbs.erase(enb_it++);
   }
 
-  std::map<uint64_t, nas*>::iterator ue_it = m_imsi_to_nas_ctx.begin();
-  while (ue_it != m_imsi_to_nas_ctx.end()) {
-    m_s1ap_log->info("Deleting UE EMM context. IMSI: %015" PRIu64 "\n", ue_it->first);
-    m_s1ap_log->console("Deleting UE EMM context. IMSI: %015" PRIu64 "\n", ue_it->first);
-    delete ue_it->second;
-    m_imsi_to_nas_ctx.erase(ue_it++);
+  std::vector<std::pair<uint64_t, imsi_ctx_t> > ue_ctxs = m_imsi_to_nas_ctx.take_all();
+  for (std::pair<uint64_t, imsi_ctx_t>& ue_ctx : ue_ctxs) {
+    m_s1ap_log->info("Deleting UE EMM context. IMSI: %015" PRIu64 "\n", ue_ctx.first);
+    m_s1ap_log->console("Deleting UE EMM context. IMSI: %015" PRIu64 "\n", ue_ctx.first);
+    delete ue_ctx.second.nas_ctx;
   }
 
   // Cleanup message handlers
@@ -140,7 +149,23 @@ int s1ap::get_s1_mme()
 
 uint32_t s1ap::get_next_mme_ue_s1ap_id()
 {
-  return m_next_mme_ue_s1ap_id++;
+  return m_mme_ue_s1ap_ids.allocate(current_shard);
+}
+
+// Each MME worker owns one shard of the UE contexts. Without workers, the MME thread owns the only one
+void s1ap::init_shards(uint32_t nof_workers)
+{
+  m_mme_ue_s1ap_ids.init(std::max(nof_workers, 1u));
+}
+
+uint32_t s1ap::get_current_shard()
+{
+  return current_shard;
+}
+
+void s1ap::set_current_shard(uint32_t shard)
+{
+  current_shard = shard;
 }
 
 int s1ap::enb_listen()
@@ -217,6 +242,7 @@ bool s1ap::s1ap_tx_pdu(const asn1::s1ap::s1ap_pdu_c& pdu, struct sctp_sndrcvinfo
   }
 
   if (m_pcap_enable) {
+    std::lock_guard<std::mutex> lock(m_pcap_mutex);
     m_pcap.write_s1ap(buf->msg, buf->N_bytes);
   }
 
@@ -227,32 +253,33 @@ void s1ap::handle_s1ap_rx_pdu(srslte::byte_buffer_t* pdu, struct sctp_sndrcvinfo
 {
   // Save PCAP
   if (m_pcap_enable) {
+    std::lock_guard<std::mutex> lock(m_pcap_mutex);
     m_pcap.write_s1ap(pdu->msg, pdu->N_bytes);
   }
 
   // Get PDU type
-  s1ap_pdu_t     rx_pdu;
-  asn1::cbit_ref bref(pdu->msg, pdu->N_bytes);
+  asn1::arena_pdu<s1ap_pdu_t> rx_pdu(rx_arena);
+  asn1::cbit_ref              bref(pdu->msg, pdu->N_bytes);
   if (rx_pdu.unpack(bref) != asn1::SRSASN_SUCCESS) {
     m_s1ap_log->error("Failed to unpack received PDU\n");
     return;
   }
 
-  switch (rx_pdu.type().value) {
+  switch (rx_pdu->type().value) {
     case s1ap_pdu_t::types_opts::init_msg:
       m_s1ap_log->info("Received Initiating PDU\n");
-      handle_initiating_message(rx_pdu.init_msg(), enb_sri);
+      handle_initiating_message(rx_pdu->init_msg(), enb_sri);
       break;
     case s1ap_pdu_t::types_opts::successful_outcome:
       m_s1ap_log->info("Received Succeseful Outcome PDU\n");
-      handle_successful_outcome(rx_pdu.successful_outcome());
+      handle_successful_outcome(rx_pdu->successful_outcome());
       break;
     case s1ap_pdu_t::types_opts::unsuccessful_outcome:
       m_s1ap_log->info("Received Unsucceseful Outcome PDU\n");
       // TODO handle_unsuccessfuloutcome(&rx_pdu.choice.unsuccessfulOutcome);
       break;
     default:
-      m_s1ap_log->error("Unhandled PDU type %d\n", rx_pdu.type().value);
+      m_s1ap_log->error("Unhandled PDU type %d\n", rx_pdu->type().value);
   }
 }
 
@@ -301,6 +328,96 @@ void s1ap::handle_successful_outcome(const asn1::s1ap::successful_outcome_s& msg
   }
 }
 
+// UE Sharding
+int s1ap::get_rx_pdu_shard(srslte::byte_buffer_t* pdu, const struct sctp_sndrcvinfo* enb_sri)
+{
+  using init_msg_type_opts_t           = asn1::s1ap::s1ap_elem_procs_o::init_msg_c::types_opts;
+  using successful_outcome_type_opts_t = asn1::s1ap::s1ap_elem_procs_o::successful_outcome_c::types_opts;
+
+  // PDUs that cannot be decoded are left to the MME thread, which logs the error
+  asn1::arena_pdu<s1ap_pdu_t> rx_pdu(rx_arena);
+  asn1::cbit_ref              bref(pdu->msg, pdu->N_bytes);
+  if (rx_pdu.unpack(bref) != asn1::SRSASN_SUCCESS) {
+    return -1;
+  }
+
+  if (rx_pdu->type().value == s1ap_pdu_t::types_opts::init_msg) {
+    const asn1::s1ap::init_msg_s& msg = rx_pdu->init_msg();
+    switch (msg.value.type().value) {
+      case init_msg_type_opts_t::init_ue_msg:
+        return get_initial_ue_message_shard(msg.value.init_ue_msg(), enb_sri);
+      case init_msg_type_opts_t::ul_nas_transport:
+        return get_id_shard(msg.value.ul_nas_transport().protocol_ies.mme_ue_s1ap_id.value.value);
+      case init_msg_type_opts_t::ue_context_release_request:
+        return get_id_shard(msg.value.ue_context_release_request().protocol_ies.mme_ue_s1ap_id.value.value);
+      default:
+        return -1;
+    }
+  }
+  if (rx_pdu->type().value == s1ap_pdu_t::types_opts::successful_outcome) {
+    const asn1::s1ap::successful_outcome_s& msg = rx_pdu->successful_outcome();
+    switch (msg.value.type().value) {
+      case successful_outcome_type_opts_t::init_context_setup_resp:
+        return get_id_shard(msg.value.init_context_setup_resp().protocol_ies.mme_ue_s1ap_id.value.value);
+      case successful_outcome_type_opts_t::ue_context_release_complete:
+        return get_id_shard(msg.value.ue_context_release_complete().protocol_ies.mme_ue_s1ap_id.value.value);
+      default:
+        return -1;
+    }
+  }
+  return -1;
+}
+
+uint32_t s1ap::get_initial_ue_message_shard(const asn1::s1ap::init_ue_msg_s& init_ue,
+                                            const struct sctp_sndrcvinfo*     enb_sri)
+{
+  uint64_t imsi = 0;
+
+  // UEs that were attached before are identified by their S-TMSI
+  if (init_ue.protocol_ies.s_tmsi_present) {
+    uint32_t m_tmsi = 0;
+    srslte::uint8_to_uint32(init_ue.protocol_ies.s_tmsi.value.m_tmsi.data(), &m_tmsi);
+    m_tmsi_to_imsi.find(m_tmsi, &imsi);
+  }
+
+  // Otherwise, look for the IMSI or GUTI of an Attach Request
+  srslte::unique_byte_buffer_t nas_msg = srslte::allocate_unique_buffer(*m_pool);
+  if (imsi == 0 && nas_msg != nullptr && init_ue.protocol_ies.nas_pdu.value.size() <= nas_msg->get_tailroom()) {
+    uint8_t pd, msg_type;
+    memcpy(nas_msg->msg, init_ue.protocol_ies.nas_pdu.value.data(), init_ue.protocol_ies.nas_pdu.value.size());
+    nas_msg->N_bytes = init_ue.protocol_ies.nas_pdu.value.size();
+    liblte_mme_parse_msg_header((LIBLTE_BYTE_MSG_STRUCT*)nas_msg.get(), &pd, &msg_type);
+
+    LIBLTE_MME_ATTACH_REQUEST_MSG_STRUCT attach_req;
+    if (msg_type == LIBLTE_MME_MSG_TYPE_ATTACH_REQUEST &&
+        liblte_mme_unpack_attach_request_msg((LIBLTE_BYTE_MSG_STRUCT*)nas_msg.get(), &attach_req) == LIBLTE_SUCCESS) {
+      if (attach_req.eps_mobile_id.type_of_id == LIBLTE_MME_EPS_MOBILE_ID_TYPE_IMSI) {
+        for (int i = 0; i <= 14; i++) {
+          imsi += attach_req.eps_mobile_id.imsi[i] * std::pow(10, 14 - i);
+        }
+      } else if (attach_req.eps_mobile_id.type_of_id == LIBLTE_MME_EPS_MOBILE_ID_TYPE_GUTI) {
+        m_tmsi_to_imsi.find(attach_req.eps_mobile_id.guti.m_tmsi, &imsi);
+      }
+    }
+  }
+  if (imsi != 0) {
+    return get_imsi_shard(imsi);
+  }
+
+  // UEs that are not known yet are spread by their eNB UE S1AP Id
+  return (enb_sri->sinfo_assoc_id + init_ue.protocol_ies.enb_ue_s1ap_id.value.value) % get_nof_shards();
+}
+
+// The shard that owns the context of a known UE, otherwise the shard given by the IMSI
+uint32_t s1ap::get_imsi_shard(uint64_t imsi)
+{
+  imsi_ctx_t imsi_ctx;
+  if (m_imsi_to_nas_ctx.find(imsi, &imsi_ctx)) {
+    return imsi_ctx.shard;
+  }
+  return imsi % get_nof_shards();
+}
+
 // eNB Context Managment
 void s1ap::add_new_enb_ctx(const enb_ctx_t& enb_ctx, const struct sctp_sndrcvinfo* enb_sri)
 {
@@ -310,6 +427,7 @@ void s1ap::add_new_enb_ctx(const enb_ctx_t& enb_ctx, const struct sctp_sndrcvinf
   *enb_ptr                   = enb_ctx;
   m_active_enbs.insert(std::pair<uint16_t, enb_ctx_t*>(enb_ptr->enb_id, enb_ptr));
   m_sctp_to_enb_id.insert(std::pair<int32_t, uint16_t>(enb_sri->sinfo_assoc_id, enb_ptr->enb_id));
+  std::lock_guard<std::mutex> lock(m_enb_ues_mutex);
   m_enb_assoc_to_ue_ids.insert(std::pair<int32_t, std::set<uint32_t> >(enb_sri->sinfo_assoc_id, ue_set));
 }
 
@@ -350,19 +468,19 @@ void s1ap::delete_enb_ctx(int32_t assoc_id)
 // UE Context Management
 bool s1ap::add_nas_ctx_to_imsi_map(nas* nas_ctx)
 {
-  std::map<uint64_t, nas*>::iterator ctx_it = m_imsi_to_nas_ctx.find(nas_ctx->m_emm_ctx.imsi);
-  if (ctx_it != m_imsi_to_nas_ctx.end()) {
-    m_s1ap_log->error("UE Context already exists. IMSI %015" PRIu64 "\n", nas_ctx->m_emm_ctx.imsi);
-    return false;
-  }
   if (nas_ctx->m_ecm_ctx.mme_ue_s1ap_id != 0) {
-    std::map<uint32_t, nas*>::iterator ctx_it2 = m_mme_ue_s1ap_id_to_nas_ctx.find(nas_ctx->m_ecm_ctx.mme_ue_s1ap_id);
-    if (ctx_it2 != m_mme_ue_s1ap_id_to_nas_ctx.end() && ctx_it2->second != nas_ctx) {
+    nas* id_nas_ctx = find_nas_ctx_from_mme_ue_s1ap_id(nas_ctx->m_ecm_ctx.mme_ue_s1ap_id);
+    if (id_nas_ctx != NULL && id_nas_ctx != nas_ctx) {
       m_s1ap_log->error("Context identified with IMSI does not match context identified by MME UE S1AP Id.\n");
       return false;
     }
   }
-  m_imsi_to_nas_ctx.insert(std::pair<uint64_t, nas*>(nas_ctx->m_emm_ctx.imsi, nas_ctx));
+  // The context belongs to the shard of the thread that creates it
+  imsi_ctx_t imsi_ctx = {nas_ctx, current_shard};
+  if (!m_imsi_to_nas_ctx.insert(nas_ctx->m_emm_ctx.imsi, imsi_ctx)) {
+    m_s1ap_log->error("UE Context already exists. IMSI %015" PRIu64 "\n", nas_ctx->m_emm_ctx.imsi);
+    return false;
+  }
   m_s1ap_log->debug("Saved UE context corresponding to IMSI %015" PRIu64 "\n", nas_ctx->m_emm_ctx.imsi);
   return true;
 }
@@ -373,25 +491,17 @@ bool s1ap::add_nas_ctx_to_mme_ue_s1ap_id_map(nas* nas_ctx)
     m_s1ap_log->error("Could not add UE context to MME UE S1AP map. MME UE S1AP ID 0 is not valid.\n");
     return false;
   }
-  std::map<uint32_t, nas*>::iterator ctx_it = m_mme_ue_s1ap_id_to_nas_ctx.find(nas_ctx->m_ecm_ctx.mme_ue_s1ap_id);
-  if (ctx_it != m_mme_ue_s1ap_id_to_nas_ctx.end()) {
+  if (!m_mme_ue_s1ap_id_to_nas_ctx.insert(nas_ctx->m_ecm_ctx.mme_ue_s1ap_id, nas_ctx)) {
     m_s1ap_log->error("UE Context already exists. MME UE S1AP Id %015" PRIu64 "\n", nas_ctx->m_emm_ctx.imsi);
     return false;
   }
-  if (nas_ctx->m_emm_ctx.imsi != 0) {
-    std::map<uint32_t, nas*>::iterator ctx_it2 = m_mme_ue_s1ap_id_to_nas_ctx.find(nas_ctx->m_ecm_ctx.mme_ue_s1ap_id);
-    if (ctx_it2 != m_mme_ue_s1ap_id_to_nas_ctx.end() && ctx_it2->second != nas_ctx) {
-      m_s1ap_log->error("Context identified with MME UE S1AP Id does not match context identified by IMSI.\n");
-      return false;
-    }
-  }
-  m_mme_ue_s1ap_id_to_nas_ctx.insert(std::pair<uint32_t, nas*>(nas_ctx->m_ecm_ctx.mme_ue_s1ap_id, nas_ctx));
   m_s1ap_log->debug("Saved UE context corresponding to MME UE S1AP Id %d\n", nas_ctx->m_ecm_ctx.mme_ue_s1ap_id);
   return true;
 }
 
 bool s1ap::add_ue_to_enb_set(int32_t enb_assoc, uint32_t mme_ue_s1ap_id)
 {
+  std::lock_guard<std::mutex>                      lock(m_enb_ues_mutex);
   std::map<int32_t, std::set<uint32_t> >::iterator ues_in_enb = m_enb_assoc_to_ue_ids.find(enb_assoc);
   if (ues_in_enb == m_enb_assoc_to_ue_ids.end()) {
     m_s1ap_log->error("Could not find eNB from eNB SCTP association %d\n", enb_assoc);
@@ -409,36 +519,38 @@ bool s1ap::add_ue_to_enb_set(int32_t enb_assoc, uint32_t mme_ue_s1ap_id)
 
 nas* s1ap::find_nas_ctx_from_mme_ue_s1ap_id(uint32_t mme_ue_s1ap_id)
 {
-  std::map<uint32_t, nas*>::iterator it = m_mme_ue_s1ap_id_to_nas_ctx.find(mme_ue_s1ap_id);
-  if (it == m_mme_ue_s1ap_id_to_nas_ctx.end()) {
-    return NULL;
-  } else {
-    return it->second;
-  }
+  nas* nas_ctx = NULL;
+  m_mme_ue_s1ap_id_to_nas_ctx.find(mme_ue_s1ap_id, &nas_ctx);
+  return nas_ctx;
 }
 
 nas* s1ap::find_nas_ctx_from_imsi(uint64_t imsi)
 {
-  std::map<uint64_t, nas*>::iterator it = m_imsi_to_nas_ctx.find(imsi);
-  if (it == m_imsi_to_nas_ctx.end()) {
+  imsi_ctx_t imsi_ctx;
+  if (!m_imsi_to_nas_ctx.find(imsi, &imsi_ctx)) {
     return NULL;
-  } else {
-    return it->second;
   }
+  return imsi_ctx.nas_ctx;
 }
 
 void s1ap::release_ues_ecm_ctx_in_enb(int32_t enb_assoc)
 {
   m_s1ap_log->console("Releasing UEs context\n");
+  std::lock_guard<std::mutex>                      lock(m_enb_ues_mutex);
   std::map<int32_t, std::set<uint32_t> >::iterator ues_in_enb = m_enb_assoc_to_ue_ids.find(enb_assoc);
   std::set<uint32_t>::iterator                     ue_id      = ues_in_enb->second.begin();
   if (ue_id == ues_in_enb->second.end()) {
     m_s1ap_log->console("No UEs to be released\n");
   } else {
     while (ue_id != ues_in_enb->second.end()) {
-      std::map<uint32_t, nas*>::iterator nas_ctx = m_mme_ue_s1ap_id_to_nas_ctx.find(*ue_id);
-      emm_ctx_t*                         emm_ctx = &nas_ctx->second->m_emm_ctx;
-      ecm_ctx_t*                         ecm_ctx = &nas_ctx->second->m_ecm_ctx;
+      nas* nas_ctx = find_nas_ctx_from_mme_ue_s1ap_id(*ue_id);
+      if (nas_ctx == NULL) {
+        m_s1ap_log->error("Could not find UE context to release. MME-UE S1AP Id: %d\n", *ue_id);
+        ues_in_enb->second.erase(ue_id++);
+        continue;
+      }
+      emm_ctx_t* emm_ctx = &nas_ctx->m_emm_ctx;
+      ecm_ctx_t* ecm_ctx = &nas_ctx->m_ecm_ctx;
 
       m_s1ap_log->info(
           "Releasing UE context. IMSI: %015" PRIu64 ", UE-MME S1AP Id: %d\n", emm_ctx->imsi, ecm_ctx->mme_ue_s1ap_id);
@@ -470,13 +582,17 @@ bool s1ap::release_ue_ecm_ctx(uint32_t mme_ue_s1ap_id)
     m_s1ap_log->error("Could not find eNB for UE release request.\n");
     return false;
   }
-  uint16_t                                         enb_id = it->second;
-  std::map<int32_t, std::set<uint32_t> >::iterator ue_set = m_enb_assoc_to_ue_ids.find(ecm_ctx->enb_sri.sinfo_assoc_id);
-  if (ue_set == m_enb_assoc_to_ue_ids.end()) {
-    m_s1ap_log->error("Could not find the eNB's UEs.\n");
-    return false;
+  uint16_t enb_id = it->second;
+  {
+    std::lock_guard<std::mutex>                      lock(m_enb_ues_mutex);
+    std::map<int32_t, std::set<uint32_t> >::iterator ue_set =
+        m_enb_assoc_to_ue_ids.find(ecm_ctx->enb_sri.sinfo_assoc_id);
+    if (ue_set == m_enb_assoc_to_ue_ids.end()) {
+      m_s1ap_log->error("Could not find the eNB's UEs.\n");
+      return false;
+    }
+    ue_set->second.erase(mme_ue_s1ap_id);
   }
-  ue_set->second.erase(mme_ue_s1ap_id);
 
   // Release UE ECM context
   m_mme_ue_s1ap_id_to_nas_ctx.erase(mme_ue_s1ap_id);
@@ -508,24 +624,46 @@ bool s1ap::delete_ue_ctx(uint64_t imsi)
   return true;
 }
 
+// Only the thread of the shard that owns a context may delete it. When that is another shard, the deletion is handed
+// to its thread, which then hands the rest of the procedure back to the current one
+void s1ap::delete_ue_ctx_in_owner_shard(uint64_t imsi, uint32_t mme_ue_s1ap_id, std::function<void(nas*)> on_deleted)
+{
+  imsi_ctx_t imsi_ctx;
+  if (!m_imsi_to_nas_ctx.find(imsi, &imsi_ctx) || imsi_ctx.shard == current_shard) {
+    delete_ue_ctx(imsi);
+    on_deleted(find_nas_ctx_from_mme_ue_s1ap_id(mme_ue_s1ap_id));
+    return;
+  }
+
+  m_s1ap_log->info("Deleting UE context in shard %d. IMSI: %015" PRIu64 "\n", imsi_ctx.shard, imsi);
+  mme*     mme   = mme::get_instance();
+  uint32_t shard = current_shard;
+  mme->run_in_shard(imsi_ctx.shard, [this, mme, shard, imsi, mme_ue_s1ap_id, on_deleted]() {
+    delete_ue_ctx(imsi);
+    mme->run_in_shard(shard, [this, mme_ue_s1ap_id, on_deleted]() {
+      // The UE may have been released while its old context was being deleted
+      on_deleted(find_nas_ctx_from_mme_ue_s1ap_id(mme_ue_s1ap_id));
+    });
+  });
+}
+
 // UE Bearer Managment
 void s1ap::activate_eps_bearer(uint64_t imsi, uint8_t ebi)
 {
-  std::map<uint64_t, nas*>::iterator ue_ctx_it = m_imsi_to_nas_ctx.find(imsi);
-  if (ue_ctx_it == m_imsi_to_nas_ctx.end()) {
+  nas* nas_ctx = find_nas_ctx_from_imsi(imsi);
+  if (nas_ctx == NULL) {
     m_s1ap_log->error("Could not activate EPS bearer: Could not find UE context\n");
     return;
   }
   // Make sure NAS is active
-  uint32_t                           mme_ue_s1ap_id = ue_ctx_it->second->m_ecm_ctx.mme_ue_s1ap_id;
-  std::map<uint32_t, nas*>::iterator it             = m_mme_ue_s1ap_id_to_nas_ctx.find(mme_ue_s1ap_id);
-  if (it == m_mme_ue_s1ap_id_to_nas_ctx.end()) {
+  uint32_t mme_ue_s1ap_id = nas_ctx->m_ecm_ctx.mme_ue_s1ap_id;
+  if (find_nas_ctx_from_mme_ue_s1ap_id(mme_ue_s1ap_id) == NULL) {
     m_s1ap_log->error("Could not activate EPS bearer: ECM context seems to be missing\n");
     return;
   }
 
-  ecm_ctx_t* ecm_ctx = &ue_ctx_it->second->m_ecm_ctx;
-  esm_ctx_t* esm_ctx = &ue_ctx_it->second->m_esm_ctx[ebi];
+  ecm_ctx_t* ecm_ctx = &nas_ctx->m_ecm_ctx;
+  esm_ctx_t* esm_ctx = &nas_ctx->m_esm_ctx[ebi];
   if (esm_ctx->state != ERAB_CTX_SETUP) {
     m_s1ap_log->error(
         "Could not be activate EPS Bearer, bearer in wrong state: MME S1AP Id %d, EPS Bearer id %d, state %d\n",
@@ -548,20 +686,19 @@ void s1ap::activate_eps_bearer(uint64_t imsi, uint8_t ebi)
 
 uint32_t s1ap::allocate_m_tmsi(uint64_t imsi)
 {
-  uint32_t m_tmsi = m_next_m_tmsi;
-  m_next_m_tmsi   = (m_next_m_tmsi + 1) % UINT32_MAX;
+  uint32_t m_tmsi = m_next_m_tmsi.fetch_add(1) % UINT32_MAX;
 
-  m_tmsi_to_imsi.insert(std::pair<uint32_t, uint64_t>(m_tmsi, imsi));
+  m_tmsi_to_imsi.insert(m_tmsi, imsi);
   m_s1ap_log->debug("Allocated M-TMSI 0x%x to IMSI %015" PRIu64 ",\n", m_tmsi, imsi);
   return m_tmsi;
 }
 
 uint64_t s1ap::find_imsi_from_m_tmsi(uint32_t m_tmsi)
 {
-  std::map<uint32_t, uint64_t>::iterator it = m_tmsi_to_imsi.find(m_tmsi);
-  if (it != m_tmsi_to_imsi.end()) {
-    m_s1ap_log->debug("Found IMSI %015" PRIu64 " from M-TMSI 0x%x\n", it->second, m_tmsi);
-    return it->second;
+  uint64_t imsi = 0;
+  if (m_tmsi_to_imsi.find(m_tmsi, &imsi)) {
+    m_s1ap_log->debug("Found IMSI %015" PRIu64 " from M-TMSI 0x%x\n", imsi, m_tmsi);
+    return imsi;
   } else {
     m_s1ap_log->debug("Could not find IMSI from M-TMSI 0x%x\n", m_tmsi);
     return 0;
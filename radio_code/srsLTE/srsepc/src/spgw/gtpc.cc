@@ -566,9 +566,10 @@ int spgw::gtpc::init_ue_ip(spgw_args_t* args, const std::map<std::string, uint64
 
   // XXX TODO add an upper bound to ip addr range via config, use 254 for now
   // first address is allocated to the epc tun interface, start w/next addr
+  m_sgi_addr = inet_addr(args->sgi_if_addr.c_str());
   for (uint32_t n = 1; n < 254; ++n) {
     struct in_addr ue_addr;
-    ue_addr.s_addr = inet_addr(args->sgi_if_addr.c_str()) + htonl(n);
+    ue_addr.s_addr = m_sgi_addr + htonl(n);
 
     std::map<std::string, uint64_t>::const_iterator iter = ip_to_imsi.find(inet_ntoa(ue_addr));
     if (iter != ip_to_imsi.end()) {
@@ -583,6 +584,64 @@ int spgw::gtpc::init_ue_ip(spgw_args_t* args, const std::map<std::string, uint64
   return SRSLTE_SUCCESS;
 }
 
+int spgw::gtpc::update_ue_ip(const std::map<std::string, uint64_t>& ip_to_imsi)
+{
+  // Check the new table first, the current one is kept if it is not usable
+  std::map<uint64_t, struct in_addr> imsi_to_ip;
+  for (std::map<std::string, uint64_t>::const_iterator iter = ip_to_imsi.begin(); iter != ip_to_imsi.end(); ++iter) {
+    struct in_addr in_addr;
+    in_addr.s_addr = inet_addr(iter->first.c_str());
+    if (in_addr.s_addr == m_sgi_addr) {
+      m_gtpc_log->error("SPGW: static ip addr %s for imsi %015" PRIu64 ", is reserved for the epc tun interface\n",
+                        iter->first.c_str(),
+                        iter->second);
+      return SRSLTE_ERROR_OUT_OF_BOUNDS;
+    }
+    if (!imsi_to_ip.insert(std::make_pair(iter->second, in_addr)).second) {
+      m_gtpc_log->error(
+          "SPGW: duplicate imsi %015" PRIu64 " for static ip address %s.\n", iter->second, iter->first.c_str());
+      return SRSLTE_ERROR_OUT_OF_BOUNDS;
+    }
+  }
+
+  std::set<in_addr_t> old_static;
+  for (std::map<uint64_t, struct in_addr>::const_iterator iter = m_imsi_to_ip.begin(); iter != m_imsi_to_ip.end();
+       ++iter) {
+    old_static.insert(iter->second.s_addr);
+  }
+  std::set<in_addr_t> in_use;
+  for (std::map<uint32_t, spgw_tunnel_ctx*>::const_iterator iter = m_teid_to_tunnel_ctx.begin();
+       iter != m_teid_to_tunnel_ctx.end();
+       ++iter) {
+    in_use.insert(iter->second->ue_ipv4);
+  }
+
+  // Addresses that became static leave the pool. Addresses that are no longer static go back to it, unless a
+  // session still uses them
+  for (uint32_t n = 1; n < 254; ++n) {
+    struct in_addr ue_addr;
+    ue_addr.s_addr = m_sgi_addr + htonl(n);
+
+    bool is_static  = ip_to_imsi.count(inet_ntoa(ue_addr)) > 0;
+    bool was_static = old_static.count(ue_addr.s_addr) > 0;
+    if (is_static and not was_static) {
+      m_ue_ip_addr_pool.erase(ue_addr.s_addr);
+      if (in_use.count(ue_addr.s_addr) > 0) {
+        m_gtpc_log->warning("SPGW: static ip addr %s is in use by a session with a dynamic address\n",
+                            inet_ntoa(ue_addr));
+      }
+    } else if (not is_static and was_static and in_use.count(ue_addr.s_addr) == 0) {
+      m_ue_ip_addr_pool.insert(ue_addr.s_addr);
+    }
+  }
+  m_imsi_to_ip.swap(imsi_to_ip);
+
+  m_gtpc_log->info("SPGW: updated static ip addrs. %zd static, %zd in pool\n",
+                   m_imsi_to_ip.size(),
+                   m_ue_ip_addr_pool.size());
+  return SRSLTE_SUCCESS;
+}
+
 in_addr_t spgw::gtpc::get_new_ue_ipv4(uint64_t imsi)
 {
   struct in_addr ue_addr;
@@ -29,8 +29,11 @@
 #include <linux/if_tun.h>
 #include <linux/ip.h>
 #include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <sys/ioctl.h>
 #include <sys/socket.h>
+#include <unistd.h>
 
 namespace srsepc {
 
@@ -41,7 +44,113 @@ namespace srsepc {
  *
  **************************************/
 
-spgw::gtpu::gtpu() : m_sgi_up(false), m_s1u_up(false)
+/**************************************
+ *
+ * User plane worker. Serves one SGi TUN
+ * queue and one S1-U socket on its own
+ * thread.
+ *
+ **************************************/
+
+class spgw::gtpu::up_worker : public srslte::thread
+{
+public:
+  up_worker(spgw::gtpu* parent_, uint32_t id_, int sgi, int s1u) :
+    thread("SPGW_UP" + std::to_string(id_)),
+    parent(parent_),
+    id(id_)
+  {
+    parent->init_up_ctx(ctx, sgi, s1u, false);
+  }
+  ~up_worker()
+  {
+    // The first worker shares its SGi queue and S1-U socket with the SP-GW thread, these are closed by gtpu::stop()
+    if (id > 0) {
+      close(ctx.sgi);
+      close(ctx.s1u);
+    }
+    if (stop_fd >= 0) {
+      close(stop_fd);
+    }
+    if (epoll_fd >= 0) {
+      close(epoll_fd);
+    }
+  }
+
+  bool init()
+  {
+    stop_fd = eventfd(0, EFD_NONBLOCK);
+    if (stop_fd < 0) {
+      parent->m_gtpu_log->error("Failed to create eventfd: %s\n", strerror(errno));
+      return false;
+    }
+    epoll_fd = epoll_create1(0);
+    if (epoll_fd < 0) {
+      parent->m_gtpu_log->error("Failed to create epoll instance: %s\n", strerror(errno));
+      return false;
+    }
+    for (int fd : {ctx.sgi, ctx.s1u, stop_fd}) {
+      epoll_event ev = {};
+      ev.events      = EPOLLIN;
+      ev.data.fd     = fd;
+      if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        parent->m_gtpu_log->error("Could not add fd %d to epoll: %s\n", fd, strerror(errno));
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void stop()
+  {
+    uint64_t one = 1;
+    running      = false;
+    if (write(stop_fd, &one, sizeof(one)) < 0) {
+      parent->m_gtpu_log->error("Could not wake up user plane worker %d\n", id);
+    }
+    wait_thread_finish();
+  }
+
+private:
+  void run_thread() override
+  {
+    epoll_event events[3];
+    while (running) {
+      int n = epoll_wait(epoll_fd, events, 3, -1);
+      if (n < 0) {
+        if (errno != EINTR) {
+          parent->m_gtpu_log->error("Error from epoll_wait: %s\n", strerror(errno));
+        }
+        continue;
+      }
+      for (int i = 0; i < n; i++) {
+        if (events[i].data.fd == ctx.sgi) {
+          parent->handle_sgi_ready(ctx);
+        } else if (events[i].data.fd == ctx.s1u) {
+          parent->handle_s1u_ready(ctx);
+        }
+      }
+      // Send the downlink PDUs generated while handling this wake-up
+      parent->flush_s1u(ctx);
+    }
+  }
+
+  spgw::gtpu*       parent;
+  uint32_t          id;
+  up_thread_ctx_t   ctx;
+  int               stop_fd  = -1;
+  int               epoll_fd = -1;
+  std::atomic<bool> running  = {true};
+};
+
+/**************************************
+ *
+ * GTP-U class that handles the packet
+ * forwarding to and from eNBs
+ *
+ **************************************/
+
+spgw::gtpu::gtpu() : m_sgi_up(false), m_s1u_up(false), m_handoff_fd(-1)
 {
   m_pool = srslte::byte_buffer_pool::get_instance();
   return;
@@ -77,6 +186,21 @@ int spgw::gtpu::init(spgw_args_t* args, spgw* spgw, gtpc_interface_gtpu* gtpc, s
     return err;
   }
 
+  // Downlink PDUs that need paging are handed from the user plane workers to the SP-GW thread
+  m_handoff_fd = eventfd(0, EFD_NONBLOCK);
+  if (m_handoff_fd < 0) {
+    m_gtpu_log->error("Failed to create eventfd: %s\n", strerror(errno));
+    return SRSLTE_ERROR_CANT_START;
+  }
+  init_up_ctx(m_ctrl_ctx, m_sgi, m_s1u, true);
+
+  // Init user plane workers
+  err = init_workers(args);
+  if (err != SRSLTE_SUCCESS) {
+    m_gtpu_log->console("Could not start the user plane workers.\n");
+    return err;
+  }
+
   m_gtpu_log->info("SPGW GTP-U Initialized.\n");
   m_gtpu_log->console("SPGW GTP-U Initialized.\n");
   return SRSLTE_SUCCESS;
@@ -84,16 +208,61 @@ int spgw::gtpu::init(spgw_args_t* args, spgw* spgw, gtpc_interface_gtpu* gtpc, s
 
 void spgw::gtpu::stop()
 {
+  // Stop user plane workers
+  for (auto& w : m_workers) {
+    w->stop();
+  }
+  m_workers.clear();
+
+  // Drop PDUs still waiting for the SP-GW thread
+  if (m_handoff_fd >= 0) {
+    for (srslte::byte_buffer_t* msg : m_handoff_queue) {
+      m_pool->deallocate(msg);
+    }
+    m_handoff_queue.clear();
+    close(m_handoff_fd);
+    m_handoff_fd = -1;
+  }
+
   // Clean up SGi interface
   if (m_sgi_up) {
     close(m_sgi);
   }
   // Clean up S1-U socket
   if (m_s1u_up) {
+    flush_s1u(m_ctrl_ctx);
     close(m_s1u);
   }
 }
 
+int spgw::gtpu::open_sgi_queue(const std::string& if_name, bool multi_queue)
+{
+  struct ifreq ifr;
+
+  // The TUN queues are non-blocking so that each thread can drain its queue on every wake-up
+  int fd = open("/dev/net/tun", O_RDWR | O_NONBLOCK);
+  m_gtpu_log->info("TUN file descriptor = %d\n", fd);
+  if (fd < 0) {
+    m_gtpu_log->error("Failed to open TUN device: %s\n", strerror(errno));
+    return -1;
+  }
+
+  memset(&ifr, 0, sizeof(ifr));
+  ifr.ifr_flags = IFF_TUN | IFF_NO_PI;
+  if (multi_queue) {
+    ifr.ifr_flags |= IFF_MULTI_QUEUE;
+  }
+  strncpy(ifr.ifr_ifrn.ifrn_name, if_name.c_str(), std::min(if_name.length(), (size_t)(IFNAMSIZ - 1)));
+  ifr.ifr_ifrn.ifrn_name[IFNAMSIZ - 1] = '\0';
+
+  if (ioctl(fd, TUNSETIFF, &ifr) < 0) {
+    m_gtpu_log->error("Failed to set TUN device name: %s\n", strerror(errno));
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
 int spgw::gtpu::init_sgi(spgw_args_t* args)
 {
   struct ifreq ifr;
@@ -103,26 +272,17 @@ int spgw::gtpu::init_sgi(spgw_args_t* args)
     return SRSLTE_ERROR_ALREADY_STARTED;
   }
 
-  // Construct the TUN device
-  m_sgi = open("/dev/net/tun", O_RDWR);
-  m_gtpu_log->info("TUN file descriptor = %d\n", m_sgi);
+  // Construct the TUN device. Every user plane worker gets its own queue of the device
+  m_sgi = open_sgi_queue(args->sgi_if_name, args->nof_up_workers > 0);
   if (m_sgi < 0) {
-    m_gtpu_log->error("Failed to open TUN device: %s\n", strerror(errno));
     return SRSLTE_ERROR_CANT_START;
   }
 
   memset(&ifr, 0, sizeof(ifr));
-  ifr.ifr_flags = IFF_TUN | IFF_NO_PI;
   strncpy(
       ifr.ifr_ifrn.ifrn_name, args->sgi_if_name.c_str(), std::min(args->sgi_if_name.length(), (size_t)(IFNAMSIZ - 1)));
   ifr.ifr_ifrn.ifrn_name[IFNAMSIZ - 1] = '\0';
 
-  if (ioctl(m_sgi, TUNSETIFF, &ifr) < 0) {
-    m_gtpu_log->error("Failed to set TUN device name: %s\n", strerror(errno));
-    close(m_sgi);
-    return SRSLTE_ERROR_CANT_START;
-  }
-
   // Bring up the interface
   sgi_sock = socket(AF_INET, SOCK_DGRAM, 0);
   if (ioctl(sgi_sock, SIOCGIFFLAGS, &ifr) < 0) {
@@ -168,25 +328,43 @@ int spgw::gtpu::init_sgi(spgw_args_t* args)
   return SRSLTE_SUCCESS;
 }
 
-int spgw::gtpu::init_s1u(spgw_args_t* args)
+int spgw::gtpu::open_s1u_socket(bool reuse_port)
 {
-  // Open S1-U socket
-  m_s1u = socket(AF_INET, SOCK_DGRAM, 0);
-  if (m_s1u == -1) {
+  int fd = socket(AF_INET, SOCK_DGRAM, 0);
+  if (fd == -1) {
     m_gtpu_log->error("Failed to open socket: %s\n", strerror(errno));
-    return SRSLTE_ERROR_CANT_START;
+    return -1;
   }
-  m_s1u_up = true;
 
-  // Bind the socket
+  // With several user plane workers each one binds its own socket to the S1-U address
+  int enable = 1;
+  if (reuse_port && setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable)) < 0) {
+    m_gtpu_log->error("Failed to set SO_REUSEPORT: %s\n", strerror(errno));
+    close(fd);
+    return -1;
+  }
+
+  if (bind(fd, (struct sockaddr*)&m_s1u_addr, sizeof(struct sockaddr_in))) {
+    m_gtpu_log->error("Failed to bind socket: %s\n", strerror(errno));
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+int spgw::gtpu::init_s1u(spgw_args_t* args)
+{
+  // Bind address
   m_s1u_addr.sin_family      = AF_INET;
   m_s1u_addr.sin_addr.s_addr = inet_addr(args->gtpu_bind_addr.c_str());
   m_s1u_addr.sin_port        = htons(GTPU_RX_PORT);
 
-  if (bind(m_s1u, (struct sockaddr*)&m_s1u_addr, sizeof(struct sockaddr_in))) {
-    m_gtpu_log->error("Failed to bind socket: %s\n", strerror(errno));
+  // Open S1-U socket
+  m_s1u = open_s1u_socket(args->nof_up_workers > 0);
+  if (m_s1u == -1) {
     return SRSLTE_ERROR_CANT_START;
   }
+  m_s1u_up = true;
   m_gtpu_log->info("S1-U socket = %d\n", m_s1u);
   m_gtpu_log->info("S1-U IP = %s, Port = %d \n", inet_ntoa(m_s1u_addr.sin_addr), ntohs(m_s1u_addr.sin_port));
 
@@ -194,28 +372,125 @@ int spgw::gtpu::init_s1u(spgw_args_t* args)
   return SRSLTE_SUCCESS;
 }
 
-void spgw::gtpu::handle_sgi_pdu(srslte::byte_buffer_t* msg)
+int spgw::gtpu::init_workers(spgw_args_t* args)
 {
-  uint8_t  version = 0;
-  uint32_t dest_ip;
-  bool     usr_found = false;
-  bool     ctr_found = false;
-
-  struct in_addr                                       dest_addr;
-  std::map<uint32_t, srslte::gtpc_f_teid_ie>::iterator gtpu_fteid_it;
-  std::map<in_addr_t, uint32_t>::iterator              gtpc_teid_it;
-  srslte::gtpc_f_teid_ie                               enb_fteid;
-  uint32_t                                             spgw_teid;
-  struct iphdr*                                        iph = (struct iphdr*)msg->msg;
+  for (uint32_t i = 0; i < args->nof_up_workers; i++) {
+    // The first worker uses the queue and socket opened at init, the others open their own
+    int sgi = (i == 0) ? m_sgi : open_sgi_queue(args->sgi_if_name, true);
+    int s1u = (i == 0) ? m_s1u : open_s1u_socket(true);
+    if (sgi < 0 || s1u < 0) {
+      if (i > 0 && sgi >= 0) {
+        close(sgi);
+      }
+      if (i > 0 && s1u >= 0) {
+        close(s1u);
+      }
+      return SRSLTE_ERROR_CANT_START;
+    }
+
+    std::unique_ptr<up_worker> w(new up_worker(this, i, sgi, s1u));
+    if (!w->init()) {
+      m_gtpu_log->error("Could not initialize user plane worker %d\n", i);
+      return SRSLTE_ERROR_CANT_START;
+    }
+    w->start();
+    m_workers.push_back(std::move(w));
+  }
+  if (args->nof_up_workers > 0) {
+    m_gtpu_log->info("Started %d user plane workers\n", args->nof_up_workers);
+  }
+  return SRSLTE_SUCCESS;
+}
+
+void spgw::gtpu::init_up_ctx(up_thread_ctx_t& ctx, int sgi, int s1u, bool ctrl_thread)
+{
+  ctx.sgi         = sgi;
+  ctx.s1u         = s1u;
+  ctx.ctrl_thread = ctrl_thread;
+  ctx.s1u_msgs.clear();
+  for (uint32_t i = 0; i < srslte::net_utils::UDP_MAX_BATCH; i++) {
+    ctx.s1u_msgs.push_back(srslte::allocate_unique_buffer(*m_pool, "spgw::gtpu::s1u_msg"));
+  }
+}
+
+/*
+ * User plane
+ */
+spgw::gtpu::tunnel_shard_t& spgw::gtpu::get_tunnel_shard(in_addr_t ue_ipv4)
+{
+  // UE IPs are handed out sequentially, so the low bits spread UEs evenly over the shards
+  return m_tunnel_shards[ntohl(ue_ipv4) % SPGW_NOF_TUNNEL_SHARDS];
+}
+
+void spgw::gtpu::handle_sgi_ready(up_thread_ctx_t& ctx)
+{
+  /*
+   * SGi messages may need to be queued when waiting for UE Paging procedure.
+   * For this reason, buffers for SGi pdus are allocated here and deallocated
+   * at the gtpu::send_s1u_pdu() when the PDU is sent, at handle_sgi_pdu() when the PDU is dropped or at
+   * gtpc::free_all_queued_packets, which is called when the Downlink Data Notification
+   * procedure fails (see handle_downlink_data_notification_acknowledgment and
+   * handle_downlink_data_notification_failure)
+   */
+  for (uint32_t i = 0; i < srslte::net_utils::UDP_MAX_BATCH; i++) {
+    srslte::byte_buffer_t* msg = m_pool->allocate("spgw::gtpu::sgi_msg");
+    if (msg == nullptr) {
+      m_gtpu_log->error("Could not allocate buffer for SGi PDU\n");
+      return;
+    }
+    ssize_t n = read(ctx.sgi, msg->msg, msg->get_tailroom());
+    if (n <= 0) {
+      m_pool->deallocate(msg);
+      return;
+    }
+    msg->N_bytes = n;
+    handle_sgi_pdu(msg, ctx);
+  }
+}
+
+void spgw::gtpu::handle_s1u_ready(up_thread_ctx_t& ctx)
+{
+  int n_recv = srslte::net_utils::udp_recv_burst(ctx.s1u, ctx.s1u_msgs, ctx.s1u_addrs);
+  if (n_recv < 0 && errno != EAGAIN) {
+    m_gtpu_log->error("Error reading from S1-U socket: %s\n", strerror(errno));
+    return;
+  }
+  for (int i = 0; i < n_recv; i++) {
+    handle_s1u_pdu(ctx.s1u_msgs[i].get(), ctx);
+    ctx.s1u_msgs[i]->clear();
+  }
+}
+
+void spgw::gtpu::handle_paging_handoff(up_thread_ctx_t& ctx)
+{
+  uint64_t                            cnt;
+  std::vector<srslte::byte_buffer_t*> pdus;
+  if (read(m_handoff_fd, &cnt, sizeof(cnt)) < 0 && errno != EAGAIN) {
+    m_gtpu_log->error("Error reading handoff eventfd: %s\n", strerror(errno));
+  }
+  {
+    std::lock_guard<std::mutex> lock(m_handoff_mutex);
+    pdus.swap(m_handoff_queue);
+  }
+  // Look the tunnel up again, the bearer may have been modified since the worker queued the PDU
+  for (srslte::byte_buffer_t* msg : pdus) {
+    handle_sgi_pdu(msg, ctx);
+  }
+}
+
+void spgw::gtpu::handle_sgi_pdu(srslte::byte_buffer_t* msg, up_thread_ctx_t& ctx)
+{
+  ue_tunnel_t   tunnel;
+  struct iphdr* iph = (struct iphdr*)msg->msg;
   m_gtpu_log->debug("Received SGi PDU. Bytes %d\n", msg->N_bytes);
 
   if (iph->version != 4) {
     m_gtpu_log->warning("IPv6 not supported yet.\n");
-    return;
+    goto pkt_discard_out;
   }
   if (ntohs(iph->tot_len) < 20) {
     m_gtpu_log->warning("Invalid IP header length. IP length %d.\n", ntohs(iph->tot_len));
-    return;
+    goto pkt_discard_out;
   }
 
   // Logging PDU info
@@ -224,32 +499,42 @@ void spgw::gtpu::handle_sgi_pdu(srslte::byte_buffer_t* msg)
   m_gtpu_log->debug("SGi PDU -- IP dst addr %s\n", srslte::gtpu_ntoa(iph->daddr).c_str());
 
   // Find user and control tunnel
-  gtpu_fteid_it = m_ip_to_usr_teid.find(iph->daddr);
-  if (gtpu_fteid_it != m_ip_to_usr_teid.end()) {
-    usr_found = true;
-    enb_fteid = gtpu_fteid_it->second;
-  }
-  gtpc_teid_it = m_ip_to_ctr_teid.find(iph->daddr);
-  if (gtpc_teid_it != m_ip_to_ctr_teid.end()) {
-    ctr_found = true;
-    spgw_teid = gtpc_teid_it->second;
+  {
+    tunnel_shard_t&             shard = get_tunnel_shard(iph->daddr);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto                        it = shard.tunnels.find(iph->daddr);
+    if (it != shard.tunnels.end()) {
+      tunnel = it->second;
+    }
   }
 
   // Handle SGi packet
-  if (usr_found == false && ctr_found == false) {
+  if (tunnel.usr_found == false && tunnel.ctr_found == false) {
     m_gtpu_log->debug("Packet for unknown UE.\n");
     goto pkt_discard_out;
-  } else if (usr_found == false && ctr_found == true) {
+  } else if (tunnel.usr_found == false && tunnel.ctr_found == true) {
+    if (!ctx.ctrl_thread) {
+      // Paging state belongs to GTP-C, let the SP-GW thread handle it
+      {
+        std::lock_guard<std::mutex> lock(m_handoff_mutex);
+        m_handoff_queue.push_back(msg);
+      }
+      uint64_t one = 1;
+      if (write(m_handoff_fd, &one, sizeof(one)) < 0) {
+        m_gtpu_log->error("Could not wake up SP-GW thread: %s\n", strerror(errno));
+      }
+      return;
+    }
     m_gtpu_log->debug("Packet for attached UE that is not ECM connected.\n");
     m_gtpu_log->debug("Triggering Donwlink Notification Requset.\n");
-    m_gtpc->send_downlink_data_notification(spgw_teid);
-    m_gtpc->queue_downlink_packet(spgw_teid, msg);
+    m_gtpc->send_downlink_data_notification(tunnel.up_ctrl_teid);
+    m_gtpc->queue_downlink_packet(tunnel.up_ctrl_teid, msg);
     return;
-  } else if (usr_found == false && ctr_found == true) {
+  } else if (tunnel.usr_found == false && tunnel.ctr_found == true) {
     m_gtpu_log->error("User plane tunnel found without a control plane tunnel present.\n");
     goto pkt_discard_out;
   } else {
-    send_s1u_pdu(enb_fteid, msg);
+    send_s1u_pdu(tunnel.dw_user_fteid, msg, ctx);
   }
   return;
 
@@ -258,14 +543,14 @@ pkt_discard_out:
   return;
 }
 
-void spgw::gtpu::handle_s1u_pdu(srslte::byte_buffer_t* msg)
+void spgw::gtpu::handle_s1u_pdu(srslte::byte_buffer_t* msg, up_thread_ctx_t& ctx)
 {
   srslte::gtpu_header_t header;
   srslte::gtpu_read_header(msg, &header, m_gtpu_log);
 
   m_gtpu_log->debug("Received PDU from S1-U. Bytes=%d\n", msg->N_bytes);
   m_gtpu_log->debug("TEID 0x%x. Bytes=%d\n", header.teid, msg->N_bytes);
-  int n = write(m_sgi, msg->msg, msg->N_bytes);
+  int n = write(ctx.sgi, msg->msg, msg->N_bytes);
   if (n < 0) {
     m_gtpu_log->error("Could not write to TUN interface.\n");
   } else {
@@ -274,7 +559,7 @@ void spgw::gtpu::handle_s1u_pdu(srslte::byte_buffer_t* msg)
   return;
 }
 
-void spgw::gtpu::send_s1u_pdu(srslte::gtp_fteid_t enb_fteid, srslte::byte_buffer_t* msg)
+void spgw::gtpu::send_s1u_pdu(srslte::gtp_fteid_t enb_fteid, srslte::byte_buffer_t* msg, up_thread_ctx_t& ctx)
 {
   // Set eNB destination address
   struct sockaddr_in enb_addr;
@@ -290,38 +575,40 @@ void spgw::gtpu::send_s1u_pdu(srslte::gtp_fteid_t enb_fteid, srslte::byte_buffer
   header.teid         = enb_fteid.teid;
 
   m_gtpu_log->debug("User plane tunnel found SGi PDU. Forwarding packet to S1-U.\n");
-  m_gtpu_log->debug("eNB F-TEID -- eNB IP %s, eNB TEID 0x%x.\n", inet_ntoa(enb_addr.sin_addr), enb_fteid.teid);
+  m_gtpu_log->debug(
+      "eNB F-TEID -- eNB IP %s, eNB TEID 0x%x.\n", srslte::gtpu_ntoa(enb_fteid.ipv4).c_str(), enb_fteid.teid);
 
   // Write header into packet
-  int n;
   if (!srslte::gtpu_write_header(&header, msg, m_gtpu_log)) {
     m_gtpu_log->error("Error writing GTP-U header on PDU\n");
-    goto out;
+    m_pool->deallocate(msg);
+    return;
   }
 
-  // Send packet to destination
-  n = sendto(m_s1u, msg->msg, msg->N_bytes, 0, (struct sockaddr*)&enb_addr, sizeof(enb_addr));
-  if (n < 0) {
+  // Queue packet for destination. The buffer is returned to the pool once the batch is sent
+  if (!ctx.tx_batch.push(ctx.s1u, srslte::unique_byte_buffer_t(msg, srslte::byte_buffer_deleter(m_pool)), enb_addr)) {
     m_gtpu_log->error("Error sending packet to eNB\n");
-  } else if ((unsigned int)n != msg->N_bytes) {
-    m_gtpu_log->error("Mis-match between packet bytes and sent bytes: Sent: %d/%d\n", n, msg->N_bytes);
   }
-
-out:
-  m_gtpu_log->debug("Deallocating packet after sending S1-U message\n");
-  m_pool->deallocate(msg);
   return;
 }
 
+void spgw::gtpu::flush_s1u(up_thread_ctx_t& ctx)
+{
+  if (!ctx.tx_batch.flush()) {
+    m_gtpu_log->error("Error sending packet to eNB\n");
+  }
+}
+
 void spgw::gtpu::send_all_queued_packets(srslte::gtp_fteid_t                 dw_user_fteid,
                                          std::queue<srslte::byte_buffer_t*>& pkt_queue)
 {
   m_gtpu_log->debug("Sending all queued packets\n");
   while (!pkt_queue.empty()) {
     srslte::byte_buffer_t* msg = pkt_queue.front();
-    send_s1u_pdu(dw_user_fteid, msg);
+    send_s1u_pdu(dw_user_fteid, msg, m_ctrl_ctx);
     pkt_queue.pop();
   }
+  flush_s1u(m_ctrl_ctx);
   return;
 }
 
@@ -335,32 +622,50 @@ bool spgw::gtpu::modify_gtpu_tunnel(in_addr_t ue_ipv4, srslte::gtpc_f_teid_ie dw
   m_gtpu_log->info(
       "Downlink eNB addr %s, U-TEID 0x%x\n", srslte::gtpu_ntoa(dw_user_fteid.ipv4).c_str(), dw_user_fteid.teid);
   m_gtpu_log->info("Uplink C-TEID: 0x%x\n", up_ctrl_teid);
-  m_ip_to_usr_teid[ue_ipv4] = dw_user_fteid;
-  m_ip_to_ctr_teid[ue_ipv4] = up_ctrl_teid;
+
+  tunnel_shard_t&             shard = get_tunnel_shard(ue_ipv4);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  ue_tunnel_t&                tunnel = shard.tunnels[ue_ipv4];
+  tunnel.usr_found                   = true;
+  tunnel.dw_user_fteid               = dw_user_fteid;
+  tunnel.ctr_found                   = true;
+  tunnel.up_ctrl_teid                = up_ctrl_teid;
   return true;
 }
 
 bool spgw::gtpu::delete_gtpu_tunnel(in_addr_t ue_ipv4)
 {
   // Remove GTP-U connections, if any.
-  if (m_ip_to_usr_teid.count(ue_ipv4)) {
-    m_ip_to_usr_teid.erase(ue_ipv4);
-  } else {
+  tunnel_shard_t&              shard = get_tunnel_shard(ue_ipv4);
+  std::unique_lock<std::mutex> lock(shard.mutex);
+  auto                         it = shard.tunnels.find(ue_ipv4);
+  if (it == shard.tunnels.end() || !it->second.usr_found) {
+    lock.unlock();
     m_gtpu_log->error("Could not find GTP-U Tunnel to delete.\n");
     return false;
   }
+  it->second.usr_found = false;
+  if (!it->second.ctr_found) {
+    shard.tunnels.erase(it);
+  }
   return true;
 }
 
 bool spgw::gtpu::delete_gtpc_tunnel(in_addr_t ue_ipv4)
 {
   // Remove Ctrl TEID from IP mapping.
-  if (m_ip_to_ctr_teid.count(ue_ipv4)) {
-    m_ip_to_ctr_teid.erase(ue_ipv4);
-  } else {
+  tunnel_shard_t&              shard = get_tunnel_shard(ue_ipv4);
+  std::unique_lock<std::mutex> lock(shard.mutex);
+  auto                         it = shard.tunnels.find(ue_ipv4);
+  if (it == shard.tunnels.end() || !it->second.ctr_found) {
+    lock.unlock();
     m_gtpu_log->error("Could not find GTP-C Tunnel info to delete.\n");
     return false;
   }
+  it->second.ctr_found = false;
+  if (!it->second.usr_found) {
+    shard.tunnels.erase(it);
+  }
   return true;
 }
 
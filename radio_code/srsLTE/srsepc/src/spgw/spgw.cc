@@ -25,13 +25,15 @@
 #include "srsepc/hdr/spgw/gtpu.h"
 #include "srslte/upper/gtpu.h"
 #include <inttypes.h> // for printing uint64_t
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 
 namespace srsepc {
 
 spgw*           spgw::m_instance    = NULL;
 pthread_mutex_t spgw_instance_mutex = PTHREAD_MUTEX_INITIALIZER;
 
-spgw::spgw() : m_running(false), thread("SPGW")
+spgw::spgw() : m_running(false), m_stop_fd(-1), m_epoll_fd(-1), thread("SPGW")
 {
   m_gtpc = new spgw::gtpc;
   m_gtpu = new spgw::gtpu;
@@ -77,6 +79,13 @@ int spgw::init(spgw_args_t*                           args,
   // Init log
   m_spgw_log = spgw_log;
 
+  // Used to wake up the SP-GW thread on stop and on static IP updates
+  m_stop_fd = eventfd(0, EFD_NONBLOCK);
+  if (m_stop_fd < 0) {
+    m_spgw_log->console("Could not create eventfd: %s\n", strerror(errno));
+    return SRSLTE_ERROR_CANT_START;
+  }
+
   // Init GTP-U
   if (m_gtpu->init(args, this, m_gtpc, gtpu_log) != SRSLTE_SUCCESS) {
     m_spgw_log->console("Could not initialize the SPGW's GTP-U.\n");
@@ -89,6 +98,27 @@ int spgw::init(spgw_args_t*                           args,
     return SRSLTE_ERROR_CANT_START;
   }
 
+  // This thread always serves S11. SGi and S1-U are only served here when there are no user plane workers
+  m_epoll_fd = epoll_create1(0);
+  if (m_epoll_fd < 0) {
+    m_spgw_log->console("Could not create epoll instance: %s\n", strerror(errno));
+    return SRSLTE_ERROR_CANT_START;
+  }
+  std::vector<int> fds = {m_gtpc->get_s11(), m_gtpu->get_handoff_fd(), m_stop_fd};
+  if (m_gtpu->get_nof_workers() == 0) {
+    fds.push_back(m_gtpu->get_sgi());
+    fds.push_back(m_gtpu->get_s1u());
+  }
+  for (int fd : fds) {
+    epoll_event ev = {};
+    ev.events      = EPOLLIN;
+    ev.data.fd     = fd;
+    if (epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+      m_spgw_log->console("Could not add fd %d to epoll: %s\n", fd, strerror(errno));
+      return SRSLTE_ERROR_CANT_START;
+    }
+  }
+
   m_spgw_log->info("SP-GW Initialized.\n");
   m_spgw_log->console("SP-GW Initialized.\n");
   return SRSLTE_SUCCESS;
@@ -97,81 +127,112 @@ int spgw::init(spgw_args_t*                           args,
 void spgw::stop()
 {
   if (m_running) {
-    m_running = false;
-    thread_cancel();
+    uint64_t one = 1;
+    m_running    = false;
+    if (write(m_stop_fd, &one, sizeof(one)) < 0) {
+      thread_cancel();
+    }
     wait_thread_finish();
   }
 
   m_gtpu->stop();
   m_gtpc->stop();
+  if (m_stop_fd >= 0) {
+    close(m_stop_fd);
+    m_stop_fd = -1;
+  }
+  if (m_epoll_fd >= 0) {
+    close(m_epoll_fd);
+    m_epoll_fd = -1;
+  }
   return;
 }
 
+void spgw::update_static_ips(const std::map<std::string, uint64_t>& ip_to_imsi)
+{
+  {
+    std::lock_guard<std::mutex> lock(m_static_ip_mutex);
+    m_pending_ip_to_imsi = ip_to_imsi;
+    m_static_ip_pending  = true;
+  }
+  uint64_t one = 1;
+  if (write(m_stop_fd, &one, sizeof(one)) < 0) {
+    m_spgw_log->error("Could not wake up the SP-GW thread: %s\n", strerror(errno));
+  }
+}
+
+// Runs on the SP-GW thread, which owns the IP pool and the sessions
+void spgw::apply_static_ips()
+{
+  std::map<std::string, uint64_t> ip_to_imsi;
+  {
+    std::lock_guard<std::mutex> lock(m_static_ip_mutex);
+    if (not m_static_ip_pending) {
+      return;
+    }
+    ip_to_imsi.swap(m_pending_ip_to_imsi);
+    m_static_ip_pending = false;
+  }
+  if (m_gtpc->update_ue_ip(ip_to_imsi) != SRSLTE_SUCCESS) {
+    m_spgw_log->console("Could not apply the static IPs of the reloaded user database\n");
+  }
+}
+
 void spgw::run_thread()
 {
   // Mark the thread as running
   m_running = true;
-  srslte::byte_buffer_t *sgi_msg, *s1u_msg, *s11_msg;
-  s1u_msg = m_pool->allocate("spgw::run_thread::s1u");
+  srslte::byte_buffer_t* s11_msg;
   s11_msg = m_pool->allocate("spgw::run_thread::s11");
 
-  struct sockaddr_in src_addr_in;
   struct sockaddr_un src_addr_un;
   socklen_t          addrlen;
-  struct iphdr*      ip_pkt;
 
-  int sgi = m_gtpu->get_sgi();
-  int s1u = m_gtpu->get_s1u();
-  int s11 = m_gtpc->get_s11();
+  spgw::gtpu::up_thread_ctx_t& up_ctx = m_gtpu->get_ctrl_ctx();
+
+  int sgi     = m_gtpu->get_sgi();
+  int s1u     = m_gtpu->get_s1u();
+  int s11     = m_gtpc->get_s11();
+  int handoff = m_gtpu->get_handoff_fd();
 
   size_t buf_len = SRSLTE_MAX_BUFFER_SIZE_BYTES - SRSLTE_BUFFER_HEADER_OFFSET;
 
-  fd_set set;
-  int    max_fd = std::max(s1u, sgi);
-  max_fd        = std::max(max_fd, s11);
+  epoll_event events[5];
   while (m_running) {
-
-    s1u_msg->clear();
-    s11_msg->clear();
-
-    FD_ZERO(&set);
-    FD_SET(s1u, &set);
-    FD_SET(sgi, &set);
-    FD_SET(s11, &set);
-
-    int n = select(max_fd + 1, &set, NULL, NULL, NULL);
+    int n = epoll_wait(m_epoll_fd, events, 5, -1);
     if (n == -1) {
-      m_spgw_log->error("Error from select\n");
-    } else if (n) {
-      if (FD_ISSET(sgi, &set)) {
-        /*
-         * SGi messages may need to be queued when waiting for UE Paging procedure.
-         * For this reason, buffers for SGi pdus are allocated here and deallocated
-         * at the gtpu::send_s1u_pdu() when the PDU is sent, at handle_sgi_pdu() when the PDU is dropped or at
-         * gtpc::free_all_queued_packets, which is called when the Downlink Data Notification
-         * procedure fails (see handle_downlink_data_notification_acknowledgment and
-         * handle_downlink_data_notification_failure)
-         */
-        m_spgw_log->debug("Message received at SPGW: SGi Message\n");
-        sgi_msg          = m_pool->allocate("spgw::run_thread::sgi_msg");
-        sgi_msg->N_bytes = read(sgi, sgi_msg->msg, buf_len);
-        m_gtpu->handle_sgi_pdu(sgi_msg);
+      if (errno != EINTR) {
+        m_spgw_log->error("Error from epoll_wait\n");
       }
-      if (FD_ISSET(s1u, &set)) {
+      continue;
+    }
+    for (int i = 0; i < n; i++) {
+      int fd = events[i].data.fd;
+      if (fd == sgi) {
+        m_spgw_log->debug("Message received at SPGW: SGi Message\n");
+        m_gtpu->handle_sgi_ready(up_ctx);
+      } else if (fd == s1u) {
         m_spgw_log->debug("Message received at SPGW: S1-U Message\n");
-        s1u_msg->N_bytes = recvfrom(s1u, s1u_msg->msg, buf_len, 0, (struct sockaddr*)&src_addr_in, &addrlen);
-        m_gtpu->handle_s1u_pdu(s1u_msg);
-      }
-      if (FD_ISSET(s11, &set)) {
+        m_gtpu->handle_s1u_ready(up_ctx);
+      } else if (fd == s11) {
         m_spgw_log->debug("Message received at SPGW: S11 Message\n");
+        s11_msg->clear();
+        addrlen          = sizeof(src_addr_un);
         s11_msg->N_bytes = recvfrom(s11, s11_msg->msg, buf_len, 0, (struct sockaddr*)&src_addr_un, &addrlen);
         m_gtpc->handle_s11_pdu(s11_msg);
+      } else if (fd == handoff) {
+        m_gtpu->handle_paging_handoff(up_ctx);
+      } else if (fd == m_stop_fd) {
+        uint64_t count;
+        if (read(m_stop_fd, &count, sizeof(count)) < 0 and errno != EAGAIN) {
+          m_spgw_log->error("Error reading eventfd: %s\n", strerror(errno));
+        }
+        apply_static_ips();
       }
-    } else {
-      m_spgw_log->debug("No data from select.\n");
     }
+    // Send the downlink PDUs generated while handling this wake-up
+    m_gtpu->flush_s1u(up_ctx);
   }
-  m_pool->deallocate(s1u_msg);
   m_pool->deallocate(s11_msg);
   return;
 }
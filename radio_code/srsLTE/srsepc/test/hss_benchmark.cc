@@ -0,0 +1,164 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/*
+ * Times the HSS user database with a large subscriber population: loading the DB file, authentications from
+ * several threads, reload of a changed DB file and compaction of the SQN journal.
+ */
+
+#include "srsepc/hdr/hss/hss.h"
+#include "srslte/common/test_common.h"
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <getopt.h>
+#include <thread>
+#include <vector>
+
+using namespace srsepc;
+
+static const char*    db_file    = "hss_benchmark_user_db.csv";
+static const uint64_t first_imsi = 1010000000000;
+
+static uint32_t nof_users   = 100000;
+static uint32_t nof_threads = 8;
+
+void usage(char* prog)
+{
+  printf("Usage: %s [nt]\n", prog);
+  printf("\t-n Number of subscribers [Default %d]\n", nof_users);
+  printf("\t-t Number of authentication threads [Default %d]\n", nof_threads);
+}
+
+void parse_args(int argc, char** argv)
+{
+  int opt;
+  while ((opt = getopt(argc, argv, "nt")) != -1) {
+    switch (opt) {
+      case 'n':
+        nof_users = (uint32_t)strtol(argv[optind], nullptr, 10);
+        break;
+      case 't':
+        nof_threads = (uint32_t)strtol(argv[optind], nullptr, 10);
+        break;
+      default:
+        usage(argv[0]);
+        exit(-1);
+    }
+  }
+}
+
+static void write_db_file(uint32_t nof_lines, uint16_t qci)
+{
+  std::string   tmp = std::string(db_file) + ".tmp";
+  std::ofstream f(tmp.c_str());
+  char          imsi[16];
+  for (uint32_t i = 0; i < nof_lines; i++) {
+    snprintf(imsi, sizeof(imsi), "%015" PRIu64, first_imsi + i);
+    f << "ue" << i << "," << (i % 2 ? "xor" : "mil") << "," << imsi
+      << ",00112233445566778899aabbccddeeff,opc,63bfa50ee6523365ff14c1f45f88737d,8000,000000001234," << qci
+      << ",dynamic\n";
+  }
+  f.close();
+  rename(tmp.c_str(), db_file);
+}
+
+static void remove_files()
+{
+  std::string journal = std::string(db_file) + ".sqn";
+  remove(db_file);
+  remove(journal.c_str());
+  remove((journal + ".old").c_str());
+}
+
+static double elapsed_ms(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv)
+{
+  parse_args(argc, argv);
+  TESTASSERT(nof_users > 0 and nof_threads > 0);
+
+  srslte::log_filter log("HSS");
+  log.set_level(srslte::LOG_LEVEL_WARNING);
+
+  remove_files();
+  write_db_file(nof_users, 7);
+
+  // Load
+  hss_args_t args = {};
+  args.db_file    = db_file;
+  args.mcc        = 1;
+  args.mnc        = 1;
+  args.db_reload  = true;
+  hss* h          = hss::get_instance();
+
+  std::chrono::steady_clock::time_point t = std::chrono::steady_clock::now();
+  TESTASSERT(h->init(&args, &log) == 0);
+  double init_ms = elapsed_ms(t);
+
+  // Reload a changed file. Done before the authentications, which would make check_db_file() compact the journal
+  write_db_file(nof_users, 9);
+  t = std::chrono::steady_clock::now();
+  TESTASSERT(h->check_db_file());
+  double  reload_ms = elapsed_ms(t);
+  uint8_t qci       = 0;
+  TESTASSERT(h->gen_update_loc_answer(first_imsi + nof_users - 1, &qci) and qci == 9);
+
+  // Authenticate every user once, spread over the threads
+  std::atomic<uint32_t>    nof_failed(0);
+  std::vector<std::thread> threads;
+  t = std::chrono::steady_clock::now();
+  for (uint32_t n = 0; n < nof_threads; n++) {
+    threads.emplace_back([h, n, &nof_failed]() {
+      uint8_t k_asme[32], autn[16], rand[16], xres[16];
+      for (uint32_t i = n; i < nof_users; i += nof_threads) {
+        if (not h->gen_auth_info_answer(first_imsi + i, k_asme, autn, rand, xres)) {
+          nof_failed++;
+        }
+      }
+    });
+  }
+  for (std::thread& th : threads) {
+    th.join();
+  }
+  double auth_ms = elapsed_ms(t);
+  TESTASSERT(nof_failed == 0);
+
+  // Compact the journal into the DB file
+  t = std::chrono::steady_clock::now();
+  h->stop();
+  double compaction_ms = elapsed_ms(t);
+  hss::cleanup();
+  remove_files();
+
+  printf("Subscribers:                %d\n", nof_users);
+  printf("Load DB file:               %.1f ms\n", init_ms);
+  printf("Reload DB file:             %.1f ms\n", reload_ms);
+  printf("Authentications (%2d thr.):  %.1f ms, %.0f auth/s\n",
+         nof_threads,
+         auth_ms,
+         nof_users * 1000.0 / auth_ms);
+  printf("Journal compaction:         %.1f ms\n", compaction_ms);
+  return SRSLTE_SUCCESS;
+}
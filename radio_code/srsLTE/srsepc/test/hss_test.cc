@@ -0,0 +1,265 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srsepc/hdr/hss/hss.h"
+#include "srslte/common/test_common.h"
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace srsepc;
+
+static const char* db_file = "hss_test_user_db.csv";
+
+static const uint64_t imsi_xor = 1010123456789;
+static const uint64_t imsi_mil = 1010123456780;
+static const uint64_t imsi_new = 1010123456781;
+
+static const std::string ue_xor =
+    "ue1,xor,001010123456789,00112233445566778899aabbccddeeff,opc,63bfa50ee6523365ff14c1f45f88737d,9001,000000001234,7,"
+    "dynamic";
+static const std::string ue_mil =
+    "ue2,mil,001010123456780,00112233445566778899aabbccddeeff,opc,63bfa50ee6523365ff14c1f45f88737d,8000,000000001234,7,"
+    "dynamic";
+static const std::string ue_new =
+    "ue3,mil,001010123456781,00112233445566778899aabbccddeeff,opc,63bfa50ee6523365ff14c1f45f88737d,8000,000000001234,9,"
+    "172.16.0.10";
+
+// Replaces the file atomically, so that the HSS sees a new inode
+static void write_file(const std::string& filename, const std::vector<std::string>& lines)
+{
+  std::string   tmp = filename + ".tmp";
+  std::ofstream f(tmp.c_str());
+  for (const std::string& line : lines) {
+    f << line << "\n";
+  }
+  f.close();
+  rename(tmp.c_str(), filename.c_str());
+}
+
+static std::vector<std::string> read_lines(const std::string& filename)
+{
+  std::vector<std::string> lines;
+  std::ifstream            f(filename.c_str());
+  std::string              line;
+  while (std::getline(f, line)) {
+    lines.push_back(line);
+  }
+  return lines;
+}
+
+static bool file_exists(const std::string& filename)
+{
+  std::ifstream f(filename.c_str());
+  return f.good();
+}
+
+// SQN column of the user in the DB file, empty if the user is not there
+static std::string get_db_sqn(uint64_t imsi)
+{
+  char imsi_str[32];
+  snprintf(imsi_str, sizeof(imsi_str), ",%015" PRIu64 ",", imsi);
+  for (const std::string& line : read_lines(db_file)) {
+    if (line.find(imsi_str) != std::string::npos) {
+      std::stringstream        ss(line);
+      std::vector<std::string> cols;
+      std::string              col;
+      while (std::getline(ss, col, ',')) {
+        cols.push_back(col);
+      }
+      return cols.size() == 10 ? cols[7] : "";
+    }
+  }
+  return "";
+}
+
+static void remove_files()
+{
+  std::string journal = std::string(db_file) + ".sqn";
+  remove(db_file);
+  remove(journal.c_str());
+  remove((journal + ".old").c_str());
+}
+
+static hss* init_hss(srslte::log_filter* log)
+{
+  hss_args_t args = {};
+  args.db_file    = db_file;
+  args.mcc        = 1;
+  args.mnc        = 1;
+  args.db_reload  = true;
+  hss* h          = hss::get_instance();
+  return h->init(&args, log) == 0 ? h : nullptr;
+}
+
+static bool authenticate(hss* h, uint64_t imsi)
+{
+  uint8_t k_asme[32], autn[16], rand[16], xres[16];
+  return h->gen_auth_info_answer(imsi, k_asme, autn, rand, xres);
+}
+
+int test_journal_replay(srslte::log_filter* log)
+{
+  remove_files();
+  write_file(db_file, {ue_xor, ue_mil});
+  std::string journal = std::string(db_file) + ".sqn";
+
+  hss* h = init_hss(log);
+  TESTASSERT(h != nullptr);
+
+  // Each authentication appends one entry, the DB file is not rewritten
+  for (uint32_t i = 0; i < 3; i++) {
+    TESTASSERT(authenticate(h, imsi_mil));
+  }
+  TESTASSERT(authenticate(h, imsi_xor));
+  std::vector<std::string> entries = read_lines(journal);
+  TESTASSERT(entries.size() == 4);
+  TESTASSERT(get_db_sqn(imsi_mil) == "000000001234");
+  std::string last_mil_sqn = entries[2].substr(entries[2].find(',') + 1);
+  std::string last_xor_sqn = entries[3].substr(entries[3].find(',') + 1);
+  TESTASSERT(last_mil_sqn != "000000001234");
+
+  // Simulate a crash: keep the journal and the DB file as they were before the clean exit
+  std::vector<std::string> saved_db = read_lines(db_file);
+  h->stop();
+  hss::cleanup();
+  TESTASSERT(not file_exists(journal));
+  write_file(db_file, saved_db);
+  write_file(journal, entries);
+
+  // The journal is replayed at startup and compacted into the DB file
+  h = init_hss(log);
+  TESTASSERT(h != nullptr);
+  TESTASSERT(get_db_sqn(imsi_mil) == last_mil_sqn);
+  TESTASSERT(get_db_sqn(imsi_xor) == last_xor_sqn);
+  TESTASSERT(read_lines(journal).empty());
+  TESTASSERT(not file_exists(journal + ".old"));
+  h->stop();
+  hss::cleanup();
+
+  // A truncated last entry is ignored
+  write_file(journal, {"001010123456780,0000000fffff", "001010123456789,0000"});
+  h = init_hss(log);
+  TESTASSERT(h != nullptr);
+  TESTASSERT(get_db_sqn(imsi_mil) == "0000000fffff");
+  TESTASSERT(get_db_sqn(imsi_xor) == last_xor_sqn);
+  h->stop();
+  hss::cleanup();
+
+  // A journal left by an interrupted compaction only moves SQNs forward
+  write_file(journal + ".old", {"001010123456780,000000000001", "001010123456789,00000fffffff"});
+  h = init_hss(log);
+  TESTASSERT(h != nullptr);
+  TESTASSERT(get_db_sqn(imsi_mil) == "0000000fffff");
+  TESTASSERT(get_db_sqn(imsi_xor) == "00000fffffff");
+  TESTASSERT(not file_exists(journal + ".old"));
+  h->stop();
+  hss::cleanup();
+
+  remove_files();
+  return SRSLTE_SUCCESS;
+}
+
+int test_compaction(srslte::log_filter* log)
+{
+  remove_files();
+  write_file(db_file, {ue_xor, ue_mil});
+  std::string journal = std::string(db_file) + ".sqn";
+
+  hss* h = init_hss(log);
+  TESTASSERT(h != nullptr);
+  TESTASSERT(authenticate(h, imsi_mil));
+  std::vector<std::string> entries = read_lines(journal);
+  TESTASSERT(entries.size() == 1);
+
+  // Stopping compacts the journal into the DB file and removes it. Users are written sorted by IMSI
+  h->stop();
+  hss::cleanup();
+  TESTASSERT(not file_exists(journal));
+  TESTASSERT(get_db_sqn(imsi_mil) == entries[0].substr(entries[0].find(',') + 1));
+  std::vector<std::string> users;
+  for (const std::string& line : read_lines(db_file)) {
+    if (line[0] != '#') {
+      users.push_back(line);
+    }
+  }
+  TESTASSERT(users.size() == 2);
+  TESTASSERT(users[0].find("001010123456780") != std::string::npos);
+  TESTASSERT(users[1] == ue_xor);
+
+  remove_files();
+  return SRSLTE_SUCCESS;
+}
+
+int test_reload(srslte::log_filter* log)
+{
+  remove_files();
+  write_file(db_file, {ue_xor, ue_mil});
+  std::string journal = std::string(db_file) + ".sqn";
+
+  hss* h = init_hss(log);
+  TESTASSERT(h != nullptr);
+  TESTASSERT(not h->check_db_file());
+  TESTASSERT(h->get_ip_to_imsi().empty());
+  TESTASSERT(authenticate(h, imsi_mil));
+  std::string mil_sqn = read_lines(journal).back().substr(std::string("001010123456780,").size());
+
+  // Users are added and removed, and the new static IPs are visible
+  write_file(db_file, {ue_mil, ue_new});
+  TESTASSERT(h->check_db_file());
+  TESTASSERT(not h->check_db_file());
+  uint8_t qci = 0;
+  TESTASSERT(h->gen_update_loc_answer(imsi_new, &qci) and qci == 9);
+  TESTASSERT(not h->gen_update_loc_answer(imsi_xor, &qci));
+  std::map<std::string, uint64_t> ip_to_imsi = h->get_ip_to_imsi();
+  TESTASSERT(ip_to_imsi.size() == 1 and ip_to_imsi["172.16.0.10"] == imsi_new);
+
+  // A file that does not parse leaves the current users in place
+  write_file(db_file, {ue_mil, "ue4,foo,001010123456782"});
+  TESTASSERT(not h->check_db_file());
+  TESTASSERT(h->gen_update_loc_answer(imsi_new, &qci));
+  TESTASSERT(h->get_ip_to_imsi().size() == 1);
+
+  // Known users keep the SQN they had in memory, not the one in the file
+  write_file(db_file, {ue_mil, ue_new});
+  TESTASSERT(h->check_db_file());
+  h->stop();
+  hss::cleanup();
+  TESTASSERT(get_db_sqn(imsi_mil) == mil_sqn);
+  TESTASSERT(get_db_sqn(imsi_new) == "000000001234");
+
+  remove_files();
+  return SRSLTE_SUCCESS;
+}
+
+int main()
+{
+  srslte::log_filter log("HSS");
+  log.set_level(srslte::LOG_LEVEL_WARNING);
+
+  TESTASSERT(test_journal_replay(&log) == SRSLTE_SUCCESS);
+  TESTASSERT(test_compaction(&log) == SRSLTE_SUCCESS);
+  TESTASSERT(test_reload(&log) == SRSLTE_SUCCESS);
+
+  printf("\nSuccess\n");
+  return SRSLTE_SUCCESS;
+}
@@ -0,0 +1,215 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srsepc/hdr/mme/s1ap.h"
+#include "srslte/common/test_common.h"
+#include <set>
+#include <thread>
+#include <vector>
+
+using namespace srsepc;
+
+static const uint32_t nof_shards     = 4;
+static const uint32_t enb_ue_s1ap_id = 1;
+
+int test_shard_id_allocator()
+{
+  // A single shard allocates the identifiers in sequence
+  shard_id_allocator single;
+  single.init(1);
+  TESTASSERT(single.get_nof_shards() == 1);
+  for (uint32_t id = 1; id < 10; id++) {
+    TESTASSERT(single.allocate(0) == id);
+    TESTASSERT(single.get_shard(id) == 0);
+  }
+
+  // With several shards, the identifiers are never 0, never repeated, and tell the shard that allocated them
+  shard_id_allocator ids;
+  ids.init(nof_shards);
+  TESTASSERT(ids.get_nof_shards() == nof_shards);
+  std::set<uint32_t> allocated;
+  for (uint32_t i = 0; i < 100; i++) {
+    for (uint32_t shard = 0; shard < nof_shards; shard++) {
+      uint32_t id = ids.allocate(shard);
+      TESTASSERT(id != 0);
+      TESTASSERT(ids.get_shard(id) == shard);
+      TESTASSERT(allocated.insert(id).second);
+    }
+  }
+  TESTASSERT(ids.get_shard(0) == 0);
+  return SRSLTE_SUCCESS;
+}
+
+int test_ctx_table()
+{
+  s1ap_ctx_table<uint32_t, uint64_t> table;
+  uint64_t                           value = 0;
+
+  TESTASSERT(!table.find(1, &value));
+  TESTASSERT(table.insert(1, 1001));
+  TESTASSERT(!table.insert(1, 2001));
+  TESTASSERT(table.find(1, &value) && value == 1001);
+  TESTASSERT(table.erase(1));
+  TESTASSERT(!table.erase(1));
+  TESTASSERT(!table.find(1, &value));
+
+  // Threads that insert and look up their own keys, which share the partitions of the table
+  const uint32_t           nof_threads = 4, nof_keys = 10000;
+  std::vector<std::thread> threads;
+  std::vector<bool>        thread_ok(nof_threads, false);
+  for (uint32_t t = 0; t < nof_threads; t++) {
+    threads.emplace_back([&table, &thread_ok, t, nof_threads, nof_keys]() {
+      bool ok = true;
+      for (uint32_t k = t; k < nof_keys; k += nof_threads) {
+        uint64_t v = 0;
+        ok         = ok && table.insert(k, k + 1000) && table.find(k, &v) && v == k + 1000;
+        if (k % 2 == 0) {
+          ok = ok && table.erase(k);
+        }
+      }
+      thread_ok[t] = ok;
+    });
+  }
+  for (std::thread& t : threads) {
+    t.join();
+  }
+  for (uint32_t t = 0; t < nof_threads; t++) {
+    TESTASSERT(thread_ok[t]);
+  }
+
+  // Only the odd keys are left
+  std::vector<std::pair<uint32_t, uint64_t> > entries = table.take_all();
+  TESTASSERT(entries.size() == nof_keys / 2);
+  for (const std::pair<uint32_t, uint64_t>& entry : entries) {
+    TESTASSERT(entry.first % 2 == 1);
+    TESTASSERT(entry.second == entry.first + 1000);
+  }
+  TESTASSERT(table.take_all().empty());
+  TESTASSERT(!table.find(1, &value));
+  return SRSLTE_SUCCESS;
+}
+
+static int get_pdu_shard(s1ap* s1ap, const s1ap_pdu_t& pdu, int32_t assoc_id)
+{
+  srslte::byte_buffer_t buf;
+  asn1::bit_ref         bref(buf.msg, buf.get_tailroom());
+  if (pdu.pack(bref) != asn1::SRSASN_SUCCESS) {
+    return -2;
+  }
+  buf.N_bytes = bref.distance_bytes();
+
+  struct sctp_sndrcvinfo sri = {};
+  sri.sinfo_assoc_id         = assoc_id;
+  return s1ap->get_rx_pdu_shard(&buf, &sri);
+}
+
+int test_rx_pdu_routing()
+{
+  s1ap* s1ap = s1ap::get_instance();
+  s1ap->init_shards(nof_shards);
+  TESTASSERT(s1ap->get_nof_shards() == nof_shards);
+
+  for (uint32_t shard = 0; shard < nof_shards; shard++) {
+    s1ap::set_current_shard(shard);
+    uint32_t mme_ue_s1ap_id = s1ap->get_next_mme_ue_s1ap_id();
+    TESTASSERT(s1ap->get_id_shard(mme_ue_s1ap_id) == shard);
+
+    // The messages of a known UE go to the shard that allocated its MME UE S1AP Id
+    s1ap_pdu_t ul_nas;
+    ul_nas.set_init_msg().load_info_obj(ASN1_S1AP_ID_UL_NAS_TRANSPORT);
+    asn1::s1ap::ul_nas_transport_ies_container& ul_nas_ies = ul_nas.init_msg().value.ul_nas_transport().protocol_ies;
+    ul_nas_ies.mme_ue_s1ap_id.value                        = mme_ue_s1ap_id;
+    ul_nas_ies.enb_ue_s1ap_id.value                        = enb_ue_s1ap_id;
+    TESTASSERT(get_pdu_shard(s1ap, ul_nas, 1) == (int)shard);
+
+    s1ap_pdu_t release_req;
+    release_req.set_init_msg().load_info_obj(ASN1_S1AP_ID_UE_CONTEXT_RELEASE_REQUEST);
+    asn1::s1ap::ue_context_release_request_ies_container& release_ies =
+        release_req.init_msg().value.ue_context_release_request().protocol_ies;
+    release_ies.mme_ue_s1ap_id.value        = mme_ue_s1ap_id;
+    release_ies.enb_ue_s1ap_id.value        = enb_ue_s1ap_id;
+    release_ies.cause.value.set_nas().value = asn1::s1ap::cause_nas_opts::normal_release;
+    TESTASSERT(get_pdu_shard(s1ap, release_req, 1) == (int)shard);
+
+    s1ap_pdu_t ctx_setup_resp;
+    ctx_setup_resp.set_successful_outcome().load_info_obj(ASN1_S1AP_ID_INIT_CONTEXT_SETUP);
+    asn1::s1ap::init_context_setup_resp_ies_container& ctx_setup_ies =
+        ctx_setup_resp.successful_outcome().value.init_context_setup_resp().protocol_ies;
+    ctx_setup_ies.mme_ue_s1ap_id.value = mme_ue_s1ap_id;
+    ctx_setup_ies.enb_ue_s1ap_id.value = enb_ue_s1ap_id;
+    ctx_setup_ies.erab_setup_list_ctxt_su_res.value.resize(1);
+    ctx_setup_ies.erab_setup_list_ctxt_su_res.value[0].load_info_obj(ASN1_S1AP_ID_ERAB_SETUP_ITEM_CTXT_SU_RES);
+    asn1::s1ap::erab_setup_item_ctxt_su_res_s& erab =
+        ctx_setup_ies.erab_setup_list_ctxt_su_res.value[0].value.erab_setup_item_ctxt_su_res();
+    erab.erab_id = 5;
+    erab.transport_layer_address.resize(32);
+    erab.gtp_teid.from_number(1);
+    TESTASSERT(get_pdu_shard(s1ap, ctx_setup_resp, 1) == (int)shard);
+
+    s1ap_pdu_t release_complete;
+    release_complete.set_successful_outcome().load_info_obj(ASN1_S1AP_ID_UE_CONTEXT_RELEASE);
+    asn1::s1ap::ue_context_release_complete_ies_container& complete_ies =
+        release_complete.successful_outcome().value.ue_context_release_complete().protocol_ies;
+    complete_ies.mme_ue_s1ap_id.value = mme_ue_s1ap_id;
+    complete_ies.enb_ue_s1ap_id.value = enb_ue_s1ap_id;
+    TESTASSERT(get_pdu_shard(s1ap, release_complete, 1) == (int)shard);
+  }
+  s1ap::set_current_shard(0);
+
+  // UEs that are not known yet are spread by their eNB association and eNB UE S1AP Id
+  const uint8_t auth_resp[] = {0x07, 0x53};
+  for (int32_t assoc_id = 1; assoc_id < 3; assoc_id++) {
+    for (uint32_t enb_id = 1; enb_id <= 2 * nof_shards; enb_id++) {
+      s1ap_pdu_t init_ue;
+      init_ue.set_init_msg().load_info_obj(ASN1_S1AP_ID_INIT_UE_MSG);
+      asn1::s1ap::init_ue_msg_ies_container& ies = init_ue.init_msg().value.init_ue_msg().protocol_ies;
+      ies.enb_ue_s1ap_id.value                   = enb_id;
+      ies.rrc_establishment_cause.value          = asn1::s1ap::rrc_establishment_cause_opts::mo_sig;
+      ies.nas_pdu.value.resize(sizeof(auth_resp));
+      memcpy(ies.nas_pdu.value.data(), auth_resp, sizeof(auth_resp));
+      TESTASSERT(get_pdu_shard(s1ap, init_ue, assoc_id) == (int)((assoc_id + enb_id) % nof_shards));
+    }
+  }
+
+  // Messages that are not associated to a UE are left to the MME thread, as are the ones that cannot be decoded
+  s1ap_pdu_t error_ind;
+  error_ind.set_init_msg().load_info_obj(ASN1_S1AP_ID_ERROR_IND);
+  TESTASSERT(get_pdu_shard(s1ap, error_ind, 1) == -1);
+
+  srslte::byte_buffer_t  garbage;
+  struct sctp_sndrcvinfo sri = {};
+  garbage.N_bytes            = 4;
+  memset(garbage.msg, 0xff, garbage.N_bytes);
+  TESTASSERT(s1ap->get_rx_pdu_shard(&garbage, &sri) == -1);
+
+  s1ap::cleanup();
+  return SRSLTE_SUCCESS;
+}
+
+int main()
+{
+  TESTASSERT(test_shard_id_allocator() == SRSLTE_SUCCESS);
+  TESTASSERT(test_ctx_table() == SRSLTE_SUCCESS);
+  TESTASSERT(test_rx_pdu_routing() == SRSLTE_SUCCESS);
+
+  printf("\nSuccess\n");
+  return SRSLTE_SUCCESS;
+}
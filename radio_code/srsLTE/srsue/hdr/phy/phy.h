@@ -51,6 +51,9 @@ public:
   // Init for LTE PHYs
   int init(const phy_args_t& args_, stack_interface_phy_lte* stack_, srslte::radio_interface_phy* radio_) final;
 
+  // Runs the subframe workers as tasks of a pool shared with other UEs. Must be called before init()
+  void set_workers_executor(srslte::task_thread_pool* executor) { workers_pool.set_executor(executor); }
+
   void stop() final;
 
   void wait_initialize() final;
@@ -118,8 +121,9 @@ public:
 
   void start_plot() final;
 
-  const static int MAX_WORKERS     = 4;
-  const static int DEFAULT_WORKERS = 4;
+  const static int MAX_WORKERS         = 4;
+  const static int DEFAULT_WORKERS     = 4;
+  const static int WORKERS_THREAD_PRIO = 2;
 
   std::string get_type() final { return "lte_soft"; }
 
@@ -132,7 +136,6 @@ private:
   uint32_t                nof_workers   = 0;
 
   const static int SF_RECV_THREAD_PRIO = 0;
-  const static int WORKERS_THREAD_PRIO = 2;
 
   srslte::radio_interface_phy*                      radio = nullptr;
   std::vector<std::unique_ptr<srslte::log_filter> > log_vec;
@@ -35,6 +35,11 @@ namespace srsue {
 typedef struct {
   bool        enable;
   std::string filename;
+  bool        async;
+  int         max_file_size;
+  uint32_t    rotation_period;
+  std::string filter_rnti;
+  std::string filter_lcid;
   bool        nas_enable;
   std::string nas_filename;
 } pcap_args_t;
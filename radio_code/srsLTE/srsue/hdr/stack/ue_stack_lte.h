@@ -58,7 +58,8 @@ class ue_stack_lte final : public ue_stack_base,
                            public srslte::thread
 {
 public:
-  ue_stack_lte();
+  // If shared_background_tasks is set, the stack pushes its background tasks to that pool instead of its own
+  explicit ue_stack_lte(srslte::task_thread_pool* shared_background_tasks = nullptr);
   ~ue_stack_lte();
 
   std::string get_type() final;
@@ -168,7 +169,8 @@ private:
   static const int        STACK_MAIN_THREAD_PRIO = -1; // Use default high-priority below UHD
   srslte::task_multiqueue pending_tasks;
   int sync_queue_id = -1, ue_queue_id = -1, gw_queue_id = -1, stack_queue_id = -1, background_queue_id = -1;
-  srslte::task_thread_pool             background_tasks;     ///< Thread pool used for long, low-priority tasks
+  srslte::task_thread_pool             own_background_tasks; ///< Thread pool used for long, low-priority tasks
+  srslte::task_thread_pool*            background_tasks;     ///< Either own_background_tasks or a pool shared by UEs
   std::vector<srslte::move_task_t>     deferred_stack_tasks; ///< enqueues stack tasks from within. Avoids locking
   srslte::block_queue<stack_metrics_t> pending_stack_metrics;
 
@@ -36,6 +36,7 @@
 #include "srslte/common/buffer_pool.h"
 #include "srslte/common/log_filter.h"
 #include "srslte/common/logger_file.h"
+#include "srslte/common/thread_pool.h"
 #include "srslte/interfaces/ue_interfaces.h"
 #include "srslte/radio/radio.h"
 #include "stack/ue_stack_base.h"
@@ -59,6 +60,7 @@ typedef struct {
   int         all_hex_limit;
   int         file_max_size;
   std::string filename;
+  std::string backend;
 } log_args_t;
 
 typedef struct {
@@ -73,6 +75,13 @@ typedef struct {
   std::string metrics_csv_filename;
 } general_args_t;
 
+typedef struct {
+  uint32_t nof_ues;
+  uint32_t rf_port_step;
+  uint32_t nof_background_threads;
+  uint32_t nof_phy_threads;
+} host_args_t;
+
 typedef struct {
   srslte::rf_args_t rf;
   trace_args_t      trace;
@@ -84,6 +93,7 @@ typedef struct {
   gw_args_t    gw;
 
   general_args_t general;
+  host_args_t    host;
 } all_args_t;
 
 /*******************************************************************************
@@ -96,7 +106,12 @@ public:
   ue();
   ~ue();
 
-  int  init(const all_args_t& args_, srslte::logger* logger_);
+  // UEs of a multi-UE host pass the host background task pool, which their stacks share, and the host PHY worker pool,
+  // which runs the subframe workers of all their PHYs
+  int  init(const all_args_t&         args_,
+            srslte::logger*           logger_,
+            srslte::task_thread_pool* background_tasks = nullptr,
+            srslte::task_thread_pool* phy_workers      = nullptr);
   void stop();
   bool switch_on();
   bool switch_off();
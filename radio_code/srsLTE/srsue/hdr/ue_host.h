@@ -0,0 +1,84 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/******************************************************************************
+ * File:        ue_host.h
+ * Description: Multi-UE launcher, runs several independent UEs in one
+ *              process. The logger, the byte buffer pool, the stack
+ *              background task pool, the PHY worker threads and the
+ *              metrics thread are shared by all of them.
+ *              Each UE still has its own radio, sync, stack and GW
+ *              threads, so the thread count grows linearly with the
+ *              number of UEs. A shared RF front-end and FFT would need a
+ *              PHY that serves several UEs, which srsue does not have.
+ *****************************************************************************/
+
+#ifndef SRSUE_UE_HOST_H
+#define SRSUE_UE_HOST_H
+
+#include "srslte/common/metrics_hub.h"
+#include "srslte/common/thread_pool.h"
+#include "srslte/common/threads.h"
+#include "srsue/hdr/metrics_csv.h"
+#include "ue.h"
+#include <memory>
+#include <vector>
+
+namespace srsue {
+
+class ue_host : public srslte::periodic_thread
+{
+public:
+  ue_host();
+  ~ue_host();
+
+  int  init(const all_args_t& args_, srslte::logger* logger_);
+  void stop();
+  void switch_on();
+  void switch_off();
+
+  // Receives the metrics of the first UE
+  void set_metrics_listener(srslte::metrics_listener<ue_metrics_t>* listener) { metrics_listener = listener; }
+
+  uint32_t nof_ues() const { return ues.size(); }
+  ue*      get_ue(uint32_t idx) { return ues[idx].get(); }
+
+  // Arguments of the UE with index idx, derived from the arguments of the host
+  static all_args_t make_ue_args(const all_args_t& args, uint32_t idx);
+
+private:
+  void run_period() override;
+
+  all_args_t                                args;
+  bool                                      metrics_started = false;
+  bool                                      stopped         = false;
+  std::unique_ptr<srslte::task_thread_pool> background_tasks;
+  std::unique_ptr<srslte::task_thread_pool> phy_workers;
+  std::vector<std::unique_ptr<ue>>          ues;
+  std::vector<std::unique_ptr<metrics_csv>> metrics_files;
+
+  srslte::metrics_listener<ue_metrics_t>* metrics_listener = nullptr;
+  std::chrono::steady_clock::time_point   period_start;
+};
+
+} // namespace srsue
+
+#endif // SRSUE_UE_HOST_H
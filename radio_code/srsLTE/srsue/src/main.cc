@@ -29,6 +29,7 @@
 #include "srsue/hdr/metrics_csv.h"
 #include "srsue/hdr/metrics_stdout.h"
 #include "srsue/hdr/ue.h"
+#include "srsue/hdr/ue_host.h"
 #include <boost/program_options.hpp>
 #include <boost/program_options/parsers.hpp>
 #include <iostream>
@@ -127,6 +128,11 @@ static int parse_args(all_args_t* args, int argc, char* argv[])
 
     ("pcap.enable", bpo::value<bool>(&args->stack.pcap.enable)->default_value(false), "Enable MAC packet captures for wireshark")
     ("pcap.filename", bpo::value<string>(&args->stack.pcap.filename)->default_value("ue.pcap"), "MAC layer capture filename")
+    ("pcap.async", bpo::value<bool>(&args->stack.pcap.async)->default_value(false), "Write MAC packet captures from a background thread instead of the MAC threads")
+    ("pcap.max_file_size", bpo::value<int>(&args->stack.pcap.max_file_size)->default_value(-1), "Maximum MAC capture file size (in kilobytes) in async mode. When passed, multiple files are created. Default -1 (single file)")
+    ("pcap.rotation_period", bpo::value<uint32_t>(&args->stack.pcap.rotation_period)->default_value(0), "Start a new MAC capture file every rotation_period seconds in async mode. Default 0 (single file)")
+    ("pcap.filter_rnti", bpo::value<string>(&args->stack.pcap.filter_rnti)->default_value(""), "Comma-separated list of C-RNTIs to capture. Default empty (all)")
+    ("pcap.filter_lcid", bpo::value<string>(&args->stack.pcap.filter_lcid)->default_value(""), "Comma-separated list of LCIDs to capture. Default empty (all)")
     ("pcap.nas_enable",   bpo::value<bool>(&args->stack.pcap.nas_enable)->default_value(false), "Enable NAS packet captures for wireshark")
     ("pcap.nas_filename", bpo::value<string>(&args->stack.pcap.nas_filename)->default_value("ue_nas.pcap"), "NAS layer capture filename (useful when NAS encryption is enabled)")
 
@@ -156,6 +162,7 @@ static int parse_args(all_args_t* args, int argc, char* argv[])
 
     ("log.filename", bpo::value<string>(&args->log.filename)->default_value("/tmp/ue.log"), "Log filename")
     ("log.file_max_size", bpo::value<int>(&args->log.file_max_size)->default_value(-1), "Maximum file size (in kilobytes). When passed, multiple files are created. Default -1 (single file)")
+    ("log.backend", bpo::value<string>(&args->log.backend)->default_value("file"), "Log backend: file, async (text file, written from per-thread buffers) or binary (binary file for srslte_log_decoder)")
 
     ("usim.mode", bpo::value<string>(&args->stack.usim.mode)->default_value("soft"), "USIM mode (soft or pcsc)")
     ("usim.algo", bpo::value<string>(&args->stack.usim.algo), "USIM authentication algorithm")
@@ -403,6 +410,23 @@ static int parse_args(all_args_t* args, int argc, char* argv[])
            bpo::value<int>(&args->general.metrics_csv_flush_period_sec)->default_value(-1),
            "Periodicity in s to flush CSV file to disk (-1 for auto)")
 
+    /* Multi-UE launcher options */
+    ("host.nof_ues",
+        bpo::value<uint32_t>(&args->host.nof_ues)->default_value(1),
+        "Number of UEs run by this process. Each UE gets consecutive IMSI, TUN device and RF ports")
+
+    ("host.rf_port_step",
+        bpo::value<uint32_t>(&args->host.rf_port_step)->default_value(2),
+        "Offset between the tcp:// ports in rf.device_args of consecutive UEs")
+
+    ("host.nof_background_threads",
+        bpo::value<uint32_t>(&args->host.nof_background_threads)->default_value(2),
+        "Number of background threads shared by all the UEs")
+
+    ("host.nof_phy_threads",
+        bpo::value<uint32_t>(&args->host.nof_phy_threads)->default_value(3),
+        "Number of threads that run the PHY workers of all the UEs")
+
     ("stack.have_tti_time_stats",
         bpo::value<bool>(&args->stack.have_tti_time_stats)->default_value(true),
         "Calculate TTI execution statistics");
@@ -476,6 +500,11 @@ static int parse_args(all_args_t* args, int argc, char* argv[])
     args->stack.usim.using_op = vm.count("usim.op");
   }
 
+  if (args->log.backend != "file" && args->log.backend != "async" && args->log.backend != "binary") {
+    cout << "Error parsing log.backend: " << args->log.backend << " - must be file, async or binary." << endl;
+    return SRSLTE_ERROR;
+  }
+
   // Apply all_level to any unset layers
   if (vm.count("log.all_level")) {
     if (!vm.count("log.rf_level")) {
@@ -572,6 +601,39 @@ static void* input_loop(void*)
   return nullptr;
 }
 
+// Runs several UEs in this process. Metrics of the first UE are printed to stdout
+static int run_host(const all_args_t& args, srslte::logger* logger)
+{
+  srsue::ue_host host;
+  metrics_stdout _metrics_screen;
+
+  metrics_screen = &_metrics_screen;
+  host.set_metrics_listener(metrics_screen);
+  if (host.init(args, logger)) {
+    host.stop();
+    return SRSLTE_SUCCESS;
+  }
+  metrics_screen->set_ue_handle(host.get_ue(0));
+
+  pthread_t input;
+  pthread_create(&input, nullptr, &input_loop, (void*)&args);
+
+  cout << "Attaching " << host.nof_ues() << " UEs..." << endl;
+  host.switch_on();
+
+  while (running) {
+    sleep(1);
+  }
+
+  host.switch_off();
+  pthread_cancel(input);
+  pthread_join(input, nullptr);
+  host.stop();
+  cout << "---  exiting  ---" << endl;
+
+  return SRSLTE_SUCCESS;
+}
+
 int main(int argc, char* argv[])
 {
   srslte_register_signal_handler();
@@ -587,12 +649,21 @@ int main(int argc, char* argv[])
   srslte::logger* logger = nullptr;
   if (args.log.filename == "stdout") {
     logger = &logger_stdout;
-  } else {
+  } else if (args.log.backend == "file") {
     logger_file.init(args.log.filename, args.log.file_max_size);
     logger = &logger_file;
+  } else {
+    logger_binary.init(args.log.filename,
+                       args.log.backend == "binary" ? srslte::logger_binary::BINARY : srslte::logger_binary::TEXT,
+                       args.log.file_max_size);
+    logger = &logger_binary;
   }
   srslte::logmap::set_default_logger(logger);
 
+  if (args.host.nof_ues > 1) {
+    return run_host(args, logger);
+  }
+
   // Create UE instance
   srsue::ue ue;
   if (ue.init(args, logger)) {
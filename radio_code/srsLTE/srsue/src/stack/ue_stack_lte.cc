@@ -30,7 +30,7 @@ using namespace srslte;
 
 namespace srsue {
 
-ue_stack_lte::ue_stack_lte() :
+ue_stack_lte::ue_stack_lte(srslte::task_thread_pool* shared_background_tasks) :
   timers(64),
   running(false),
   args(),
@@ -44,7 +44,8 @@ ue_stack_lte::ue_stack_lte() :
   nas(this),
   thread("STACK"),
   pending_tasks(512),
-  background_tasks(2),
+  own_background_tasks(shared_background_tasks != nullptr ? 0 : 2),
+  background_tasks(shared_background_tasks != nullptr ? shared_background_tasks : &own_background_tasks),
   tti_tprof("tti_tprof", "STCK", TTI_STAT_PERIOD)
 {
   ue_queue_id         = pending_tasks.add_queue();
@@ -53,7 +54,7 @@ ue_stack_lte::ue_stack_lte() :
   stack_queue_id      = pending_tasks.add_queue();
   background_queue_id = pending_tasks.add_queue();
 
-  background_tasks.start();
+  own_background_tasks.start();
 }
 
 ue_stack_lte::~ue_stack_lte()
@@ -108,7 +109,14 @@ int ue_stack_lte::init(const stack_args_t& args_, srslte::logger* logger_)
 
   // Set up pcap
   if (args.pcap.enable) {
-    mac_pcap.open(args.pcap.filename.c_str());
+    if (mac_pcap.set_filters(args.pcap.filter_rnti, args.pcap.filter_lcid) != SRSLTE_SUCCESS) {
+      return SRSLTE_ERROR;
+    }
+    if (args.pcap.async) {
+      mac_pcap.open_async(args.pcap.filename.c_str(), 0, args.pcap.max_file_size, args.pcap.rotation_period);
+    } else {
+      mac_pcap.open(args.pcap.filename.c_str());
+    }
     mac.start_pcap(&mac_pcap);
   }
   if (args.pcap.nas_enable) {
@@ -324,7 +332,7 @@ void ue_stack_lte::run_tti_impl(uint32_t tti, uint32_t tti_jump)
 
 void ue_stack_lte::enqueue_background_task(std::function<void(uint32_t)> f)
 {
-  background_tasks.push_task(std::move(f));
+  background_tasks->push_task(std::move(f));
 }
 
 void ue_stack_lte::notify_background_task_result(srslte::move_task_t task)
@@ -349,7 +357,7 @@ void ue_stack_lte::defer_task(srslte::move_task_t task)
 
 void ue_stack_lte::start_cell_search()
 {
-  background_tasks.push_task([this](uint32_t worker_id) {
+  background_tasks->push_task([this](uint32_t worker_id) {
     phy_interface_rrc_lte::phy_cell_t        found_cell;
     phy_interface_rrc_lte::cell_search_ret_t ret = phy->cell_search(&found_cell);
     // notify back RRC
@@ -359,7 +367,7 @@ void ue_stack_lte::start_cell_search()
 
 void ue_stack_lte::start_cell_select(const phy_interface_rrc_lte::phy_cell_t* phy_cell)
 {
-  background_tasks.push_task([this, phy_cell](uint32_t worker_id) {
+  background_tasks->push_task([this, phy_cell](uint32_t worker_id) {
     bool ret = phy->cell_select(phy_cell);
     // notify back RRC
     pending_tasks.push(background_queue_id, [this, ret]() { rrc.cell_select_completed(ret); });
@@ -26,6 +26,7 @@
 #include "srsue/hdr/phy/phy.h"
 #include "srsue/hdr/stack/ue_stack_lte.h"
 #include <algorithm>
+#include <atomic>
 #include <iostream>
 #include <iterator>
 #include <pthread.h>
@@ -36,10 +37,15 @@ using namespace srslte;
 
 namespace srsue {
 
+// The buffer pool is shared by all the UEs of the process, and is cleaned up with the last one
+static std::atomic<uint32_t> nof_ue_instances{0};
+
 ue::ue() : logger(nullptr)
 {
   // print build info
-  std::cout << std::endl << get_build_string() << std::endl;
+  if (nof_ue_instances++ == 0) {
+    std::cout << std::endl << get_build_string() << std::endl;
+  }
   pool = byte_buffer_pool::get_instance();
 }
 
@@ -47,10 +53,15 @@ ue::~ue()
 {
   // destruct stack components before cleaning buffer pool
   stack.reset();
-  byte_buffer_pool::cleanup();
+  if (--nof_ue_instances == 0) {
+    byte_buffer_pool::cleanup();
+  }
 }
 
-int ue::init(const all_args_t& args_, srslte::logger* logger_)
+int ue::init(const all_args_t&         args_,
+             srslte::logger*           logger_,
+             srslte::task_thread_pool* background_tasks,
+             srslte::task_thread_pool* phy_workers)
 {
   int ret = SRSLTE_SUCCESS;
   logger = logger_;
@@ -68,7 +79,7 @@ int ue::init(const all_args_t& args_, srslte::logger* logger_)
 
   // Instantiate layers and stack together our UE
   if (args.stack.type == "lte") {
-    std::unique_ptr<ue_stack_lte> lte_stack(new ue_stack_lte());
+    std::unique_ptr<ue_stack_lte> lte_stack(new ue_stack_lte(background_tasks));
     if (!lte_stack) {
       log.console("Error creating LTE stack instance.\n");
       return SRSLTE_ERROR;
@@ -92,6 +103,10 @@ int ue::init(const all_args_t& args_, srslte::logger* logger_)
       return SRSLTE_ERROR;
     }
 
+    if (phy_workers != nullptr) {
+      lte_phy->set_workers_executor(phy_workers);
+    }
+
     // init layers (do not exit immedietly if something goes wrong as sub-layers may already use interfaces)
     if (lte_radio->init(args.rf, lte_phy.get())) {
       log.console("Error initializing radio.\n");
@@ -0,0 +1,235 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srsue/hdr/ue_host.h"
+#include "srsue/hdr/phy/phy.h"
+#include <inttypes.h>
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+
+namespace srsue {
+
+// Adds offset to the port of every "tcp://address:port" endpoint in the RF device arguments
+static std::string shift_tcp_ports(const std::string& device_args, uint32_t offset)
+{
+  std::string ret = device_args;
+  size_t      pos = 0;
+  while (offset > 0 and (pos = ret.find("tcp://", pos)) != std::string::npos) {
+    size_t host_start = pos + strlen("tcp://");
+    size_t port_sep   = ret.find(':', host_start);
+    size_t port_end   = ret.find_first_not_of("0123456789", port_sep + 1);
+    if (port_sep == std::string::npos or port_sep > ret.find(',', host_start)) {
+      pos = host_start;
+      continue;
+    }
+    port_end      = std::min(port_end, ret.size());
+    uint32_t port = (uint32_t)strtoul(ret.c_str() + port_sep + 1, nullptr, 10);
+    ret.replace(port_sep + 1, port_end - port_sep - 1, std::to_string(port + offset));
+    pos = port_sep;
+  }
+  return ret;
+}
+
+// Inserts the UE index before the extension of filename
+static std::string indexed_filename(const std::string& filename, uint32_t idx)
+{
+  size_t dot   = filename.rfind('.');
+  size_t slash = filename.rfind('/');
+  if (dot == std::string::npos or (slash != std::string::npos and dot < slash)) {
+    return filename + "_" + std::to_string(idx);
+  }
+  return filename.substr(0, dot) + "_" + std::to_string(idx) + filename.substr(dot);
+}
+
+// Adds idx to the serial number of a 15 digit IMEI and recomputes its Luhn check digit
+static std::string indexed_imei(const std::string& imei, uint32_t idx)
+{
+  if (imei.size() != 15 or imei.find_first_not_of("0123456789") != std::string::npos) {
+    return imei;
+  }
+  uint64_t body = (strtoull(imei.substr(0, 14).c_str(), nullptr, 10) + idx) % 100000000000000ULL;
+  char     body_str[16];
+  snprintf(body_str, sizeof(body_str), "%014" PRIu64, body);
+
+  uint32_t sum = 0;
+  for (uint32_t i = 0; i < 14; i++) {
+    uint32_t d = body_str[i] - '0';
+    if (i % 2 == 1) {
+      d *= 2;
+      d = d > 9 ? d - 9 : d;
+    }
+    sum += d;
+  }
+  return std::string(body_str) + std::to_string((10 - sum % 10) % 10);
+}
+
+ue_host::ue_host() : periodic_thread("UE_HOST") {}
+
+ue_host::~ue_host()
+{
+  stop();
+}
+
+all_args_t ue_host::make_ue_args(const all_args_t& args, uint32_t idx)
+{
+  all_args_t ue_args   = args;
+  ue_args.host.nof_ues = 1;
+
+  // Consecutive IMSIs
+  if (not args.stack.usim.imsi.empty()) {
+    uint64_t imsi = strtoull(args.stack.usim.imsi.c_str(), nullptr, 10) + idx;
+    char     imsi_str[32];
+    snprintf(imsi_str, sizeof(imsi_str), "%0*" PRIu64, (int)args.stack.usim.imsi.size(), imsi);
+    ue_args.stack.usim.imsi = imsi_str;
+  }
+  ue_args.stack.usim.imei = indexed_imei(args.stack.usim.imei, idx);
+
+  // Each UE connects to its own RF ports
+  ue_args.rf.device_args = shift_tcp_ports(args.rf.device_args, idx * args.host.rf_port_step);
+
+  // One TUN device, and network namespace if used, per UE
+  ue_args.gw.tun_dev_name += std::to_string(idx);
+  if (not args.gw.netns.empty()) {
+    ue_args.gw.netns += std::to_string(idx);
+  }
+
+  // One capture, trace and metrics file per UE
+  ue_args.stack.pcap.filename          = indexed_filename(args.stack.pcap.filename, idx);
+  ue_args.stack.pcap.nas_filename      = indexed_filename(args.stack.pcap.nas_filename, idx);
+  ue_args.trace.phy_filename           = indexed_filename(args.trace.phy_filename, idx);
+  ue_args.trace.radio_filename         = indexed_filename(args.trace.radio_filename, idx);
+  ue_args.general.metrics_csv_filename = indexed_filename(args.general.metrics_csv_filename, idx);
+
+  return ue_args;
+}
+
+int ue_host::init(const all_args_t& args_, srslte::logger* logger_)
+{
+  args = args_;
+
+  background_tasks.reset(new srslte::task_thread_pool(std::max(args.host.nof_background_threads, 1u)));
+  background_tasks->start();
+
+  // The subframe workers of every UE run on the same threads. The pool is FIFO, which the workers rely on: a worker
+  // waits for the previous subframe of its UE to be transmitted, and that one was queued, hence started, before it
+  phy_workers.reset(new srslte::task_thread_pool(std::max(args.host.nof_phy_threads, 1u)));
+  phy_workers->start(phy::WORKERS_THREAD_PRIO, args.phy.worker_cpu_mask);
+
+  for (uint32_t i = 0; i < args.host.nof_ues; i++) {
+    all_args_t ue_args = make_ue_args(args, i);
+
+    ues.emplace_back(new ue());
+    if (ues.back()->init(ue_args, logger_, background_tasks.get(), phy_workers.get())) {
+      std::cout << "Error initializing UE " << i << std::endl;
+      return SRSLTE_ERROR;
+    }
+
+    if (args.general.metrics_csv_enable) {
+      metrics_files.emplace_back(
+          new metrics_csv(ue_args.general.metrics_csv_filename, ue_args.general.metrics_csv_append));
+      metrics_files.back()->set_ue_handle(ues.back().get());
+      if (args.general.metrics_csv_flush_period_sec > 0) {
+        metrics_files.back()->set_flush_period((uint32_t)args.general.metrics_csv_flush_period_sec);
+      }
+    }
+  }
+
+  // A single thread collects the metrics of all the UEs
+  period_start    = std::chrono::steady_clock::now();
+  metrics_started = true;
+  start_periodic(args.general.metrics_period_secs * 1e6, -2);
+
+  return SRSLTE_SUCCESS;
+}
+
+void ue_host::stop()
+{
+  if (stopped) {
+    return;
+  }
+  stopped = true;
+
+  if (metrics_started) {
+    metrics_started = false;
+    stop_thread();
+    for (auto& f : metrics_files) {
+      f->stop();
+    }
+    if (metrics_listener != nullptr) {
+      metrics_listener->stop();
+    }
+  }
+
+  for (auto& u : ues) {
+    u->stop();
+  }
+
+  // Stop the shared pools only once no PHY or stack can push tasks
+  if (phy_workers != nullptr) {
+    phy_workers->stop();
+  }
+  if (background_tasks != nullptr) {
+    background_tasks->stop();
+  }
+}
+
+void ue_host::switch_on()
+{
+  for (auto& u : ues) {
+    u->switch_on();
+  }
+}
+
+void ue_host::switch_off()
+{
+  // Each UE waits for its detach to be sent, so detach all of them in parallel
+  std::vector<std::thread> detach_threads;
+  for (auto& u : ues) {
+    ue* u_ptr = u.get();
+    detach_threads.emplace_back([u_ptr]() { u_ptr->switch_off(); });
+  }
+  for (auto& t : detach_threads) {
+    t.join();
+  }
+}
+
+void ue_host::run_period()
+{
+  auto     now         = std::chrono::steady_clock::now();
+  uint32_t period_usec = std::chrono::duration_cast<std::chrono::microseconds>(now - period_start).count();
+
+  for (uint32_t i = 0; i < ues.size(); i++) {
+    ue_metrics_t metrics;
+    ues[i]->get_metrics(&metrics);
+    if (i < metrics_files.size()) {
+      metrics_files[i]->set_metrics(metrics, period_usec);
+    }
+    if (i == 0 and metrics_listener != nullptr) {
+      metrics_listener->set_metrics(metrics, period_usec);
+    }
+  }
+  period_start = now;
+}
+
+} // namespace srsue